@@ -0,0 +1,540 @@
+# Linked list traversal, 256 nodes of {value, next} spread over memory in a
+# shuffled order and walked 600 times. Every load depends on the one before.
+# Result at 0x00400800 (and in $v0) is the sum of every value seen, 0x012ad400
+# The head pointer is at 0x00400804 and the nodes start at 0x00400808
+
+00400000 : <text>
+  400000:	3c1c0040 	lui $gp 0x40            ; gp = 0x00400000, the data is addressed off it
+  400004:	24170258 	addiu $s7 $zero 600     ; s7 = walks left
+  400008:	24020000 	addiu $v0 $zero 0       ; v0 = sum of the values seen
+  40000c:	8f880804 	lw $t0 0x804($gp)       ; rep: t0 = head of the list
+  400010:	8d090000 	lw $t1 0($t0)           ; walk: t1 = value
+  400014:	8d080004 	lw $t0 4($t0)           ; t0 = next
+  400018:	00491021 	addu $v0 $v0 $t1
+  40001c:	1500fffc 	bne $t0 $zero walk
+  400020:	00000000 	nop
+  400024:	26f7ffff 	addiu $s7 $s7 -1
+  400028:	1ee0fff8 	bgtz $s7 rep
+  40002c:	00000000 	nop
+  400030:	af820800 	sw $v0 0x800($gp)       ; result = v0
+  400034:	24080004 	addiu $t0 $zero 4       ; wait for the result to be written back
+  400038:	2508ffff 	addiu $t0 $t0 -1        ; drain: a wide pipeline fetches the halt early
+  40003c:	1500fffe 	bne $t0 $zero drain
+  400040:	00000000 	nop
+  400044:	1000ffff 	beq $zero $zero -1      ; halt
+
+00400800 : <data>
+  400800:	00000000
+  400804:	00400fe0
+  400808:	0000000b
+  40080c:	00400ec0
+  400810:	00000030
+  400814:	00400e80
+  400818:	00000055
+  40081c:	004008c0
+  400820:	0000007a
+  400824:	00400880
+  400828:	0000009f
+  40082c:	004009d0
+  400830:	000000c4
+  400834:	00400dd8
+  400838:	000000e9
+  40083c:	00400cc0
+  400840:	0000000e
+  400844:	00400aa0
+  400848:	00000033
+  40084c:	00400a18
+  400850:	00000058
+  400854:	00400960
+  400858:	0000007d
+  40085c:	00400cc8
+  400860:	000000a2
+  400864:	00400bc8
+  400868:	000000c7
+  40086c:	00400b30
+  400870:	000000ec
+  400874:	00400ff8
+  400878:	00000011
+  40087c:	00400bf0
+  400880:	00000036
+  400884:	00400f70
+  400888:	0000005b
+  40088c:	00400898
+  400890:	00000080
+  400894:	00400d98
+  400898:	000000a5
+  40089c:	00400a88
+  4008a0:	000000ca
+  4008a4:	00400cf8
+  4008a8:	000000ef
+  4008ac:	00400fb8
+  4008b0:	00000014
+  4008b4:	00400c30
+  4008b8:	00000039
+  4008bc:	00400fe8
+  4008c0:	0000005e
+  4008c4:	004009a8
+  4008c8:	00000083
+  4008cc:	00400c98
+  4008d0:	000000a8
+  4008d4:	004008f8
+  4008d8:	000000cd
+  4008dc:	00400fa0
+  4008e0:	000000f2
+  4008e4:	00400a30
+  4008e8:	00000017
+  4008ec:	00400ec8
+  4008f0:	0000003c
+  4008f4:	00400f10
+  4008f8:	00000061
+  4008fc:	00400ae8
+  400900:	00000086
+  400904:	00400df0
+  400908:	000000ab
+  40090c:	00400900
+  400910:	000000d0
+  400914:	00400ad8
+  400918:	000000f5
+  40091c:	00400888
+  400920:	0000001a
+  400924:	004009c0
+  400928:	0000003f
+  40092c:	00400860
+  400930:	00000064
+  400934:	00400f90
+  400938:	00000089
+  40093c:	00400f80
+  400940:	000000ae
+  400944:	00400df8
+  400948:	000000d3
+  40094c:	00400d30
+  400950:	000000f8
+  400954:	00400dc0
+  400958:	0000001d
+  40095c:	00400878
+  400960:	00000042
+  400964:	00400bd8
+  400968:	00000067
+  40096c:	00400b70
+  400970:	0000008c
+  400974:	00400cd0
+  400978:	000000b1
+  40097c:	00400ce0
+  400980:	000000d6
+  400984:	00400d60
+  400988:	000000fb
+  40098c:	004008a0
+  400990:	00000020
+  400994:	00400918
+  400998:	00000045
+  40099c:	00400970
+  4009a0:	0000006a
+  4009a4:	00400fc0
+  4009a8:	0000008f
+  4009ac:	004009d8
+  4009b0:	000000b4
+  4009b4:	00400990
+  4009b8:	000000d9
+  4009bc:	00400a90
+  4009c0:	000000fe
+  4009c4:	00400ef0
+  4009c8:	00000023
+  4009cc:	004009e0
+  4009d0:	00000048
+  4009d4:	00400998
+  4009d8:	0000006d
+  4009dc:	00400a98
+  4009e0:	00000092
+  4009e4:	00400f28
+  4009e8:	000000b7
+  4009ec:	00400d40
+  4009f0:	000000dc
+  4009f4:	00400ff0
+  4009f8:	00000001
+  4009fc:	00400ce8
+  400a00:	00000026
+  400a04:	00400eb8
+  400a08:	0000004b
+  400a0c:	004009f8
+  400a10:	00000070
+  400a14:	00400d70
+  400a18:	00000095
+  400a1c:	00400ea0
+  400a20:	000000ba
+  400a24:	00400be8
+  400a28:	000000df
+  400a2c:	00400c58
+  400a30:	00000004
+  400a34:	00400980
+  400a38:	00000029
+  400a3c:	00400ab8
+  400a40:	0000004e
+  400a44:	00400ba0
+  400a48:	00000073
+  400a4c:	00400db0
+  400a50:	00000098
+  400a54:	00400928
+  400a58:	000000bd
+  400a5c:	004009c8
+  400a60:	000000e2
+  400a64:	00400dc8
+  400a68:	00000007
+  400a6c:	00400eb0
+  400a70:	0000002c
+  400a74:	00400838
+  400a78:	00000051
+  400a7c:	00400c88
+  400a80:	00000076
+  400a84:	004008e0
+  400a88:	0000009b
+  400a8c:	00400b08
+  400a90:	000000c0
+  400a94:	00400c38
+  400a98:	000000e5
+  400a9c:	00400ee0
+  400aa0:	0000000a
+  400aa4:	00400af0
+  400aa8:	0000002f
+  400aac:	00400f50
+  400ab0:	00000054
+  400ab4:	00400d38
+  400ab8:	00000079
+  400abc:	00400f18
+  400ac0:	0000009e
+  400ac4:	00400a58
+  400ac8:	000000c3
+  400acc:	00400bf8
+  400ad0:	000000e8
+  400ad4:	00400a80
+  400ad8:	0000000d
+  400adc:	00400d18
+  400ae0:	00000032
+  400ae4:	00400ed0
+  400ae8:	00000057
+  400aec:	00400c40
+  400af0:	0000007c
+  400af4:	00400a20
+  400af8:	000000a1
+  400afc:	00400e68
+  400b00:	000000c6
+  400b04:	00400d80
+  400b08:	000000eb
+  400b0c:	00400ca8
+  400b10:	00000010
+  400b14:	00400bd0
+  400b18:	00000035
+  400b1c:	00400910
+  400b20:	0000005a
+  400b24:	00400e48
+  400b28:	0000007f
+  400b2c:	00400a60
+  400b30:	000000a4
+  400b34:	00400d10
+  400b38:	000000c9
+  400b3c:	00400e70
+  400b40:	000000ee
+  400b44:	00400908
+  400b48:	00000013
+  400b4c:	00400ba8
+  400b50:	00000038
+  400b54:	00400968
+  400b58:	0000005d
+  400b5c:	00400ca0
+  400b60:	00000082
+  400b64:	00400aa8
+  400b68:	000000a7
+  400b6c:	00400b20
+  400b70:	000000cc
+  400b74:	00400840
+  400b78:	000000f1
+  400b7c:	00400d28
+  400b80:	00000016
+  400b84:	00401000
+  400b88:	0000003b
+  400b8c:	00400938
+  400b90:	00000060
+  400b94:	00000000
+  400b98:	00000085
+  400b9c:	00400a10
+  400ba0:	000000aa
+  400ba4:	00400b10
+  400ba8:	000000cf
+  400bac:	004009b0
+  400bb0:	000000f4
+  400bb4:	00400b40
+  400bb8:	00000019
+  400bbc:	00400e08
+  400bc0:	0000003e
+  400bc4:	00400958
+  400bc8:	00000063
+  400bcc:	00400ad0
+  400bd0:	00000088
+  400bd4:	004009e8
+  400bd8:	000000ad
+  400bdc:	00400d68
+  400be0:	000000d2
+  400be4:	00400950
+  400be8:	000000f7
+  400bec:	00400c08
+  400bf0:	0000001c
+  400bf4:	00400c50
+  400bf8:	00000041
+  400bfc:	00400e28
+  400c00:	00000066
+  400c04:	00400d58
+  400c08:	0000008b
+  400c0c:	004009b8
+  400c10:	000000b0
+  400c14:	00400be0
+  400c18:	000000d5
+  400c1c:	00400c60
+  400c20:	000000fa
+  400c24:	00400858
+  400c28:	0000001f
+  400c2c:	00400a28
+  400c30:	00000044
+  400c34:	00400fb0
+  400c38:	00000069
+  400c3c:	00400b98
+  400c40:	0000008e
+  400c44:	00400828
+  400c48:	000000b3
+  400c4c:	00400dd0
+  400c50:	000000d8
+  400c54:	00400b90
+  400c58:	000000fd
+  400c5c:	00400c78
+  400c60:	00000022
+  400c64:	00400f30
+  400c68:	00000047
+  400c6c:	00400b48
+  400c70:	0000006c
+  400c74:	00400a50
+  400c78:	00000091
+  400c7c:	00400e88
+  400c80:	000000b6
+  400c84:	00400820
+  400c88:	000000db
+  400c8c:	00400e40
+  400c90:	00000000
+  400c94:	00400e10
+  400c98:	00000025
+  400c9c:	00400da0
+  400ca0:	0000004a
+  400ca4:	004008b0
+  400ca8:	0000006f
+  400cac:	00400988
+  400cb0:	00000094
+  400cb4:	00400b80
+  400cb8:	000000b9
+  400cbc:	00400c10
+  400cc0:	000000de
+  400cc4:	00400cb0
+  400cc8:	00000003
+  400ccc:	00400a78
+  400cd0:	00000028
+  400cd4:	00400b00
+  400cd8:	0000004d
+  400cdc:	00400f08
+  400ce0:	00000072
+  400ce4:	00400c68
+  400ce8:	00000097
+  400cec:	00400920
+  400cf0:	000000bc
+  400cf4:	00400f40
+  400cf8:	000000e1
+  400cfc:	004008f0
+  400d00:	00000006
+  400d04:	00400e50
+  400d08:	0000002b
+  400d0c:	00400ab0
+  400d10:	00000050
+  400d14:	00400f60
+  400d18:	00000075
+  400d1c:	00400e30
+  400d20:	0000009a
+  400d24:	00400b60
+  400d28:	000000bf
+  400d2c:	00400db8
+  400d30:	000000e4
+  400d34:	00400e58
+  400d38:	00000009
+  400d3c:	00400818
+  400d40:	0000002e
+  400d44:	00400cb8
+  400d48:	00000053
+  400d4c:	00400a08
+  400d50:	00000078
+  400d54:	00400848
+  400d58:	0000009d
+  400d5c:	004008e8
+  400d60:	000000c2
+  400d64:	00400948
+  400d68:	000000e7
+  400d6c:	00400b38
+  400d70:	0000000c
+  400d74:	00400e78
+  400d78:	00000031
+  400d7c:	00400f78
+  400d80:	00000056
+  400d84:	00400bc0
+  400d88:	0000007b
+  400d8c:	00400a00
+  400d90:	000000a0
+  400d94:	00400fd0
+  400d98:	000000c5
+  400d9c:	00400ac8
+  400da0:	000000ea
+  400da4:	00400e60
+  400da8:	0000000f
+  400dac:	00400de0
+  400db0:	00000034
+  400db4:	00400870
+  400db8:	00000059
+  400dbc:	00400d48
+  400dc0:	0000007e
+  400dc4:	00400c28
+  400dc8:	000000a3
+  400dcc:	00400f48
+  400dd0:	000000c8
+  400dd4:	00400fd8
+  400dd8:	000000ed
+  400ddc:	00400810
+  400de0:	00000012
+  400de4:	00400ed8
+  400de8:	00000037
+  400dec:	00400d20
+  400df0:	0000005c
+  400df4:	00400a38
+  400df8:	00000081
+  400dfc:	00400af8
+  400e00:	000000a6
+  400e04:	00400bb0
+  400e08:	000000cb
+  400e0c:	00400f38
+  400e10:	000000f0
+  400e14:	00400c00
+  400e18:	00000015
+  400e1c:	00400fa8
+  400e20:	0000003a
+  400e24:	00400830
+  400e28:	0000005f
+  400e2c:	00400f00
+  400e30:	00000084
+  400e34:	00400a70
+  400e38:	000000a9
+  400e3c:	00400ef8
+  400e40:	000000ce
+  400e44:	00400d88
+  400e48:	000000f3
+  400e4c:	004008a8
+  400e50:	00000018
+  400e54:	00400b88
+  400e58:	0000003d
+  400e5c:	00400a40
+  400e60:	00000062
+  400e64:	00400ea8
+  400e68:	00000087
+  400e6c:	00400f68
+  400e70:	000000ac
+  400e74:	00400b58
+  400e78:	000000d1
+  400e7c:	00400e38
+  400e80:	000000f6
+  400e84:	00400d00
+  400e88:	0000001b
+  400e8c:	00400d50
+  400e90:	00000040
+  400e94:	00400c70
+  400e98:	00000065
+  400e9c:	00400808
+  400ea0:	0000008a
+  400ea4:	00400e98
+  400ea8:	000000af
+  400eac:	00400930
+  400eb0:	000000d4
+  400eb4:	00400c80
+  400eb8:	000000f9
+  400ebc:	00400850
+  400ec0:	0000001e
+  400ec4:	004008d8
+  400ec8:	00000043
+  400ecc:	00400c48
+  400ed0:	00000068
+  400ed4:	00400978
+  400ed8:	0000008d
+  400edc:	00400b78
+  400ee0:	000000b2
+  400ee4:	004008c8
+  400ee8:	000000d7
+  400eec:	00400b68
+  400ef0:	000000fc
+  400ef4:	00400c90
+  400ef8:	00000021
+  400efc:	00400868
+  400f00:	00000046
+  400f04:	00400b18
+  400f08:	0000006b
+  400f0c:	00400da8
+  400f10:	00000090
+  400f14:	00400c18
+  400f18:	000000b5
+  400f1c:	00400f20
+  400f20:	000000da
+  400f24:	00400bb8
+  400f28:	000000ff
+  400f2c:	00400c20
+  400f30:	00000024
+  400f34:	00400ee8
+  400f38:	00000049
+  400f3c:	004009f0
+  400f40:	0000006e
+  400f44:	00400890
+  400f48:	00000093
+  400f4c:	00400f58
+  400f50:	000000b8
+  400f54:	00400d08
+  400f58:	000000dd
+  400f5c:	00400e20
+  400f60:	00000002
+  400f64:	00400de8
+  400f68:	00000027
+  400f6c:	00400e00
+  400f70:	0000004c
+  400f74:	00400e18
+  400f78:	00000071
+  400f7c:	00400ac0
+  400f80:	00000096
+  400f84:	00400b50
+  400f88:	000000bb
+  400f8c:	00400fc8
+  400f90:	000000e0
+  400f94:	00400a48
+  400f98:	00000005
+  400f9c:	004008b8
+  400fa0:	0000002a
+  400fa4:	00400a68
+  400fa8:	0000004f
+  400fac:	00400cd8
+  400fb0:	00000074
+  400fb4:	00400b28
+  400fb8:	00000099
+  400fbc:	00400940
+  400fc0:	000000be
+  400fc4:	00400d78
+  400fc8:	000000e3
+  400fcc:	004009a0
+  400fd0:	00000008
+  400fd4:	00400e90
+  400fd8:	0000002d
+  400fdc:	00400f98
+  400fe0:	00000052
+  400fe4:	00400f88
+  400fe8:	00000077
+  400fec:	00400cf0
+  400ff0:	0000009c
+  400ff4:	004008d0
+  400ff8:	000000c1
+  400ffc:	00400d90
+  401000:	000000e6
+  401004:	00400ae0
@@ -0,0 +1,502 @@
+# Matrix multiply, C = A*B of 12x12 words, 16 times. There is no multiply
+# instruction, products are done by shift and add.
+# Result at 0x00400800 (and in $v0) is the sum of C, 0x00017690
+# A is at 0x00400804, B at 0x00400a44 and C at 0x00400c84
+
+00400000 : <text>
+  400000:	3c1c0040 	lui $gp 0x40            ; gp = 0x00400000, the data is addressed off it
+  400004:	24170010 	addiu $s7 $zero 16      ; s7 = times left to multiply
+  400008:	24100000 	addiu $s0 $zero 0       ; rep: s0 = i
+  40000c:	24110000 	addiu $s1 $zero 0       ; iloop: s1 = j
+  400010:	24190000 	addiu $t9 $zero 0       ; jloop: t9 = C[i][j] so far
+  400014:	24120000 	addiu $s2 $zero 0       ; s2 = k
+  400018:	00104140 	sll $t0 $s0 5           ; t0 = i*48, offset of row i
+  40001c:	00104900 	sll $t1 $s0 4
+  400020:	01094021 	addu $t0 $t0 $t1
+  400024:	011c4021 	addu $t0 $t0 $gp
+  400028:	00114880 	sll $t1 $s1 2           ; t1 = j*4, offset of column j
+  40002c:	013c4821 	addu $t1 $t1 $gp
+  400030:	8d040804 	lw $a0 0x804($t0)       ; kloop: a0 = A[i][k]
+  400034:	8d250a44 	lw $a1 0xa44($t1)       ; a1 = B[k][j]
+  400038:	24030000 	addiu $v1 $zero 0       ; v1 = a0*a1 by shift and add
+  40003c:	30aa0001 	andi $t2 $a1 1          ; mul: low bit of the multiplier
+  400040:	11400002 	beq $t2 $zero skip
+  400044:	00000000 	nop
+  400048:	00641821 	addu $v1 $v1 $a0
+  40004c:	00052842 	srl $a1 $a1 1           ; skip: next bit
+  400050:	14a0fffa 	bne $a1 $zero mul
+  400054:	00042040 	sll $a0 $a0 1           ; (delay slot) double the multiplicand
+  400058:	0323c821 	addu $t9 $t9 $v1        ; C[i][j] += A[i][k]*B[k][j]
+  40005c:	25080004 	addiu $t0 $t0 4
+  400060:	26520001 	addiu $s2 $s2 1
+  400064:	2a4b000c 	slti $t3 $s2 12
+  400068:	1560fff1 	bne $t3 $zero kloop
+  40006c:	25290030 	addiu $t1 $t1 48        ; (delay slot) next row of B
+  400070:	00104140 	sll $t0 $s0 5           ; t0 = offset of C[i][j]
+  400074:	00104900 	sll $t1 $s0 4
+  400078:	01094021 	addu $t0 $t0 $t1
+  40007c:	00114880 	sll $t1 $s1 2
+  400080:	01094021 	addu $t0 $t0 $t1
+  400084:	011c4021 	addu $t0 $t0 $gp
+  400088:	ad190c84 	sw $t9 0xc84($t0)       ; C[i][j] = t9
+  40008c:	26310001 	addiu $s1 $s1 1
+  400090:	2a2b000c 	slti $t3 $s1 12
+  400094:	1560ffde 	bne $t3 $zero jloop
+  400098:	00000000 	nop
+  40009c:	26100001 	addiu $s0 $s0 1
+  4000a0:	2a0b000c 	slti $t3 $s0 12
+  4000a4:	1560ffd9 	bne $t3 $zero iloop
+  4000a8:	00000000 	nop
+  4000ac:	26f7ffff 	addiu $s7 $s7 -1
+  4000b0:	1ee0ffd5 	bgtz $s7 rep
+  4000b4:	00000000 	nop
+  4000b8:	24020000 	addiu $v0 $zero 0       ; v0 = sum of C
+  4000bc:	24080000 	addiu $t0 $zero 0
+  4000c0:	011c4821 	addu $t1 $t0 $gp        ; sum:
+  4000c4:	8d290c84 	lw $t1 0xc84($t1)
+  4000c8:	00491021 	addu $v0 $v0 $t1
+  4000cc:	25080004 	addiu $t0 $t0 4
+  4000d0:	290b0240 	slti $t3 $t0 576
+  4000d4:	1560fffa 	bne $t3 $zero sum
+  4000d8:	00000000 	nop
+  4000dc:	af820800 	sw $v0 0x800($gp)       ; result = v0
+  4000e0:	24080004 	addiu $t0 $zero 4       ; wait for the result to be written back
+  4000e4:	2508ffff 	addiu $t0 $t0 -1        ; drain: a wide pipeline fetches the halt early
+  4000e8:	1500fffe 	bne $t0 $zero drain
+  4000ec:	00000000 	nop
+  4000f0:	1000ffff 	beq $zero $zero -1      ; halt
+
+00400800 : <data>
+  400800:	00000000
+  400804:	00000001
+  400808:	00000004
+  40080c:	00000007
+  400810:	0000000a
+  400814:	0000000d
+  400818:	00000000
+  40081c:	00000003
+  400820:	00000006
+  400824:	00000009
+  400828:	0000000c
+  40082c:	0000000f
+  400830:	00000002
+  400834:	00000008
+  400838:	0000000b
+  40083c:	0000000e
+  400840:	00000001
+  400844:	00000004
+  400848:	00000007
+  40084c:	0000000a
+  400850:	0000000d
+  400854:	00000000
+  400858:	00000003
+  40085c:	00000006
+  400860:	00000009
+  400864:	0000000f
+  400868:	00000002
+  40086c:	00000005
+  400870:	00000008
+  400874:	0000000b
+  400878:	0000000e
+  40087c:	00000001
+  400880:	00000004
+  400884:	00000007
+  400888:	0000000a
+  40088c:	0000000d
+  400890:	00000000
+  400894:	00000006
+  400898:	00000009
+  40089c:	0000000c
+  4008a0:	0000000f
+  4008a4:	00000002
+  4008a8:	00000005
+  4008ac:	00000008
+  4008b0:	0000000b
+  4008b4:	0000000e
+  4008b8:	00000001
+  4008bc:	00000004
+  4008c0:	00000007
+  4008c4:	0000000d
+  4008c8:	00000000
+  4008cc:	00000003
+  4008d0:	00000006
+  4008d4:	00000009
+  4008d8:	0000000c
+  4008dc:	0000000f
+  4008e0:	00000002
+  4008e4:	00000005
+  4008e8:	00000008
+  4008ec:	0000000b
+  4008f0:	0000000e
+  4008f4:	00000004
+  4008f8:	00000007
+  4008fc:	0000000a
+  400900:	0000000d
+  400904:	00000000
+  400908:	00000003
+  40090c:	00000006
+  400910:	00000009
+  400914:	0000000c
+  400918:	0000000f
+  40091c:	00000002
+  400920:	00000005
+  400924:	0000000b
+  400928:	0000000e
+  40092c:	00000001
+  400930:	00000004
+  400934:	00000007
+  400938:	0000000a
+  40093c:	0000000d
+  400940:	00000000
+  400944:	00000003
+  400948:	00000006
+  40094c:	00000009
+  400950:	0000000c
+  400954:	00000002
+  400958:	00000005
+  40095c:	00000008
+  400960:	0000000b
+  400964:	0000000e
+  400968:	00000001
+  40096c:	00000004
+  400970:	00000007
+  400974:	0000000a
+  400978:	0000000d
+  40097c:	00000000
+  400980:	00000003
+  400984:	00000009
+  400988:	0000000c
+  40098c:	0000000f
+  400990:	00000002
+  400994:	00000005
+  400998:	00000008
+  40099c:	0000000b
+  4009a0:	0000000e
+  4009a4:	00000001
+  4009a8:	00000004
+  4009ac:	00000007
+  4009b0:	0000000a
+  4009b4:	00000000
+  4009b8:	00000003
+  4009bc:	00000006
+  4009c0:	00000009
+  4009c4:	0000000c
+  4009c8:	0000000f
+  4009cc:	00000002
+  4009d0:	00000005
+  4009d4:	00000008
+  4009d8:	0000000b
+  4009dc:	0000000e
+  4009e0:	00000001
+  4009e4:	00000007
+  4009e8:	0000000a
+  4009ec:	0000000d
+  4009f0:	00000000
+  4009f4:	00000003
+  4009f8:	00000006
+  4009fc:	00000009
+  400a00:	0000000c
+  400a04:	0000000f
+  400a08:	00000002
+  400a0c:	00000005
+  400a10:	00000008
+  400a14:	0000000e
+  400a18:	00000001
+  400a1c:	00000004
+  400a20:	00000007
+  400a24:	0000000a
+  400a28:	0000000d
+  400a2c:	00000000
+  400a30:	00000003
+  400a34:	00000006
+  400a38:	00000009
+  400a3c:	0000000c
+  400a40:	0000000f
+  400a44:	00000002
+  400a48:	0000000d
+  400a4c:	00000008
+  400a50:	00000003
+  400a54:	0000000e
+  400a58:	00000009
+  400a5c:	00000004
+  400a60:	0000000f
+  400a64:	0000000a
+  400a68:	00000005
+  400a6c:	00000000
+  400a70:	0000000b
+  400a74:	00000007
+  400a78:	00000002
+  400a7c:	0000000d
+  400a80:	00000008
+  400a84:	00000003
+  400a88:	0000000e
+  400a8c:	00000009
+  400a90:	00000004
+  400a94:	0000000f
+  400a98:	0000000a
+  400a9c:	00000005
+  400aa0:	00000000
+  400aa4:	0000000c
+  400aa8:	00000007
+  400aac:	00000002
+  400ab0:	0000000d
+  400ab4:	00000008
+  400ab8:	00000003
+  400abc:	0000000e
+  400ac0:	00000009
+  400ac4:	00000004
+  400ac8:	0000000f
+  400acc:	0000000a
+  400ad0:	00000005
+  400ad4:	00000001
+  400ad8:	0000000c
+  400adc:	00000007
+  400ae0:	00000002
+  400ae4:	0000000d
+  400ae8:	00000008
+  400aec:	00000003
+  400af0:	0000000e
+  400af4:	00000009
+  400af8:	00000004
+  400afc:	0000000f
+  400b00:	0000000a
+  400b04:	00000006
+  400b08:	00000001
+  400b0c:	0000000c
+  400b10:	00000007
+  400b14:	00000002
+  400b18:	0000000d
+  400b1c:	00000008
+  400b20:	00000003
+  400b24:	0000000e
+  400b28:	00000009
+  400b2c:	00000004
+  400b30:	0000000f
+  400b34:	0000000b
+  400b38:	00000006
+  400b3c:	00000001
+  400b40:	0000000c
+  400b44:	00000007
+  400b48:	00000002
+  400b4c:	0000000d
+  400b50:	00000008
+  400b54:	00000003
+  400b58:	0000000e
+  400b5c:	00000009
+  400b60:	00000004
+  400b64:	00000000
+  400b68:	0000000b
+  400b6c:	00000006
+  400b70:	00000001
+  400b74:	0000000c
+  400b78:	00000007
+  400b7c:	00000002
+  400b80:	0000000d
+  400b84:	00000008
+  400b88:	00000003
+  400b8c:	0000000e
+  400b90:	00000009
+  400b94:	00000005
+  400b98:	00000000
+  400b9c:	0000000b
+  400ba0:	00000006
+  400ba4:	00000001
+  400ba8:	0000000c
+  400bac:	00000007
+  400bb0:	00000002
+  400bb4:	0000000d
+  400bb8:	00000008
+  400bbc:	00000003
+  400bc0:	0000000e
+  400bc4:	0000000a
+  400bc8:	00000005
+  400bcc:	00000000
+  400bd0:	0000000b
+  400bd4:	00000006
+  400bd8:	00000001
+  400bdc:	0000000c
+  400be0:	00000007
+  400be4:	00000002
+  400be8:	0000000d
+  400bec:	00000008
+  400bf0:	00000003
+  400bf4:	0000000f
+  400bf8:	0000000a
+  400bfc:	00000005
+  400c00:	00000000
+  400c04:	0000000b
+  400c08:	00000006
+  400c0c:	00000001
+  400c10:	0000000c
+  400c14:	00000007
+  400c18:	00000002
+  400c1c:	0000000d
+  400c20:	00000008
+  400c24:	00000004
+  400c28:	0000000f
+  400c2c:	0000000a
+  400c30:	00000005
+  400c34:	00000000
+  400c38:	0000000b
+  400c3c:	00000006
+  400c40:	00000001
+  400c44:	0000000c
+  400c48:	00000007
+  400c4c:	00000002
+  400c50:	0000000d
+  400c54:	00000009
+  400c58:	00000004
+  400c5c:	0000000f
+  400c60:	0000000a
+  400c64:	00000005
+  400c68:	00000000
+  400c6c:	0000000b
+  400c70:	00000006
+  400c74:	00000001
+  400c78:	0000000c
+  400c7c:	00000007
+  400c80:	00000002
+  400c84:	00000000
+  400c88:	00000000
+  400c8c:	00000000
+  400c90:	00000000
+  400c94:	00000000
+  400c98:	00000000
+  400c9c:	00000000
+  400ca0:	00000000
+  400ca4:	00000000
+  400ca8:	00000000
+  400cac:	00000000
+  400cb0:	00000000
+  400cb4:	00000000
+  400cb8:	00000000
+  400cbc:	00000000
+  400cc0:	00000000
+  400cc4:	00000000
+  400cc8:	00000000
+  400ccc:	00000000
+  400cd0:	00000000
+  400cd4:	00000000
+  400cd8:	00000000
+  400cdc:	00000000
+  400ce0:	00000000
+  400ce4:	00000000
+  400ce8:	00000000
+  400cec:	00000000
+  400cf0:	00000000
+  400cf4:	00000000
+  400cf8:	00000000
+  400cfc:	00000000
+  400d00:	00000000
+  400d04:	00000000
+  400d08:	00000000
+  400d0c:	00000000
+  400d10:	00000000
+  400d14:	00000000
+  400d18:	00000000
+  400d1c:	00000000
+  400d20:	00000000
+  400d24:	00000000
+  400d28:	00000000
+  400d2c:	00000000
+  400d30:	00000000
+  400d34:	00000000
+  400d38:	00000000
+  400d3c:	00000000
+  400d40:	00000000
+  400d44:	00000000
+  400d48:	00000000
+  400d4c:	00000000
+  400d50:	00000000
+  400d54:	00000000
+  400d58:	00000000
+  400d5c:	00000000
+  400d60:	00000000
+  400d64:	00000000
+  400d68:	00000000
+  400d6c:	00000000
+  400d70:	00000000
+  400d74:	00000000
+  400d78:	00000000
+  400d7c:	00000000
+  400d80:	00000000
+  400d84:	00000000
+  400d88:	00000000
+  400d8c:	00000000
+  400d90:	00000000
+  400d94:	00000000
+  400d98:	00000000
+  400d9c:	00000000
+  400da0:	00000000
+  400da4:	00000000
+  400da8:	00000000
+  400dac:	00000000
+  400db0:	00000000
+  400db4:	00000000
+  400db8:	00000000
+  400dbc:	00000000
+  400dc0:	00000000
+  400dc4:	00000000
+  400dc8:	00000000
+  400dcc:	00000000
+  400dd0:	00000000
+  400dd4:	00000000
+  400dd8:	00000000
+  400ddc:	00000000
+  400de0:	00000000
+  400de4:	00000000
+  400de8:	00000000
+  400dec:	00000000
+  400df0:	00000000
+  400df4:	00000000
+  400df8:	00000000
+  400dfc:	00000000
+  400e00:	00000000
+  400e04:	00000000
+  400e08:	00000000
+  400e0c:	00000000
+  400e10:	00000000
+  400e14:	00000000
+  400e18:	00000000
+  400e1c:	00000000
+  400e20:	00000000
+  400e24:	00000000
+  400e28:	00000000
+  400e2c:	00000000
+  400e30:	00000000
+  400e34:	00000000
+  400e38:	00000000
+  400e3c:	00000000
+  400e40:	00000000
+  400e44:	00000000
+  400e48:	00000000
+  400e4c:	00000000
+  400e50:	00000000
+  400e54:	00000000
+  400e58:	00000000
+  400e5c:	00000000
+  400e60:	00000000
+  400e64:	00000000
+  400e68:	00000000
+  400e6c:	00000000
+  400e70:	00000000
+  400e74:	00000000
+  400e78:	00000000
+  400e7c:	00000000
+  400e80:	00000000
+  400e84:	00000000
+  400e88:	00000000
+  400e8c:	00000000
+  400e90:	00000000
+  400e94:	00000000
+  400e98:	00000000
+  400e9c:	00000000
+  400ea0:	00000000
+  400ea4:	00000000
+  400ea8:	00000000
+  400eac:	00000000
+  400eb0:	00000000
+  400eb4:	00000000
+  400eb8:	00000000
+  400ebc:	00000000
+  400ec0:	00000000
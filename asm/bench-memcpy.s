@@ -0,0 +1,439 @@
+# memcpy of 1 KB a word at a time (unrolled by four), then of 255 bytes
+# from an unaligned source a byte at a time, 400 times.
+# Result at 0x00400800 (and in $v0) is a rotate and xor of both copies, 0xf57c4991
+# The source is at 0x00400a00, the copies at 0x00400e00 and 0x00401200
+
+00400000 : <text>
+  400000:	3c1c0040 	lui $gp 0x40            ; gp = 0x00400000, the data is addressed off it
+  400004:	24170190 	addiu $s7 $zero 400     ; s7 = copies left
+  400008:	27880a00 	addiu $t0 $gp 0xa00     ; rep: t0 = source
+  40000c:	27890e00 	addiu $t1 $gp 0xe00     ; t1 = destination
+  400010:	278a0e00 	addiu $t2 $gp 0xe00     ; t2 = end of the source
+  400014:	8d0b0000 	lw $t3 0($t0)           ; words: four words at a time
+  400018:	8d0c0004 	lw $t4 4($t0)
+  40001c:	8d0d0008 	lw $t5 8($t0)
+  400020:	8d0e000c 	lw $t6 12($t0)
+  400024:	ad2b0000 	sw $t3 0($t1)
+  400028:	ad2c0004 	sw $t4 4($t1)
+  40002c:	ad2d0008 	sw $t5 8($t1)
+  400030:	ad2e000c 	sw $t6 12($t1)
+  400034:	25080010 	addiu $t0 $t0 16
+  400038:	150afff6 	bne $t0 $t2 words
+  40003c:	25290010 	addiu $t1 $t1 16        ; (delay slot)
+  400040:	27880a01 	addiu $t0 $gp 0xa01     ; t0 = second byte of the source, unaligned
+  400044:	27891200 	addiu $t1 $gp 0x1200    ; t1 = byte destination
+  400048:	278a0b00 	addiu $t2 $gp 0xb00     ; t2 = end of the bytes copied
+  40004c:	910b0000 	lbu $t3 0($t0)          ; bytes: one byte at a time
+  400050:	25080001 	addiu $t0 $t0 1
+  400054:	a12b0000 	sb $t3 0($t1)
+  400058:	150afffc 	bne $t0 $t2 bytes
+  40005c:	25290001 	addiu $t1 $t1 1         ; (delay slot)
+  400060:	8f8b0a00 	lw $t3 0xa00($gp)       ; bump the first source word, so every copy differs
+  400064:	256b0001 	addiu $t3 $t3 1
+  400068:	af8b0a00 	sw $t3 0xa00($gp)
+  40006c:	26f7ffff 	addiu $s7 $s7 -1
+  400070:	1ee0ffe5 	bgtz $s7 rep
+  400074:	00000000 	nop
+  400078:	24020000 	addiu $v0 $zero 0       ; v0 = rotate and xor of both copies
+  40007c:	27880e00 	addiu $t0 $gp 0xe00
+  400080:	278a1300 	addiu $t2 $gp 0x1300
+  400084:	8d090000 	lw $t1 0($t0)           ; sum:
+  400088:	00026140 	sll $t4 $v0 5
+  40008c:	00026ec2 	srl $t5 $v0 27
+  400090:	018d1025 	or $v0 $t4 $t5
+  400094:	00491026 	xor $v0 $v0 $t1
+  400098:	25080004 	addiu $t0 $t0 4
+  40009c:	150afff9 	bne $t0 $t2 sum
+  4000a0:	00000000 	nop
+  4000a4:	af820800 	sw $v0 0x800($gp)       ; result = v0
+  4000a8:	24080004 	addiu $t0 $zero 4       ; wait for the result to be written back
+  4000ac:	2508ffff 	addiu $t0 $t0 -1        ; drain: a wide pipeline fetches the halt early
+  4000b0:	1500fffe 	bne $t0 $zero drain
+  4000b4:	00000000 	nop
+  4000b8:	1000ffff 	beq $zero $zero -1      ; halt
+
+00400800 : <data>
+  400800:	00000000
+  400804:	00000000
+  400808:	00000000
+  40080c:	00000000
+  400810:	00000000
+  400814:	00000000
+  400818:	00000000
+  40081c:	00000000
+  400820:	00000000
+  400824:	00000000
+  400828:	00000000
+  40082c:	00000000
+  400830:	00000000
+  400834:	00000000
+  400838:	00000000
+  40083c:	00000000
+  400840:	00000000
+  400844:	00000000
+  400848:	00000000
+  40084c:	00000000
+  400850:	00000000
+  400854:	00000000
+  400858:	00000000
+  40085c:	00000000
+  400860:	00000000
+  400864:	00000000
+  400868:	00000000
+  40086c:	00000000
+  400870:	00000000
+  400874:	00000000
+  400878:	00000000
+  40087c:	00000000
+  400880:	00000000
+  400884:	00000000
+  400888:	00000000
+  40088c:	00000000
+  400890:	00000000
+  400894:	00000000
+  400898:	00000000
+  40089c:	00000000
+  4008a0:	00000000
+  4008a4:	00000000
+  4008a8:	00000000
+  4008ac:	00000000
+  4008b0:	00000000
+  4008b4:	00000000
+  4008b8:	00000000
+  4008bc:	00000000
+  4008c0:	00000000
+  4008c4:	00000000
+  4008c8:	00000000
+  4008cc:	00000000
+  4008d0:	00000000
+  4008d4:	00000000
+  4008d8:	00000000
+  4008dc:	00000000
+  4008e0:	00000000
+  4008e4:	00000000
+  4008e8:	00000000
+  4008ec:	00000000
+  4008f0:	00000000
+  4008f4:	00000000
+  4008f8:	00000000
+  4008fc:	00000000
+  400900:	00000000
+  400904:	00000000
+  400908:	00000000
+  40090c:	00000000
+  400910:	00000000
+  400914:	00000000
+  400918:	00000000
+  40091c:	00000000
+  400920:	00000000
+  400924:	00000000
+  400928:	00000000
+  40092c:	00000000
+  400930:	00000000
+  400934:	00000000
+  400938:	00000000
+  40093c:	00000000
+  400940:	00000000
+  400944:	00000000
+  400948:	00000000
+  40094c:	00000000
+  400950:	00000000
+  400954:	00000000
+  400958:	00000000
+  40095c:	00000000
+  400960:	00000000
+  400964:	00000000
+  400968:	00000000
+  40096c:	00000000
+  400970:	00000000
+  400974:	00000000
+  400978:	00000000
+  40097c:	00000000
+  400980:	00000000
+  400984:	00000000
+  400988:	00000000
+  40098c:	00000000
+  400990:	00000000
+  400994:	00000000
+  400998:	00000000
+  40099c:	00000000
+  4009a0:	00000000
+  4009a4:	00000000
+  4009a8:	00000000
+  4009ac:	00000000
+  4009b0:	00000000
+  4009b4:	00000000
+  4009b8:	00000000
+  4009bc:	00000000
+  4009c0:	00000000
+  4009c4:	00000000
+  4009c8:	00000000
+  4009cc:	00000000
+  4009d0:	00000000
+  4009d4:	00000000
+  4009d8:	00000000
+  4009dc:	00000000
+  4009e0:	00000000
+  4009e4:	00000000
+  4009e8:	00000000
+  4009ec:	00000000
+  4009f0:	00000000
+  4009f4:	00000000
+  4009f8:	00000000
+  4009fc:	00000000
+  400a00:	7a46cf34
+  400a04:	0169e1dd
+  400a08:	105c39d2
+  400a0c:	11d84423
+  400a10:	f6dbc0a0
+  400a14:	9fe7a8d9
+  400a18:	ec76a71e
+  400a1c:	6b5a977f
+  400a20:	87ba70cc
+  400a24:	7a278795
+  400a28:	cd593d2a
+  400a2c:	ea981b9b
+  400a30:	acd70fb8
+  400a34:	ec20ad11
+  400a38:	7423e7f6
+  400a3c:	a03e8377
+  400a40:	83d0c164
+  400a44:	6f022f4d
+  400a48:	2d87d382
+  400a4c:	8f32e413
+  400a50:	7ecc89d0
+  400a54:	59b9d149
+  400a58:	f87d33ce
+  400a5c:	9eddf86f
+  400a60:	0068b4fc
+  400a64:	a912a705
+  400a68:	b06002da
+  400a6c:	f7bfb98b
+  400a70:	d227eee8
+  400a74:	b86c5581
+  400a78:	7c02fca6
+  400a7c:	0568fe67
+  400a80:	09fcb794
+  400a84:	d4eadebd
+  400a88:	0084b932
+  400a8c:	5fd36003
+  400a90:	d8fc5f00
+  400a94:	b979bfb9
+  400a98:	b36e327e
+  400a9c:	1ebdbd5f
+  400aa0:	65a27d2c
+  400aa4:	ba424375
+  400aa8:	9d3dc68a
+  400aac:	5e83407b
+  400ab0:	65a98218
+  400ab4:	8a6e38f1
+  400ab8:	1b39e556
+  400abc:	fbdf5557
+  400ac0:	b07391c4
+  400ac4:	c508642d
+  400ac8:	abad88e2
+  400acc:	47a748f3
+  400ad0:	30d91030
+  400ad4:	d69d1829
+  400ad8:	e5f8452e
+  400adc:	6f26d64f
+  400ae0:	33f9d95c
+  400ae4:	03d638e5
+  400ae8:	d395fe3a
+  400aec:	491bee6b
+  400af0:	747b0948
+  400af4:	4b1d1761
+  400af8:	4c59fa06
+  400afc:	cf7d6847
+  400b00:	06beaff4
+  400b04:	3481af9d
+  400b08:	2cdfd692
+  400b0c:	a726ace3
+  400b10:	13f46d60
+  400b14:	de7abe99
+  400b18:	871dcdde
+  400b1c:	2663733f
+  400b20:	02f7a98c
+  400b24:	1a1f3c55
+  400b28:	787b7bea
+  400b2c:	6eb3385b
+  400b30:	c4b6c478
+  400b34:	a7b523d1
+  400b38:	b793f4b6
+  400b3c:	266faf37
+  400b40:	51613624
+  400b44:	2ca44d0d
+  400b48:	07d33042
+  400b4c:	ca998cd3
+  400b50:	567f1690
+  400b54:	4c419709
+  400b58:	186ab88e
+  400b5c:	ebf9142f
+  400b60:	326d0dbc
+  400b64:	95363dc5
+  400b68:	752d4b9a
+  400b6c:	53420e4b
+  400b70:	3e9ebba8
+  400b74:	db6c8a41
+  400b78:	2eacc166
+  400b7c:	c2ebaa27
+  400b80:	c396f454
+  400b84:	fd218f7d
+  400b88:	9ad9b7f2
+  400b8c:	6a7ca8c3
+  400b90:	70856bc0
+  400b94:	ab084c79
+  400b98:	4512f73e
+  400b9c:	617cb91f
+  400ba0:	be5355ec
+  400ba4:	1a683935
+  400ba8:	a7406f4a
+  400bac:	11d1803b
+  400bb0:	22657ed8
+  400bb4:	63d11eb1
+  400bb8:	4ed54a16
+  400bbc:	76b15117
+  400bc0:	f239c684
+  400bc4:	3565e2ed
+  400bc8:	b12889a2
+  400bcc:	937950b3
+  400bd0:	88dc1cf0
+  400bd4:	6dc77ee9
+  400bd8:	e8d5abee
+  400bdc:	8503020f
+  400be0:	609cee1c
+  400be4:	06de36a5
+  400be8:	85e024fa
+  400bec:	612afe2b
+  400bf0:	dd04e608
+  400bf4:	17510d21
+  400bf8:	65f378c6
+  400bfc:	b6a91407
+  400c00:	b0804cb4
+  400c04:	d402dc5d
+  400c08:	7aaf8752
+  400c0c:	57d9f4a3
+  400c10:	72e9fa20
+  400c14:	202a7359
+  400c18:	dae1929e
+  400c1c:	cd1d0fff
+  400c20:	aaf2ae4c
+  400c24:	bcb72a15
+  400c28:	fa1560aa
+  400c2c:	056c981b
+  400c30:	3e074138
+  400c34:	5d72f991
+  400c38:	0f8ab976
+  400c3c:	f4728bf7
+  400c40:	ee31e6e4
+  400c44:	dfd2abcd
+  400c48:	af4d5102
+  400c4c:	7b615493
+  400c50:	49c2b350
+  400c54:	f17995c9
+  400c58:	bf694d4e
+  400c5c:	9b8a80ef
+  400c60:	655ca27c
+  400c64:	f2ce1b85
+  400c68:	5476705a
+  400c6c:	f24e1e0b
+  400c70:	27a93068
+  400c74:	44788001
+  400c78:	9a4de626
+  400c7c:	e42016e7
+  400c80:	23207514
+  400c84:	1f7e3d3d
+  400c88:	c70b64b2
+  400c8c:	b062b083
+  400c90:	80bbb880
+  400c94:	0ba4a239
+  400c98:	37df7dfe
+  400c9c:	bb89f5df
+  400ca0:	8f7a4aac
+  400ca4:	665277f5
+  400ca8:	5f3bd40a
+  400cac:	a47800fb
+  400cb0:	bf779b98
+  400cb4:	16743371
+  400cb8:	d32498d6
+  400cbc:	6e029dd7
+  400cc0:	6f21f744
+  400cc4:	b4fd20ad
+  400cc8:	bf2f4662
+  400ccc:	1ce91973
+  400cd0:	45ca59b0
+  400cd4:	22191ca9
+  400cd8:	579cf0ae
+  400cdc:	9c93becf
+  400ce0:	470a66dc
+  400ce4:	28aa0f65
+  400ce8:	4b224dba
+  400cec:	7c204eeb
+  400cf0:	3a8bb2c8
+  400cf4:	a79523e1
+  400cf8:	a9e73d86
+  400cfc:	ba2f40c7
+  400d00:	1adb2d74
+  400d04:	fa6c4a1d
+  400d08:	bd537412
+  400d0c:	242a1d63
+  400d10:	9d02c6e0
+  400d14:	750d8119
+  400d18:	8286f75e
+  400d1c:	9ce4ebbf
+  400d20:	1963e70c
+  400d24:	61cf00d5
+  400d28:	0086296a
+  400d2c:	46d238db
+  400d30:	f21b7df8
+  400d34:	9feb7e51
+  400d38:	21c90e36
+  400d3c:	365737b7
+  400d40:	d42017a4
+  400d44:	7959c98d
+  400d48:	050cafc2
+  400d4c:	a0583d53
+  400d50:	85f49010
+  400d54:	38aa4b89
+  400d58:	1026920e
+  400d5c:	67b6fcaf
+  400d60:	f4e5bb3c
+  400d64:	96d23045
+  400d68:	2c22791a
+  400d6c:	f1202ecb
+  400d70:	7783cd28
+  400d74:	5fe876c1
+  400d78:	62e244e6
+  400d7c:	49b702a7
+  400d80:	a7db35d4
+  400d84:	0324abfd
+  400d88:	916f5572
+  400d8c:	43c67943
+  400d90:	f4788540
+  400d94:	c4cdb0f9
+  400d98:	b3a302be
+  400d9c:	5f14719f
+  400da0:	0046e36c
+  400da4:	fc14edb5
+  400da8:	3b0df2ca
+  400dac:	6ffd40bb
+  400db0:	25d17058
+  400db4:	6cc58931
+  400db8:	c5a6ad96
+  400dbc:	ed501997
+  400dc0:	9d4ae404
+  400dc4:	a17fa16d
+  400dc8:	34eac722
+  400dcc:	5d0ee133
+  400dd0:	705e6670
+  400dd4:	41e97169
+  400dd8:	1112056e
+  400ddc:	8ca0aa8f
+  400de0:	701d3f9c
+  400de4:	50e64525
+  400de8:	6a3fba7a
+  400dec:	13771eab
+  400df0:	5b6b4f88
+  400df4:	d30199a1
+  400df8:	17638246
+  400dfc:	b59b2c87
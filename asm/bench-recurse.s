@@ -0,0 +1,36 @@
+# Recursive calls, fib(23) the naive way with a stack frame per call.
+# Result at 0x00400800 (and in $v0) is fib(23), 0x00006ff1
+
+00400000 : <text>
+  400000:	3c1c0040 	lui $gp 0x40            ; gp = 0x00400000, the data is addressed off it
+  400004:	279d2000 	addiu $sp $gp 0x2000    ; sp = 0x00402000, the stack grows down
+  400008:	0c10000a 	jal fib                 ; v0 = fib(23)
+  40000c:	24040017 	addiu $a0 $zero 23      ; (delay slot)
+  400010:	af820800 	sw $v0 0x800($gp)       ; result = v0
+  400014:	24080004 	addiu $t0 $zero 4       ; wait for the result to be written back
+  400018:	2508ffff 	addiu $t0 $t0 -1        ; drain: a wide pipeline fetches the halt early
+  40001c:	1500fffe 	bne $t0 $zero drain
+  400020:	00000000 	nop
+  400024:	1000ffff 	beq $zero $zero -1      ; halt
+  400028:	28880002 	slti $t0 $a0 2          ; fib: v0 = fib(a0)
+  40002c:	11000003 	beq $t0 $zero recurse
+  400030:	00000000 	nop
+  400034:	03e00008 	jr $ra                  ; fib(0) = 0 and fib(1) = 1
+  400038:	00041021 	addu $v0 $zero $a0      ; (delay slot)
+  40003c:	27bdfff4 	addiu $sp $sp -12       ; recurse: push ra, a0 and fib(a0-1)
+  400040:	afbf0008 	sw $ra 8($sp)
+  400044:	afa40004 	sw $a0 4($sp)
+  400048:	0c10000a 	jal fib
+  40004c:	2484ffff 	addiu $a0 $a0 -1        ; (delay slot) fib(a0-1)
+  400050:	afa20000 	sw $v0 0($sp)
+  400054:	8fa40004 	lw $a0 4($sp)
+  400058:	0c10000a 	jal fib
+  40005c:	2484fffe 	addiu $a0 $a0 -2        ; (delay slot) fib(a0-2)
+  400060:	8fa90000 	lw $t1 0($sp)
+  400064:	8fbf0008 	lw $ra 8($sp)
+  400068:	00491021 	addu $v0 $v0 $t1
+  40006c:	03e00008 	jr $ra
+  400070:	27bd000c 	addiu $sp $sp 12        ; (delay slot) pop
+
+00400800 : <data>
+  400800:	00000000
@@ -0,0 +1,377 @@
+# Insertion sort of 160 signed words, copied from the unsorted ones and sorted
+# again 16 times.
+# Result at 0x00400800 (and in $v0) is a rotate and xor of the sorted words, 0x06c19611
+# The unsorted words are at 0x00400804 and the work array at 0x00400a84
+
+00400000 : <text>
+  400000:	3c1c0040 	lui $gp 0x40            ; gp = 0x00400000, the data is addressed off it
+  400004:	24170010 	addiu $s7 $zero 16      ; s7 = sorts left
+  400008:	24080000 	addiu $t0 $zero 0       ; rep: copy the unsorted words to the work array
+  40000c:	011c4821 	addu $t1 $t0 $gp        ; copy:
+  400010:	8d2a0804 	lw $t2 0x804($t1)
+  400014:	25080004 	addiu $t0 $t0 4
+  400018:	290b0280 	slti $t3 $t0 640
+  40001c:	1560fffb 	bne $t3 $zero copy
+  400020:	ad2a0a84 	sw $t2 0xa84($t1)       ; (delay slot)
+  400024:	24100004 	addiu $s0 $zero 4       ; s0 = i*4, insertion sort from i = 1
+  400028:	03904021 	addu $t0 $gp $s0        ; outer:
+  40002c:	8d090a84 	lw $t1 0xa84($t0)       ; t1 = key = W[i]
+  400030:	250afffc 	addiu $t2 $t0 -4        ; t2 points at W[j], j = i-1
+  400034:	8d4b0a84 	lw $t3 0xa84($t2)       ; inner: t3 = W[j]
+  400038:	012b602a 	slt $t4 $t1 $t3
+  40003c:	11800006 	beq $t4 $zero place     ; stop once W[j] <= key
+  400040:	00000000 	nop
+  400044:	ad4b0a88 	sw $t3 0xa88($t2)       ; W[j+1] = W[j]
+  400048:	254afffc 	addiu $t2 $t2 -4
+  40004c:	015c682a 	slt $t5 $t2 $gp
+  400050:	11a0fff8 	beq $t5 $zero inner     ; until j < 0
+  400054:	00000000 	nop
+  400058:	ad490a88 	sw $t1 0xa88($t2)       ; place: W[j+1] = key
+  40005c:	26100004 	addiu $s0 $s0 4
+  400060:	2a0b0280 	slti $t3 $s0 640
+  400064:	1560fff0 	bne $t3 $zero outer
+  400068:	00000000 	nop
+  40006c:	26f7ffff 	addiu $s7 $s7 -1
+  400070:	1ee0ffe5 	bgtz $s7 rep
+  400074:	00000000 	nop
+  400078:	24020000 	addiu $v0 $zero 0       ; v0 = rotate and xor of the sorted words
+  40007c:	24080000 	addiu $t0 $zero 0
+  400080:	011c4821 	addu $t1 $t0 $gp        ; sum:
+  400084:	8d290a84 	lw $t1 0xa84($t1)
+  400088:	00026140 	sll $t4 $v0 5
+  40008c:	00026ec2 	srl $t5 $v0 27
+  400090:	018d1025 	or $v0 $t4 $t5
+  400094:	00491026 	xor $v0 $v0 $t1
+  400098:	25080004 	addiu $t0 $t0 4
+  40009c:	290b0280 	slti $t3 $t0 640
+  4000a0:	1560fff7 	bne $t3 $zero sum
+  4000a4:	00000000 	nop
+  4000a8:	af820800 	sw $v0 0x800($gp)       ; result = v0
+  4000ac:	24080004 	addiu $t0 $zero 4       ; wait for the result to be written back
+  4000b0:	2508ffff 	addiu $t0 $t0 -1        ; drain: a wide pipeline fetches the halt early
+  4000b4:	1500fffe 	bne $t0 $zero drain
+  4000b8:	00000000 	nop
+  4000bc:	1000ffff 	beq $zero $zero -1      ; halt
+
+00400800 : <data>
+  400800:	00000000
+  400804:	ffffd31b
+  400808:	000043e5
+  40080c:	fffffd5d
+  400810:	fffff899
+  400814:	00000e6f
+  400818:	00003424
+  40081c:	ffffcd5c
+  400820:	0000376c
+  400824:	ffffc8da
+  400828:	ffffaf92
+  40082c:	ffffed2e
+  400830:	ffffc655
+  400834:	ffffbd08
+  400838:	ffff996d
+  40083c:	00006562
+  400840:	fffff0ef
+  400844:	ffffa464
+  400848:	ffffccaf
+  40084c:	00003b42
+  400850:	00002098
+  400854:	0000631b
+  400858:	ffffd814
+  40085c:	00007cdb
+  400860:	fffff86a
+  400864:	fffff419
+  400868:	00007a1a
+  40086c:	00000cf9
+  400870:	00003142
+  400874:	0000150a
+  400878:	ffffdcfb
+  40087c:	00002f28
+  400880:	000035bb
+  400884:	ffffb259
+  400888:	ffff92b4
+  40088c:	ffffd3b3
+  400890:	00007e33
+  400894:	00001334
+  400898:	00005101
+  40089c:	ffffa3a7
+  4008a0:	ffffacc4
+  4008a4:	ffffc584
+  4008a8:	00006d5d
+  4008ac:	ffffccd0
+  4008b0:	0000694b
+  4008b4:	000049f8
+  4008b8:	00001906
+  4008bc:	ffff8db9
+  4008c0:	fffffd63
+  4008c4:	00007ffb
+  4008c8:	00005cf6
+  4008cc:	ffff81b0
+  4008d0:	ffffb06a
+  4008d4:	ffffd1b8
+  4008d8:	ffffd5e9
+  4008dc:	ffffacbf
+  4008e0:	ffffe37a
+  4008e4:	0000201c
+  4008e8:	0000305d
+  4008ec:	000047b2
+  4008f0:	ffffed70
+  4008f4:	00006ed2
+  4008f8:	0000648c
+  4008fc:	00004c17
+  400900:	ffffb6e7
+  400904:	00005048
+  400908:	ffffb273
+  40090c:	ffffc038
+  400910:	0000163d
+  400914:	000011a8
+  400918:	00005dce
+  40091c:	ffffc322
+  400920:	ffffeb8c
+  400924:	ffffa6df
+  400928:	00002a18
+  40092c:	000058a1
+  400930:	fffffcb1
+  400934:	00005699
+  400938:	ffff968e
+  40093c:	fffff541
+  400940:	ffff9147
+  400944:	00002641
+  400948:	ffffda2c
+  40094c:	ffffca4d
+  400950:	ffffceac
+  400954:	00000604
+  400958:	ffff9fae
+  40095c:	ffffd1d2
+  400960:	ffffd3fa
+  400964:	ffffbcce
+  400968:	ffff8190
+  40096c:	ffff9a9c
+  400970:	ffff960e
+  400974:	ffff944b
+  400978:	0000460d
+  40097c:	ffffd436
+  400980:	00007b83
+  400984:	ffffc4e6
+  400988:	ffffdb22
+  40098c:	ffff9aee
+  400990:	ffffb8b6
+  400994:	ffffa1cc
+  400998:	0000128b
+  40099c:	ffff83ce
+  4009a0:	00006bc4
+  4009a4:	ffff84e9
+  4009a8:	00001dc3
+  4009ac:	000068a2
+  4009b0:	00007886
+  4009b4:	00007ae9
+  4009b8:	ffffca07
+  4009bc:	fffff3f8
+  4009c0:	0000249b
+  4009c4:	ffffaf37
+  4009c8:	00007c53
+  4009cc:	ffffed1a
+  4009d0:	0000735d
+  4009d4:	ffff9800
+  4009d8:	ffffed63
+  4009dc:	00004415
+  4009e0:	000041ea
+  4009e4:	ffffe230
+  4009e8:	ffffa5b3
+  4009ec:	ffffddb5
+  4009f0:	0000231b
+  4009f4:	00001d73
+  4009f8:	0000397e
+  4009fc:	00001f86
+  400a00:	fffffb8f
+  400a04:	00002835
+  400a08:	000044c1
+  400a0c:	00003bd3
+  400a10:	00005da0
+  400a14:	00005ba1
+  400a18:	00002737
+  400a1c:	00003da9
+  400a20:	ffffa56b
+  400a24:	000077a4
+  400a28:	ffff805e
+  400a2c:	ffffd4d4
+  400a30:	ffffd4cc
+  400a34:	00004ee9
+  400a38:	00006b70
+  400a3c:	ffffe1df
+  400a40:	00002f5f
+  400a44:	000032de
+  400a48:	00007b6a
+  400a4c:	ffffc218
+  400a50:	ffff967f
+  400a54:	00001fad
+  400a58:	00007708
+  400a5c:	00005b89
+  400a60:	ffffa549
+  400a64:	ffffa843
+  400a68:	ffffd4c5
+  400a6c:	ffffe8ff
+  400a70:	ffff8c99
+  400a74:	ffffa24b
+  400a78:	fffff6df
+  400a7c:	ffff8605
+  400a80:	ffffaf0b
+  400a84:	00000000
+  400a88:	00000000
+  400a8c:	00000000
+  400a90:	00000000
+  400a94:	00000000
+  400a98:	00000000
+  400a9c:	00000000
+  400aa0:	00000000
+  400aa4:	00000000
+  400aa8:	00000000
+  400aac:	00000000
+  400ab0:	00000000
+  400ab4:	00000000
+  400ab8:	00000000
+  400abc:	00000000
+  400ac0:	00000000
+  400ac4:	00000000
+  400ac8:	00000000
+  400acc:	00000000
+  400ad0:	00000000
+  400ad4:	00000000
+  400ad8:	00000000
+  400adc:	00000000
+  400ae0:	00000000
+  400ae4:	00000000
+  400ae8:	00000000
+  400aec:	00000000
+  400af0:	00000000
+  400af4:	00000000
+  400af8:	00000000
+  400afc:	00000000
+  400b00:	00000000
+  400b04:	00000000
+  400b08:	00000000
+  400b0c:	00000000
+  400b10:	00000000
+  400b14:	00000000
+  400b18:	00000000
+  400b1c:	00000000
+  400b20:	00000000
+  400b24:	00000000
+  400b28:	00000000
+  400b2c:	00000000
+  400b30:	00000000
+  400b34:	00000000
+  400b38:	00000000
+  400b3c:	00000000
+  400b40:	00000000
+  400b44:	00000000
+  400b48:	00000000
+  400b4c:	00000000
+  400b50:	00000000
+  400b54:	00000000
+  400b58:	00000000
+  400b5c:	00000000
+  400b60:	00000000
+  400b64:	00000000
+  400b68:	00000000
+  400b6c:	00000000
+  400b70:	00000000
+  400b74:	00000000
+  400b78:	00000000
+  400b7c:	00000000
+  400b80:	00000000
+  400b84:	00000000
+  400b88:	00000000
+  400b8c:	00000000
+  400b90:	00000000
+  400b94:	00000000
+  400b98:	00000000
+  400b9c:	00000000
+  400ba0:	00000000
+  400ba4:	00000000
+  400ba8:	00000000
+  400bac:	00000000
+  400bb0:	00000000
+  400bb4:	00000000
+  400bb8:	00000000
+  400bbc:	00000000
+  400bc0:	00000000
+  400bc4:	00000000
+  400bc8:	00000000
+  400bcc:	00000000
+  400bd0:	00000000
+  400bd4:	00000000
+  400bd8:	00000000
+  400bdc:	00000000
+  400be0:	00000000
+  400be4:	00000000
+  400be8:	00000000
+  400bec:	00000000
+  400bf0:	00000000
+  400bf4:	00000000
+  400bf8:	00000000
+  400bfc:	00000000
+  400c00:	00000000
+  400c04:	00000000
+  400c08:	00000000
+  400c0c:	00000000
+  400c10:	00000000
+  400c14:	00000000
+  400c18:	00000000
+  400c1c:	00000000
+  400c20:	00000000
+  400c24:	00000000
+  400c28:	00000000
+  400c2c:	00000000
+  400c30:	00000000
+  400c34:	00000000
+  400c38:	00000000
+  400c3c:	00000000
+  400c40:	00000000
+  400c44:	00000000
+  400c48:	00000000
+  400c4c:	00000000
+  400c50:	00000000
+  400c54:	00000000
+  400c58:	00000000
+  400c5c:	00000000
+  400c60:	00000000
+  400c64:	00000000
+  400c68:	00000000
+  400c6c:	00000000
+  400c70:	00000000
+  400c74:	00000000
+  400c78:	00000000
+  400c7c:	00000000
+  400c80:	00000000
+  400c84:	00000000
+  400c88:	00000000
+  400c8c:	00000000
+  400c90:	00000000
+  400c94:	00000000
+  400c98:	00000000
+  400c9c:	00000000
+  400ca0:	00000000
+  400ca4:	00000000
+  400ca8:	00000000
+  400cac:	00000000
+  400cb0:	00000000
+  400cb4:	00000000
+  400cb8:	00000000
+  400cbc:	00000000
+  400cc0:	00000000
+  400cc4:	00000000
+  400cc8:	00000000
+  400ccc:	00000000
+  400cd0:	00000000
+  400cd4:	00000000
+  400cd8:	00000000
+  400cdc:	00000000
+  400ce0:	00000000
+  400ce4:	00000000
+  400ce8:	00000000
+  400cec:	00000000
+  400cf0:	00000000
+  400cf4:	00000000
+  400cf8:	00000000
+  400cfc:	00000000
+  400d00:	00000000
@@ -0,0 +1,18 @@
+# Shared counter bumped 100 times by every core with ll/sc
+# Run with --cores, the counter at 0x00400100 ends up at 100 times the cores
+
+00400000 : <text>
+  400000:	3c100040 	lui $s0 0x40          ; s0 = 0x00400000
+  400004:	24080064 	addiu $t0 $zero 100   ; t0 = increments left
+  400008:	c2090100 	ll $t1 0x100($s0)     ; loop: t1 = counter
+  40000c:	25290001 	addiu $t1 $t1 1       ; t1 = counter + 1
+  400010:	e2090100 	sc $t1 0x100($s0)     ; t1 = 1 if stored, 0 if another core got there first
+  400014:	1120fffc 	beq $t1 $zero -4      ; try again if it failed
+  400018:	00000000 	nop
+  40001c:	2508ffff 	addiu $t0 $t0 -1      ; t0 = t0 - 1
+  400020:	1500fff9 	bne $t0 $zero -7      ; next increment
+  400024:	00000000 	nop
+  400028:	1000ffff 	beq $zero $zero -1    ; halt
+
+00400100 : <data>
+  400100:	00000000
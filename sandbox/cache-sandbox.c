@@ -26,7 +26,7 @@ int main(int argc, char * argv[]){
     uint32_t data;
     for(i = 4; i < 200; i+=4){
         //cache_digest();
-        while(d_cache_read_w(&i, &data) != CACHE_HIT){
+        while(d_cache_read_w(&i, &data, 0) != CACHE_HIT){
             cache_digest();
             system ("/bin/stty raw"); // set terminal to raw/unbuffered
             char c = getchar();
@@ -3,6 +3,7 @@
  */
 
 #include "alu.h"
+#include "eventlog.h"
 
 extern int flags; // from main.c
 
@@ -31,19 +32,12 @@ int execute(control_t *idex, control_t *exmem) {
             idex->regWrite = false;
     }
 
-    if (flags & MASK_DEBUG) {
-        cprintf(ANSI_C_CYAN, "EXECUTE: \n");
-        printf("\tInstruction: 0x%08x\n", idex->instr);
-        printf("\tALUOp:     0x%08x\n", idex->ALUop);
-        printf("\tArg1:      0x%08x\t(0d%d)\n", ALUArg1, ALUArg1);
-        printf("\tArg2:      0x%08x\t(0d%d)\n", ALUArg2, ALUArg2);
-        printf("\tshamt:     0x%02x\t\t(0d%d)\n", idex->shamt, idex->shamt);
-        printf("\tALUresult: 0x%08x\t(0d%d)\n", ALUresult, ALUresult);
-    }
+    EVENT(EV_EXECUTE, idex->instr, idex->ALUop, ALUArg1, ALUArg2, idex->shamt, ALUresult);
 
     // Copy the results into the next pipeline register
     copy_pipeline_register(idex, exmem);
     exmem->ALUresult = ALUresult;
+    exmem->memDone = false;
     return 0;
 }
 
@@ -62,9 +56,7 @@ int alu(operation_t operation, word_t op_rs, word_t op_rt, word_t shamt, word_t
             if (!(ADD_OVERFLOW(op_rs,op_rt,temp))) {
                 *result = temp;
             } else {
-                if (flags & MASK_DEBUG) {
-                    printf("ALU::OPR_ADD: OVERFLOW! rs: %d, rt: %d, temp: %d; rs.31: %d, rt.31: %d, temp.31: %d\n",(int32_t)op_rs,(int32_t)op_rt,(int32_t)temp,BIT31(op_rs),BIT31(op_rt),BIT31(temp));
-                }
+                EVENT(EV_ALU_OVERFLOW, op_rs, op_rt, temp, BIT31(op_rs), BIT31(op_rt), BIT31(temp));
                 return ALU_INTEGER_OVERFLOW;
             }
             break;
@@ -95,11 +87,11 @@ int alu(operation_t operation, word_t op_rs, word_t op_rt, word_t shamt, word_t
             break;
         case OPR_SEB:
             *result = SIGN_EXTEND_B((op_rt & 0xff));
-            printf("ALU::OPR_SEB: rt = %x, result = %x\n",op_rt,*result);
+            EVENT(EV_ALU_SIGN_EXTEND, 0, op_rt, *result);
             break;
         case OPR_SEH:
             *result = SIGN_EXTEND_H((op_rt & 0xffff));
-            printf("ALU::OPR_SEH: rt = %x, result = %x\n",op_rt,*result);
+            EVENT(EV_ALU_SIGN_EXTEND, 1, op_rt, *result);
             break;
         case OPR_SLL:
             // rd = rt << shamt
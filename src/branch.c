@@ -0,0 +1,345 @@
+/* src/branch.c
+* Branch prediction unit: static, bimodal, gshare and tournament predictors
+* and a direct mapped branch target buffer
+*/
+
+#include "branch.h"
+#include "stats.h"
+#include "registers.h"
+#include "eventlog.h"
+
+extern int flags;
+
+static const char * const BP_TYPE_STRINGS[] = {
+    [BP_NONE]       = "none",
+    [BP_STATIC]     = "static not-taken",
+    [BP_BIMODAL]    = "bimodal",
+    [BP_GSHARE]     = "gshare",
+    [BP_TOURNAMENT] = "tournament"
+};
+
+static branch_predictor_t *bpu = NULL;
+
+static bool bpu_power_of_two(uint32_t n){
+    return n != 0 && (n & (n - 1)) == 0 && n <= BP_MAX_ENTRIES;
+}
+
+static uint8_t *bpu_counters(uint32_t n, uint8_t initial){
+    uint8_t *table = (uint8_t *)malloc(sizeof(uint8_t) * n);
+    if(table == NULL){
+        cprintf(ANSI_C_RED, "bpu_init: Unable to allocate predictor tables\n");
+        assert(0);
+    }
+    for(uint32_t i = 0; i < n; i++){
+        table[i] = initial;
+    }
+    return table;
+}
+
+void bpu_init(cpu_config_t *cpu_cfg){
+    if(cpu_cfg->bp_type == BP_NONE){
+        return;
+    }
+    if(!bpu_power_of_two(cpu_cfg->bp_entries) || !bpu_power_of_two(cpu_cfg->btb_entries)){
+        cprintf(ANSI_C_RED, "bpu_init: %d predictor entries and %d BTB entries requested, both must be 2^n up to %d\n",
+            cpu_cfg->bp_entries, cpu_cfg->btb_entries, BP_MAX_ENTRIES);
+        assert(0);
+    }
+    if(cpu_cfg->ras_depth > RAS_MAX_DEPTH){
+        cprintf(ANSI_C_RED, "bpu_init: Return address stack of %d entries requested, at most %d\n",
+            cpu_cfg->ras_depth, RAS_MAX_DEPTH);
+        assert(0);
+    }
+    bpu = (branch_predictor_t *)malloc(sizeof(branch_predictor_t));
+    if(bpu == NULL){
+        cprintf(ANSI_C_RED, "bpu_init: Unable to allocate branch predictor\n");
+        assert(0);
+    }
+    bpu->type = cpu_cfg->bp_type;
+    bpu->num_entries = cpu_cfg->bp_entries;
+    bpu->index_mask = cpu_cfg->bp_entries - 1;
+    //Counters start weakly not taken, the chooser weakly on bimodal
+    bpu->bimodal = bpu_counters(bpu->num_entries, 1);
+    bpu->gshare = bpu_counters(bpu->num_entries, 1);
+    bpu->chooser = bpu_counters(bpu->num_entries, 1);
+    bpu->history = 0;
+    bpu->btb_entries = cpu_cfg->btb_entries;
+    bpu->btb = (btb_entry_t *)calloc(bpu->btb_entries, sizeof(btb_entry_t));
+    if(bpu->btb == NULL){
+        cprintf(ANSI_C_RED, "bpu_init: Unable to allocate branch target buffer\n");
+        assert(0);
+    }
+    bpu->ras_depth = cpu_cfg->ras_depth;
+    bpu->ras = (pc_t *)calloc(bpu->ras_depth ? bpu->ras_depth : 1, sizeof(pc_t));
+    if(bpu->ras == NULL){
+        cprintf(ANSI_C_RED, "bpu_init: Unable to allocate return address stack\n");
+        assert(0);
+    }
+    bpu->ras_top = 0;
+    bpu->ras_count = 0;
+    bpu->ras_op = RAS_NONE;
+    bpu->branches = 0;
+    bpu->jumps = 0;
+    bpu->taken = 0;
+    bpu->mispredicts = 0;
+    bpu->direction_mispredicts = 0;
+    bpu->target_mispredicts = 0;
+    bpu->btb_misses = 0;
+    bpu->calls = 0;
+    bpu->returns = 0;
+    bpu->ras_mispredicts = 0;
+    bpu->ras_overflows = 0;
+    bpu->ras_underflows = 0;
+
+    stats_register("bpu", "branches", &bpu->branches, "conditional branches resolved");
+    stats_register("bpu", "jumps", &bpu->jumps, "jumps resolved");
+    stats_register("bpu", "taken", &bpu->taken, "conditional branches taken");
+    stats_register("bpu", "mispredicts", &bpu->mispredicts, "wrong path fetches flushed");
+    stats_register("bpu", "direction_mispredicts", &bpu->direction_mispredicts, "branches predicted the wrong way");
+    stats_register("bpu", "target_mispredicts", &bpu->target_mispredicts, "taken with no target or the wrong one");
+    stats_register("bpu", "btb_misses", &bpu->btb_misses, "taken branches and jumps not in the BTB");
+    stats_register("bpu", "calls", &bpu->calls, "jal resolved");
+    stats_register("bpu", "returns", &bpu->returns, "jr $ra predicted by the return address stack");
+    stats_register("bpu", "ras_mispredicts", &bpu->ras_mispredicts, "returns to the wrong address");
+    stats_register("bpu", "ras_overflows", &bpu->ras_overflows, "calls that dropped the oldest return address");
+    stats_register("bpu", "ras_underflows", &bpu->ras_underflows, "returns fetched with the stack empty");
+}
+
+void bpu_free(void){
+    if(bpu == NULL){
+        return;
+    }
+    stats_unregister("bpu");
+    free(bpu->ras);
+    free(bpu->btb);
+    free(bpu->chooser);
+    free(bpu->gshare);
+    free(bpu->bimodal);
+    free(bpu);
+    bpu = NULL;
+}
+
+bool bpu_enabled(void){
+    return bpu != NULL;
+}
+
+static btb_entry_t *bpu_btb_find(pc_t pc){
+    btb_entry_t *entry = &bpu->btb[(pc >> 2) & (bpu->btb_entries - 1)];
+    if(entry->valid && entry->pc == pc){
+        return entry;
+    }
+    return NULL;
+}
+
+static uint32_t bpu_bimodal_index(pc_t pc){
+    return (pc >> 2) & bpu->index_mask;
+}
+
+static uint32_t bpu_gshare_index(pc_t pc, uint32_t history){
+    return ((pc >> 2) ^ history) & bpu->index_mask;
+}
+
+// Direction the counters give for a conditional branch at pc
+static bool bpu_direction(pc_t pc, uint32_t history){
+    bool bimodal = bpu->bimodal[bpu_bimodal_index(pc)] >= 2;
+    bool gshare = bpu->gshare[bpu_gshare_index(pc, history)] >= 2;
+    switch(bpu->type){
+        case BP_BIMODAL:
+            return bimodal;
+        case BP_GSHARE:
+            return gshare;
+        case BP_TOURNAMENT:
+            return bpu->chooser[bpu_bimodal_index(pc)] >= 2 ? gshare : bimodal;
+        default:
+            return false;
+    }
+}
+
+static void bpu_train(uint8_t *counter, bool taken){
+    if(taken && *counter < 3){
+        (*counter)++;
+    } else if(!taken && *counter > 0){
+        (*counter)--;
+    }
+}
+
+// Pushes a return address, dropping the oldest one if the stack is full
+static void bpu_ras_push(pc_t address){
+    bpu->ras_top = (bpu->ras_top + 1) % bpu->ras_depth;
+    bpu->ras_saved = bpu->ras[bpu->ras_top];
+    bpu->ras[bpu->ras_top] = address;
+    bpu->ras_counted = bpu->ras_count == bpu->ras_depth;
+    if(bpu->ras_counted){
+        bpu->ras_overflows++;
+    } else {
+        bpu->ras_count++;
+    }
+    bpu->ras_op = RAS_PUSH;
+}
+
+// Pops a return address, returns false if the stack is empty
+static bool bpu_ras_pop(pc_t *address){
+    bpu->ras_op = RAS_POP;
+    bpu->ras_counted = bpu->ras_count == 0;
+    if(bpu->ras_counted){
+        bpu->ras_underflows++;
+        return false;
+    }
+    *address = bpu->ras[bpu->ras_top];
+    bpu->ras_top = (bpu->ras_top + bpu->ras_depth - 1) % bpu->ras_depth;
+    bpu->ras_count--;
+    return true;
+}
+
+void bpu_squash(void){
+    if(bpu == NULL){
+        return;
+    }
+    switch(bpu->ras_op){
+        case RAS_PUSH:
+            bpu->ras[bpu->ras_top] = bpu->ras_saved;
+            bpu->ras_top = (bpu->ras_top + bpu->ras_depth - 1) % bpu->ras_depth;
+            if(bpu->ras_counted){
+                bpu->ras_overflows--;
+            } else {
+                bpu->ras_count--;
+            }
+            break;
+        case RAS_POP:
+            if(bpu->ras_counted){
+                bpu->ras_underflows--;
+            } else {
+                bpu->ras_top = (bpu->ras_top + 1) % bpu->ras_depth;
+                bpu->ras_count++;
+            }
+            break;
+        default:
+            break;
+    }
+    bpu->ras_op = RAS_NONE;
+}
+
+void bpu_predict(control_t *ifid){
+    ifid->predTaken = false;
+    ifid->predTarget = 0;
+    ifid->predReturn = false;
+    ifid->bpHistory = bpu->history;
+    bpu->ras_op = RAS_NONE;
+    if(bpu->type == BP_STATIC){
+        return;
+    }
+    //Predecode calls and returns, $ra gets the address after the jal
+    if(bpu->ras_depth && ifid->opCode == OPC_JAL){
+        bpu_ras_push(ifid->pcNext);
+    } else if(bpu->ras_depth && ifid->opCode == OPC_RTYPE && ifid->funct == FNC_JR && ifid->regRs == REG_RA){
+        if(bpu_ras_pop(&ifid->predTarget)){
+            ifid->predTaken = true;
+            ifid->predReturn = true;
+            EVENT(EV_BPU_RETURN, ifid->pc, ifid->predTarget);
+            return;
+        }
+    }
+    btb_entry_t *entry = bpu_btb_find(ifid->pc);
+    if(entry == NULL){
+        return;
+    }
+    if(entry->unconditional || bpu_direction(ifid->pc, bpu->history)){
+        ifid->predTaken = true;
+        ifid->predTarget = entry->target;
+    }
+    EVENT(EV_BPU_PREDICT, ifid->pc, ifid->predTaken, entry->target);
+}
+
+bool bpu_is_control(control_t *reg){
+    switch(reg->opCode){
+        case OPC_BEQ:
+        case OPC_BNE:
+        case OPC_BLTZ:
+        case OPC_BGTZ:
+        case OPC_BLEZ:
+            return true;
+        default:
+            return reg->jump;
+    }
+}
+
+pc_t bpu_actual_next(control_t *reg){
+    //Past the delay slot when not taken
+    return (reg->jump || reg->PCSrc) ? reg->pcNext : reg->pc + 8;
+}
+
+void bpu_update(control_t *reg, bool mispredicted){
+    bool taken = reg->jump || reg->PCSrc;
+    btb_entry_t *entry = bpu->type == BP_STATIC ? NULL : bpu_btb_find(reg->pc);
+    bool btb_hit = entry != NULL;
+    if(reg->jump){
+        bpu->jumps++;
+        if(reg->opCode == OPC_JAL){
+            bpu->calls++;
+        }
+        if(reg->predReturn){
+            bpu->returns++;
+            if(mispredicted){
+                bpu->ras_mispredicts++;
+            }
+        }
+    } else {
+        bpu->branches++;
+        if(taken){
+            bpu->taken++;
+        }
+        //Both tables learn, the chooser moves toward whichever was right
+        uint8_t *bimodal = &bpu->bimodal[bpu_bimodal_index(reg->pc)];
+        uint8_t *gshare = &bpu->gshare[bpu_gshare_index(reg->pc, reg->bpHistory)];
+        if((*bimodal >= 2) != (*gshare >= 2)){
+            bpu_train(&bpu->chooser[bpu_bimodal_index(reg->pc)], (*gshare >= 2) == taken);
+        }
+        bpu_train(bimodal, taken);
+        bpu_train(gshare, taken);
+        bpu->history = ((bpu->history << 1) | taken) & bpu->index_mask;
+    }
+    if(taken && bpu->type != BP_STATIC){
+        if(entry == NULL){
+            bpu->btb_misses++;
+            entry = &bpu->btb[(reg->pc >> 2) & (bpu->btb_entries - 1)];
+        }
+        entry->valid = true;
+        entry->unconditional = reg->jump;
+        entry->pc = reg->pc;
+        entry->target = reg->pcNext;
+    }
+    if(mispredicted){
+        bpu->mispredicts++;
+        if(taken && (reg->predTaken || (!btb_hit && bpu->type != BP_STATIC))){
+            //Right direction (or no chance to predict it), wrong place
+            bpu->target_mispredicts++;
+        } else {
+            bpu->direction_mispredicts++;
+        }
+    }
+    EVENT(EV_BPU_UPDATE, reg->pc, taken | mispredicted << 1);
+}
+
+void bpu_report(void){
+    if(bpu == NULL){
+        return;
+    }
+    uint32_t resolved = bpu->branches + bpu->jumps;
+    printf("Branch prediction (%s, %d entries, %d entry BTB):\n", BP_TYPE_STRINGS[bpu->type],
+        bpu->num_entries, bpu->btb_entries);
+    printf("\tBranches resolved:      %d (%d taken)\n", bpu->branches, bpu->taken);
+    printf("\tJumps resolved:         %d\n", bpu->jumps);
+    printf("\tMispredictions:         %d (%d direction, %d target)\n", bpu->mispredicts,
+        bpu->direction_mispredicts, bpu->target_mispredicts);
+    printf("\tBTB misses:             %d\n", bpu->btb_misses);
+    if(resolved){
+        printf("\tAccuracy:               %.3f\n", 1.0 - (double)bpu->mispredicts / resolved);
+    }
+    if(bpu->ras_depth){
+        printf("\tReturn address stack:   %d entries, %d calls, %d returns predicted\n",
+            bpu->ras_depth, bpu->calls, bpu->returns);
+        printf("\t    Mispredicted returns: %d\n", bpu->ras_mispredicts);
+        printf("\t    Overflows:            %d\n", bpu->ras_overflows);
+        printf("\t    Underflows:           %d\n", bpu->ras_underflows);
+    }
+}
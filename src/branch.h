@@ -0,0 +1,108 @@
+/* src/branch.h
+* Branch prediction unit: direction predictors and a branch target buffer.
+* With a predictor selected, branches and jumps resolve in the execute stage
+* instead of decode. Fetch follows the prediction after the delay slot and
+* hazard() flushes the wrong path when the branch resolves.
+*/
+
+#ifndef _BRANCH_H
+#define _BRANCH_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <assert.h>
+#include "util.h"
+#include "types.h"
+
+//Largest predictor table / BTB that can be configured
+#define BP_MAX_ENTRIES (1<<16)
+//Deepest return address stack that can be configured
+#define RAS_MAX_DEPTH 64
+
+//A branch target buffer entry, tagged with the full address of the branch
+typedef struct BTB_ENTRY {
+    bool valid;
+    bool unconditional;     //a jump, always taken when found
+    pc_t pc;
+    pc_t target;
+} btb_entry_t;
+
+//What the last fetch did to the return address stack
+typedef enum RAS_OP {
+    RAS_NONE,
+    RAS_PUSH,
+    RAS_POP
+} ras_op_t;
+
+typedef struct BRANCH_PREDICTOR {
+    bp_type_t type;
+    uint32_t num_entries;
+    uint32_t index_mask;
+    uint8_t *bimodal;           //2-bit saturating counters indexed by PC
+    uint8_t *gshare;            //2-bit saturating counters indexed by PC xor history
+    uint8_t *chooser;           //2-bit counters, high half picks gshare
+    uint32_t history;           //global outcome history, newest outcome in bit 0
+    uint32_t btb_entries;
+    btb_entry_t *btb;
+    uint32_t ras_depth;
+    pc_t *ras;                  //circular return address stack
+    uint32_t ras_top;           //index of the newest entry
+    uint32_t ras_count;         //valid entries, up to ras_depth
+    ras_op_t ras_op;            //operation of the last fetch, undone if it is squashed
+    pc_t ras_saved;             //entry a push overwrote
+    bool ras_counted;           //the push overflowed or the pop underflowed
+    //Counters
+    uint32_t branches;          //conditional branches resolved
+    uint32_t jumps;             //j, jal and jr resolved
+    uint32_t taken;             //conditional branches taken
+    uint32_t mispredicts;       //wrong path fetches flushed
+    uint32_t direction_mispredicts; //conditional branches predicted the wrong way
+    uint32_t target_mispredicts;    //taken, but the BTB had no target or the wrong one
+    uint32_t btb_misses;        //taken branches and jumps not found in the BTB
+    uint32_t calls;             //jal resolved
+    uint32_t returns;           //jr $ra resolved with a target from the stack
+    uint32_t ras_mispredicts;   //returns whose stack target was wrong
+    uint32_t ras_overflows;     //pushes that dropped the oldest entry
+    uint32_t ras_underflows;    //jr $ra fetched with the stack empty
+} branch_predictor_t;
+
+/* @brief Creates the branch prediction unit described by cpu_cfg and
+*  registers its counters with the statistics registry.
+*  Nothing is created for BP_NONE and branches keep resolving in decode.
+*/
+void bpu_init(cpu_config_t *cpu_cfg);
+void bpu_free(void);
+
+/* @brief Returns true if branches resolve in execute with prediction */
+bool bpu_enabled(void);
+
+/* @brief Predicts the instruction just fetched into ifid. Sets
+*  ifid->predTaken/predTarget for where fetch goes after its delay slot.
+*  A jal pushes its return address on the return address stack and a
+*  jr $ra pops its target from it.
+*/
+void bpu_predict(control_t *ifid);
+
+/* @brief Undoes the return address stack operation of the instruction
+*  fetched this cycle. Called when ifid is flushed or the cycle restored.
+*/
+void bpu_squash(void);
+
+/* @brief Returns true if reg holds a branch or jump */
+bool bpu_is_control(control_t *reg);
+
+/* @brief Returns where fetch has to go after the delay slot of the branch
+*  or jump in reg, now that it is resolved
+*/
+pc_t bpu_actual_next(control_t *reg);
+
+/* @brief Trains the predictor on a resolved branch or jump.
+*  mispredicted is true if its wrong path was flushed.
+*/
+void bpu_update(control_t *reg, bool mispredicted);
+
+/* @brief Prints the accuracy of the predictor */
+void bpu_report(void);
+
+#endif /* _BRANCH_H */
@@ -0,0 +1,170 @@
+/* src/breakpoint.c
+* Breakpoint and watchpoint bitmaps
+*/
+
+#include "breakpoint.h"
+#include "main_memory.h"
+
+extern int flags;
+
+//A bit per word of main memory, allocated when the first one is set
+static uint64_t *breakpoints = NULL;
+static uint64_t *watch_reads = NULL;
+static uint64_t *watch_writes = NULL;
+static uint32_t num_breakpoints = 0;
+static uint32_t num_watched = 0;
+static bool pending = false;
+static watch_hit_t pending_hit;
+
+/* Index of the word at address in the bitmaps, false if it isn't in memory */
+static bool breakpoint_index(uint32_t address, uint32_t *index){
+    if(address < mem_start() || address > mem_end()){
+        return false;
+    }
+    *index = (address - mem_start()) >> 2;
+    return true;
+}
+
+static bool bit_get(const uint64_t *map, uint32_t index){
+    return map != NULL && (map[index >> 6] >> (index & 63)) & 1;
+}
+
+static void bit_set(uint64_t **map, uint32_t index, bool value){
+    if(*map == NULL && !value){
+        return;
+    }
+    if(*map == NULL){
+        *map = (uint64_t *)calloc((mem_size_w() + 63) >> 6, sizeof(uint64_t));
+        if(*map == NULL){
+            cprintf(ANSI_C_RED, "bit_set: Unable to allocate the breakpoint bitmap\n");
+            assert(0);
+        }
+    }
+    if(value){
+        (*map)[index >> 6] |= (uint64_t)1 << (index & 63);
+    } else {
+        (*map)[index >> 6] &= ~((uint64_t)1 << (index & 63));
+    }
+}
+
+bool breakpoint_add(uint32_t address){
+    uint32_t index;
+    if(!breakpoint_index(address, &index) || bit_get(breakpoints, index)){
+        return false;
+    }
+    bit_set(&breakpoints, index, true);
+    num_breakpoints++;
+    flags |= MASK_BREAKPOINTS;
+    return true;
+}
+
+bool breakpoint_delete(uint32_t address){
+    uint32_t index;
+    if(!breakpoint_index(address, &index) || !bit_get(breakpoints, index)){
+        return false;
+    }
+    bit_set(&breakpoints, index, false);
+    if(--num_breakpoints == 0){
+        flags &= ~MASK_BREAKPOINTS;
+    }
+    return true;
+}
+
+uint32_t breakpoint_get_active(void){
+    return num_breakpoints;
+}
+
+bool breakpoint_at(uint32_t address){
+    uint32_t index;
+    return breakpoint_index(address, &index) && bit_get(breakpoints, index);
+}
+
+void breakpoint_dump(void){
+    uint32_t words = mem_size_w();
+    printf("\tAddress     Breakpoint  Watchpoint\n");
+    for(uint32_t i = 0; i < words; i++){
+        //A 64-bit word of the bitmaps at a time while they are all clear
+        if((i & 63) == 0){
+            uint64_t any = (breakpoints == NULL ? 0 : breakpoints[i >> 6]) | (watch_reads == NULL ? 0 : watch_reads[i >> 6]) |
+                (watch_writes == NULL ? 0 : watch_writes[i >> 6]);
+            if(any == 0){
+                i += 63;
+                continue;
+            }
+        }
+        bool read = bit_get(watch_reads, i), write = bit_get(watch_writes, i);
+        if(bit_get(breakpoints, i) || read || write){
+            printf("\t0x%08x  %-10s  %s\n", mem_start() + (i << 2), bit_get(breakpoints, i) ? "SET" : "---",
+                read && write ? "read/write" : read ? "read" : write ? "write" : "---");
+        }
+    }
+}
+
+bool watch_add(uint32_t address, watch_kind_t kind){
+    uint32_t index;
+    if(!breakpoint_index(address, &index)){
+        return false;
+    }
+    if(!bit_get(watch_reads, index) && !bit_get(watch_writes, index)){
+        num_watched++;
+    }
+    if(kind & WATCH_READ){
+        bit_set(&watch_reads, index, true);
+    }
+    if(kind & WATCH_WRITE){
+        bit_set(&watch_writes, index, true);
+    }
+    flags |= MASK_WATCHPOINTS;
+    return true;
+}
+
+bool watch_delete(uint32_t address){
+    uint32_t index;
+    if(!breakpoint_index(address, &index) || (!bit_get(watch_reads, index) && !bit_get(watch_writes, index))){
+        return false;
+    }
+    bit_set(&watch_reads, index, false);
+    bit_set(&watch_writes, index, false);
+    if(--num_watched == 0){
+        flags &= ~MASK_WATCHPOINTS;
+    }
+    return true;
+}
+
+uint32_t watch_get_active(void){
+    return num_watched;
+}
+
+void watch_access(uint32_t address, bool write, pc_t pc, word_t value){
+    uint32_t index;
+    if(pending || !breakpoint_index(address, &index) || !bit_get(write ? watch_writes : watch_reads, index)){
+        return;
+    }
+    pending = true;
+    pending_hit.address = address;
+    pending_hit.pc = pc;
+    pending_hit.value = value;
+    pending_hit.write = write;
+}
+
+bool watch_hit(watch_hit_t *hit){
+    if(!pending){
+        return false;
+    }
+    *hit = pending_hit;
+    pending = false;
+    return true;
+}
+
+void breakpoint_free(void){
+    free(breakpoints);
+    free(watch_reads);
+    free(watch_writes);
+    breakpoints = NULL;
+    watch_reads = NULL;
+    watch_writes = NULL;
+    num_breakpoints = 0;
+    num_watched = 0;
+    pending = false;
+    flags &= ~(MASK_BREAKPOINTS | MASK_WATCHPOINTS);
+}
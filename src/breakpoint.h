@@ -0,0 +1,83 @@
+/* src/breakpoint.h
+* Breakpoints and watchpoints of the interactive debugger. Both are bitmaps
+* with a bit per word of main memory, so there can be as many as there are
+* words and checking one is a shift and a mask. Watchpoints cover the whole
+* word, a byte or halfword access to it triggers them too.
+*
+* The main loop and memory() only look at them while MASK_BREAKPOINTS or
+* MASK_WATCHPOINTS is set, which is only while some are, so a run without
+* any pays a flags test.
+*/
+
+#ifndef _BREAKPOINT_H
+#define _BREAKPOINT_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <assert.h>
+#include "util.h"
+#include "types.h"
+
+typedef enum WATCH_KIND {
+    WATCH_READ          = 1,    // loads of the word
+    WATCH_WRITE         = 2,    // stores to the word
+    WATCH_ACCESS        = 3     // both
+} watch_kind_t;
+
+// The access that triggered a watchpoint
+typedef struct WATCH_HIT {
+    uint32_t address;
+    pc_t pc;                    // of the load or store
+    word_t value;               // loaded or stored
+    bool write;
+} watch_hit_t;
+
+/* @brief Sets a breakpoint on the instruction at address
+*  @returns false if the address is outside memory or already has one
+*/
+bool breakpoint_add(uint32_t address);
+
+/* @brief Clears the breakpoint at address
+*  @returns false if there is none
+*/
+bool breakpoint_delete(uint32_t address);
+
+/* @brief Number of breakpoints set */
+uint32_t breakpoint_get_active(void);
+
+/* @brief Whether there is a breakpoint at address */
+bool breakpoint_at(uint32_t address);
+
+/* @brief Lists the breakpoints and watchpoints in address order */
+void breakpoint_dump(void);
+
+/* @brief Watches the word at address for kind accesses, on top of what it
+*  is watched for already
+*  @returns false if the address is outside memory
+*/
+bool watch_add(uint32_t address, watch_kind_t kind);
+
+/* @brief Stops watching the word at address
+*  @returns false if it wasn't watched
+*/
+bool watch_delete(uint32_t address);
+
+/* @brief Number of words watched */
+uint32_t watch_get_active(void);
+
+/* @brief Called by memory() for every load and store that went through, only
+*  while MASK_WATCHPOINTS is set. Remembers the first one that hits a
+*  watchpoint until watch_hit() picks it up.
+*/
+void watch_access(uint32_t address, bool write, pc_t pc, word_t value);
+
+/* @brief Hands over the access that hit a watchpoint since the last call
+*  @returns false if none did
+*/
+bool watch_hit(watch_hit_t *hit);
+
+/* @brief Clears every breakpoint and watchpoint and frees the bitmaps */
+void breakpoint_free(void);
+
+#endif /* _BREAKPOINT_H */
@@ -4,38 +4,103 @@
 
 
 #include "cache.h"
+#include "prefetch.h"
+#include "stats.h"
+#include "coherence.h"
+#include "eventlog.h"
 
 extern int flags;
 
-direct_cache_t *d_cache;
-direct_cache_t *i_cache;
-write_buffer_t *write_buffer;
-memory_status_t memory_status = MEM_IDLE;
+//Caches, bus and write buffer of the core selected by this host thread
+_Thread_local direct_cache_t *d_cache;
+_Thread_local direct_cache_t *i_cache;
+static _Thread_local cache_bus_t *bus;
+static _Thread_local write_buffer_t *write_buffer;
+//Private caches of every core
+static direct_cache_t *d_caches[COHERENCE_MAX_CORES];
+static direct_cache_t *i_caches[COHERENCE_MAX_CORES];
+static uint32_t num_cores = 1;
+//One bus shared by every core, or one for each with a quantum
+static cache_bus_t buses[COHERENCE_MAX_CORES];
+static uint32_t num_buses = 1;
 
 cache_config_t *config;
 
 memory_status_t get_mem_status(void){
-    return memory_status;
+    return bus != NULL ? bus->status : MEM_IDLE;
 }
 void set_mem_status(memory_status_t status){
-    memory_status = status;
+    bus->status = status;
 }
 
 void cache_init(cache_config_t *cpu_cfg){
+    config = (cache_config_t *)malloc(sizeof(cache_config_t));
     memcpy(config, cpu_cfg, sizeof(cache_config_t));
 
-    set_mem_status(MEM_IDLE);
+    num_cores = config->cores > 1 ? config->cores : 1;
+    num_buses = (num_cores > 1 && config->quantum) ? num_cores : 1;
+    for(uint32_t i = 0; i < COHERENCE_MAX_CORES; i++){
+        memset(&buses[i], 0, sizeof(cache_bus_t));
+        buses[i].status = MEM_IDLE;
+        buses[i].first = num_buses > 1 ? i : 0;
+        buses[i].count = num_buses > 1 ? 1 : num_cores;
+    }
+    coherence_init(config->coherence, num_cores);
+    if(num_buses > 1){
+        coherence_defer();
+    }
+    for(uint32_t i = 0; i < COHERENCE_MAX_CORES; i++){
+        d_caches[i] = NULL;
+        i_caches[i] = NULL;
+    }
     if(config->mode == CACHE_DISABLE){
+        cache_select(0);
         return;
-    } else if(config->mode == CACHE_SPLIT){
-        d_cache_init(config);
-        i_cache_init(config);
-        write_buffer = write_buffer_init();
-    } else if(config->mode == CACHE_UNIFIED){
+    }
+    for(uint32_t i = 0; i < num_cores; i++){
         d_cache_init(config);
-        write_buffer = write_buffer_init();
+        d_caches[i] = d_cache;
+        if(config->mode == CACHE_SPLIT){
+            i_cache_init(config);
+            i_caches[i] = i_cache;
+        }
+        if(num_cores > 1 && config->data_enabled){
+            coherence_attach(i, d_cache);
+        }
+    }
+    for(uint32_t i = 0; i < num_buses; i++){
+        buses[i].write_buffer = write_buffer_init();
     }
+    cache_select(0);
+    cache_register_stats();
+}
+
+void cache_select(uint32_t core){
+    d_cache = d_caches[core];
+    i_cache = i_caches[core];
+    bus = &buses[num_buses > 1 ? core : 0];
+    write_buffer = bus->write_buffer;
+    coherence_select(core);
+}
 
+void cache_register_stats(void){
+    if(d_cache != NULL && config->data_enabled){
+        direct_cache_register_stats(d_cache, "dcache");
+        victim_register_stats(d_cache->victim, "dcache.victim");
+        prefetch_register_stats(d_cache->prefetch, "dcache.prefetch");
+    }
+    if(i_cache != NULL && config->inst_enabled){
+        direct_cache_register_stats(i_cache, "icache");
+        victim_register_stats(i_cache->victim, "icache.victim");
+        prefetch_register_stats(i_cache->prefetch, "icache.prefetch");
+    }
+    stats_register("write_buffer", "blocks", &write_buffer->blocks, "dirty blocks queued for memory");
+    stats_register("write_buffer", "stores", &write_buffer->stores, "write through stores queued for memory");
+    stats_register("write_buffer", "full_stalls", &write_buffer->full_stalls, "requests turned away while the buffer was busy");
+    stats_register("bus", "idle", &bus->cycles[MEM_IDLE], "cycles with nothing on the memory bus");
+    stats_register("bus", "writing", &bus->cycles[MEM_WRITING], "cycles draining the write buffer");
+    stats_register("bus", "reading_d", &bus->cycles[MEM_READING_D], "cycles filling the data cache");
+    stats_register("bus", "reading_i", &bus->cycles[MEM_READING_I], "cycles filling the instruction cache");
 }
 
 void d_cache_init(cache_config_t *cpu_cfg){
@@ -51,7 +116,12 @@ void d_cache_init(cache_config_t *cpu_cfg){
     }
     //Each block contains a word of data
     uint32_t num_blocks = cpu_cfg->data_size >> 2;
-    d_cache = direct_cache_init(num_blocks, cpu_cfg->data_block);
+    d_cache = direct_cache_init(num_blocks, cpu_cfg->data_block, cpu_cfg->data_mshrs);
+    d_cache->write_policy = (cpu_cfg->data_wpolicy == CACHE_WRITEBACK) ? WRITEBACK : WRITETHROUGH;
+    d_cache->prefetch = prefetch_init(d_cache, cpu_cfg->data_prefetch);
+    d_cache->victim = victim_init(cpu_cfg->data_victim, cpu_cfg->data_block);
+    d_cache->timing_only = cpu_cfg->timing_only;
+    d_cache->classify = cpu_cfg->classify;
 }
 
 void i_cache_init(cache_config_t *cpu_cfg){
@@ -64,18 +134,74 @@ void i_cache_init(cache_config_t *cpu_cfg){
         printf("Creating Instruction Cache (I Cache)\n");
     }
     uint32_t num_blocks = cpu_cfg->inst_size >> 2;
-    i_cache = direct_cache_init(num_blocks, cpu_cfg->inst_block);
+    //The pipeline can't do anything without its next instruction, so
+    //the instruction cache stays blocking
+    i_cache = direct_cache_init(num_blocks, cpu_cfg->inst_block, 1);
+    i_cache->prefetch = prefetch_init(i_cache, cpu_cfg->inst_prefetch);
+    i_cache->victim = victim_init(cpu_cfg->inst_victim, cpu_cfg->inst_block);
+    i_cache->timing_only = cpu_cfg->timing_only;
+    i_cache->classify = cpu_cfg->classify;
 }
 
 
 void cache_destroy(void){
 
-    direct_cache_free(d_cache);
+    stats_unregister("dcache");
+    stats_unregister("icache");
+    stats_unregister("write_buffer");
+    stats_unregister("bus");
+    coherence_free();
+
+    for(uint32_t i = 0; i < num_cores; i++){
+        direct_cache_free(d_caches[i]);
+        direct_cache_free(i_caches[i]);
+        d_caches[i] = NULL;
+        i_caches[i] = NULL;
+    }
 
-    direct_cache_free(i_cache);
+    for(uint32_t i = 0; i < num_buses; i++){
+        if(buses[i].write_buffer != NULL){
+            write_buffer_destroy(buses[i].write_buffer);
+            buses[i].write_buffer = NULL;
+        }
+    }
+    d_cache = NULL;
+    i_cache = NULL;
+    bus = NULL;
+    write_buffer = NULL;
+    free(config);
     return;
 }
 
+/* Returns true if core (or the write buffer) still needs the bus for status */
+static bool cache_bus_wants(memory_status_t status, uint32_t core){
+    switch(status){
+        case MEM_READING_D:
+            return d_caches[core]->fetching;
+        case MEM_READING_I:
+            return i_caches[core]->fetching;
+        case MEM_WRITING:
+            return write_buffer->writing;
+        default:
+            return false;
+    }
+}
+
+/* Picks the next user of the bus and the core it reads for */
+static memory_status_t cache_bus_arbitrate(void){
+    static const memory_status_t reads[] = {MEM_READING_D, MEM_READING_I};
+    for(int r = 0; r < 2; r++){
+        for(uint32_t n = 1; n <= bus->count; n++){
+            uint32_t core = bus->first + (bus->core - bus->first + n) % bus->count;
+            if(cache_bus_wants(reads[r], core)){
+                bus->core = core;
+                return reads[r];
+            }
+        }
+    }
+    return write_buffer->writing ? MEM_WRITING : MEM_IDLE;
+}
+
 /* void cache_digest(void)
 * processes the cache on each cycle
 * handles the business logic of fetching data from main memory,
@@ -84,8 +210,9 @@ void cache_destroy(void){
 */
 
 void cache_digest(void){
-    if(flags & MASK_DEBUG){
-        cprintf(ANSI_C_CYAN, "CACHE DIGEST:\n");
+    EVENT(EV_CACHE_DIGEST);
+    if(config->mode == CACHE_DISABLE){
+        return;
     }
 
     if(d_cache == NULL){
@@ -101,106 +228,32 @@ void cache_digest(void){
         assert(0);
     }
 
-    //State machine to ensure we do not have more than one memory access at a time
-    //This is a state that is consistent between all
-    switch (get_mem_status()) {
-        case MEM_IDLE:
-            //Ready to accept new memory accesses
-            //check for data cache read requests
-            if(d_cache->fetching){
-                set_mem_status(MEM_READING_D);
-            }
-            else if(i_cache->fetching){
-                set_mem_status(MEM_READING_I);
-            }
-            else if(write_buffer->writing){
-                set_mem_status(MEM_WRITING);
-            }
-            break;
-        case MEM_READING_D:
-            //Last digest cycle, we were reading into data cache. See if still reading
-            if(d_cache->fetching){
-                //Still reading, no state change
-                break;
-            }
-            else if(i_cache->fetching){
-                //Now instruction cache is reading
-                set_mem_status(MEM_READING_I);
-            }
-            else if(write_buffer->writing){
-                //writing from data cache to memory
-                set_mem_status(MEM_WRITING);
-            }
-            else {
-                set_mem_status(MEM_IDLE);
-            }
-            break;
-        case MEM_READING_I:
-            //Last cycle we were reading into instruction cache
-            if(i_cache->fetching){
-                //still reading into i cache
-                break;
-            }
-            else if(d_cache->fetching){
-                //now we are reading into d cache
-                set_mem_status(MEM_READING_D);
-            }
-            else if(write_buffer->writing){
-                //now we are writing into memory from d cache
-                set_mem_status(MEM_WRITING);
-            }
-            else {
-                //nothing to do
-                set_mem_status(MEM_IDLE);
-            }
-            break;
-        case MEM_WRITING:
-            //Last cycle we were writing to memory
-            if(write_buffer->writing){
-                //still writing
-                break;
-            }
-            else if(d_cache->fetching){
-                //Now reading into data cache
-                set_mem_status(MEM_READING_D);
-            }
-            else if(i_cache->fetching){
-                //Now reading into instruction cache
-                set_mem_status(MEM_READING_I);
-            }
-            else{
-                //nothing to do
-                set_mem_status(MEM_IDLE);
-            }
-            break;
-        default:
-            cprintf(ANSI_C_RED, "cache_digest: Undefined Memory State %d\n", get_mem_status());
-            assert(0);
-            break;
+    //State machine to ensure we do not have more than one memory access at a
+    //time. Whoever has the bus keeps it until it is done, then data cache
+    //fills go first, instruction cache fills next and the write buffer last.
+    //Cores take turns, starting after the one that had the bus.
+    memory_status_t status = get_mem_status();
+    if(status == MEM_IDLE || !cache_bus_wants(status, bus->core)){
+        set_mem_status(cache_bus_arbitrate());
     }
-    if(flags & MASK_DEBUG){
-        printf("\tcache_digest: Memory state is ");
-        switch(get_mem_status()){
-            case MEM_IDLE:
-                printf("MEM_IDLE\n");
-                break;
-            case MEM_WRITING:
-                printf("MEM_WRITING\n");
-                break;
-            case MEM_READING_D:
-                printf("MEM_READING_D\n");
-                break;
-            case MEM_READING_I:
-                printf("MEM_READING_I\n");
-                break;
-            default:
-                printf("UNDEFINED\n");
+    EVENT(EV_CACHE_BUS, get_mem_status() <= MEM_READING_I ? get_mem_status() : MEM_READING_I + 1);
+
+    bus->cycles[get_mem_status()]++;
+
+    //Prefetches only get the bus in cycles nobody else wants it
+    uint32_t last = bus->first + bus->count;
+    if(get_mem_status() == MEM_IDLE){
+        for(uint32_t i = bus->first; i < last; i++){
+            if(prefetch_issue(d_caches[i]) || prefetch_issue(i_caches[i])){
                 break;
+            }
         }
     }
 
-    direct_cache_digest(d_cache, MEM_READING_D);
-    direct_cache_digest(i_cache, MEM_READING_I);
+    for(uint32_t i = bus->first; i < last; i++){
+        direct_cache_digest(d_caches[i], get_mem_status() == MEM_READING_D && bus->core == i);
+        direct_cache_digest(i_caches[i], get_mem_status() == MEM_READING_I && bus->core == i);
+    }
     write_buffer_digest();
 
     //print_cache(i_cache);
@@ -209,32 +262,84 @@ void cache_digest(void){
 
 
 
-cache_status_t d_cache_read_w(uint32_t *address, word_t *data){
-    if(flags & MASK_DEBUG){
-        cprintf(ANSI_C_CYAN, "D_CACHE GET WORD:\n");
+/* Writes whatever wb still holds to memory, its mask is cleared so the
+*  words aren't written again
+*/
+static void write_buffer_publish(write_buffer_t *wb){
+    if(wb == NULL || !wb->writing){
+        return;
+    }
+    for(uint32_t i = wb->subsequent_writing; i < wb->length; i++){
+        uint32_t address = wb->address + (i << 2);
+        word_t word;
+        mem_read_w(address, &word);
+        word = (word & ~wb->mask[i]) | (wb->data[i] & wb->mask[i]);
+        mem_write_w(address, &word);
+        wb->mask[i] = 0;
+    }
+}
+
+bool cache_busy(void){
+    if(bus == NULL){
+        return false;
+    }
+    for(uint32_t i = bus->first; i < bus->first + bus->count; i++){
+        if((d_caches[i] != NULL && d_caches[i]->fetching) || (i_caches[i] != NULL && i_caches[i]->fetching)){
+            return true;
+        }
+    }
+    return write_buffer != NULL && write_buffer->writing;
+}
+
+void cache_publish(void){
+    for(uint32_t i = 0; i < num_buses; i++){
+        write_buffer_publish(buses[i].write_buffer);
+    }
+}
+
+void cache_flush(void){
+    if(config->timing_only){
+        //The caches hold no data worth writing back
+        return;
     }
+    for(uint32_t b = 0; b < num_buses; b++){
+        write_buffer_t *wb = buses[b].write_buffer;
+        if(wb != NULL && wb->writing){
+            //Older than anything in the cache, so it goes first
+            write_buffer_publish(wb);
+            wb->writing = false;
+            wb->subsequent_writing = 0;
+            wb->penalty_count = 0;
+        }
+    }
+    for(uint32_t i = 0; i < num_cores; i++){
+        if(d_caches[i] != NULL){
+            direct_cache_flush(d_caches[i]);
+        }
+    }
+}
+
+
+cache_status_t d_cache_read_w(uint32_t *address, word_t *data, pc_t pc){
+    EVENT(EV_DCACHE_READ);
     //Get data from the data cache
-    cache_status_t status = direct_cache_read_w(d_cache, address, data);
+    cache_status_t status = direct_cache_read_w(d_cache, address, data, pc);
     return status;
 }
 
 
-cache_status_t d_cache_write_w(uint32_t *address, word_t *data){
-    if(flags & MASK_DEBUG){
-        cprintf(ANSI_C_CYAN, "D_CACHE WRITE WORD:\n");
-    }
+cache_status_t d_cache_write_w(uint32_t *address, word_t *data, word_t mask, pc_t pc){
+    EVENT(EV_DCACHE_WRITE);
 
-    cache_status_t status = direct_cache_write_w(d_cache, address, data);
+    cache_status_t status = direct_cache_write_w(d_cache, address, data, mask, pc);
     return status;
 }
 
 cache_status_t i_cache_read_w(uint32_t *address, word_t *data){
-    if(flags & MASK_DEBUG){
-        cprintf(ANSI_C_CYAN, "I_CACHE GET WORD:\n");
-    }
+    EVENT(EV_ICACHE_READ);
     //Get data from the data cache
 
-    cache_status_t status = direct_cache_read_w(i_cache, address, data);
+    cache_status_t status = direct_cache_read_w(i_cache, address, data, *address);
 
     return status;
 }
@@ -242,13 +347,20 @@ cache_status_t i_cache_read_w(uint32_t *address, word_t *data){
 
 /* Write buffer implementation functions */
 /* @brief Initializes a new write buffer
-*  @returns an instance of a new write buffer depending on what write policy is defined
+*  @returns an instance of a new write buffer sized for a data cache block
 */
 write_buffer_t *write_buffer_init(void){
 
     write_buffer_t *wb = (write_buffer_t *)malloc(sizeof(write_buffer_t));
+    wb->writing = false;
     wb->penalty_count = 0;
+    wb->subsequent_writing = 0;
+    wb->length = 0;
+    wb->blocks = 0;
+    wb->stores = 0;
+    wb->full_stalls = 0;
     wb->data = (word_t *)malloc(sizeof(word_t)*d_cache->block_size);
+    wb->mask = (word_t *)malloc(sizeof(word_t)*d_cache->block_size);
     return wb;
 }
 
@@ -256,71 +368,132 @@ write_buffer_t *write_buffer_init(void){
 *  @params the write buffer to be destroyed.
 */
 void write_buffer_destroy(write_buffer_t *wb){
+    free(wb->mask);
     free(wb->data);
     free(wb);
 }
 
 void write_buffer_digest(void){
-    if(write_buffer->writing){
-        if(get_mem_status() != MEM_WRITING){
-            //Its not my turn!!!
-            return;
-        }
-        else {
-            write_buffer->penalty_count++;
-            if(write_buffer->penalty_count == CACHE_WRITE_PENALTY){
-                mem_write_w(write_buffer->address, &write_buffer->data[write_buffer->subsequent_writing]);
-                write_buffer->writing = false;
-                write_buffer->penalty_count = 0;
-                if(write_buffer->subsequent_writing != (d_cache->block_size - 1)){
-                    //enqueue the next data address
-                    write_buffer->address+=4;
-                    write_buffer->writing = true;
-                    write_buffer->penalty_count = 0;
-                    write_buffer->subsequent_writing = 1;
-                }
-            }
-            else if(write_buffer->subsequent_writing && write_buffer->penalty_count == CACHE_WRITE_SUBSEQUENT_PENALTY){
-                mem_write_w(write_buffer->address, &write_buffer->data[write_buffer->subsequent_writing]);
-                write_buffer->writing = false;
-                write_buffer->penalty_count = 0;
-                if(write_buffer->subsequent_writing != (d_cache->block_size - 1)){
-                    write_buffer->address += 4;
-                    write_buffer->writing = true;
-                    write_buffer->subsequent_writing++;
-                    write_buffer->penalty_count = 0;
-                }
+    if(!write_buffer->writing){
+        return;
+    }
+    if(get_mem_status() != MEM_WRITING){
+        //Its not my turn!!!
+        return;
+    }
+    write_buffer->penalty_count++;
+    if((write_buffer->subsequent_writing == 0 && write_buffer->penalty_count == CACHE_WRITE_PENALTY) ||
+        (write_buffer->subsequent_writing && write_buffer->penalty_count == CACHE_WRITE_SUBSEQUENT_PENALTY)){
+        uint32_t i = write_buffer->subsequent_writing;
+        uint32_t address = write_buffer->address + (i << 2);
+        word_t word = write_buffer->data[i];
+        //With timing only caches just the time on the bus counts
+        if(write_buffer->mask[i] != 0 && !config->timing_only){
+            if(write_buffer->mask[i] != 0xffffffff){
+                //Partial store, only replace the byte lanes that were written
+                mem_read_w(address, &word);
+                word = (word & ~write_buffer->mask[i]) | (write_buffer->data[i] & write_buffer->mask[i]);
             }
+            mem_write_w(address, &word);
+        }
+        write_buffer->penalty_count = 0;
+        if(i + 1 < write_buffer->length){
+            //move on to the next word
+            write_buffer->subsequent_writing++;
+        } else {
+            write_buffer->writing = false;
+            write_buffer->subsequent_writing = 0;
         }
     }
 }
 
-cache_status_t write_buffer_enqueue(cache_access_t info){
+cache_status_t write_buffer_enqueue(uint32_t address, word_t *data, bool *valid, uint32_t length){
     if(write_buffer == NULL){
         cprintf(ANSI_C_RED, "write_buffer_enqueue: buffer is not initialized\n");
         assert(0);
     }
     if(write_buffer->writing){
         //buffer is full!!
-        if(flags & MASK_DEBUG){
-            printf("\twrite_buffer_enqueue: Write buffer is full!\n");
-        }
+        EVENT(EV_WB_FULL);
+        write_buffer->full_stalls++;
         return CACHE_MISS;
     }
-    else {
-        if(flags & MASK_DEBUG){
-            printf("\twrite_buffer_enqueue: filling write buffer with block index %d and tag 0x%08x\n", info.index, info.tag);
-        }
-        write_buffer->address = info.tag | info.index;
-        uint8_t i = 0;
-        for(i = 0; i < d_cache->block_size; i++){
-            write_buffer->data[i] = d_cache->blocks[info.index].data[i];
-        }
-        write_buffer->writing = true;
-        write_buffer->penalty_count = 0;
-        write_buffer->subsequent_writing = 0;
-        return CACHE_HIT;
+    EVENT(EV_WB_BLOCK, address);
+    write_buffer->address = address;
+    for(uint32_t i = 0; i < length; i++){
+        write_buffer->data[i] = data[i];
+        write_buffer->mask[i] = valid[i] ? 0xffffffff : 0;
+    }
+    write_buffer->length = length;
+    write_buffer->writing = true;
+    write_buffer->blocks++;
+    write_buffer->penalty_count = 0;
+    write_buffer->subsequent_writing = 0;
+    return CACHE_HIT;
+}
+
+cache_status_t write_buffer_enqueue_word(uint32_t address, word_t data, word_t mask){
+    if(write_buffer == NULL){
+        cprintf(ANSI_C_RED, "write_buffer_enqueue_word: buffer is not initialized\n");
+        assert(0);
+    }
+    if(write_buffer->writing){
+        EVENT(EV_WB_WORD_FULL);
+        write_buffer->full_stalls++;
+        return CACHE_MISS;
+    }
+    EVENT(EV_WB_WORD, data, mask, address);
+    write_buffer->address = address;
+    write_buffer->data[0] = data;
+    write_buffer->mask[0] = mask;
+    write_buffer->length = 1;
+    write_buffer->writing = true;
+    write_buffer->stores++;
+    write_buffer->penalty_count = 0;
+    write_buffer->subsequent_writing = 0;
+    return CACHE_HIT;
+}
+
+bool write_buffer_pending(uint32_t address, uint32_t words){
+    if(write_buffer == NULL || !write_buffer->writing){
+        return false;
+    }
+    uint32_t end = address + (words << 2);
+    uint32_t wb_end = write_buffer->address + (write_buffer->length << 2);
+    return (write_buffer->address < end) && (address < wb_end);
+}
+
+uint32_t write_buffer_full_stalls(void){
+    if(write_buffer == NULL){
+        return 0;
+    }
+    return write_buffer->full_stalls;
+}
+
+
+void cache_report(void){
+    coherence_report();
+    if(i_cache != NULL && config->inst_enabled){
+        victim_report(i_cache->victim, "Instruction");
+        prefetch_report(i_cache, "Instruction");
+    }
+    if(d_cache == NULL || !config->data_enabled){
+        return;
+    }
+    printf("Data cache miss handling (%d MSHR%s):\n", d_cache->num_mshrs, d_cache->num_mshrs == 1 ? "" : "s");
+    printf("\tPrimary misses:         %d\n", d_cache->mshr_primary);
+    printf("\tSecondary misses:       %d (merged into an MSHR in flight)\n", d_cache->mshr_secondary);
+    printf("\tHits under miss:        %d\n", d_cache->hit_under_miss);
+    printf("\tMisses under miss:      %d\n", d_cache->miss_under_miss);
+    printf("\tMSHR full stalls:       %d\n", d_cache->mshr_full);
+    printf("\tMSHR conflict stalls:   %d\n", d_cache->mshr_conflict);
+    printf("\tCycles with MSHRs busy: %d\n", d_cache->mshr_busy_cycles);
+    if(d_cache->mshr_busy_cycles){
+        printf("\tMemory-level parallelism: %.3f average, %d peak\n",
+            (double)d_cache->mshr_occupancy / d_cache->mshr_busy_cycles, d_cache->mshr_peak);
     }
+    victim_report(d_cache->victim, "Data");
+    prefetch_report(d_cache, "Data");
 }
 
 
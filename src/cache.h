@@ -26,18 +26,43 @@
 memory_status_t get_mem_status(void);
 void set_mem_status(memory_status_t status);
 
+/* Builds a set of private caches for each of cache_cfg->cores cores, they
+*  share the write buffer and the memory bus. With cache_cfg->quantum set
+*  every core gets a bus and write buffer of its own instead, so cores can
+*  run on separate host threads. Core 0 is selected.
+*/
 void cache_init(cache_config_t *cache_cfg);
 void cache_destroy(void);
+/* Makes the caches (and bus) of core the ones the d_cache and i_cache
+*  functions use. The selection belongs to the calling host thread.
+*/
+void cache_select(uint32_t core);
+/* Runs a cycle of the selected bus, for every core on it */
 void cache_digest(void);
-
-cache_status_t d_cache_read_w(uint32_t *address, word_t *data);
-cache_status_t d_cache_write_w(uint32_t *address, word_t *data);
+/* Returns true while the selected bus has fills or writes under way */
+bool cache_busy(void);
+/* Writes the words waiting in every write buffer to memory right away, the
+*  buffers still hold the bus for as long as they would have. Called between
+*  quanta so no core reads memory another core's buffer hasn't updated yet.
+*/
+void cache_publish(void);
+/* Registers the counters of the caches, the write buffer and the memory bus
+*  with the statistics registry, called by cache_init
+*/
+void cache_register_stats(void);
+/* Drains the write buffer and the data caches into main memory, used at halt
+*  so memory reflects every store the program made
+*/
+void cache_flush(void);
+
+/* pc is the address of the load/store, for the prefetcher to train on */
+cache_status_t d_cache_read_w(uint32_t *address, word_t *data, pc_t pc);
+cache_status_t d_cache_write_w(uint32_t *address, word_t *data, word_t mask, pc_t pc);
 
 
 void d_cache_init(cache_config_t *cache_cfg);
 void i_cache_init(cache_config_t *cache_cfg);
 cache_status_t i_cache_read_w(uint32_t *address, word_t *data);
-cache_status_t i_cache_write_w(uint32_t *address, word_t *data);
 
 
 
@@ -46,14 +71,46 @@ typedef struct WRITE_BUFFER {
     bool writing;
     uint32_t penalty_count;
     uint32_t subsequent_writing;
+    uint32_t length;        //number of words held, a whole block or a single store
     word_t *data;
+    word_t *mask;           //byte lanes of each word that get written to memory
+    //Counters
+    uint32_t blocks;        //blocks queued by a write back
+    uint32_t stores;        //single word stores queued by a write through
+    uint32_t full_stalls;   //requests turned away because the buffer was busy
 } write_buffer_t;
 
+typedef struct CACHE_BUS {
+    memory_status_t status;
+    uint32_t core;          //core the bus is reading for
+    uint32_t first;         //cores on the bus are first to first + count - 1
+    uint32_t count;
+    write_buffer_t *write_buffer;
+    uint32_t cycles[MEM_READING_I + 1];    //cycles spent in each memory_status_t
+} cache_bus_t;
+
 
 write_buffer_t *write_buffer_init(void);
 void write_buffer_destroy(write_buffer_t *wb);
 void write_buffer_digest(void);
-cache_status_t write_buffer_enqueue(cache_access_t info);
+/* @brief Queues a block being replaced to be written back to main memory.
+*  Only the words marked valid are written.
+*  @returns CACHE_MISS if the buffer is full, CACHE_HIT otherwise
+*/
+cache_status_t write_buffer_enqueue(uint32_t address, word_t *data, bool *valid, uint32_t length);
+/* @brief Queues a single (possibly partial) word store for a writethrough cache */
+cache_status_t write_buffer_enqueue_word(uint32_t address, word_t data, word_t mask);
+/* @brief Returns true if the buffer still holds data for any of the words
+*  starting at address
+*/
+bool write_buffer_pending(uint32_t address, uint32_t words);
+/* @brief Returns how many requests the write buffer has turned away so far */
+uint32_t write_buffer_full_stalls(void);
+
+/* Prints the miss handling counters of the data cache and the counters of
+*  any victim caches and prefetchers
+*/
+void cache_report(void);
 
 /*Debugging stuff*/
 void print_icache(int block);
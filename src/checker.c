@@ -0,0 +1,275 @@
+/* src/checker.c
+* Functional reference model the pipeline is checked against in lockstep
+*/
+
+#include "checker.h"
+#include "fetch.h"
+#include "decode.h"
+#include "alu.h"
+#include "hazard.h"
+#include "registers.h"
+#include "main_memory.h"
+#include "stats.h"
+
+extern int flags;
+
+static bool enabled = false;
+static bool diverged = false;
+//The reference
+static control_t *ifid = NULL, *idex = NULL, *exmem = NULL;
+static pc_t pc = 0;
+static pc_t pc_next = 0;
+static word_t regs[32];
+static word_t *image = NULL;        //its own copy of memory
+static uint32_t image_start = 0;
+static uint32_t image_words = 0;
+static bool linked = false;         //ll/sc, one core only
+static uint32_t link = 0;
+static bool halted = false;
+//Written back by the cycle running now, kept unless it is restored
+static checker_commit_t pending;
+static bool have_pending = false;
+//Statistics
+static uint32_t commits = 0;        //register writes and stores compared
+static uint32_t stores = 0;
+
+void checker_init(pc_t start){
+    //The reference does the memory stage itself, three registers are enough
+    ifid = (control_t *)malloc(sizeof(control_t));
+    idex = (control_t *)malloc(sizeof(control_t));
+    exmem = (control_t *)malloc(sizeof(control_t));
+    flush(ifid);
+    flush(idex);
+    flush(exmem);
+    pc = start;
+    pc_next = start + 4;
+    for(int r = 0; r < 32; r++){
+        reg_read(r, &regs[r]);
+    }
+    image_start = mem_start();
+    image_words = mem_size_w();
+    image = (word_t *)malloc(image_words * sizeof(word_t));
+    for(uint32_t i = 0; i < image_words; i++){
+        mem_read_w(image_start + (i << 2), &image[i]);
+    }
+    linked = false;
+    halted = false;
+    diverged = false;
+    have_pending = false;
+    commits = 0;
+    stores = 0;
+    enabled = true;
+    stats_register("checker", "commits", &commits, "register writes and stores compared with the reference");
+    stats_register("checker", "stores", &stores, "stores compared with the reference");
+    if(flags & MASK_DEBUG){
+        printf("checker_init: reference starting at 0x%08x with %d words of memory\n", start, image_words);
+    }
+}
+
+void checker_free(void){
+    if(!enabled){
+        return;
+    }
+    stats_unregister("checker");
+    free(ifid);
+    free(idex);
+    free(exmem);
+    ifid = idex = exmem = NULL;
+    free(image);
+    image = NULL;
+    enabled = false;
+}
+
+bool checker_enabled(void){
+    return enabled;
+}
+
+static word_t *checker_word(uint32_t address){
+    uint32_t index = (address >> 2) - (image_start >> 2);
+    if(index >= image_words){
+        cprintf(ANSI_C_RED, "checker: reference access to 0x%08x is out of memory\n", address);
+        assert(0);
+    }
+    return &image[index];
+}
+
+/* Byte lanes a store of opcode writes at address */
+static word_t checker_mask(opcode_t opcode, uint32_t address){
+    switch(opcode){
+        case OPC_SB:
+            return 0xff << ((3-(address & 0x3))<<3);
+        case OPC_SH:
+            return 0xffff << ((2-(address & 0x2))<<3);
+        default:
+            return 0xffffffff;
+    }
+}
+
+/* Runs the next instruction of the reference
+*  @returns false if it is one of the halt numbers, which aren't run
+*/
+static bool checker_step(checker_commit_t *commit){
+    ifid->instr = *checker_word(pc);
+    if(ifid->instr == 0x1000ffff || ifid->instr == 0x00000008){
+        return false;
+    }
+    fetch_fields(ifid);
+    ifid->pc = pc;
+    ifid->pcNext = pc + 4;
+    decode(ifid, idex);
+    execute(idex, exmem);
+    memset(commit, 0, sizeof(checker_commit_t));
+    commit->pc = pc;
+    commit->instr = exmem->instr;
+    uint32_t address = exmem->ALUresult;
+    word_t data = 0;
+    if(exmem->memRead){
+        word_t word = *checker_word(address);
+        switch(exmem->opCode){
+            case OPC_LB:
+                data = (word >> ((3-(address & 0x3))<<3)) & 0xff;
+                data = SIGN_EXTEND_B(data);
+                break;
+            case OPC_LBU:
+                data = (word >> ((3-(address & 0x3))<<3)) & 0xff;
+                break;
+            case OPC_LH:
+                data = (word >> ((2-(address & 0x2))<<3)) & 0xffff;
+                data = SIGN_EXTEND_H(data);
+                break;
+            case OPC_LHU:
+                data = (word >> ((2-(address & 0x2))<<3)) & 0xffff;
+                break;
+            default:
+                data = word;
+                break;
+        }
+        if(exmem->opCode == OPC_LL){
+            linked = true;
+            link = address & ~3u;
+        }
+    }
+    if(exmem->memWrite){
+        bool stored = true;
+        if(exmem->opCode == OPC_SC){
+            stored = linked && link == (address & ~3u);
+            data = stored;
+        }
+        if(stored){
+            word_t mask = checker_mask(exmem->opCode, address);
+            word_t shifted = exmem->regRtValue;
+            if(exmem->opCode == OPC_SB){
+                shifted <<= (3-(address & 0x3))<<3;
+            } else if(exmem->opCode == OPC_SH){
+                shifted <<= (2-(address & 0x2))<<3;
+            }
+            word_t *word = checker_word(address);
+            *word = (*word & ~mask) | (shifted & mask);
+            if(linked && link == (address & ~3u)){
+                linked = false;
+            }
+            commit->store = true;
+            commit->address = address & ~3u;
+            commit->mask = mask;
+            commit->data = shifted & mask;
+        }
+    }
+    if(exmem->regWrite){
+        commit->reg = exmem->regDst ? exmem->regRd : exmem->regRt;
+        commit->value = exmem->memToReg ? data : exmem->ALUresult;
+        reg_write(commit->reg, &commit->value);
+        if(commit->reg == 0){
+            commit->value = 0;
+        }
+    }
+    //A branch or jump takes effect after its delay slot
+    pc_t after = (idex->jump || idex->PCSrc) ? idex->pcNext : pc_next + 4;
+    pc = pc_next;
+    pc_next = after;
+    return true;
+}
+
+void checker_commit(control_t *memwb){
+    checker_commit_t *commit = &pending;
+    memset(commit, 0, sizeof(checker_commit_t));
+    commit->pc = memwb->pc;
+    commit->instr = memwb->instr;
+    if(memwb->regWrite){
+        commit->reg = memwb->regDst ? memwb->regRd : memwb->regRt;
+        commit->value = commit->reg ? (memwb->memToReg ? memwb->memData : memwb->ALUresult) : 0;
+    }
+    //memData of an sc says whether it stored
+    if(memwb->memWrite && (memwb->opCode != OPC_SC || memwb->memData)){
+        uint32_t address = memwb->ALUresult;
+        word_t shifted = memwb->regRtValue;
+        if(memwb->opCode == OPC_SB){
+            shifted <<= (3-(address & 0x3))<<3;
+        } else if(memwb->opCode == OPC_SH){
+            shifted <<= (2-(address & 0x2))<<3;
+        }
+        commit->store = true;
+        commit->address = address & ~3u;
+        commit->mask = checker_mask(memwb->opCode, address);
+        commit->data = shifted & commit->mask;
+    }
+    have_pending = commit->reg != 0 || commit->store;
+}
+
+static void checker_print(const char *who, const checker_commit_t *commit){
+    printf("\t%-9s 0x%08x (0x%08x)", who, commit->pc, commit->instr);
+    if(commit->reg){
+        printf(" $%s = 0x%08x", get_register_name_string(commit->reg), commit->value);
+    }
+    if(commit->store){
+        printf(" [0x%08x] = 0x%08x (lanes 0x%08x)", commit->address, commit->data, commit->mask);
+    }
+    printf("\n");
+}
+
+bool checker_cycle(uint32_t cycle){
+    if(diverged){
+        return false;
+    }
+    pc_t stall_pc;
+    stall_cause_t cause = hazard_stall_cause(&stall_pc);
+    bool keep = have_pending && cause != STALL_I_MISS && cause != STALL_D_MISS;
+    have_pending = false;
+    if(!keep){
+        return true;
+    }
+    //Runs the reference up to its next instruction that writes something
+    checker_commit_t expected;
+    memset(&expected, 0, sizeof(checker_commit_t));
+    bool found = false;
+    int saved_flags = flags;
+    flags &= ~(MASK_DEBUG | MASK_VERBOSE | MASK_EVENTS);
+    reg_select(regs);
+    for(uint32_t i = 0; i < CHECKER_MAX_SILENT && !halted; i++){
+        if(!checker_step(&expected)){
+            halted = true;
+        } else if(expected.reg != 0 || expected.store){
+            found = true;
+            break;
+        }
+    }
+    reg_select(NULL);
+    flags = saved_flags;
+    commits++;
+    if(pending.store){
+        stores++;
+    }
+    if(found && memcmp(&expected, &pending, sizeof(checker_commit_t)) == 0){
+        return true;
+    }
+    diverged = true;
+    cprintf(ANSI_C_RED, "Checker: pipeline diverged from the reference in cycle %d, commit %d\n", cycle, commits);
+    checker_print("pipeline:", &pending);
+    if(found){
+        checker_print("expected:", &expected);
+    } else if(halted){
+        printf("\texpected: nothing, the reference halted at 0x%08x\n", pc);
+    } else {
+        printf("\texpected: nothing, the reference ran %d instructions without writing\n", CHECKER_MAX_SILENT);
+    }
+    return false;
+}
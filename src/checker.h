@@ -0,0 +1,55 @@
+/* src/checker.h
+* Lockstep checker. A functional reference model with its own register file
+* and copy of memory runs the program one instruction at a time, and every
+* instruction leaving the pipeline through writeback() is compared with the
+* next one the reference runs: its pc, the register it writes and the value,
+* and the word, byte lanes and data it stores. The first difference is
+* reported and stops the run.
+*
+* Instructions that write nothing ($zero and nops included) aren't compared.
+* An instruction is committed by the cycle it was written back in, a cycle
+* undone by a cache miss commits nothing.
+*/
+
+#ifndef _CHECKER_H
+#define _CHECKER_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <assert.h>
+#include "util.h"
+#include "types.h"
+
+//Instructions the reference may run in a row without writing anything
+#define CHECKER_MAX_SILENT (1<<20)
+
+//What an instruction left behind
+typedef struct CHECKER_COMMIT {
+    pc_t pc;
+    inst_t instr;
+    uint32_t reg;       //register written, 0 for none
+    word_t value;
+    bool store;
+    uint32_t address;   //word the store went to
+    word_t mask;        //byte lanes stored
+    word_t data;        //stored lanes, the others are 0
+} checker_commit_t;
+
+/* @brief Starts the reference at pc with a copy of the registers and of
+*  memory as they are now, before the first cycle
+*/
+void checker_init(pc_t pc);
+void checker_free(void);
+bool checker_enabled(void);
+
+/* @brief Notes what the instruction in memwb commits, called by writeback() */
+void checker_commit(control_t *memwb);
+
+/* @brief Compares what the cycle that just ended committed with the
+*  reference, after hazard()
+*  @returns false at the first divergence, after reporting it
+*/
+bool checker_cycle(uint32_t cycle);
+
+#endif /* _CHECKER_H */
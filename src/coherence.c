@@ -0,0 +1,423 @@
+/*
+* src/coherence.c
+* Snooping bus for the private data caches of several cores
+*/
+
+#include "coherence.h"
+#include "stats.h"
+
+extern int flags;
+
+static const char * const COHERENCE_STATE_STRINGS[] = {
+    [COH_INVALID]   = "I",
+    [COH_SHARED]    = "S",
+    [COH_EXCLUSIVE] = "E",
+    [COH_MODIFIED]  = "M"
+};
+
+static const char * const COHERENCE_REQUEST_STRINGS[] = {
+    [COH_BUS_READ]      = "BusRd",
+    [COH_BUS_READX]     = "BusRdX",
+    [COH_BUS_UPGRADE]   = "BusUpgr"
+};
+
+static coherence_core_t cores[COHERENCE_MAX_CORES];
+static uint32_t num_cores = 1;
+static _Thread_local uint32_t current = 0;
+static cache_coherence_t protocol = CACHE_MESI;
+static bool deferred = false;
+//Requests served by the coherence_settle() running, answered at its end
+static coherence_message_t settled[COHERENCE_MAX_CORES][COHERENCE_QUEUE];
+static uint32_t num_settled[COHERENCE_MAX_CORES];
+//Totals over all cores, for the statistics registry
+static uint32_t total_bus_reads = 0;
+static uint32_t total_bus_readx = 0;
+static uint32_t total_upgrades = 0;
+static uint32_t total_invalidations = 0;
+static uint32_t total_interventions = 0;
+static uint32_t total_retries = 0;
+static uint32_t total_sc_successes = 0;
+static uint32_t total_sc_failures = 0;
+
+void coherence_init(cache_coherence_t coherence, uint32_t count){
+    if(count < 1 || count > COHERENCE_MAX_CORES){
+        cprintf(ANSI_C_RED, "coherence_init: %d cores requested, must be 1 to %d\n", count, COHERENCE_MAX_CORES);
+        assert(0);
+    }
+    protocol = coherence;
+    num_cores = count;
+    current = 0;
+    deferred = false;
+    for(uint32_t i = 0; i < COHERENCE_MAX_CORES; i++){
+        memset(&cores[i], 0, sizeof(coherence_core_t));
+    }
+    total_bus_reads = 0;
+    total_bus_readx = 0;
+    total_upgrades = 0;
+    total_invalidations = 0;
+    total_interventions = 0;
+    total_retries = 0;
+    total_sc_successes = 0;
+    total_sc_failures = 0;
+    if(num_cores == 1){
+        return;
+    }
+    stats_register("coherence", "bus_reads", &total_bus_reads, "misses asking for a shared copy (BusRd)");
+    stats_register("coherence", "bus_readx", &total_bus_readx, "store misses asking for the only copy (BusRdX)");
+    stats_register("coherence", "upgrades", &total_upgrades, "stores to a shared copy (BusUpgr)");
+    stats_register("coherence", "invalidations", &total_invalidations, "copies invalidated by another core's store");
+    stats_register("coherence", "interventions", &total_interventions, "modified copies written back for another core");
+    stats_register("coherence", "retries", &total_retries, "requests refused while another core filled the block");
+    stats_register("coherence", "sc_successes", &total_sc_successes, "store conditionals that stored");
+    stats_register("coherence", "sc_failures", &total_sc_failures, "store conditionals that found their link broken");
+}
+
+void coherence_free(void){
+    stats_unregister("coherence");
+    for(uint32_t i = 0; i < COHERENCE_MAX_CORES; i++){
+        cores[i].cache = NULL;
+        spsc_free(cores[i].requests);
+        spsc_free(cores[i].replies);
+        cores[i].requests = NULL;
+        cores[i].replies = NULL;
+    }
+    deferred = false;
+}
+
+void coherence_attach(uint32_t core, direct_cache_t *cache){
+    if(core >= num_cores){
+        cprintf(ANSI_C_RED, "coherence_attach: core %d out of range\n", core);
+        assert(0);
+    }
+    cores[core].cache = cache;
+    cache->coherent = true;
+    cache->core = core;
+}
+
+void coherence_select(uint32_t core){
+    current = core;
+}
+
+void coherence_defer(void){
+    for(uint32_t i = 0; i < num_cores; i++){
+        if(cores[i].requests == NULL){
+            cores[i].requests = spsc_init(sizeof(coherence_message_t), COHERENCE_QUEUE);
+            cores[i].replies = spsc_init(sizeof(coherence_message_t), COHERENCE_QUEUE);
+        }
+        cores[i].posted = false;
+        cores[i].answered = false;
+    }
+    deferred = true;
+}
+
+/* Breaks the link of core if it is in the block at address of cache */
+static void coherence_unlink(uint32_t core, direct_cache_t *cache, uint32_t address){
+    uint32_t block_mask = cache->tag_mask | cache->index_mask;
+    if(cores[core].linked && (cores[core].link & block_mask) == (address & block_mask)){
+        cores[core].linked = false;
+        if(flags & MASK_DEBUG){
+            printf("\tcoherence_unlink: core %d lost its link to 0x%08x\n", core, cores[core].link);
+        }
+    }
+}
+
+/* Tells every other cache about a request for the block holding address.
+*  @returns false if one of them is still filling it and the request can't
+*  be ordered after that fill yet
+*/
+static bool coherence_snoop(direct_cache_t *cache, uint32_t address, bool exclusive, bool *shared){
+    coherence_core_t *self = &cores[cache->core];
+    *shared = false;
+    //Every copy in flight has to be settled before anything changes
+    for(uint32_t i = 0; i < num_cores; i++){
+        direct_cache_t *other = cores[i].cache;
+        if(i == cache->core || other == NULL){
+            continue;
+        }
+        mshr_t *mshr = direct_cache_find_mshr(other, address);
+        if(mshr != NULL && (exclusive || other->blocks[mshr->index].state == COH_MODIFIED)){
+            self->retries++;
+            total_retries++;
+            if(flags & MASK_DEBUG){
+                printf("\tcoherence_snoop: core %d is filling 0x%08x, core %d retries\n", i, address, cache->core);
+            }
+            return false;
+        }
+    }
+    for(uint32_t i = 0; i < num_cores; i++){
+        direct_cache_t *other = cores[i].cache;
+        if(i == cache->core || other == NULL){
+            continue;
+        }
+        mshr_t *mshr = direct_cache_find_mshr(other, address);
+        if(mshr != NULL){
+            //A shared or exclusive fill on its way, both end up shared
+            other->blocks[mshr->index].state = COH_SHARED;
+            *shared = true;
+            continue;
+        }
+        bool supplied;
+        coherence_state_t state = direct_cache_snoop(other, address, exclusive, &supplied);
+        if(state == COH_INVALID){
+            continue;
+        }
+        *shared = true;
+        if(supplied){
+            cores[i].interventions++;
+            total_interventions++;
+        }
+        if(exclusive){
+            cores[i].invalidations++;
+            total_invalidations++;
+            if(deferred){
+                //Its stores can't reach the other links any more, the block can
+                coherence_unlink(i, other, address);
+            }
+        }
+        if(flags & MASK_DEBUG){
+            printf("\tcoherence_snoop: core %d %s, block 0x%08x in core %d %s -> %s\n", cache->core,
+                exclusive ? "writes" : "reads", address, i, COHERENCE_STATE_STRINGS[state], exclusive ? "I" : "S");
+        }
+    }
+    return true;
+}
+
+/* Queues request for the block at address, or picks up its answer.
+*  @returns true once it was granted, with the state in *state
+*/
+static bool coherence_post(direct_cache_t *cache, uint32_t address, coherence_request_t request, coherence_state_t *state){
+    coherence_core_t *self = &cores[cache->core];
+    address &= cache->tag_mask | cache->index_mask;
+    bool same = self->posted && self->pending.address == address && self->pending.request == request;
+    if(same && self->answered){
+        *state = self->pending.state;
+        self->posted = false;
+        self->answered = false;
+        return true;
+    }
+    if(same){
+        //Still waiting on the answer
+        return false;
+    }
+    coherence_message_t message = {
+        .address = address,
+        .request = request,
+        .held = direct_cache_state(cache, address) != COH_INVALID,
+        .granted = false,
+        .state = COH_INVALID
+    };
+    if(!spsc_push(self->requests, &message)){
+        return false;
+    }
+    self->pending = message;
+    self->posted = true;
+    self->answered = false;
+    if(flags & MASK_DEBUG){
+        printf("\tcoherence_post: core %d queued %s for 0x%08x\n", cache->core, COHERENCE_REQUEST_STRINGS[request], address);
+    }
+    return false;
+}
+
+void coherence_receive(uint32_t core){
+    coherence_core_t *self = &cores[core];
+    coherence_message_t message;
+    while(spsc_pop(self->replies, &message)){
+        if(!self->posted || message.address != self->pending.address || message.request != self->pending.request){
+            //Answers a request the core gave up on
+            continue;
+        }
+        if(message.granted){
+            self->pending.state = message.state;
+            self->answered = true;
+        } else {
+            self->posted = false;
+        }
+    }
+}
+
+/* Checks message against what other cores were granted earlier in this
+*  settle, their caches don't show it yet. A second reader makes an
+*  exclusive grant shared.
+*  @returns false if it has to wait for them
+*/
+static bool coherence_settled_clear(uint32_t core, coherence_message_t *message, bool *shared){
+    bool exclusive = message->request != COH_BUS_READ;
+    *shared = false;
+    for(uint32_t i = 0; i < num_cores; i++){
+        for(uint32_t j = 0; i != core && j < num_settled[i]; j++){
+            coherence_message_t *granted = &settled[i][j];
+            if(!granted->granted || granted->address != message->address){
+                continue;
+            }
+            if(exclusive || granted->request != COH_BUS_READ){
+                return false;
+            }
+            granted->state = COH_SHARED;
+            *shared = true;
+        }
+    }
+    return true;
+}
+
+/* Snoops the other caches for one queued request of core */
+static void coherence_serve(uint32_t core, coherence_message_t *message){
+    direct_cache_t *cache = cores[core].cache;
+    bool exclusive = message->request != COH_BUS_READ;
+    bool shared, settled_shared;
+    message->granted = false;
+    if((message->request == COH_BUS_UPGRADE && message->held && direct_cache_state(cache, message->address) == COH_INVALID) ||
+        !coherence_settled_clear(core, message, &settled_shared)){
+        //Lost the copy to an earlier request (the store has to miss now), or
+        //another core got the block this settle
+        cores[core].retries++;
+        total_retries++;
+        return;
+    }
+    if(!coherence_snoop(cache, message->address, exclusive, &shared)){
+        return;
+    }
+    shared |= settled_shared;
+    message->granted = true;
+    switch(message->request){
+        case COH_BUS_READ:
+            cores[core].bus_reads++;
+            total_bus_reads++;
+            message->state = (protocol == CACHE_MESI && !shared) ? COH_EXCLUSIVE : COH_SHARED;
+            break;
+        case COH_BUS_READX:
+            cores[core].bus_readx++;
+            total_bus_readx++;
+            message->state = COH_MODIFIED;
+            break;
+        default:
+            cores[core].upgrades++;
+            total_upgrades++;
+            message->state = COH_MODIFIED;
+            break;
+    }
+}
+
+void coherence_settle(uint32_t first){
+    for(uint32_t i = 0; i < num_cores; i++){
+        if(cores[i].answered){
+            cores[i].posted = false;
+            cores[i].answered = false;
+        }
+    }
+    for(uint32_t i = 0; i < num_cores; i++){
+        num_settled[i] = 0;
+    }
+    for(uint32_t n = 0; n < num_cores; n++){
+        uint32_t core = (first + n) % num_cores;
+        if(cores[core].requests == NULL){
+            continue;
+        }
+        while(num_settled[core] < COHERENCE_QUEUE && spsc_pop(cores[core].requests, &settled[core][num_settled[core]])){
+            coherence_serve(core, &settled[core][num_settled[core]]);
+            num_settled[core]++;
+        }
+    }
+    //A grant may still turn shared until everyone was served
+    for(uint32_t core = 0; core < num_cores; core++){
+        for(uint32_t j = 0; j < num_settled[core]; j++){
+            coherence_message_t *message = &settled[core][j];
+            if(flags & MASK_DEBUG){
+                printf("\tcoherence_settle: core %d %s 0x%08x %s\n", core, COHERENCE_REQUEST_STRINGS[message->request],
+                    message->address, message->granted ? COHERENCE_STATE_STRINGS[message->state] : "retries");
+            }
+            if(!spsc_push(cores[core].replies, message)){
+                cprintf(ANSI_C_RED, "coherence_settle: core %d has too many answers waiting\n", core);
+                assert(0);
+            }
+        }
+    }
+}
+
+void coherence_evicted(direct_cache_t *cache, uint32_t address){
+    if(deferred){
+        coherence_unlink(cache->core, cache, address);
+    }
+}
+
+bool coherence_request(direct_cache_t *cache, uint32_t address, bool exclusive, coherence_state_t *state){
+    bool shared;
+    if(deferred){
+        return coherence_post(cache, address, exclusive ? COH_BUS_READX : COH_BUS_READ, state);
+    }
+    if(!coherence_snoop(cache, address, exclusive, &shared)){
+        return false;
+    }
+    if(exclusive){
+        cores[cache->core].bus_readx++;
+        total_bus_readx++;
+        *state = COH_MODIFIED;
+    } else {
+        cores[cache->core].bus_reads++;
+        total_bus_reads++;
+        *state = (protocol == CACHE_MESI && !shared) ? COH_EXCLUSIVE : COH_SHARED;
+    }
+    return true;
+}
+
+bool coherence_upgrade(direct_cache_t *cache, uint32_t address){
+    bool shared;
+    if(deferred){
+        coherence_state_t state;
+        return coherence_post(cache, address, COH_BUS_UPGRADE, &state);
+    }
+    if(!coherence_snoop(cache, address, true, &shared)){
+        return false;
+    }
+    cores[cache->core].upgrades++;
+    total_upgrades++;
+    return true;
+}
+
+void coherence_link(uint32_t address){
+    cores[current].linked = true;
+    cores[current].link = address & ~3u;
+}
+
+bool coherence_linked(uint32_t address){
+    if(cores[current].linked && cores[current].link == (address & ~3u)){
+        return true;
+    }
+    cores[current].sc_failures++;
+    //Cores on other host threads count too
+    __atomic_fetch_add(&total_sc_failures, 1, __ATOMIC_RELAXED);
+    return false;
+}
+
+void coherence_stored(uint32_t address, bool conditional){
+    if(deferred){
+        //The other links are broken when their copies get invalidated
+        if(cores[current].link == (address & ~3u)){
+            cores[current].linked = false;
+        }
+    } else {
+        //Every link, cores can run without caches and never call coherence_init()
+        for(uint32_t i = 0; i < COHERENCE_MAX_CORES; i++){
+            if(cores[i].linked && cores[i].link == (address & ~3u)){
+                cores[i].linked = false;
+            }
+        }
+    }
+    if(conditional){
+        cores[current].sc_successes++;
+        __atomic_fetch_add(&total_sc_successes, 1, __ATOMIC_RELAXED);
+    }
+}
+
+void coherence_report(void){
+    if(num_cores == 1){
+        return;
+    }
+    printf("Coherence (%s, %d cores):\n", protocol == CACHE_MESI ? "MESI" : "MSI", num_cores);
+    printf("\tcore  bus_reads  bus_readx   upgrades  invalidated  interventions  retries  sc_ok  sc_fail\n");
+    for(uint32_t i = 0; i < num_cores; i++){
+        coherence_core_t *c = &cores[i];
+        printf("\t%4d %10d %10d %10d %12d %14d %8d %6d %8d\n", i, c->bus_reads, c->bus_readx, c->upgrades,
+            c->invalidations, c->interventions, c->retries, c->sc_successes, c->sc_failures);
+    }
+    printf("\tTotal bus transactions: %d\n", total_bus_reads + total_bus_readx + total_upgrades);
+}
@@ -0,0 +1,127 @@
+/*
+* src/coherence.h
+* Snooping bus that keeps the private data caches of several cores coherent
+* with MSI or MESI, and the load linked/store conditional links of each core
+*/
+
+#ifndef _COHERENCE_H
+#define _COHERENCE_H
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "util.h"
+#include "types.h"
+#include "direct.h"
+#include "spsc.h"
+
+//Most cores that can share the bus
+#define COHERENCE_MAX_CORES 16
+//Requests a core can have queued for coherence_settle()
+#define COHERENCE_QUEUE 64
+
+typedef enum COHERENCE_REQUEST {
+    COH_BUS_READ,
+    COH_BUS_READX,
+    COH_BUS_UPGRADE
+} coherence_request_t;
+
+/* A request queued by a core and the answer it gets back */
+typedef struct COHERENCE_MESSAGE {
+    uint32_t address;           //block address
+    coherence_request_t request;
+    bool held;                  //the block was valid in the requester when it asked
+    bool granted;               //answer: false to retry
+    coherence_state_t state;    //answer: state the block comes in with
+} coherence_message_t;
+
+typedef struct COHERENCE_CORE {
+    direct_cache_t *cache;      //private data cache, NULL if caching is disabled
+    bool linked;                //an ll was done and nothing has written its word since
+    uint32_t link;              //word address of the ll
+    //Deferred requests, see coherence_defer()
+    spsc_t *requests;           //core to coherence_settle()
+    spsc_t *replies;            //coherence_settle() to core
+    coherence_message_t pending;//the request the core waits on
+    bool posted;                //pending is queued or answered
+    bool answered;              //pending got granted, not used yet
+    //Counters
+    uint32_t bus_reads;         //misses asking for a shared copy (BusRd)
+    uint32_t bus_readx;         //store misses asking for the only copy (BusRdX)
+    uint32_t upgrades;          //stores to a shared copy invalidating the others (BusUpgr)
+    uint32_t invalidations;     //copies this core lost to another core's store
+    uint32_t interventions;     //modified copies this core wrote back for another core
+    uint32_t retries;           //requests refused while another core was filling the block
+    uint32_t sc_successes;
+    uint32_t sc_failures;
+} coherence_core_t;
+
+/* @brief Resets the links and counters of cores cores kept coherent with
+*  protocol. Registers the "coherence" statistics if there is more than one.
+*/
+void coherence_init(cache_coherence_t protocol, uint32_t cores);
+void coherence_free(void);
+
+/* @brief Puts the data cache of core on the bus */
+void coherence_attach(uint32_t core, direct_cache_t *cache);
+
+/* @brief Makes core the one issuing ll, sc and stores, for the calling
+*  host thread
+*/
+void coherence_select(uint32_t core);
+
+/* @brief From now on requests and upgrades are queued instead of snooping
+*  the other caches right away, and answered by coherence_settle(). Until
+*  then a core touches nothing but its own caches and links, so the cores
+*  can run on separate host threads. A retried access finds its answer.
+*/
+void coherence_defer(void);
+
+/* @brief Takes in the answers coherence_settle() left for core, from the
+*  host thread running it
+*/
+void coherence_receive(uint32_t core);
+
+/* @brief Serves the queued requests of every core, starting with first, in
+*  the order they were made. Called while no core runs. Answers nobody used
+*  since the last call are dropped, they may be stale now.
+*/
+void coherence_settle(uint32_t first);
+
+/* @brief The block at address is leaving cache. Once requests are deferred
+*  nobody would tell the core about stores to it any more, so its link goes.
+*/
+void coherence_evicted(direct_cache_t *cache, uint32_t address);
+
+/* @brief Called by cache when it claims a block for a miss. Other copies are
+*  written back if modified, then invalidated for a store (exclusive) or
+*  downgraded to shared for a load.
+*  @returns false if another core is still filling the block and the miss
+*  has to be retried, otherwise *state is the state the block comes in with
+*/
+bool coherence_request(direct_cache_t *cache, uint32_t address, bool exclusive, coherence_state_t *state);
+
+/* @brief Called by cache before writing a block it doesn't own (shared, or
+*  not allocated by a write through store). Invalidates every other copy.
+*  @returns false if the store has to be retried
+*/
+bool coherence_upgrade(direct_cache_t *cache, uint32_t address);
+
+/* @brief ll by the selected core */
+void coherence_link(uint32_t address);
+
+/* @brief Returns true if the selected core's link to address still holds,
+*  an sc that finds it broken is counted as failed
+*/
+bool coherence_linked(uint32_t address);
+
+/* @brief A store by the selected core went through, breaks every link to
+*  its word. conditional is set for a successful sc.
+*/
+void coherence_stored(uint32_t address, bool conditional);
+
+/* @brief Prints the bus traffic caused by each core */
+void coherence_report(void);
+
+#endif /* _COHERENCE_H */
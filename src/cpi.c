@@ -0,0 +1,162 @@
+/* src/cpi.c
+* CPI stack cycle accounting
+*/
+
+#include "cpi.h"
+#include "hazard.h"
+#include "cache.h"
+#include "stats.h"
+
+extern int flags;
+
+static const char * const CPI_BUCKET_STRINGS[] = {
+    [CPI_BASE]      = "base",
+    [CPI_LOAD_USE]  = "load_use",
+    [CPI_CONTROL]   = "control",
+    [CPI_I_MISS]    = "i_miss",
+    [CPI_D_MISS]    = "d_miss",
+    [CPI_WB_FULL]   = "wb_full",
+    [CPI_BUS]       = "bus"
+};
+
+static const char * const CPI_BUCKET_DESC[] = {
+    [CPI_BASE]      = "cycles an instruction entered the pipeline",
+    [CPI_LOAD_USE]  = "load-use bubbles",
+    [CPI_CONTROL]   = "cycles lost to fetch redirects",
+    [CPI_I_MISS]    = "cycles filling the instruction cache",
+    [CPI_D_MISS]    = "cycles filling the data cache",
+    [CPI_WB_FULL]   = "cycles turned away by a busy write buffer",
+    [CPI_BUS]       = "miss cycles waiting on the bus"
+};
+
+static cpi_stack_t stack;
+static cpi_stack_t interval_start;  //stack at the start of the current interval
+static uint32_t interval_cycles = 0;
+static uint32_t total_cycles = 0;
+static uint32_t last_full_stalls = 0;
+
+void cpi_init(uint32_t interval){
+    for(int i = 0; i < CPI_BUCKETS; i++){
+        stack.cycles[i] = 0;
+        stats_register("cpi", CPI_BUCKET_STRINGS[i], &stack.cycles[i], CPI_BUCKET_DESC[i]);
+    }
+    interval_start = stack;
+    interval_cycles = interval;
+    total_cycles = 0;
+    last_full_stalls = write_buffer_full_stalls();
+}
+
+void cpi_free(void){
+    stats_unregister("cpi");
+}
+
+// Prints the CPI of each bucket between two snapshots of the stack
+static void cpi_print(const cpi_stack_t *from, const cpi_stack_t *to){
+    uint32_t cycles = 0;
+    uint32_t instructions = to->cycles[CPI_BASE] - from->cycles[CPI_BASE];
+    for(int i = 0; i < CPI_BUCKETS; i++){
+        cycles += to->cycles[i] - from->cycles[i];
+    }
+    if(instructions == 0){
+        printf(" no instructions in %d cycles\n", cycles);
+        return;
+    }
+    printf(" cpi %.3f =", (double)cycles / instructions);
+    for(int i = 0; i < CPI_BUCKETS; i++){
+        printf(" %s%s %.3f", i ? "+ " : "", CPI_BUCKET_STRINGS[i],
+            (double)(to->cycles[i] - from->cycles[i]) / instructions);
+    }
+    printf("\n");
+}
+
+cpi_bucket_t cpi_classify(stall_cause_t cause, bool full){
+    cpi_bucket_t bucket;
+    memory_status_t bus = get_mem_status();
+    switch(cause){
+        case STALL_LOAD_USE:
+            bucket = CPI_LOAD_USE;
+            break;
+        case STALL_CONTROL:
+            bucket = CPI_CONTROL;
+            break;
+        case STALL_I_MISS:
+            bucket = (bus == MEM_WRITING || bus == MEM_READING_D) ? CPI_BUS : CPI_I_MISS;
+            break;
+        case STALL_D_MISS:
+            if(full){
+                bucket = CPI_WB_FULL;
+            } else if(bus == MEM_WRITING || bus == MEM_READING_I){
+                bucket = CPI_BUS;
+            } else {
+                bucket = CPI_D_MISS;
+            }
+            break;
+        default:
+            bucket = CPI_BASE;
+            break;
+    }
+    return bucket;
+}
+
+cpi_bucket_t cpi_charge(stall_cause_t cause, cpi_stack_t *core){
+    cpi_bucket_t bucket = cpi_classify(cause, write_buffer_full_stalls() != last_full_stalls);
+    stack.cycles[bucket]++;
+    if(core != NULL){
+        core->cycles[bucket]++;
+    }
+    return bucket;
+}
+
+void cpi_merge(const cpi_stack_t *from, const cpi_stack_t *to){
+    for(int i = 0; i < CPI_BUCKETS; i++){
+        stack.cycles[i] += to->cycles[i] - from->cycles[i];
+    }
+}
+
+void cpi_tick(void){
+    last_full_stalls = write_buffer_full_stalls();
+    total_cycles++;
+    if(interval_cycles && total_cycles % interval_cycles == 0){
+        printf("CPI interval %d-%d:", total_cycles - interval_cycles, total_cycles);
+        cpi_print(&interval_start, &stack);
+        interval_start = stack;
+    }
+}
+
+cpi_bucket_t cpi_cycle(void){
+    pc_t pc;
+    cpi_bucket_t bucket = cpi_charge(hazard_stall_cause(&pc), NULL);
+    cpi_tick();
+    return bucket;
+}
+
+const cpi_stack_t *cpi_get(void){
+    return &stack;
+}
+
+void cpi_print_stack(const cpi_stack_t *core){
+    cpi_stack_t zero = {{0}};
+    cpi_print(&zero, core);
+}
+
+void cpi_report(void){
+    cpi_stack_t zero = {{0}};
+    uint32_t charged = 0;
+    for(int i = 0; i < CPI_BUCKETS; i++){
+        charged += stack.cycles[i];
+    }
+    if(charged != total_cycles){
+        printf("CPI stack (%d cycles, %d core cycles, %d instructions):\n", total_cycles, charged, stack.cycles[CPI_BASE]);
+    } else {
+        printf("CPI stack (%d cycles, %d instructions):\n", total_cycles, stack.cycles[CPI_BASE]);
+    }
+    for(int i = 0; i < CPI_BUCKETS; i++){
+        printf("\t%-10s %10d cycles", CPI_BUCKET_STRINGS[i], stack.cycles[i]);
+        if(stack.cycles[CPI_BASE]){
+            printf("  %.3f", (double)stack.cycles[i] / stack.cycles[CPI_BASE]);
+        }
+        printf("\n");
+    }
+    printf("\tTotal:");
+    cpi_print(&zero, &stack);
+}
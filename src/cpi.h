@@ -0,0 +1,74 @@
+/* src/cpi.h
+* CPI stack: every cycle is put in exactly one bucket by what held the
+* pipeline up, so the buckets add up to the total cycle count
+*/
+
+#ifndef _CPI_H
+#define _CPI_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "util.h"
+#include "types.h"
+#include "hazard.h"
+
+typedef enum CPI_BUCKET {
+    CPI_BASE,           //an instruction entered the pipeline
+    CPI_LOAD_USE,       //bubble behind a load whose result is needed right away
+    CPI_CONTROL,        //fetch redirected, wrong path instructions flushed
+    CPI_I_MISS,         //instruction cache miss being filled
+    CPI_D_MISS,         //data cache miss being filled (or swapped in)
+    CPI_WB_FULL,        //store or replacement turned away by a busy write buffer
+    CPI_BUS,            //miss waiting while the bus serves someone else
+    CPI_BUCKETS
+} cpi_bucket_t;
+
+typedef struct CPI_STACK {
+    uint32_t cycles[CPI_BUCKETS];
+} cpi_stack_t;
+
+/* @brief Clears the stack and registers its buckets with the statistics
+*  registry. interval is the number of cycles between interval reports,
+*  0 for none.
+*/
+void cpi_init(uint32_t interval);
+void cpi_free(void);
+
+/* @brief Puts the cycle that just ended in its bucket. Called once a cycle
+*  after hazard() and cache_digest()
+*  @returns the bucket used
+*/
+cpi_bucket_t cpi_cycle(void);
+
+/* @brief Puts one core's part of the cycle in the bucket for cause, in the
+*  stack of the whole run and in core if it isn't NULL. With several cores
+*  the stack counts core cycles.
+*  @returns the bucket used
+*/
+cpi_bucket_t cpi_charge(stall_cause_t cause, cpi_stack_t *core);
+
+/* @brief Returns the bucket for a cycle that stalled on cause, judged by
+*  the bus selected by this host thread. full tells that the write buffer
+*  turned a request away in the cycle. Charges nothing.
+*/
+cpi_bucket_t cpi_classify(stall_cause_t cause, bool full);
+
+/* @brief Adds what a core charged on its own between two snapshots of its
+*  stack to the stack of the whole run
+*/
+void cpi_merge(const cpi_stack_t *from, const cpi_stack_t *to);
+
+/* @brief Ends a cycle charged with cpi_charge() */
+void cpi_tick(void);
+
+/* @brief Prints the CPI of each bucket of stack on one line */
+void cpi_print_stack(const cpi_stack_t *stack);
+
+/* @brief Returns the stack so far */
+const cpi_stack_t *cpi_get(void);
+
+/* @brief Prints the CPI stack of the whole run */
+void cpi_report(void);
+
+#endif /* _CPI_H */
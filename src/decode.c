@@ -3,6 +3,7 @@
  */
 
 #include "decode.h"
+#include "eventlog.h"
 
 extern int flags; // from main.c or memory-test.c
 
@@ -80,6 +81,7 @@ int decode( control_t * ifid , control_t * idex) {
         case OPC_LB:
         case OPC_LHU:
         case OPC_LBU:
+        case OPC_LL:
             idex->ALUop = OPR_ADDU;
             setidexLoad(idex);
             break;
@@ -89,6 +91,14 @@ int decode( control_t * ifid , control_t * idex) {
             idex->ALUop = OPR_ADDU;
             setidexStore(idex);
             break;
+        case OPC_SC:
+            //A store that also writes 1 (stored) or 0 (link broken) to rt
+            idex->ALUop = OPR_ADDU;
+            setidexStore(idex);
+            idex->regDst = false;
+            idex->regWrite = true;
+            idex->memToReg = true;
+            break;
         case OPC_BEQ:
         case OPC_BNE:
         case OPC_BLTZ:
@@ -283,10 +293,12 @@ int decode( control_t * ifid , control_t * idex) {
     }
 
 
-    if(flags & MASK_DEBUG){
-        cprintf(ANSI_C_CYAN, "DECODE: \n");
-        print_pipeline_register(idex);
-    }
+    //The whole of ID/EX, a byte of each small field
+    EVENT(EV_DECODE, idex->instr, idex->opCode | idex->regRs << 8 | idex->regRt << 16 | (word_t)idex->regRd << 24,
+        idex->shamt | idex->funct << 8, idex->immed, idex->address, idex->pcNext, idex->regRtValue, idex->regRsValue);
+    EVENT(EV_DECODE_CONTROL, idex->ALUresult,
+        idex->regDst | idex->ALUSrc << 8 | idex->memToReg << 16 | (word_t)idex->regWrite << 24,
+        idex->memRead | idex->memWrite << 8 | idex->PCSrc << 16 | (word_t)idex->jump << 24);
 
     return 0;
 
@@ -0,0 +1,254 @@
+/* src/decoupled.c
+* Functional front-end thread feeding a timing-only pipeline replay
+*/
+
+#include <pthread.h>
+#include <sched.h>
+#include "decoupled.h"
+#include "fetch.h"
+#include "decode.h"
+#include "alu.h"
+#include "memory.h"
+#include "write.h"
+#include "eventlog.h"
+#include "branch.h"
+#include "main_memory.h"
+#include "stats.h"
+
+extern int flags;
+
+static spsc_t *queue = NULL;
+static pthread_t front;
+static pc_t front_start = 0;
+static atomic_bool stopping = false;
+static bool running = false;
+//Next record for the replay to fetch, popped but not fetched for good yet
+static decoupled_record_t next;
+static bool have_next = false;
+static bool ended = false;
+//Statistics, the front-end's are only read once it stopped
+static uint32_t instructions = 0;   //records the front-end produced
+static uint32_t full = 0;           //times the front-end found the queue full
+static uint32_t waits = 0;          //times the replay found the queue empty
+static uint32_t wrong_path = 0;     //fetches that weren't the next record
+
+//The front-end goes straight to memory
+static cache_config_t front_cfg = {
+    .mode           = CACHE_DISABLE,
+    .data_enabled   = false,
+    .inst_enabled   = false,
+};
+
+static bool decoupled_push(const decoupled_record_t *record){
+    while(!spsc_push(queue, record)){
+        if(atomic_load_explicit(&stopping, memory_order_relaxed)){
+            return false;
+        }
+        full++;
+        sched_yield();
+    }
+    return true;
+}
+
+/* Runs the program an instruction at a time through the stages of the
+*  pipeline, each finishing before the next starts, so nothing is forwarded
+*  or stalled. A branch takes effect after its delay slot.
+*/
+static void *decoupled_front(void *arg){
+    (void)arg;
+    control_t *ifid, *idex, *exmem, *memwb;
+    pc_t pc;
+    pipeline_init(&ifid, &idex, &exmem, &memwb, &pc, front_start);
+    pc_t pc_next = pc + 4;
+    decoupled_record_t record;
+    while(!atomic_load_explicit(&stopping, memory_order_relaxed)){
+        mem_read_w(pc, &ifid->instr);
+        fetch_fields(ifid);
+        ifid->pc = pc;
+        ifid->pcNext = pc + 4;
+        memset(&record, 0, sizeof(decoupled_record_t));
+        record.pc = pc;
+        record.instr = ifid->instr;
+        record.target = pc + 4;
+        //The pipeline stops once it fetches one of the magic halt numbers
+        if(ifid->instr == 0x1000ffff || ifid->instr == 0x00000008){
+            decoupled_push(&record);
+            break;
+        }
+        decode(ifid, idex);
+        execute(idex, exmem);
+        memory(exmem, memwb, &front_cfg);
+        writeback(memwb);
+        record.target = idex->pcNext;
+        record.address = exmem->ALUresult;
+        record.kind = (idex->jump ? DECOUPLED_JUMP : 0) | (idex->PCSrc ? DECOUPLED_TAKEN : 0) |
+            (idex->memRead ? DECOUPLED_READ : 0) | (idex->memWrite ? DECOUPLED_WRITE : 0);
+        if(idex->opCode == OPC_SC && memwb->memData){
+            record.kind |= DECOUPLED_STORED;
+        }
+        if(!decoupled_push(&record)){
+            break;
+        }
+        instructions++;
+        pc_t after = (idex->jump || idex->PCSrc) ? idex->pcNext : pc_next + 4;
+        pc = pc_next;
+        pc_next = after;
+        if(pc_next == 0){
+            //Halts with the delay slot fetched but not done
+            break;
+        }
+    }
+    memset(&record, 0, sizeof(decoupled_record_t));
+    record.kind = DECOUPLED_END;
+    decoupled_push(&record);
+    pipeline_destroy(&ifid, &idex, &exmem, &memwb);
+    return NULL;
+}
+
+void decoupled_init(pc_t pc){
+    queue = spsc_init(sizeof(decoupled_record_t), DECOUPLED_QUEUE);
+    front_start = pc;
+    atomic_store(&stopping, false);
+    have_next = false;
+    ended = false;
+    instructions = 0;
+    full = 0;
+    waits = 0;
+    wrong_path = 0;
+    if(pthread_create(&front, NULL, decoupled_front, NULL) != 0){
+        cprintf(ANSI_C_RED, "decoupled_init: unable to start the front-end thread\n");
+        assert(0);
+    }
+    running = true;
+    stats_register("decoupled", "instructions", &instructions, "instructions run by the front-end");
+    stats_register("decoupled", "full", &full, "times the front-end waited on a full queue");
+    stats_register("decoupled", "waits", &waits, "times the replay waited on an empty queue");
+    stats_register("decoupled", "wrong_path", &wrong_path, "fetches off the path the front-end took");
+    if(flags & MASK_DEBUG){
+        printf("decoupled_init: front-end starting at 0x%08x, %d records queued at most\n", pc, DECOUPLED_QUEUE);
+    }
+}
+
+void decoupled_stop(void){
+    if(!running){
+        return;
+    }
+    atomic_store(&stopping, true);
+    pthread_join(front, NULL);
+    running = false;
+    if(flags & MASK_VERBOSE){
+        printf("Front-end ran %d instructions, waited %d times on a full queue, the replay %d times on an empty one\n",
+            instructions, full, waits);
+    }
+}
+
+void decoupled_free(void){
+    if(queue == NULL){
+        return;
+    }
+    decoupled_stop();
+    stats_unregister("decoupled");
+    spsc_free(queue);
+    queue = NULL;
+}
+
+/* Returns the next record, NULL once there are no more */
+static decoupled_record_t *decoupled_peek(void){
+    if(!have_next && !ended){
+        while(!spsc_pop(queue, &next)){
+            waits++;
+            sched_yield();
+        }
+        if(next.kind & DECOUPLED_END){
+            ended = true;
+        } else {
+            have_next = true;
+        }
+    }
+    return have_next ? &next : NULL;
+}
+
+/* Memory stage with the access the front-end already did, only the cache
+*  sees it. Sets memwb->status the way memory() does.
+*/
+static void decoupled_memory(control_t *exmem, control_t *memwb, cache_config_t *cache_cfg){
+    copy_pipeline_register(exmem, memwb);
+    if(exmem->memDone){
+        return;
+    }
+    word_t temp = 0;
+    cache_status_t status = CACHE_NO_ACCESS;
+    if(exmem->memRead){
+        if(cache_cfg->data_enabled){
+            status = d_cache_read_w(&exmem->ALUresult, &temp, exmem->pc);
+        }
+        memwb->status = status;
+    }
+    if(exmem->memWrite){
+        word_t mask = 0xffffffff;
+        if(exmem->opCode == OPC_SB){
+            mask = 0xff << ((3-(exmem->ALUresult & 0x3))<<3);
+        } else if(exmem->opCode == OPC_SH){
+            mask = 0xffff << ((2-(exmem->ALUresult & 0x2))<<3);
+        }
+        //memData of an sc says whether it stored
+        if(cache_cfg->data_enabled && (exmem->opCode != OPC_SC || exmem->memData)){
+            status = d_cache_write_w(&exmem->ALUresult, &temp, mask, exmem->pc);
+        }
+        memwb->status = status;
+    }
+}
+
+/* Fetches the next record if it is at pc, otherwise the wrong path
+*  instruction there. Everything decode and execute would work out about a
+*  record is filled in already, decode and execute only pass it along.
+*  @returns true if ifid got the next record
+*/
+static bool decoupled_fetch(control_t *ifid, pc_t *pc, cache_config_t *cache_cfg){
+    decoupled_record_t *record = decoupled_peek();
+    if(cache_cfg->inst_enabled){
+        word_t unused;
+        ifid->status = i_cache_read_w(pc, &unused);
+    }
+    bool on_path = record != NULL && record->pc == *pc;
+    if(on_path){
+        ifid->instr = record->instr;
+    } else {
+        mem_read_w(*pc, &ifid->instr);
+        wrong_path++;
+    }
+    fetch_fields(ifid);
+    ifid->pc = *pc;
+    ifid->pcNext = *pc + 4;
+    if(bpu_enabled()){
+        bpu_predict(ifid);
+    }
+    ifid->jump = on_path && (record->kind & DECOUPLED_JUMP);
+    ifid->PCSrc = on_path && (record->kind & DECOUPLED_TAKEN);
+    ifid->memRead = on_path && (record->kind & DECOUPLED_READ);
+    ifid->memWrite = on_path && (record->kind & DECOUPLED_WRITE);
+    //Nothing writes a register, so hazard() never forwards or rechecks a branch
+    ifid->regWrite = false;
+    if(on_path){
+        ifid->pcNext = record->target;
+        ifid->ALUresult = record->address;
+        ifid->memData = (record->kind & DECOUPLED_STORED) != 0;
+    }
+    EVENT(EV_FETCH_REPLAY, on_path, ifid->instr, *pc);
+    return on_path;
+}
+
+void decoupled_cycle(control_t *ifid, control_t *idex, control_t *exmem, control_t *memwb, pc_t *pc, cache_config_t *cache_cfg){
+    backup(ifid, idex, exmem, memwb, pc);
+    decoupled_memory(exmem, memwb, cache_cfg);
+    copy_pipeline_register(idex, exmem);
+    exmem->memDone = false;
+    copy_pipeline_register(ifid, idex);
+    bool on_path = decoupled_fetch(ifid, pc, cache_cfg);
+    hazard(ifid, idex, exmem, memwb, pc, cache_cfg);
+    //The record stays next if it was stalled, flushed or restored
+    pc_t stall_pc;
+    if(on_path && hazard_stall_cause(&stall_pc) == STALL_NONE){
+        have_next = false;
+    }
+}
@@ -0,0 +1,68 @@
+/* src/decoupled.h
+* Functional-first simulation on two host threads. A front-end thread runs
+* the program one whole instruction at a time (no timing at all) and
+* streams a record of each one through an SPSC queue (see spsc.h). The
+* caller's thread replays the records through the five-stage pipeline for
+* timing only: backup(), hazard() and the caches are the ones the pipeline
+* uses, but no register or memory value is computed again.
+*
+* Everything the replay needs to know about an instruction is in its record,
+* where a branch or jump went, the address of a load or store and whether an
+* sc stored. Fetches that aren't the next record (the instruction after a
+* mispredicted delay slot, or after the last record) are wrong path and are
+* read from memory as fetch() would, cache and predictor included, so the
+* cycle count is the one of the integrated pipeline.
+*
+* The front-end owns main memory and the register file, the caches only keep
+* tags and timing (cache_config_t timing_only). The front-end finishes every
+* instruction before the halt, the pipeline leaves the last few in flight.
+*/
+
+#ifndef _DECOUPLED_H
+#define _DECOUPLED_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <assert.h>
+#include "util.h"
+#include "types.h"
+#include "cache.h"
+#include "hazard.h"
+#include "spsc.h"
+
+//Records the front-end can run ahead of the replay
+#define DECOUPLED_QUEUE 4096
+
+//What the front-end found out about an instruction
+#define DECOUPLED_JUMP      (1<<0)  //j, jal or jr
+#define DECOUPLED_TAKEN     (1<<1)  //branch taken
+#define DECOUPLED_READ      (1<<2)  //load
+#define DECOUPLED_WRITE     (1<<3)  //store
+#define DECOUPLED_STORED    (1<<4)  //sc found its link and stored
+#define DECOUPLED_END       (1<<5)  //no more records, not an instruction
+
+typedef struct DECOUPLED_RECORD {
+    pc_t pc;
+    inst_t instr;
+    pc_t target;        //pcNext after decode, where a taken branch or jump goes
+    uint32_t address;   //effective address of a load or store
+    uint32_t kind;      //DECOUPLED_* bits
+} decoupled_record_t;
+
+/* @brief Starts the front-end thread running the loaded program from pc */
+void decoupled_init(pc_t pc);
+
+/* @brief Stops the front-end thread (it already finished if the replay got
+*  to the halt) and waits for it, call before looking at registers or memory
+*/
+void decoupled_stop(void);
+void decoupled_free(void);
+
+/* @brief Replays one clock cycle of the pipeline, in place of the stages and
+*  hazard() of the integrated pipeline. Waits for the front-end when it
+*  needs a record that isn't there yet.
+*/
+void decoupled_cycle(control_t *ifid, control_t *idex, control_t *exmem, control_t *memwb, pc_t *pc, cache_config_t *cache_cfg);
+
+#endif /* _DECOUPLED_H */
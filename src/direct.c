@@ -4,11 +4,17 @@
 */
 
 #include "direct.h"
+#include "prefetch.h"
+#include "stats.h"
+#include "coherence.h"
+#include "eventlog.h"
 
 
 extern int flags;
 
-direct_cache_t * direct_cache_init(uint32_t num_blocks, uint32_t block_size){
+static cache_status_t direct_cache_victim_swap(direct_cache_t *cache, cache_access_t *info);
+
+direct_cache_t * direct_cache_init(uint32_t num_blocks, uint32_t block_size, uint32_t num_mshrs){
     //The linear memory that the cache blocks point to
     word_t *words = (word_t *)malloc(sizeof(word_t)*num_blocks*block_size);
     //The cache struct itself
@@ -24,6 +30,10 @@ direct_cache_t * direct_cache_init(uint32_t num_blocks, uint32_t block_size){
     for(i = 0; i < num_blocks; i++){
         blocks[i].data = words + i * block_size;
         blocks[i].valid = valids + i * block_size;
+        blocks[i].dirty = false;
+        blocks[i].prefetched = false;
+        blocks[i].state = COH_INVALID;
+        blocks[i].tag = 0;
     }
 
     cache->blocks = blocks;
@@ -62,10 +72,61 @@ direct_cache_t * direct_cache_init(uint32_t num_blocks, uint32_t block_size){
         printf("inner_index_mask: 0x%08x, inner_index_size: %d\n", cache->inner_index_mask, cache->inner_index_size);
     }
 
-    //Set up the fetch variables
+    cache->write_policy = WRITEBACK;
+
+    //Set up the miss status holding registers
+    if(num_mshrs == 0 || num_mshrs > CACHE_MSHR_MAX){
+        cprintf(ANSI_C_RED, "cache_init: %d MSHRs requested, must be between 1 and %d\n", num_mshrs, CACHE_MSHR_MAX);
+        assert(0);
+    }
+    cache->num_mshrs = num_mshrs;
+    cache->mshrs = (mshr_t *)malloc(sizeof(mshr_t) * num_mshrs);
+    if(cache->mshrs == NULL){
+        cprintf(ANSI_C_RED, "cache_init: Unable to allocate MSHRs\n");
+        assert(0);
+    }
+    for(i = 0; i < num_mshrs; i++){
+        cache->mshrs[i].valid = false;
+        cache->mshrs[i].penalty_count = 0;
+        cache->mshrs[i].subsequent_fetching = 0;
+        cache->mshrs[i].num_targets = 0;
+        cache->mshrs[i].prefetch = false;
+        cache->mshrs[i].to_stream = false;
+    }
     cache->fetching = false;
-    cache->penalty_count = 0;
-    cache->subsequent_fetching = 0;
+    cache->prefetch = NULL;
+    cache->victim = NULL;
+    cache->coherent = false;
+    cache->timing_only = false;
+    cache->classify = false;
+    cache->core = 0;
+
+    cache->mshr_primary = 0;
+    cache->mshr_secondary = 0;
+    cache->mshr_full = 0;
+    cache->mshr_conflict = 0;
+    cache->hit_under_miss = 0;
+    cache->miss_under_miss = 0;
+    cache->mshr_busy_cycles = 0;
+    cache->mshr_occupancy = 0;
+    cache->mshr_peak = 0;
+
+    cache->reads = 0;
+    cache->writes = 0;
+    cache->read_hits = 0;
+    cache->write_hits = 0;
+    cache->read_misses = 0;
+    cache->write_misses = 0;
+    cache->compulsory_misses = 0;
+    cache->capacity_misses = 0;
+    cache->conflict_misses = 0;
+    cache->evictions = 0;
+    cache->writebacks = 0;
+    cache->last_valid = false;
+    cache->shadow_blocks = 0;
+    cache->shadow_prev = NULL;
+    cache->shadow_next = NULL;
+    cache->shadow_state = NULL;
 
     //Invalidate all data in the cache
     uint8_t j;
@@ -78,78 +139,137 @@ direct_cache_t * direct_cache_init(uint32_t num_blocks, uint32_t block_size){
 }
 
 void direct_cache_free(direct_cache_t *cache){
-
+    if(cache == NULL){
+        return;
+    }
+    prefetch_free(cache->prefetch);
+    victim_free(cache->victim);
+    free(cache->shadow_prev);
+    free(cache->shadow_next);
+    free(cache->shadow_state);
+    free(cache->blocks[0].valid);
+    free(cache->mshrs);
     free(cache->words);
     free(cache->blocks);
     free(cache);
 }
 
+/* Brings the word an MSHR is waiting on into the cache (or the stream buffer
+*  slot it is filling), merges any stores that were parked on that word and
+*  moves on to the next word of the block
+*/
+static void direct_cache_fill_word(direct_cache_t *cache, mshr_t *mshr){
+    uint32_t word = mshr->subsequent_fetching;
+    uint32_t address = mshr->block_address | (word << 2);
+    word_t data = 0;
 
-void direct_cache_digest(direct_cache_t *cache, memory_status_t proceed_condition){
-    cache_access_t info;
-    direct_cache_get_tag_and_index(&info, cache, &(cache->target_address));
-    if(get_mem_status() == proceed_condition){
-        //Increment the wait count
-        cache->penalty_count++;
-        if(flags & MASK_DEBUG){
-            printf("\tdirect_cache_digest: Value of incremented penalty_count %d, pending address: 0x%08x\n",cache->penalty_count, cache->target_address);
-        }
-        if(cache->penalty_count == CACHE_MISS_PENALTY){
-            //Finished waiting, get data and return it
-            if(flags & MASK_DEBUG){
-                printf("\tdirect_cache_digest: Reached stall count retreiveing data.\n");
-            }
-            mem_read_w(cache->target_address, &info.data);
-            cache->blocks[info.index].data[info.inner_index] = info.data;
-            cache->blocks[info.index].tag = info.tag;
-            cache->blocks[info.index].valid[info.inner_index] = true;
-            //Invalidate the rest of the data in the cache since the tag changed
-            for(uint8_t i = 1; i < cache->block_size; i++){
-                cache->blocks[info.index].valid[i] = false;
+    if(!cache->timing_only){
+        mem_read_w(address, &data);
+    }
+    mshr->fill_data[word] = data;
+    mshr->fill_valid[word] = true;
+    for(uint32_t i = 0; i < mshr->num_targets; i++){
+        mshr_target_t *target = &mshr->targets[i];
+        if(target->request == CACHE_WRITE && target->inner_index == word){
+            mshr->fill_data[word] = (mshr->fill_data[word] & ~target->mask) | (target->data & target->mask);
+            if(cache->write_policy == WRITEBACK){
+                cache->blocks[mshr->index].dirty = true;
             }
-            cache->blocks[info.index].dirty = false;
-            cache->fetching = false;
-            cache->penalty_count = 0;
-            if(cache->subsequent_fetching != (cache->block_size - 1)){
-                //get the second word in the block
-                info.address |= (1 << 2);
-                cache->subsequent_fetching = 1;
-                direct_cache_queue_mem_access(cache, info);
+        }
+    }
+    EVENT(EV_DIRECT_FILL, mshr->fill_data[word], address, mshr->to_stream, mshr->index, word);
+
+    mshr->penalty_count = 0;
+    if(mshr->subsequent_fetching < (cache->block_size - 1)){
+        //get the next word for the block
+        mshr->subsequent_fetching++;
+    } else {
+        //Whole block is in, release the MSHR
+        mshr->valid = false;
+        mshr->subsequent_fetching = 0;
+        mshr->num_targets = 0;
+        mshr->prefetch = false;
+        mshr->to_stream = false;
+    }
+}
+
+void direct_cache_digest(direct_cache_t *cache, bool proceed){
+    uint32_t busy = direct_cache_mshrs_busy(cache);
+    if(busy){
+        cache->mshr_busy_cycles++;
+        cache->mshr_occupancy += busy;
+        if(busy > cache->mshr_peak){
+            cache->mshr_peak = busy;
+        }
+    }
+    if(proceed){
+        for(uint32_t i = 0; i < cache->num_mshrs; i++){
+            mshr_t *mshr = &cache->mshrs[i];
+            if(!mshr->valid){
+                continue;
             }
-            return;
-        }
-        if(cache->subsequent_fetching && (cache->penalty_count == CACHE_MISS_SUBSEQUENT_PENALTY)){
-            //Have the next word for the block
-            mem_read_w(cache->target_address, &info.data);
-            cache->blocks[info.index].data[info.inner_index] = info.data;
-            cache->blocks[info.index].tag = info.tag;
-            cache->blocks[info.index].valid[info.inner_index] = true;
-            cache->blocks[info.index].dirty = false;
-            cache->fetching = false;
-            cache->penalty_count = 0;
-            if(cache->subsequent_fetching < (cache->block_size - 1)){
-                //get the next word for the block
-                cache->subsequent_fetching++;
-                info.address &= ~(0xc);
-                info.address |= (cache->subsequent_fetching << 2);
-                direct_cache_queue_mem_access(cache, info);
-            } else if(cache->subsequent_fetching == (cache->block_size - 1)){
-                cache->subsequent_fetching = 0;
+            //Increment the wait count
+            mshr->penalty_count++;
+            EVENT(EV_DIRECT_MSHR_WAIT, i, mshr->penalty_count, mshr->block_address | (mshr->subsequent_fetching << 2));
+            if((mshr->subsequent_fetching == 0 && mshr->penalty_count == CACHE_MISS_PENALTY) ||
+                (mshr->subsequent_fetching && mshr->penalty_count == CACHE_MISS_SUBSEQUENT_PENALTY)){
+                //Finished waiting, get data and put it in the block
+                direct_cache_fill_word(cache, mshr);
             }
-            return;
         }
     }
+    cache->fetching = (direct_cache_mshrs_busy(cache) != 0);
+}
 
+/* Records an access against an MSHR. An access that returned CACHE_MISS is
+*  replayed by the pipeline every cycle, so when replayed is set one that is
+*  already recorded is not added twice. A store parked by a non-blocking
+*  cache returned CACHE_HIT and is never replayed: every call is a new store,
+*  even one with the same word, value and mask as an earlier one.
+*  @returns 1 if a new target was added, 0 if it was already there, -1 if the
+*  MSHR has no room left
+*/
+static int direct_cache_add_target(mshr_t *mshr, cache_access_request_t request, uint32_t inner_index, word_t data, word_t mask, bool replayed){
+    for(uint32_t i = 0; replayed && i < mshr->num_targets; i++){
+        mshr_target_t *target = &mshr->targets[i];
+        if(target->request == request && target->inner_index == inner_index &&
+            (request == CACHE_READ || (target->data == data && target->mask == mask))){
+            return 0;
+        }
+    }
+    if(mshr->num_targets == CACHE_MSHR_TARGETS){
+        return -1;
+    }
+    mshr->targets[mshr->num_targets].request = request;
+    mshr->targets[mshr->num_targets].inner_index = inner_index;
+    mshr->targets[mshr->num_targets].data = data;
+    mshr->targets[mshr->num_targets].mask = mask;
+    mshr->num_targets++;
+    return 1;
 }
 
+/* Counts the first demand access to a block brought in by the prefetcher.
+*  The block may still be on its way, in which case the prefetch was late.
+*/
+static prefetch_event_t direct_cache_use_block(direct_cache_t *cache, direct_cache_block_t *block, bool in_flight){
+    if(!block->prefetched){
+        return in_flight ? PREFETCH_EVENT_MISS : PREFETCH_EVENT_HIT;
+    }
+    block->prefetched = false;
+    if(cache->prefetch != NULL){
+        cache->prefetch->useful++;
+        if(in_flight){
+            cache->prefetch->late++;
+        }
+    }
+    return PREFETCH_EVENT_PREFETCHED;
+}
 
-cache_status_t direct_cache_read_w(direct_cache_t *cache, uint32_t *address, uint32_t *data){
+static cache_status_t direct_cache_read(direct_cache_t *cache, uint32_t *address, uint32_t *data, pc_t pc){
     cache_access_t info;
     direct_cache_get_tag_and_index(&info, cache, address);
     info.request = CACHE_READ;
-    if(flags & MASK_DEBUG){
-        printf("\tdirect_cache_read_w: looking for address 0x%08x\n", *address);
-    }
+    EVENT(EV_DIRECT_LOOKUP, *address);
 
     //Some index checking to make sure we don't seg fault
     if(info.index >= cache->num_blocks){
@@ -161,95 +281,639 @@ cache_status_t direct_cache_read_w(direct_cache_t *cache, uint32_t *address, uin
         cprintf(ANSI_C_RED, "direct_cache_read_w: Cache not initialized\n");
         assert(0);
     }
-    if(flags & MASK_DEBUG){
-        printf("\tdirect_cache_read_w: Reading from cache block %d\n", info.index);
-    }
+    EVENT(EV_DIRECT_BLOCK, info.index);
+    direct_cache_block_t *block = &cache->blocks[info.index];
+    prefetch_event_t event;
     //Check to make sure the data is valid
-    if(cache->blocks[info.index].valid[info.inner_index] == true && cache->blocks[info.index].tag == info.tag){
+    if(block->valid[info.inner_index] == true && block->tag == info.tag){
         info.data = cache->blocks[info.index].data[info.inner_index];
         info.dirty = cache->blocks[info.index].dirty;
-        if(flags & MASK_DEBUG){
-            printf("\tdirect_cache_read_w: CACHE_HIT Found valid data 0x%08x for address 0x%08x in block: %d, inner_index: %d\n", info.data, info.address, info.index, info.inner_index);
-            if(info.dirty){
-                printf("\tdirect_cache_read_w: Block is dirty\n");
-            }
+        EVENT(EV_DIRECT_HIT, info.data, info.address, info.index, info.inner_index);
+        if(info.dirty){
+            EVENT(EV_DIRECT_DIRTY);
+        }
+        if(cache->fetching){
+            cache->hit_under_miss++;
         }
+        prefetch_access(cache, pc, *address, direct_cache_use_block(cache, block, false));
         *data = info.data;
         return CACHE_HIT;
     }
     else {
-        if(flags & MASK_DEBUG){
-            printf("\tdirect_cache_read_w: CACHE_MISS: Data at requested address is not in the cache\n");
+        EVENT(EV_DIRECT_MISS);
+        mshr_t *mshr = direct_cache_find_mshr(cache, *address);
+        if(mshr == NULL && cache->victim != NULL &&
+            direct_cache_victim_swap(cache, &info) != CACHE_NO_ACCESS){
+            //Swapping the block back in takes this cycle, the replay hits
+            prefetch_access(cache, pc, *address, PREFETCH_EVENT_HIT);
+            return CACHE_MISS;
         }
-        if(cache->fetching){
-            if(flags & MASK_DEBUG){
-                printf("\tdirect_cache_read_word: CACHE_MISS, cache is fetching data.\n");
+        if(mshr == NULL && cache->prefetch != NULL &&
+            prefetch_stream_lookup(cache, &info) != CACHE_NO_ACCESS){
+            //A stream buffer has the block, it is moved in for the replay
+            prefetch_access(cache, pc, *address, PREFETCH_EVENT_PREFETCHED);
+            return CACHE_MISS;
+        }
+        event = PREFETCH_EVENT_MISS;
+        if(mshr != NULL){
+            //Block is already on its way, wait for it along with the first miss
+            if(direct_cache_add_target(mshr, CACHE_READ, info.inner_index, 0, 0, true) == 1){
+                cache->mshr_secondary++;
             }
+            event = direct_cache_use_block(cache, block, true);
+            EVENT(EV_DIRECT_MISS_PENDING);
         } else {
             //Data is not in the cache. Start retrieval
-            if(flags & MASK_DEBUG){
-                printf("\tdirect_cache_read_word: CACHE_MISS, data is not in the cache. Queueing read\n");
+            EVENT(EV_DIRECT_MISS_QUEUED);
+            mshr = direct_cache_queue_mem_access(cache, info);
+            if(mshr != NULL){
+                direct_cache_add_target(mshr, CACHE_READ, info.inner_index, 0, 0, true);
             }
-            info.request = CACHE_READ;
-            direct_cache_queue_mem_access(cache, info);
         }
+        prefetch_access(cache, pc, *address, event);
         return CACHE_MISS;
     }
 
 }
 
-cache_status_t direct_cache_write_w(direct_cache_t *cache, uint32_t *address, uint32_t *data){
+static cache_status_t direct_cache_write(direct_cache_t *cache, uint32_t *address, uint32_t *data, word_t mask, pc_t pc){
     cache_access_t info;
-    cache_status_t status;
     direct_cache_get_tag_and_index(&info, cache, address);
+    info.request = CACHE_WRITE;
     info.data = *data;
-    if(cache->blocks[info.index].valid[info.inner_index] == true && cache->blocks[info.index].tag == info.tag){
-        status = CACHE_HIT;
-        if(info.dirty && write_policy == WRITEBACK){
-            //There is valid dirty data in the cache, and we must put it in the write buffer
-            status = write_buffer_enqueue(info);
-            if(status == CACHE_MISS){
-                if(flags & MASK_DEBUG){
-                    printf("\tdirect_cache_access_word: Write buffer is full. Cannot fill cache without losing data.\n");
-                }
-                //The write buffer is full! Don't fill the block
+    direct_cache_block_t *block = &cache->blocks[info.index];
+    bool hit = block->valid[info.inner_index] == true && block->tag == info.tag;
+    mshr_t *mshr = direct_cache_find_mshr(cache, *address);
+
+    if(!hit && mshr == NULL && cache->victim != NULL &&
+        direct_cache_victim_swap(cache, &info) != CACHE_NO_ACCESS){
+        //Swapped back in for the replay, a writethrough store must not
+        //leave a stale copy behind in the victim cache
+        prefetch_access(cache, pc, *address, PREFETCH_EVENT_HIT);
+        return CACHE_MISS;
+    }
+    if(!hit && mshr == NULL && cache->prefetch != NULL &&
+        prefetch_stream_lookup(cache, &info) != CACHE_NO_ACCESS){
+        //A stream buffer has the block, the store goes into the cache once
+        //it is moved in so the stream buffer never holds stale data
+        prefetch_access(cache, pc, *address, PREFETCH_EVENT_PREFETCHED);
+        return CACHE_MISS;
+    }
+    bool owned = (hit || mshr != NULL) && (block->state == COH_MODIFIED || block->state == COH_EXCLUSIVE);
+    if(cache->coherent && (hit || mshr != NULL || cache->write_policy == WRITETHROUGH) && !owned){
+        //Nobody else may keep a copy of what is about to be written. A miss
+        //that allocates gets the block exclusive when it is claimed.
+        if(!coherence_upgrade(cache, *address)){
+            return CACHE_MISS;
+        }
+    }
+    if(cache->coherent && (hit || mshr != NULL)){
+        block->state = COH_MODIFIED;
+    }
+    if(hit || mshr != NULL){
+        prefetch_access(cache, pc, *address, direct_cache_use_block(cache, block, !hit));
+    } else {
+        prefetch_access(cache, pc, *address, PREFETCH_EVENT_MISS);
+    }
+
+    if(cache->write_policy == WRITETHROUGH){
+        //Every store goes to memory through the write buffer, no allocation on a miss
+        if(write_buffer_enqueue_word(*address & ~0x3, info.data, mask) == CACHE_MISS){
+            EVENT(EV_DIRECT_WRITE_STALL);
+            return CACHE_MISS;
+        }
+        if(hit){
+            block->data[info.inner_index] = (block->data[info.inner_index] & ~mask) | (info.data & mask);
+            if(cache->fetching){
+                cache->hit_under_miss++;
+            }
+        } else if(mshr != NULL){
+            //The block is being filled, make sure the fill doesn't bring in stale data
+            if(direct_cache_add_target(mshr, CACHE_WRITE, info.inner_index, info.data, mask, false) == -1){
                 return CACHE_MISS;
             }
         }
-        cache->blocks[info.index].data[info.inner_index] = info.data;
-        cache->blocks[info.index].tag = info.tag;
-        cache->blocks[info.index].dirty = true;
-    } else {
-        //The processor is writing to a place in memory that isnt in the cache
-        //The transaction becomes a READ MODIFY WRITE
-        if(flags & MASK_DEBUG){
-            printf("\tdirect_cache_access_word: no valid data in the cache for the specified address.\n");
+        return CACHE_HIT;
+    }
+
+    if(hit){
+        block->data[info.inner_index] = (block->data[info.inner_index] & ~mask) | (info.data & mask);
+        block->dirty = true;
+        if(cache->fetching){
+            cache->hit_under_miss++;
         }
+        EVENT(EV_DIRECT_WRITE_HIT, block->data[info.inner_index], info.index, info.inner_index);
+        return CACHE_HIT;
+    }
+
+    //The processor is writing to a place in memory that isnt in the cache
+    //The transaction becomes a READ MODIFY WRITE
+    EVENT(EV_DIRECT_WRITE_MISS);
+    bool allocated = false;
+    if(mshr == NULL){
+        mshr = direct_cache_queue_mem_access(cache, info);
+        if(mshr == NULL){
+            return CACHE_MISS;
+        }
+        allocated = true;
+    }
+    if(cache->num_mshrs == 1){
+        //Blocking cache, the store is replayed once its word is in
         return CACHE_MISS;
     }
+    //Non-blocking cache, park the store in the MSHR and let the pipeline go on
+    int added = direct_cache_add_target(mshr, CACHE_WRITE, info.inner_index, info.data, mask, false);
+    if(added == -1){
+        return CACHE_MISS;
+    }
+    if(added == 1 && !allocated){
+        cache->mshr_secondary++;
+    }
+    return CACHE_HIT;
+}
+
+/* Builds the miss classification shadow cache, one list node per block of
+*  main memory
+*/
+static void direct_cache_shadow_init(direct_cache_t *cache){
+    cache->shadow_blocks = mem_size_w() / cache->block_size;
+    cache->shadow_prev = (uint32_t *)malloc(sizeof(uint32_t) * cache->shadow_blocks);
+    cache->shadow_next = (uint32_t *)malloc(sizeof(uint32_t) * cache->shadow_blocks);
+    cache->shadow_state = (uint8_t *)malloc(sizeof(uint8_t) * cache->shadow_blocks);
+    if(cache->shadow_prev == NULL || cache->shadow_next == NULL || cache->shadow_state == NULL){
+        cprintf(ANSI_C_RED, "direct_cache_shadow_init: Unable to allocate shadow cache\n");
+        assert(0);
+    }
+    for(uint32_t i = 0; i < cache->shadow_blocks; i++){
+        cache->shadow_state[i] = SHADOW_NEVER;
+    }
+    cache->shadow_used = 0;
+    cache->shadow_head = cache->shadow_blocks;
+    cache->shadow_tail = cache->shadow_blocks;
+}
+
+static void direct_cache_shadow_unlink(direct_cache_t *cache, uint32_t block){
+    uint32_t prev = cache->shadow_prev[block];
+    uint32_t next = cache->shadow_next[block];
+    if(prev == cache->shadow_blocks){
+        cache->shadow_head = next;
+    } else {
+        cache->shadow_next[prev] = next;
+    }
+    if(next == cache->shadow_blocks){
+        cache->shadow_tail = prev;
+    } else {
+        cache->shadow_prev[next] = prev;
+    }
+    cache->shadow_used--;
+}
 
+/* Moves the block holding address to the front of the shadow cache
+*  @returns where the block was before the access
+*/
+static uint8_t direct_cache_shadow_touch(direct_cache_t *cache, uint32_t address){
+    if(cache->shadow_blocks == 0){
+        direct_cache_shadow_init(cache);
+    }
+    uint32_t block = ((address - mem_start()) >> 2) / cache->block_size;
+    if(block >= cache->shadow_blocks){
+        //Outside of memory, the access itself will fault
+        return SHADOW_NEVER;
+    }
+    uint8_t state = cache->shadow_state[block];
+    if(state == SHADOW_IN){
+        direct_cache_shadow_unlink(cache, block);
+    } else if(cache->shadow_used == cache->num_blocks){
+        //Full, the least recently used block falls out
+        uint32_t lru = cache->shadow_tail;
+        direct_cache_shadow_unlink(cache, lru);
+        cache->shadow_state[lru] = SHADOW_OUT;
+    }
+    cache->shadow_prev[block] = cache->shadow_blocks;
+    cache->shadow_next[block] = cache->shadow_head;
+    if(cache->shadow_head == cache->shadow_blocks){
+        cache->shadow_tail = block;
+    } else {
+        cache->shadow_prev[cache->shadow_head] = block;
+    }
+    cache->shadow_head = block;
+    cache->shadow_used++;
+    cache->shadow_state[block] = SHADOW_IN;
+    return state;
+}
+
+/* Counts an access once. The pipeline replays an access until it hits, so a
+*  call for the same pc and address right after a miss is the same access.
+*  Fetches pass their own address as the pc, a fetch repeated after the
+*  pipeline was restored is not a new access either. A miss merged into a
+*  fill already in flight is not given a 3C class.
+*/
+static void direct_cache_count(direct_cache_t *cache, pc_t pc, uint32_t address, cache_access_request_t request, cache_status_t status, bool merged){
+    bool repeat = cache->last_valid && cache->last_pc == pc && cache->last_address == address &&
+        (cache->last_miss || pc == address);
+    cache->last_valid = true;
+    cache->last_pc = pc;
+    cache->last_address = address;
+    cache->last_miss = status == CACHE_MISS;
+    if(repeat){
+        return;
+    }
+    bool hit = status == CACHE_HIT;
+    if(request == CACHE_READ){
+        cache->reads++;
+        if(hit) cache->read_hits++;
+        else cache->read_misses++;
+    } else {
+        cache->writes++;
+        if(hit) cache->write_hits++;
+        else cache->write_misses++;
+    }
+    if(!cache->classify){
+        return;
+    }
+    uint8_t state = direct_cache_shadow_touch(cache, address);
+    if(!hit && !merged){
+        if(state == SHADOW_NEVER) cache->compulsory_misses++;
+        else if(state == SHADOW_OUT) cache->capacity_misses++;
+        else cache->conflict_misses++;
+    }
+}
+
+cache_status_t direct_cache_read_w(direct_cache_t *cache, uint32_t *address, uint32_t *data, pc_t pc){
+    uint32_t secondary = cache->mshr_secondary;
+    cache_status_t status = direct_cache_read(cache, address, data, pc);
+    direct_cache_count(cache, pc, *address, CACHE_READ, status, cache->mshr_secondary != secondary);
     return status;
 }
 
+cache_status_t direct_cache_write_w(direct_cache_t *cache, uint32_t *address, uint32_t *data, word_t mask, pc_t pc){
+    uint32_t secondary = cache->mshr_secondary;
+    cache_status_t status = direct_cache_write(cache, address, data, mask, pc);
+    direct_cache_count(cache, pc, *address, CACHE_WRITE, status, cache->mshr_secondary != secondary);
+    return status;
+}
 
+mshr_t *direct_cache_find_mshr(direct_cache_t *cache, uint32_t address){
+    uint32_t block_address = address & (cache->tag_mask | cache->index_mask);
+    for(uint32_t i = 0; i < cache->num_mshrs; i++){
+        //Stream buffer fills are found through the prefetcher instead
+        if(cache->mshrs[i].valid && !cache->mshrs[i].to_stream && cache->mshrs[i].block_address == block_address){
+            return &cache->mshrs[i];
+        }
+    }
+    return NULL;
+}
 
+coherence_state_t direct_cache_snoop(direct_cache_t *cache, uint32_t address, bool invalidate, bool *supplied){
+    cache_access_t info;
+    *supplied = false;
+    direct_cache_get_tag_and_index(&info, cache, &address);
+    direct_cache_block_t *block = &cache->blocks[info.index];
+    coherence_state_t state = block->state;
+    if(block->tag != info.tag || state == COH_INVALID){
+        return COH_INVALID;
+    }
+    uint32_t block_address = address & (cache->tag_mask | cache->index_mask);
+    if(block->dirty){
+        for(uint32_t i = 0; i < cache->block_size; i++){
+            if(block->valid[i]){
+                mem_write_w(block_address | (i << 2), &block->data[i]);
+            }
+        }
+        block->dirty = false;
+        *supplied = true;
+    }
+    if(invalidate){
+        for(uint32_t i = 0; i < cache->block_size; i++){
+            block->valid[i] = false;
+        }
+        block->state = COH_INVALID;
+    } else {
+        block->state = COH_SHARED;
+    }
+    EVENT(EV_DIRECT_SNOOP, block_address, info.index, invalidate);
+    return state;
+}
 
-void direct_cache_queue_mem_access(direct_cache_t *cache, cache_access_t info){
-    if(flags & MASK_DEBUG){
-        printf("\tdirect_cache_queue_mem_access: Queueing memory access for address 0x%08x\n", info.address);
+coherence_state_t direct_cache_state(direct_cache_t *cache, uint32_t address){
+    cache_access_t info;
+    direct_cache_get_tag_and_index(&info, cache, &address);
+    direct_cache_block_t *block = &cache->blocks[info.index];
+    return block->tag == info.tag ? block->state : COH_INVALID;
+}
+
+uint32_t direct_cache_mshrs_busy(direct_cache_t *cache){
+    uint32_t busy = 0;
+    for(uint32_t i = 0; i < cache->num_mshrs; i++){
+        if(cache->mshrs[i].valid){
+            busy++;
+        }
+    }
+    return busy;
+}
+
+/* Finds a free MSHR. If check_index is set, a fill already going into block
+*  index also makes this return NULL (and sets *conflict).
+*  *busy is set to the number of MSHRs in use.
+*/
+static mshr_t *direct_cache_free_mshr(direct_cache_t *cache, uint32_t index, bool check_index, uint32_t *busy, bool *conflict){
+    mshr_t *mshr = NULL;
+    *busy = 0;
+    *conflict = false;
+    for(uint32_t i = 0; i < cache->num_mshrs; i++){
+        if(cache->mshrs[i].valid){
+            (*busy)++;
+            if(check_index && !cache->mshrs[i].to_stream && cache->mshrs[i].index == index){
+                //Another fill owns this block, wait for it to finish
+                EVENT(EV_DIRECT_MSHR_CONFLICT, index, i);
+                *conflict = true;
+                return NULL;
+            }
+        } else if(mshr == NULL){
+            mshr = &cache->mshrs[i];
+        }
+    }
+    if(mshr == NULL){
+        EVENT(EV_DIRECT_MSHR_BUSY, cache->num_mshrs);
+    }
+    return mshr;
+}
+
+/* Returns true if every word of block is valid */
+static bool direct_cache_block_whole(direct_cache_t *cache, direct_cache_block_t *block){
+    for(uint32_t i = 0; i < cache->block_size; i++){
+        if(!block->valid[i]){
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Looks for the block of info in the victim cache and swaps it with the
+*  block currently sitting in its frame.
+*  @returns CACHE_NO_ACCESS if the victim cache doesn't have the block,
+*  CACHE_HIT if it was swapped in, CACHE_MISS if the swap has to wait
+*/
+static cache_status_t direct_cache_victim_swap(direct_cache_t *cache, cache_access_t *info){
+    victim_cache_t *vc = cache->victim;
+    uint32_t block_address = info->address & (cache->tag_mask | cache->index_mask);
+    if(vc->last_probe != block_address){
+        vc->last_probe = block_address;
+        vc->probes++;
+    }
+    victim_entry_t *entry = victim_find(vc, block_address);
+    if(entry == NULL){
+        return CACHE_NO_ACCESS;
+    }
+    uint32_t busy;
+    bool conflict;
+    direct_cache_free_mshr(cache, info->index, true, &busy, &conflict);
+    if(conflict){
+        return CACHE_MISS;
+    }
+
+    direct_cache_block_t *block = &cache->blocks[info->index];
+    bool dirty = entry->dirty;
+    for(uint32_t i = 0; i < cache->block_size; i++){
+        vc->swap[i] = entry->data[i];
+    }
+    if(direct_cache_block_whole(cache, block)){
+        //The block in the frame takes the place of the one coming back
+        entry->block_address = (block->tag << (2 + cache->index_size + cache->inner_index_size)) |
+            (info->index << (2 + cache->inner_index_size));
+        entry->dirty = block->dirty;
+        for(uint32_t i = 0; i < cache->block_size; i++){
+            entry->data[i] = block->data[i];
+        }
+        victim_touch(vc, entry);
+    } else {
+        entry->valid = false;
+    }
+    if(block->prefetched && cache->prefetch != NULL){
+        cache->prefetch->useless++;
+    }
+    for(uint32_t i = 0; i < cache->block_size; i++){
+        block->data[i] = vc->swap[i];
+        block->valid[i] = true;
+    }
+    block->tag = info->tag;
+    block->dirty = dirty;
+    block->prefetched = false;
+    vc->hits++;
+    EVENT(EV_DIRECT_VICTIM_SWAP, block_address, info->index);
+    return CACHE_HIT;
+}
+
+/* Hands the cache block for info over to its new tag. The block being
+*  replaced is written back if it is dirty.
+*  @returns false if that can not happen this cycle
+*/
+static bool direct_cache_claim_block(direct_cache_t *cache, cache_access_t *info){
+    //Memory has to be up to date before we read the block back in
+    uint32_t block_address = info->address & (cache->tag_mask | cache->index_mask);
+    if(write_buffer_pending(block_address, cache->block_size)){
+        EVENT(EV_DIRECT_CLAIM_DRAIN, block_address);
+        return false;
+    }
+
+    direct_cache_block_t *block = &cache->blocks[info->index];
+    uint32_t victim_address = (block->tag << (2 + cache->index_size + cache->inner_index_size)) |
+        (info->index << (2 + cache->inner_index_size));
+    if(cache->victim != NULL && direct_cache_block_whole(cache, block)){
+        //The victim cache catches the block on its way out, dirty or not
+        if(!victim_insert(cache->victim, victim_address, block->data, block->dirty)){
+            return false;
+        }
+    } else if(block->dirty){
+        //Write the block being replaced back to memory
+        if(write_buffer_enqueue(victim_address, block->data, block->valid, cache->block_size) == CACHE_MISS){
+            EVENT(EV_DIRECT_CLAIM_FULL);
+            return false;
+        }
+        cache->writebacks++;
     }
+    for(uint32_t i = 0; i < cache->block_size; i++){
+        if(block->valid[i]){
+            cache->evictions++;
+            if(cache->coherent){
+                coherence_evicted(cache, victim_address);
+            }
+            break;
+        }
+    }
+    if(block->prefetched && cache->prefetch != NULL){
+        //Prefetched block never got used
+        cache->prefetch->useless++;
+    }
+    //The block now belongs to the incoming data
+    for(uint32_t i = 0; i < cache->block_size; i++){
+        block->valid[i] = false;
+    }
+    block->tag = info->tag;
+    block->dirty = false;
+    block->prefetched = false;
+    block->state = COH_INVALID;
+    if(cache->coherent && !coherence_request(cache, block_address, info->request == CACHE_WRITE, &block->state)){
+        //Left invalid, the replay claims it again
+        return false;
+    }
+    return true;
+}
+
+/* Sets up an MSHR to fetch the block at block_address into data/valid */
+static void direct_cache_start_fill(direct_cache_t *cache, mshr_t *mshr, cache_access_t *info, word_t *data, bool *valid){
+    mshr->valid = true;
+    mshr->block_address = info->address & (cache->tag_mask | cache->index_mask);
+    mshr->index = info->index;
+    mshr->tag = info->tag;
+    mshr->subsequent_fetching = 0;
+    mshr->penalty_count = 0;
+    mshr->num_targets = 0;
+    mshr->prefetch = false;
+    mshr->to_stream = false;
+    mshr->fill_data = data;
+    mshr->fill_valid = valid;
     cache->fetching = true;
-    if(cache->subsequent_fetching == 0){
-        //We must get the first word in a block first
-        cache->target_address = info.address & (cache->tag_mask | cache->index_mask);
+    if(cache->block_size > 1){
+        EVENT(EV_DIRECT_FILL_ADDRESS, mshr->block_address);
     }
-    else {
-        cache->target_address = info.address;
+}
+
+mshr_t *direct_cache_queue_mem_access(direct_cache_t *cache, cache_access_t info){
+    EVENT(EV_DIRECT_QUEUE, info.address);
+    uint32_t busy;
+    bool conflict;
+    mshr_t *mshr = direct_cache_free_mshr(cache, info.index, true, &busy, &conflict);
+    if(mshr == NULL){
+        if(conflict){
+            cache->mshr_conflict++;
+        } else {
+            cache->mshr_full++;
+        }
+        return NULL;
     }
-    cache->penalty_count = 0;
-    if(flags & MASK_DEBUG && cache->block_size > 1){
-        printf("\tdirect_cache_queue_mem_access: Actual requested address will be 0x%08x\n", cache->target_address);
+    if(!direct_cache_claim_block(cache, &info)){
+        return NULL;
+    }
+
+    direct_cache_start_fill(cache, mshr, &info, cache->blocks[info.index].data, cache->blocks[info.index].valid);
+    cache->mshr_primary++;
+    if(busy){
+        cache->miss_under_miss++;
+    }
+    return mshr;
+}
+
+mshr_t *direct_cache_queue_prefetch(direct_cache_t *cache, uint32_t address, word_t *data, bool *ready){
+    cache_access_t info;
+    direct_cache_get_tag_and_index(&info, cache, &address);
+    info.request = CACHE_READ;
+    uint32_t busy;
+    bool conflict;
+    mshr_t *mshr = direct_cache_free_mshr(cache, info.index, data == NULL, &busy, &conflict);
+    if(mshr == NULL){
+        return NULL;
+    }
+    if(data == NULL){
+        //Prefetch into the cache itself
+        if(!direct_cache_claim_block(cache, &info)){
+            return NULL;
+        }
+        cache->blocks[info.index].prefetched = true;
+        direct_cache_start_fill(cache, mshr, &info, cache->blocks[info.index].data, cache->blocks[info.index].valid);
+    } else {
+        //Prefetch into a stream buffer slot
+        if(write_buffer_pending(address & (cache->tag_mask | cache->index_mask), cache->block_size)){
+            return NULL;
+        }
+        for(uint32_t i = 0; i < cache->block_size; i++){
+            ready[i] = false;
+        }
+        direct_cache_start_fill(cache, mshr, &info, data, ready);
+        mshr->to_stream = true;
+    }
+    mshr->prefetch = true;
+    EVENT(EV_DIRECT_PREFETCH, mshr->block_address, data == NULL);
+    return mshr;
+}
+
+bool direct_cache_install_block(direct_cache_t *cache, cache_access_t *info, word_t *data){
+    uint32_t busy;
+    bool conflict;
+    direct_cache_free_mshr(cache, info->index, true, &busy, &conflict);
+    if(conflict || !direct_cache_claim_block(cache, info)){
+        return false;
+    }
+    direct_cache_block_t *block = &cache->blocks[info->index];
+    for(uint32_t i = 0; i < cache->block_size; i++){
+        block->data[i] = data[i];
+        block->valid[i] = true;
+    }
+    return true;
+}
+
+bool direct_cache_holds(direct_cache_t *cache, uint32_t address){
+    cache_access_t info;
+    direct_cache_get_tag_and_index(&info, cache, &address);
+    direct_cache_block_t *block = &cache->blocks[info.index];
+    if(block->tag == info.tag){
+        for(uint32_t i = 0; i < cache->block_size; i++){
+            if(block->valid[i]){
+                return true;
+            }
+        }
+    }
+    if(cache->victim != NULL && victim_find(cache->victim, address & (cache->tag_mask | cache->index_mask)) != NULL){
+        return true;
+    }
+    return direct_cache_find_mshr(cache, address) != NULL;
+}
+
+void direct_cache_flush(direct_cache_t *cache){
+    for(uint32_t i = 0; i < cache->num_mshrs; i++){
+        while(cache->mshrs[i].valid){
+            direct_cache_fill_word(cache, &cache->mshrs[i]);
+        }
+    }
+    cache->fetching = false;
+    for(uint32_t i = 0; i < cache->num_blocks; i++){
+        direct_cache_block_t *block = &cache->blocks[i];
+        if(!block->dirty){
+            continue;
+        }
+        uint32_t address = (block->tag << (2 + cache->index_size + cache->inner_index_size)) |
+            (i << (2 + cache->inner_index_size));
+        for(uint32_t j = 0; j < cache->block_size; j++){
+            if(block->valid[j]){
+                mem_write_w(address | (j << 2), &block->data[j]);
+            }
+        }
+        block->dirty = false;
+    }
+    victim_flush(cache->victim);
+}
+
+void direct_cache_register_stats(direct_cache_t *cache, const char *group){
+    stats_register(group, "reads", &cache->reads, "loads and fetches");
+    stats_register(group, "writes", &cache->writes, "stores");
+    stats_register(group, "read_hits", &cache->read_hits, "reads found in the cache");
+    stats_register(group, "write_hits", &cache->write_hits, "stores completed without stalling");
+    stats_register(group, "read_misses", &cache->read_misses, "reads that stalled");
+    stats_register(group, "write_misses", &cache->write_misses, "stores that stalled");
+    if(cache->classify){
+        stats_register(group, "compulsory_misses", &cache->compulsory_misses, "misses on the first touch of a block");
+        stats_register(group, "capacity_misses", &cache->capacity_misses, "misses a fully associative cache would also take");
+        stats_register(group, "conflict_misses", &cache->conflict_misses, "misses a fully associative cache would hit");
     }
+    stats_register(group, "evictions", &cache->evictions, "valid blocks replaced by a fill");
+    stats_register(group, "writebacks", &cache->writebacks, "dirty blocks written back on replacement");
+    stats_register(group, "mshr_primary", &cache->mshr_primary, "misses that allocated an MSHR");
+    stats_register(group, "mshr_secondary", &cache->mshr_secondary, "misses merged into an MSHR in flight");
+    stats_register(group, "mshr_full", &cache->mshr_full, "misses turned away with every MSHR busy");
+    stats_register(group, "mshr_conflict", &cache->mshr_conflict, "misses turned away by a fill for another tag");
+    stats_register(group, "hit_under_miss", &cache->hit_under_miss, "hits serviced while an MSHR was busy");
+    stats_register(group, "miss_under_miss", &cache->miss_under_miss, "misses allocated while an MSHR was busy");
+    stats_register(group, "mshr_busy_cycles", &cache->mshr_busy_cycles, "cycles with an MSHR waiting on memory");
 }
 
 void direct_cache_get_tag_and_index(cache_access_t *info, direct_cache_t *cache, uint32_t *address){
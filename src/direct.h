@@ -15,15 +15,28 @@
 #include "main_memory.h"
 #include "types.h"
 #include "cache.h"
+#include "victim.h"
 
 //Cache miss penalty
 #define CACHE_MISS_PENALTY 8
 //If multiple lines come in, subsequent lines miss penalty
 #define CACHE_MISS_SUBSEQUENT_PENALTY 2
+//Largest number of miss status holding registers a cache can be built with
+#define CACHE_MSHR_MAX 16
+//Number of accesses (primary + secondary) a single MSHR can keep track of
+#define CACHE_MSHR_TARGETS 8
 
 //Represents the tag field of the direct cache block
 typedef uint32_t tag_t;
 
+//Where a memory block stands in the miss classification shadow cache
+#define SHADOW_NEVER 0  //never accessed
+#define SHADOW_OUT   1  //accessed before, fell out of the shadow cache
+#define SHADOW_IN    2  //in the shadow cache
+
+//Prefetch engine that can be attached to a cache, see prefetch.h
+struct PREFETCHER;
+
 
 typedef enum WRITE_POLICY{
     WRITEBACK,
@@ -31,16 +44,52 @@ typedef enum WRITE_POLICY{
 } write_policy_t;
 
 
-write_policy_t write_policy;    //write back or write through
+//Coherence state of a block, only kept up in caches attached to the
+//coherence bus (see coherence.h)
+typedef enum COHERENCE_STATE {
+    COH_INVALID,
+    COH_SHARED,         //other caches may have a copy, a store has to invalidate them first
+    COH_EXCLUSIVE,      //only copy and clean (MESI)
+    COH_MODIFIED        //only copy, may be dirty
+} coherence_state_t;
 
 //Struct for a single block of a direct mapped cache
 typedef struct DIRECT_CACHE_BLOCK {
     bool *valid;
     bool dirty;
+    bool prefetched;    //brought in by a prefetch and not used yet
+    coherence_state_t state;
     tag_t tag;
     word_t *data;
 } direct_cache_block_t;
 
+//A single access waiting on an MSHR. Loads only need to know which word
+//they are waiting for, stores also carry the data and byte lanes to merge
+//into the block once the word arrives from memory.
+typedef struct MSHR_TARGET {
+    cache_access_request_t request;
+    uint32_t inner_index;
+    word_t data;
+    word_t mask;
+} mshr_target_t;
+
+//Miss status holding register, tracks one outstanding block fill
+typedef struct MSHR {
+    bool valid;
+    uint32_t block_address;     //address of the first word in the block
+    uint32_t index;             //block the fill is going into
+    tag_t tag;
+    bool prefetch;              //started by the prefetcher rather than a demand miss
+    bool to_stream;             //fills a stream buffer slot instead of a cache block
+    word_t *fill_data;          //where the words of the block go
+    bool *fill_valid;
+    //Used for getting multiple block lines
+    uint32_t subsequent_fetching;
+    uint32_t penalty_count;
+    uint32_t num_targets;
+    mshr_target_t targets[CACHE_MSHR_TARGETS];
+} mshr_t;
+
 typedef struct DIRECT_CACHE {
     uint32_t num_blocks;
     uint32_t block_size;
@@ -50,26 +99,70 @@ typedef struct DIRECT_CACHE {
     uint32_t index_mask;
     uint32_t inner_index_size;
     uint32_t inner_index_mask;
-    //Flag to tell if active fetch from memory
+    write_policy_t write_policy;    //write back or write through
+    //Flag to tell if there is an active fetch from memory (any MSHR in use)
     bool fetching;
-    //Used for getting multiple block lines
-    uint8_t subsequent_fetching;
-    uint32_t penalty_count;
-    uint32_t target_address;
+    //Miss status holding registers. With a single MSHR the cache is blocking,
+    //with more than one it keeps servicing hits and new misses under a miss
+    uint32_t num_mshrs;
+    mshr_t *mshrs;
     direct_cache_block_t *blocks;
     word_t *words;
+    struct PREFETCHER *prefetch;    //NULL if the cache has no prefetcher
+    victim_cache_t *victim;         //NULL if the cache has no victim cache
+    bool coherent;                  //attached to the coherence bus
+    bool timing_only;               //fills don't read main memory, see cache_config_t
+    bool classify;                  //keeps the shadow cache and the 3C counters below
+    uint32_t core;                  //core the cache belongs to
+    //Miss handling counters
+    uint32_t mshr_primary;          //misses that allocated an MSHR
+    uint32_t mshr_secondary;        //misses merged into an MSHR already in flight
+    uint32_t mshr_full;             //misses turned away because no MSHR was free
+    uint32_t mshr_conflict;         //misses turned away because their block was being filled for another tag
+    uint32_t hit_under_miss;        //hits serviced while at least one MSHR was busy
+    uint32_t miss_under_miss;       //primary misses allocated while another MSHR was busy
+    uint32_t mshr_busy_cycles;      //cycles with at least one MSHR waiting on memory
+    uint32_t mshr_occupancy;        //sum of busy MSHRs over those cycles
+    uint32_t mshr_peak;             //most MSHRs busy in a single cycle
+    //Access counters, replays of a stalled access are only counted once
+    uint32_t reads;
+    uint32_t writes;
+    uint32_t read_hits;
+    uint32_t write_hits;
+    uint32_t read_misses;
+    uint32_t write_misses;
+    uint32_t compulsory_misses;     //first touch of the block
+    uint32_t capacity_misses;       //would miss in a fully associative cache of the same size
+    uint32_t conflict_misses;       //would hit in a fully associative cache of the same size
+    uint32_t evictions;             //valid blocks replaced by a fill
+    uint32_t writebacks;            //dirty blocks sent to the write buffer on replacement
+    pc_t last_pc;                   //last access, to tell a replay from a new access
+    uint32_t last_address;
+    bool last_miss;
+    bool last_valid;
+    //Fully associative LRU shadow of the cache used to classify misses.
+    //Lists are indexed by memory block number, built on the first access
+    //and only with classify set.
+    uint32_t shadow_blocks;         //memory blocks tracked, 0 until built
+    uint32_t shadow_used;           //blocks in the shadow cache
+    uint32_t shadow_head;           //most recently used, shadow_blocks if empty
+    uint32_t shadow_tail;           //least recently used
+    uint32_t *shadow_prev;
+    uint32_t *shadow_next;
+    uint8_t *shadow_state;          //SHADOW_NEVER, SHADOW_OUT or SHADOW_IN
 } direct_cache_t;
 
 
 
 
 /*
-* direct_cache_t * direct_cache_init(uint32_t num_blocks)
+* direct_cache_t * direct_cache_init(uint32_t num_blocks, uint32_t block_size, uint32_t num_mshrs)
 * Creates an instance of a direct mapped cache with the number
 * of blocks as a parameter. From the number of blocks we can determine
 * dynamically the tag size. This function also initializes all of the
 * blocks to have invalid data and sets up bitmasks to easily obtain
-* index and tags from an address.
+* index and tags from an address. num_mshrs sets how many misses can be
+* outstanding at once (1 makes a blocking cache).
 */
 /* Get the bit masks for the tag and index
 hopefully this example will make this look less like magic
@@ -82,42 +175,95 @@ index_mask =                1111 1111 1111 1111 1111 (index_mask - 1)
 tag_mask   = 1111 1111 1111 0000 0000 0000 0000 0000 (tag_mask = ~index_mask)
 index_mask =                1111 1111 1111 1111 1100 (index_mask & ~3)//helper functions do not call directly
 */
-direct_cache_t * direct_cache_init(uint32_t num_blocks, uint32_t block_size);
+direct_cache_t * direct_cache_init(uint32_t num_blocks, uint32_t block_size, uint32_t num_mshrs);
 
 void direct_cache_free(direct_cache_t *cache);
 
 /*
-* void direct_cache_digest(direct_cache_t *cache, memory_status_t proceed_condition)
+* void direct_cache_digest(direct_cache_t *cache, bool proceed)
 * function to be called every cycle of the clock.
-* No advancement on stall counters will occur if the memory state does not
-* match the given proceed condition
+* No advancement on stall counters will occur unless the cache owns the
+* memory bus this cycle. While it does every busy MSHR advances, so the
+* fills of several misses overlap (the memory behind the bus is treated as
+* pipelined).
 * @params *cache is which cache the digest will operate on
-* @params proceed_condition is a memory state to ensure a read doesn't proceed
-*         if there is another memory operation occuring
+* @params proceed is true if the bus is reading into this cache, so a read
+*         doesn't proceed if there is another memory operation occuring
 */
-void direct_cache_digest(direct_cache_t *cache, memory_status_t proceed_condition);
+void direct_cache_digest(direct_cache_t *cache, bool proceed);
 
 /* cache_status_t direct_cache_get_word(direct_cache_t *cache, uint32_t *address, uint32_t *data)
 * returns CACHE_HIT or CACHE_MISS depending on if the data is available in the cache
 * if there is a CACHE_MISS, function will set up the direct mapped cache to
-* start fetching the data from main memory.
+* start fetching the data from main memory, or merge the access into the MSHR
+* already fetching its block. pc is the address of the instruction making
+* the access, for the prefetcher to train on.
 */
-cache_status_t direct_cache_read_w(direct_cache_t *cache, uint32_t *address, uint32_t *data);
+cache_status_t direct_cache_read_w(direct_cache_t *cache, uint32_t *address, uint32_t *data, pc_t pc);
 
-/*  @brief Sets up a word to be written back to main memory
+/*  @brief Writes the byte lanes selected by mask of a word into the cache
 *   If writeback, the dirty bit in the cache gets set and returns. Once the
-*   block gets replaced, the data will be written back to main memory
-*   If writethrough, the data gets set in the cache as well as the write buffer
-*   If the write buffer is full, this will return CACHE_MISS to inform the processor
-*   if needs to stall
+*   block gets replaced, the data will be written back to main memory.
+*   A writeback miss allocates the block; a non-blocking cache parks the store
+*   in the MSHR and lets the processor go on, a blocking cache returns
+*   CACHE_MISS until the block is in.
+*   If writethrough, the data gets set in the cache (on a hit) as well as the
+*   write buffer. If the write buffer is full, this will return CACHE_MISS to
+*   inform the processor it needs to stall
+*   pc is the address of the store, for the prefetcher to train on
+*/
+cache_status_t direct_cache_write_w(direct_cache_t *cache, uint32_t *address, uint32_t *data, word_t mask, pc_t pc);
+
+/* @brief Finds the MSHR fetching the block at address, NULL if none */
+mshr_t *direct_cache_find_mshr(direct_cache_t *cache, uint32_t address);
+
+/* @brief Claims an MSHR and a cache block for a miss on info.
+*  Writes back the block being replaced if it is dirty.
+*  @returns the MSHR, or NULL if the miss can not be handled this cycle
 */
-cache_status_t direct_cache_write_w(direct_cache_t *cache, uint32_t *address, uint32_t *data);
+mshr_t *direct_cache_queue_mem_access(direct_cache_t *cache, cache_access_t info);
 
-void direct_cache_fill_word(direct_cache_t *cache, cache_access_t info);
+/* @brief Starts a prefetch of the block holding address. The block goes into
+*  the cache, or into data/ready (a stream buffer slot) if those are given.
+*  @returns the MSHR, or NULL if there are no resources for it this cycle
+*/
+mshr_t *direct_cache_queue_prefetch(direct_cache_t *cache, uint32_t address, word_t *data, bool *ready);
+
+/* @brief Moves a whole block (e.g. out of a stream buffer) into the cache
+*  @returns false if the block it replaces can not be written back yet
+*/
+bool direct_cache_install_block(direct_cache_t *cache, cache_access_t *info, word_t *data);
+
+/* @brief Returns true if the block holding address is in the cache, its
+*  victim cache or on its way into the cache
+*/
+bool direct_cache_holds(direct_cache_t *cache, uint32_t address);
+
+/* @brief Completes every outstanding fill and writes all dirty blocks
+*  (including those in the victim cache) straight to main memory, without
+*  modelling any timing
+*/
+void direct_cache_flush(direct_cache_t *cache);
+
+/* @brief Registers the access, miss and replacement counters of the cache
+*  with the statistics registry under group, see stats.h
+*/
+void direct_cache_register_stats(direct_cache_t *cache, const char *group);
 
-cache_status_t direct_cache_access_word(direct_cache_t *cache, cache_access_t *info);
+/* @brief Another cache asked for the block holding address. A dirty copy is
+*  written straight to memory, then the copy is dropped if invalidate is set
+*  or downgraded to shared otherwise. *supplied is set if data was written.
+*  @returns the state the block was in, COH_INVALID if the cache doesn't have it
+*/
+coherence_state_t direct_cache_snoop(direct_cache_t *cache, uint32_t address, bool invalidate, bool *supplied);
+
+/* @brief Returns the coherence state of the block holding address, filling
+*  or not, COH_INVALID if the cache doesn't have it
+*/
+coherence_state_t direct_cache_state(direct_cache_t *cache, uint32_t address);
 
-void direct_cache_queue_mem_access(direct_cache_t *cache, cache_access_t info);
+/* @brief Returns the number of MSHRs currently waiting on memory */
+uint32_t direct_cache_mshrs_busy(direct_cache_t *cache);
 
 /* Helper functions specific to the direct mapped cache */
 void direct_cache_get_tag_and_index(cache_access_t *info, direct_cache_t *cache, uint32_t *address);
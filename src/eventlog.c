@@ -0,0 +1,472 @@
+/* src/eventlog.c
+* Debug events, recorded in binary and rendered as text
+*/
+
+#include <pthread.h>
+#include "eventlog.h"
+
+extern int flags;
+
+typedef struct EVENT_FORMAT {
+    const char *header;             //in colour, before the rest
+    const char *format;
+    const char * const *names;      //what %N prints, by argument
+} event_format_t;
+
+//Names the subsystems go by in --event-filter
+static const char * const EVENT_SUBSYSTEM_STRINGS[] = {
+    "fetch", "decode", "execute", "memory", "writeback", "hazard", "cache", "main", NULL
+};
+
+static const char * const EVENT_SIGN_EXTEND_STRINGS[] = {"SEB", "SEH"};
+static const char * const EVENT_BRANCH_STRINGS[] = {"BNE", "BEQ", "BLTZ", "BGTZ", "BLEZ", "JR"};
+static const char * const EVENT_MEM_STATUS_STRINGS[] = {"MEM_IDLE", "MEM_WRITING", "MEM_READING_D", "MEM_READING_I", "UNDEFINED"};
+static const char * const EVENT_FILL_STRINGS[] = {"block", "stream slot for block"};
+static const char * const EVENT_SNOOP_STRINGS[] = {"shared", "invalidated"};
+static const char * const EVENT_PREFETCH_STRINGS[] = {"a stream buffer", "the cache"};
+static const char * const EVENT_PATH_STRINGS[] = {"wrong path", "retrieved"};
+static const char * const EVENT_TAKEN_STRINGS[] = {"not taken", "taken", "not taken, mispredicted", "taken, mispredicted"};
+static const char * const EVENT_DIRTY_STRINGS[] = {"", " (dirty)"};
+static const char * const EVENT_MAIN_STRINGS[] = {"mem_read_w", "mem_read_h", "mem_read_b", "mem_write_w", "mem_write_h", "mem_write_b"};
+
+/* The text of every event. Conversions take the next argument, or the one
+*  numbered as in printf ("%2$d"), %R prints it as a register name and %N
+*  as one of names
+*/
+static const event_format_t EVENT_FORMATS[EVENT_IDS] = {
+    [EV_FETCH]                  = {"FETCH:\n", "\tretrieved instruction 0x%08x at 0x%08x\n", NULL},
+    [EV_FETCH_MISS]             = {"FETCH:\n", "\tCACHE MISS at 0x%08x\n", NULL},
+    [EV_FETCH_REPLAY]           = {"FETCH (replay):\n", "\t%N instruction 0x%08x at 0x%08x\n", EVENT_PATH_STRINGS},
+    [EV_BPU_RETURN]             = {NULL, "\tbpu_predict: 0x%08x returns to 0x%08x\n", NULL},
+    [EV_BPU_PREDICT]            = {NULL, "\tbpu_predict: 0x%08x predicted %N (target 0x%08x)\n", EVENT_TAKEN_STRINGS},
+    [EV_DECODE]                 = {"DECODE: \n", NULL, NULL},
+    [EV_DECODE_CONTROL]         = {NULL, NULL, NULL},
+    [EV_EXECUTE]                = {"EXECUTE: \n",
+                                    "\tInstruction: 0x%08x\n"
+                                    "\tALUOp:     0x%08x\n"
+                                    "\tArg1:      0x%08x\t(0d%3$d)\n"
+                                    "\tArg2:      0x%4$08x\t(0d%4$d)\n"
+                                    "\tshamt:     0x%5$02x\t\t(0d%5$d)\n"
+                                    "\tALUresult: 0x%6$08x\t(0d%6$d)\n", NULL},
+    [EV_ALU_OVERFLOW]           = {NULL,
+                                    "ALU::OPR_ADD: OVERFLOW! rs: %d, rt: %d, temp: %d; rs.31: %d, rt.31: %d, temp.31: %d\n", NULL},
+    [EV_ALU_SIGN_EXTEND]        = {NULL, "ALU::OPR_%N: rt = %x, result = %x\n", EVENT_SIGN_EXTEND_STRINGS},
+    [EV_MEMORY]                 = {"MEMORY:\n", "\tInstruction: 0x%08x\n", NULL},
+    [EV_MEMORY_DONE]            = {NULL, "\tAccess already performed, not repeating it\n", NULL},
+    [EV_MEMORY_LOAD]            = {NULL, "\tLoaded 0x%08x from address 0x%08x\n", NULL},
+    [EV_MEMORY_STORE]           = {NULL, "\tStored 0x%08x to address 0x%08x\n", NULL},
+    [EV_MEMORY_STORE_MISS]      = {NULL, "\tTried to store 0x%08x to address 0x%08x\n", NULL},
+    [EV_WRITEBACK]              = {"WRITE: \n", "\tInstruction: 0x%08x\n", NULL},
+    [EV_WRITEBACK_REG]          = {NULL, "\tWriting 0x%08x to register 0x%02x (0d%2$d, $%2$R)\n", NULL},
+    [EV_HAZARD]                 = {"HAZARD:\n", "", NULL},
+    [EV_HAZARD_WIDE]            = {"HAZARD (%d lanes, %d fetched):\n", "", NULL},
+    [EV_HAZARD_RECALC]          = {NULL, "\tRecalculating %N\n", EVENT_BRANCH_STRINGS},
+    [EV_HAZARD_TAKEN]           = {NULL, "\tBranch will be taken\n", NULL},
+    [EV_HAZARD_MISS]            = {NULL, "\tcache miss! Restoring the pipeline\n", NULL},
+    [EV_BPU_UPDATE]             = {NULL, "\tbpu_update: 0x%08x %N\n", EVENT_TAKEN_STRINGS},
+    [EV_CACHE_DIGEST]           = {"CACHE DIGEST:\n", "", NULL},
+    [EV_CACHE_BUS]              = {NULL, "\tcache_digest: Memory state is %N\n", EVENT_MEM_STATUS_STRINGS},
+    [EV_DCACHE_READ]            = {"D_CACHE GET WORD:\n", "", NULL},
+    [EV_DCACHE_WRITE]           = {"D_CACHE WRITE WORD:\n", "", NULL},
+    [EV_ICACHE_READ]            = {"I_CACHE GET WORD:\n", "", NULL},
+    [EV_WB_FULL]                = {NULL, "\twrite_buffer_enqueue: Write buffer is full!\n", NULL},
+    [EV_WB_BLOCK]               = {NULL, "\twrite_buffer_enqueue: filling write buffer with block at address 0x%08x\n", NULL},
+    [EV_WB_WORD_FULL]           = {NULL, "\twrite_buffer_enqueue_word: Write buffer is full!\n", NULL},
+    [EV_WB_WORD]                = {NULL,
+                                    "\twrite_buffer_enqueue_word: filling write buffer with 0x%08x (mask 0x%08x) for address 0x%08x\n", NULL},
+    [EV_DIRECT_FILL]            = {NULL,
+                                    "\tdirect_cache_fill_word: filled 0x%08x from address 0x%08x into %N %d, word %d\n", EVENT_FILL_STRINGS},
+    [EV_DIRECT_MSHR_WAIT]       = {NULL,
+                                    "\tdirect_cache_digest: MSHR %d penalty_count %d, pending address: 0x%08x\n", NULL},
+    [EV_DIRECT_LOOKUP]          = {NULL, "\tdirect_cache_read_w: looking for address 0x%08x\n", NULL},
+    [EV_DIRECT_BLOCK]           = {NULL, "\tdirect_cache_read_w: Reading from cache block %d\n", NULL},
+    [EV_DIRECT_HIT]             = {NULL,
+                                    "\tdirect_cache_read_w: CACHE_HIT Found valid data 0x%08x for address 0x%08x in block: %d, inner_index: %d\n", NULL},
+    [EV_DIRECT_DIRTY]           = {NULL, "\tdirect_cache_read_w: Block is dirty\n", NULL},
+    [EV_DIRECT_MISS]            = {NULL,
+                                    "\tdirect_cache_read_w: CACHE_MISS: Data at requested address is not in the cache\n", NULL},
+    [EV_DIRECT_MISS_PENDING]    = {NULL, "\tdirect_cache_read_w: CACHE_MISS, block is already being fetched.\n", NULL},
+    [EV_DIRECT_MISS_QUEUED]     = {NULL,
+                                    "\tdirect_cache_read_w: CACHE_MISS, data is not in the cache. Queueing read\n", NULL},
+    [EV_DIRECT_WRITE_STALL]     = {NULL, "\tdirect_cache_write_w: Write buffer is full. Stalling the store.\n", NULL},
+    [EV_DIRECT_WRITE_HIT]       = {NULL, "\tdirect_cache_write_w: CACHE_HIT wrote 0x%08x to block %d, inner_index %d\n", NULL},
+    [EV_DIRECT_WRITE_MISS]      = {NULL,
+                                    "\tdirect_cache_write_w: no valid data in the cache for the specified address.\n", NULL},
+    [EV_DIRECT_SNOOP]           = {NULL, "\tdirect_cache_snoop: block 0x%08x in block %d %N\n", EVENT_SNOOP_STRINGS},
+    [EV_DIRECT_MSHR_CONFLICT]   = {NULL, "\tdirect_cache_free_mshr: block %d is being filled by MSHR %d\n", NULL},
+    [EV_DIRECT_MSHR_BUSY]       = {NULL, "\tdirect_cache_free_mshr: all %d MSHRs busy\n", NULL},
+    [EV_DIRECT_VICTIM_SWAP]     = {NULL, "\tdirect_cache_victim_swap: swapped block 0x%08x back into block %d\n", NULL},
+    [EV_DIRECT_CLAIM_DRAIN]     = {NULL, "\tdirect_cache_claim_block: waiting on the write buffer to drain 0x%08x\n", NULL},
+    [EV_DIRECT_CLAIM_FULL]      = {NULL,
+                                    "\tdirect_cache_claim_block: Write buffer is full. Cannot replace block without losing data.\n", NULL},
+    [EV_DIRECT_FILL_ADDRESS]    = {NULL, "\tdirect_cache_start_fill: Actual requested address will be 0x%08x\n", NULL},
+    [EV_DIRECT_QUEUE]           = {NULL, "\tdirect_cache_queue_mem_access: Queueing memory access for address 0x%08x\n", NULL},
+    [EV_DIRECT_PREFETCH]        = {NULL, "\tdirect_cache_queue_prefetch: prefetching block 0x%08x into %N\n", EVENT_PREFETCH_STRINGS},
+    [EV_PREFETCH_CANDIDATE]     = {NULL, "\tprefetch_enqueue: block 0x%08x is a prefetch candidate\n", NULL},
+    [EV_PREFETCH_STREAM]        = {NULL, "\tprefetch_stream_allocate: stream buffer %d follows block 0x%08x\n", NULL},
+    [EV_PREFETCH_STREAM_HIT]    = {NULL, "\tprefetch_stream_lookup: moved block 0x%08x from stream buffer %d into the cache\n", NULL},
+    [EV_VICTIM_FULL]            = {NULL, "\tvictim_insert: Write buffer is full, can't push out dirty block 0x%08x\n", NULL},
+    [EV_VICTIM_EVICT]           = {NULL, "\tvictim_insert: pushed out block 0x%08x\n", NULL},
+    [EV_VICTIM_INSERT]          = {NULL, "\tvictim_insert: caught block 0x%08x%N\n", EVENT_DIRTY_STRINGS},
+    [EV_MAIN_ACCESS]            = {NULL, "%N: address 0x%08x, data 0x%08x, array index %d\n", EVENT_MAIN_STRINGS}
+};
+
+const uint8_t event_subsystems[EVENT_IDS] = {
+    [EV_FETCH]                  = EVENTS_FETCH,
+    [EV_FETCH_MISS]             = EVENTS_FETCH,
+    [EV_FETCH_REPLAY]           = EVENTS_FETCH,
+    [EV_BPU_RETURN]             = EVENTS_FETCH,
+    [EV_BPU_PREDICT]            = EVENTS_FETCH,
+    [EV_DECODE]                 = EVENTS_DECODE,
+    [EV_DECODE_CONTROL]         = EVENTS_DECODE,
+    [EV_EXECUTE]                = EVENTS_EXECUTE,
+    [EV_ALU_OVERFLOW]           = EVENTS_EXECUTE,
+    [EV_ALU_SIGN_EXTEND]        = EVENTS_EXECUTE,
+    [EV_MEMORY]                 = EVENTS_MEMORY,
+    [EV_MEMORY_DONE]            = EVENTS_MEMORY,
+    [EV_MEMORY_LOAD]            = EVENTS_MEMORY,
+    [EV_MEMORY_STORE]           = EVENTS_MEMORY,
+    [EV_MEMORY_STORE_MISS]      = EVENTS_MEMORY,
+    [EV_WRITEBACK]              = EVENTS_WRITEBACK,
+    [EV_WRITEBACK_REG]          = EVENTS_WRITEBACK,
+    [EV_HAZARD]                 = EVENTS_HAZARD,
+    [EV_HAZARD_WIDE]            = EVENTS_HAZARD,
+    [EV_HAZARD_RECALC]          = EVENTS_HAZARD,
+    [EV_HAZARD_TAKEN]           = EVENTS_HAZARD,
+    [EV_HAZARD_MISS]            = EVENTS_HAZARD,
+    [EV_BPU_UPDATE]             = EVENTS_HAZARD,
+    [EV_CACHE_DIGEST]           = EVENTS_CACHE,
+    [EV_CACHE_BUS]              = EVENTS_CACHE,
+    [EV_DCACHE_READ]            = EVENTS_CACHE,
+    [EV_DCACHE_WRITE]           = EVENTS_CACHE,
+    [EV_ICACHE_READ]            = EVENTS_CACHE,
+    [EV_WB_FULL]                = EVENTS_CACHE,
+    [EV_WB_BLOCK]               = EVENTS_CACHE,
+    [EV_WB_WORD_FULL]           = EVENTS_CACHE,
+    [EV_WB_WORD]                = EVENTS_CACHE,
+    [EV_DIRECT_FILL]            = EVENTS_CACHE,
+    [EV_DIRECT_MSHR_WAIT]       = EVENTS_CACHE,
+    [EV_DIRECT_LOOKUP]          = EVENTS_CACHE,
+    [EV_DIRECT_BLOCK]           = EVENTS_CACHE,
+    [EV_DIRECT_HIT]             = EVENTS_CACHE,
+    [EV_DIRECT_DIRTY]           = EVENTS_CACHE,
+    [EV_DIRECT_MISS]            = EVENTS_CACHE,
+    [EV_DIRECT_MISS_PENDING]    = EVENTS_CACHE,
+    [EV_DIRECT_MISS_QUEUED]     = EVENTS_CACHE,
+    [EV_DIRECT_WRITE_STALL]     = EVENTS_CACHE,
+    [EV_DIRECT_WRITE_HIT]       = EVENTS_CACHE,
+    [EV_DIRECT_WRITE_MISS]      = EVENTS_CACHE,
+    [EV_DIRECT_SNOOP]           = EVENTS_CACHE,
+    [EV_DIRECT_MSHR_CONFLICT]   = EVENTS_CACHE,
+    [EV_DIRECT_MSHR_BUSY]       = EVENTS_CACHE,
+    [EV_DIRECT_VICTIM_SWAP]     = EVENTS_CACHE,
+    [EV_DIRECT_CLAIM_DRAIN]     = EVENTS_CACHE,
+    [EV_DIRECT_CLAIM_FULL]      = EVENTS_CACHE,
+    [EV_DIRECT_FILL_ADDRESS]    = EVENTS_CACHE,
+    [EV_DIRECT_QUEUE]           = EVENTS_CACHE,
+    [EV_DIRECT_PREFETCH]        = EVENTS_CACHE,
+    [EV_PREFETCH_CANDIDATE]     = EVENTS_CACHE,
+    [EV_PREFETCH_STREAM]        = EVENTS_CACHE,
+    [EV_PREFETCH_STREAM_HIT]    = EVENTS_CACHE,
+    [EV_VICTIM_FULL]            = EVENTS_CACHE,
+    [EV_VICTIM_EVICT]           = EVENTS_CACHE,
+    [EV_VICTIM_INSERT]          = EVENTS_CACHE,
+    [EV_MAIN_ACCESS]            = EVENTS_MAIN
+};
+
+uint32_t event_mask = EVENTS_ALL;
+uint32_t event_cycle = 0;
+
+//The records of one thread, and the list of every thread's
+typedef struct EVENT_THREAD {
+    uint32_t thread;
+    uint32_t count;
+    event_record_t records[EVENT_RING];
+    struct EVENT_THREAD *next;
+} event_ring_t;
+
+//What every run of records in the log starts with
+typedef struct EVENT_CHUNK {
+    uint32_t thread;
+    uint32_t count;
+} event_chunk_t;
+
+static _Thread_local event_ring_t *ring = NULL;
+static event_ring_t *rings = NULL;
+static uint32_t threads = 0;
+static FILE *log_fp = NULL;
+static pthread_mutex_t log_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Prints format with the arguments of record, next is the argument the
+*  next conversion without a number takes
+*/
+static void event_print(FILE *fp, const char *format, const event_record_t *record, const char * const *names, int *next){
+    for(const char *c = format; *c; c++){
+        if(*c != '%'){
+            fputc(*c, fp);
+            continue;
+        }
+        c++;
+        if(*c == '%'){
+            fputc('%', fp);
+            continue;
+        }
+        int arg;
+        if(*c >= '1' && *c <= '9' && c[1] == '$'){
+            arg = *c - '1';
+            c += 2;
+        } else {
+            arg = (*next)++;
+        }
+        char spec[8] = "%";
+        int length = 1;
+        while(((*c >= '0' && *c <= '9') || *c == '-') && length < 6){
+            spec[length++] = *c++;
+        }
+        word_t value = arg < EVENT_ARGS ? record->args[arg] : 0;
+        if(*c == 'R'){
+            fputs(get_register_name_string(value & 0x1f), fp);
+        } else if(*c == 'N'){
+            fputs(names != NULL ? names[value] : "?", fp);
+        } else {
+            spec[length++] = *c;
+            spec[length] = '\0';
+            fprintf(fp, spec, value);
+        }
+    }
+}
+
+/* The decode stage prints the whole ID/EX register, which takes two
+*  records, EV_DECODE and EV_DECODE_CONTROL right after it
+*/
+static _Thread_local event_record_t decoded;
+
+static void event_print_decode(FILE *fp, const event_record_t *control){
+    word_t *args = decoded.args;
+    //A byte of each small field and of each control bit
+    uint32_t fields = args[1];
+    uint64_t bits = control->args[1] | (uint64_t)control->args[2] << 32;
+    uint8_t rs = fields >> 8, rt = fields >> 16, rd = fields >> 24;
+    fprintf(fp, "\tInstruction: 0x%08x\n", args[0]);
+    fprintf(fp, "\tPipeline Register: %s\n", "ID/EX");
+    fprintf(fp, "\tDecoded Instruction: \n");
+    fprintf(fp, "\t    reg->opCode:     0x%02x\n", (uint8_t)fields);
+    fprintf(fp, "\t    reg->regRs:      0x%02x\t(0d%d, $%s)\n", rs, rs, get_register_name_string(rs));
+    fprintf(fp, "\t    reg->regRt:      0x%02x\t(0d%d, $%s)\n", rt, rt, get_register_name_string(rt));
+    fprintf(fp, "\t    reg->regRd:      0x%02x\t(0d%d, $%s)\n", rd, rd, get_register_name_string(rd));
+    fprintf(fp, "\t    reg->shamt:      0x%02x\t(0d%d)\n", (uint8_t)args[2], (uint8_t)args[2]);
+    fprintf(fp, "\t    reg->funct:      0x%02x\n", (uint8_t)(args[2] >> 8));
+    fprintf(fp, "\t    reg->immed:      0x%04x\t(0d%d)\n", args[3], args[3]);
+    fprintf(fp, "\t    reg->address:    0x%08x\n", args[4]);
+    fprintf(fp, "\t    reg->pcNext:     0x%08x\n", args[5]);
+    fprintf(fp, "\t    reg->regRtValue: 0x%08x\t(0d%d)\n", args[6], args[6]);
+    fprintf(fp, "\t    reg->regRsValue: 0x%08x\t(0d%d)\n", args[7], args[7]);
+    fprintf(fp, "\t    reg->ALUresult:  0x%08x\t(0d%d)\n", control->args[0], control->args[0]);
+    fprintf(fp, "\tRegister control bits:\n");
+    fprintf(fp, "\t    reg->regDst:     %01d\n", (uint8_t)(bits >> 0));
+    fprintf(fp, "\t    reg->ALUSrc:     %01d\n", (uint8_t)(bits >> 8));
+    fprintf(fp, "\t    reg->memToReg:   %01d\n", (uint8_t)(bits >> 16));
+    fprintf(fp, "\t    reg->regWrite:   %01d\n", (uint8_t)(bits >> 24));
+    fprintf(fp, "\t    reg->memRead:    %01d\n", (uint8_t)(bits >> 32));
+    fprintf(fp, "\t    reg->memWrite:   %01d\n", (uint8_t)(bits >> 40));
+    fprintf(fp, "\t    reg->PCSrc:      %01d\n", (uint8_t)(bits >> 48));
+    fprintf(fp, "\t    reg->jump:       %01d\n\n", (uint8_t)(bits >> 56));
+}
+
+/* Renders record the way the stages printed it, the header on head_fp */
+static void event_render(FILE *head_fp, FILE *fp, const event_record_t *record){
+    const event_format_t *format = &EVENT_FORMATS[record->id];
+    int next = 0;
+    if(format->header != NULL){
+        if(flags & MASK_COLOR){
+            fputs(ANSI_C_CYAN, head_fp);
+        }
+        event_print(head_fp, format->header, record, format->names, &next);
+        if(flags & MASK_COLOR){
+            fputs(ANSI_RESET, head_fp);
+        }
+    }
+    if(record->id == EV_DECODE){
+        decoded = *record;
+    } else if(record->id == EV_DECODE_CONTROL){
+        event_print_decode(fp, record);
+    } else {
+        event_print(fp, format->format, record, format->names, &next);
+    }
+}
+
+/* Appends the records of r to the log */
+static void event_ring_write(event_ring_t *r){
+    if(r->count == 0){
+        return;
+    }
+    event_chunk_t chunk = {r->thread, r->count};
+    pthread_mutex_lock(&log_lock);
+    if(log_fp != NULL){
+        fwrite(&chunk, sizeof(event_chunk_t), 1, log_fp);
+        fwrite(r->records, sizeof(event_record_t), r->count, log_fp);
+    }
+    pthread_mutex_unlock(&log_lock);
+    r->count = 0;
+}
+
+void event_record(event_id_t id, word_t a, word_t b, word_t c, word_t d, word_t e, word_t f, word_t g, word_t h){
+    event_record_t live;
+    event_record_t *record = &live;
+    if(flags & MASK_EVENTS){
+        if(ring == NULL){
+            ring = (event_ring_t *)malloc(sizeof(event_ring_t));
+            if(ring == NULL){
+                cprintf(ANSI_C_RED, "event_record: unable to allocate a ring\n");
+                assert(0);
+            }
+            ring->count = 0;
+            pthread_mutex_lock(&log_lock);
+            ring->thread = threads++;
+            ring->next = rings;
+            rings = ring;
+            pthread_mutex_unlock(&log_lock);
+        }
+        record = &ring->records[ring->count];
+    }
+    record->cycle = event_cycle;
+    record->id = id;
+    record->unused = 0;
+    record->args[0] = a;
+    record->args[1] = b;
+    record->args[2] = c;
+    record->args[3] = d;
+    record->args[4] = e;
+    record->args[5] = f;
+    record->args[6] = g;
+    record->args[7] = h;
+    if(record == &live){
+        //The stages printed their headers with cprintf
+        event_render(stderr, stdout, record);
+    } else if(++ring->count == EVENT_RING){
+        event_ring_write(ring);
+    }
+}
+
+bool event_filter(const char *list){
+    uint32_t mask = 0;
+    const char *name = list;
+    while(*name){
+        size_t length = strcspn(name, ",");
+        bool found = false;
+        if(length == 3 && strncmp(name, "all", 3) == 0){
+            mask = EVENTS_ALL;
+            found = true;
+        }
+        for(int i = 0; EVENT_SUBSYSTEM_STRINGS[i] != NULL && !found; i++){
+            if(strlen(EVENT_SUBSYSTEM_STRINGS[i]) == length && strncmp(name, EVENT_SUBSYSTEM_STRINGS[i], length) == 0){
+                mask |= 1 << i;
+                found = true;
+            }
+        }
+        if(!found){
+            return false;
+        }
+        name += length;
+        if(*name == ','){
+            name++;
+        }
+    }
+    event_mask = mask;
+    return true;
+}
+
+bool event_log_open(const char *path){
+    log_fp = fopen(path, "wb");
+    if(log_fp == NULL){
+        return false;
+    }
+    uint32_t header[2] = {EVENT_VERSION, sizeof(event_record_t)};
+    fwrite(EVENT_MAGIC, 1, 8, log_fp);
+    fwrite(header, sizeof(uint32_t), 2, log_fp);
+    flags |= MASK_EVENTS;
+    if(flags & MASK_DEBUG){
+        printf("event_log_open: logging to %s, %d records a ring\n", path, EVENT_RING);
+    }
+    return true;
+}
+
+void event_log_close(void){
+    if(log_fp == NULL){
+        return;
+    }
+    //Oldest thread first, the list is newest first
+    event_ring_t *ordered = NULL;
+    while(rings != NULL){
+        event_ring_t *r = rings;
+        rings = r->next;
+        r->next = ordered;
+        ordered = r;
+    }
+    while(ordered != NULL){
+        event_ring_t *r = ordered;
+        ordered = r->next;
+        event_ring_write(r);
+        free(r);
+    }
+    ring = NULL;
+    threads = 0;
+    fclose(log_fp);
+    log_fp = NULL;
+    flags &= ~MASK_EVENTS;
+}
+
+bool event_decode(const char *path, FILE *fp){
+    FILE *in = fopen(path, "rb");
+    if(in == NULL){
+        cprintf(ANSI_C_RED, "Unable to open event log %s\n", path);
+        return false;
+    }
+    char magic[8];
+    uint32_t header[2];
+    if(fread(magic, 1, 8, in) != 8 || memcmp(magic, EVENT_MAGIC, 8) != 0 ||
+        fread(header, sizeof(uint32_t), 2, in) != 2 ||
+        header[0] != EVENT_VERSION || header[1] != sizeof(event_record_t)){
+        cprintf(ANSI_C_RED, "%s is not an event log of this version\n", path);
+        fclose(in);
+        return false;
+    }
+    event_chunk_t chunk;
+    uint32_t thread = 0;
+    uint32_t cycle = UINT32_MAX;
+    uint32_t records = 0;
+    while(fread(&chunk, sizeof(event_chunk_t), 1, in) == 1){
+        if(chunk.thread != thread){
+            fprintf(fp, "Thread %d:\n", chunk.thread);
+            thread = chunk.thread;
+            cycle = UINT32_MAX;
+        }
+        for(uint32_t i = 0; i < chunk.count; i++){
+            event_record_t record;
+            if(fread(&record, sizeof(event_record_t), 1, in) != 1){
+                cprintf(ANSI_C_YELLOW, "%s ends in the middle of a record\n", path);
+                fclose(in);
+                return false;
+            }
+            if(record.id >= EVENT_IDS){
+                cprintf(ANSI_C_RED, "Unknown event %d in %s\n", record.id, path);
+                fclose(in);
+                return false;
+            }
+            if(!(event_mask & event_subsystems[record.id])){
+                continue;
+            }
+            if(record.cycle != cycle){
+                fprintf(fp, "Cycle %d:\n", record.cycle);
+                cycle = record.cycle;
+            }
+            event_render(fp, fp, &record);
+            records++;
+        }
+    }
+    fclose(in);
+    if(flags & MASK_VERBOSE){
+        printf("%d events decoded from %s\n", records, path);
+    }
+    return true;
+}
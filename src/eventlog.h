@@ -0,0 +1,153 @@
+/* src/eventlog.h
+* Debug events. The stages, caches and main memory report what they do as
+* fixed size records (an event number, the cycle and up to EVENT_ARGS words)
+* instead of formatting text themselves. With --debug every record is
+* rendered as it happens, as the text the stages used to print. With
+* --event-log the records go to a ring of the calling thread instead, which
+* is written to the log file in one piece whenever it fills up, and
+* --event-decode renders a log afterwards.
+*
+* Every event belongs to a subsystem, and --event-filter picks the ones that
+* are recorded (and the ones a log is decoded with).
+*/
+
+#ifndef _EVENTLOG_H
+#define _EVENTLOG_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <assert.h>
+#include "util.h"
+#include "types.h"
+
+//Words of arguments in a record
+#define EVENT_ARGS 8
+//Records in the ring of a thread, written out when it fills up
+#define EVENT_RING 4096
+//Start of a log file, and its version
+#define EVENT_MAGIC "MIPSEVTS"
+#define EVENT_VERSION 1
+
+typedef enum EVENT_SUBSYSTEM {
+    EVENTS_FETCH        = 1<<0,
+    EVENTS_DECODE       = 1<<1,
+    EVENTS_EXECUTE      = 1<<2,
+    EVENTS_MEMORY       = 1<<3,     //the memory stage
+    EVENTS_WRITEBACK    = 1<<4,
+    EVENTS_HAZARD       = 1<<5,
+    EVENTS_CACHE        = 1<<6,     //caches, MSHRs, write buffer and bus
+    EVENTS_MAIN         = 1<<7,     //main memory
+    EVENTS_ALL          = (1<<8) - 1
+} event_subsystem_t;
+
+typedef enum EVENT_ID {
+    EV_FETCH,
+    EV_FETCH_MISS,
+    EV_FETCH_REPLAY,
+    EV_BPU_RETURN,
+    EV_BPU_PREDICT,
+    EV_DECODE,
+    EV_DECODE_CONTROL,
+    EV_EXECUTE,
+    EV_ALU_OVERFLOW,
+    EV_ALU_SIGN_EXTEND,
+    EV_MEMORY,
+    EV_MEMORY_DONE,
+    EV_MEMORY_LOAD,
+    EV_MEMORY_STORE,
+    EV_MEMORY_STORE_MISS,
+    EV_WRITEBACK,
+    EV_WRITEBACK_REG,
+    EV_HAZARD,
+    EV_HAZARD_WIDE,
+    EV_HAZARD_RECALC,
+    EV_HAZARD_TAKEN,
+    EV_HAZARD_MISS,
+    EV_BPU_UPDATE,
+    EV_CACHE_DIGEST,
+    EV_CACHE_BUS,
+    EV_DCACHE_READ,
+    EV_DCACHE_WRITE,
+    EV_ICACHE_READ,
+    EV_WB_FULL,
+    EV_WB_BLOCK,
+    EV_WB_WORD_FULL,
+    EV_WB_WORD,
+    EV_DIRECT_FILL,
+    EV_DIRECT_MSHR_WAIT,
+    EV_DIRECT_LOOKUP,
+    EV_DIRECT_BLOCK,
+    EV_DIRECT_HIT,
+    EV_DIRECT_DIRTY,
+    EV_DIRECT_MISS,
+    EV_DIRECT_MISS_PENDING,
+    EV_DIRECT_MISS_QUEUED,
+    EV_DIRECT_WRITE_STALL,
+    EV_DIRECT_WRITE_HIT,
+    EV_DIRECT_WRITE_MISS,
+    EV_DIRECT_SNOOP,
+    EV_DIRECT_MSHR_CONFLICT,
+    EV_DIRECT_MSHR_BUSY,
+    EV_DIRECT_VICTIM_SWAP,
+    EV_DIRECT_CLAIM_DRAIN,
+    EV_DIRECT_CLAIM_FULL,
+    EV_DIRECT_FILL_ADDRESS,
+    EV_DIRECT_QUEUE,
+    EV_DIRECT_PREFETCH,
+    EV_PREFETCH_CANDIDATE,
+    EV_PREFETCH_STREAM,
+    EV_PREFETCH_STREAM_HIT,
+    EV_VICTIM_FULL,
+    EV_VICTIM_EVICT,
+    EV_VICTIM_INSERT,
+    EV_MAIN_ACCESS,
+    EVENT_IDS
+} event_id_t;
+
+typedef struct EVENT_RECORD {
+    uint32_t cycle;
+    uint16_t id;
+    uint16_t unused;
+    word_t args[EVENT_ARGS];
+} event_record_t;
+
+//Subsystems recorded, all unless --event-filter says otherwise
+extern uint32_t event_mask;
+//Cycle the records are stamped with, set by the main loop
+extern uint32_t event_cycle;
+extern const uint8_t event_subsystems[EVENT_IDS];
+
+/* @brief Records event id with its arguments, rendering it right away
+*  unless a log is open
+*/
+void event_record(event_id_t id, word_t a, word_t b, word_t c, word_t d, word_t e, word_t f, word_t g, word_t h);
+
+//Records an event of a subsystem that is being debugged or logged, the
+//arguments that aren't given are 0
+#define EVENT(id, ...) EVENT_(id, ##__VA_ARGS__, 0, 0, 0, 0, 0, 0, 0, 0)
+#define EVENT_(id, a, b, c, d, e, f, g, h, ...) do { \
+    if ((flags & (MASK_DEBUG | MASK_EVENTS)) && (event_mask & event_subsystems[id])) \
+        event_record(id, a, b, c, d, e, f, g, h); \
+} while (0)
+
+/* @brief Parses a comma separated list of subsystems into event_mask
+*  @returns false if one of them isn't a subsystem
+*/
+bool event_filter(const char *list);
+
+/* @brief Opens path for the binary log and sets MASK_EVENTS
+*  @returns false if it can't be written
+*/
+bool event_log_open(const char *path);
+
+/* @brief Writes the rings of every thread out and closes the log */
+void event_log_close(void);
+
+/* @brief Renders the log at path as text on fp, the subsystems in
+*  event_mask only
+*  @returns false if it isn't a log
+*/
+bool event_decode(const char *path, FILE *fp);
+
+#endif /* _EVENTLOG_H */
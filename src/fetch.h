@@ -12,9 +12,15 @@
 #include "util.h"
 #include "main_memory.h"
 #include "cache.h"
+#include "branch.h"
 
 void fetch(control_t *, pc_t * pc, cache_config_t *cache_cfg);
 
+/* @brief Breaks ifid->instr into the opcode, register, shift, function,
+*  jump address and (sign extended) immediate fields
+*/
+void fetch_fields(control_t *ifid);
+
 //Instruction decoding bitmasks
 #define OP_MASK 0xFC000000
 #define RS_MASK 0x03E00000
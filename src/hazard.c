@@ -2,29 +2,95 @@
 * Hazard detection unit. Control and data hazard detection and forwarding
 */
 #include "hazard.h"
+#include "registers.h"
+#include "eventlog.h"
 
 extern int flags;
 
-control_t *ifid_backup;
-control_t *idex_backup;
-control_t *exmem_backup;
-control_t *memwb_backup;
-pc_t pc_backup;
+//Each host thread running cores has its own, see hazard_init()
+_Thread_local control_t *ifid_backup;
+_Thread_local control_t *idex_backup;
+_Thread_local control_t *exmem_backup;
+_Thread_local control_t *memwb_backup;
+_Thread_local pc_t pc_backup;
 
+_Thread_local stall_cause_t stall_cause = STALL_NONE;
+_Thread_local pc_t stall_pc = 0;
 
+//Backups of every lane for hazard_group()
+static control_t *ifid_group_backup[ISSUE_MAX_WIDTH];
+static control_t *idex_group_backup[ISSUE_MAX_WIDTH];
+static control_t *exmem_group_backup[ISSUE_MAX_WIDTH];
+static control_t *memwb_group_backup[ISSUE_MAX_WIDTH];
+static int group_width = 0;
 
+void hazard_recheck_branch(control_t *idex){
+    if(idex->opCode == OPC_BNE){
+        EVENT(EV_HAZARD_RECALC, 0); //BNE
+        if(idex->regRsValue != idex->regRtValue){
+            //Branch taken!
+            idex->PCSrc = true;
+        }
+        else{
+            idex->PCSrc = false;
+        }
+    }
+    else if(idex->opCode == OPC_BEQ){
+        EVENT(EV_HAZARD_RECALC, 1); //BEQ
+        if(idex->regRsValue == idex->regRtValue){
+            //Branch taken!
+            idex->PCSrc = true;
+        }
+        else{
+            idex->PCSrc = false;
+        }
+    }
+    else if (idex->opCode == OPC_BLTZ){
+        EVENT(EV_HAZARD_RECALC, 2); //BLTZ
+        if((int)idex->regRsValue < 0){
+            idex->PCSrc = true;
+        }
+        else{
+            idex->PCSrc = false;
+        }
+    }
+    else if (idex->opCode == OPC_BGTZ){
+        EVENT(EV_HAZARD_RECALC, 3); //BGTZ
+        if((int)idex->regRsValue > 0){
+            idex->PCSrc = true;
+        }
+        else{
+            idex->PCSrc = false;
+        }
+    }
+    else if (idex->opCode == OPC_BLEZ){
+        EVENT(EV_HAZARD_RECALC, 4); //BLEZ
+        if((int)idex->regRsValue <= 0){
+            idex->PCSrc = true;
+        }
+        else{
+            idex->PCSrc = false;
+        }
+    }
+    else if((idex->opCode == OPC_RTYPE) && (idex->funct == FNC_JR)){
+        EVENT(EV_HAZARD_RECALC, 5); //JR
+        idex->pcNext = idex->regRsValue;
+    }
+    if(idex->PCSrc){
+        EVENT(EV_HAZARD_TAKEN);
+    }
+}
 
 int hazard(control_t *ifid, control_t *idex, control_t *exmem, control_t *memwb, pc_t *pc, cache_config_t *cache_cfg){
 
     bool forward = false;
     pc_backup = *pc;
 
-    if(flags & MASK_DEBUG){
-        cprintf(ANSI_C_CYAN, "HAZARD:\n");
-    }
+    EVENT(EV_HAZARD);
 
     //Reset stall
     bool stall = false;
+    stall_cause = STALL_NONE;
 
 
     //Our destination register could be Rd or Rt
@@ -108,86 +174,33 @@ int hazard(control_t *ifid, control_t *idex, control_t *exmem, control_t *memwb,
 
     //Recheck the outcome of the branch if there was a forward that occured.
     if(forward){
-        if(idex->opCode == OPC_BNE){
-            if(flags & MASK_DEBUG){
-                printf("\tRecalculating BNE\n");
-            }
-            if(idex->regRsValue != idex->regRtValue){
-                //Branch taken!
-                idex->PCSrc = true;
-            }
-            else{
-                idex->PCSrc = false;
-            }
-        }
-        else if(idex->opCode == OPC_BEQ){
-            if(flags & MASK_DEBUG){
-                printf("\tRecalculating BEQ\n");
-            }
-            if(idex->regRsValue == idex->regRtValue){
-                //Branch taken!
-                idex->PCSrc = true;
-            }
-            else{
-                idex->PCSrc = false;
-            }
-        }
-        else if (idex->opCode == OPC_BLTZ){
-            if(flags & MASK_DEBUG){
-                printf("\tRecalculating BLTZ\n");
-            }
-            if((int)idex->regRsValue < 0){
-                idex->PCSrc = true;
-            }
-            else{
-                idex->PCSrc = false;
-            }
-        }
-        else if (idex->opCode == OPC_BGTZ){
-            if(flags & MASK_DEBUG){
-                printf("\tRecalculating BGTZ\n");
-            }
-            if((int)idex->regRsValue > 0){
-                idex->PCSrc = true;
-            }
-            else{
-                idex->PCSrc = false;
-            }
-        }
-        else if (idex->opCode == OPC_BLEZ){
-            if(flags & MASK_DEBUG){
-                printf("\tRecalculating BLEZ\n");
-            }
-            if((int)idex->regRsValue <= 0){
-                idex->PCSrc = true;
-            }
-            else{
-                idex->PCSrc = false;
-            }
-        }
-        else if((idex->opCode == OPC_RTYPE) && (idex->funct == FNC_JR)){
-            if(flags & MASK_DEBUG){
-                printf("\tRecalculating JR\n");
-            }
-            idex->pcNext = idex->regRsValue;
-        }
-        if(flags & MASK_DEBUG){
-            if(idex->PCSrc){
-                printf("\tBranch will be taken\n");
-            }
-        }
+        hazard_recheck_branch(idex);
     }
 
 
+    //With a branch predictor, branches and jumps resolve in execute. The
+    //instruction fetched this cycle is the one after the delay slot, it is
+    //on the wrong path if it isn't where the branch actually goes.
+    bool resolved = bpu_enabled() && bpu_is_control(exmem);
+    bool mispredict = false;
+    pc_t actual_next = 0;
+    if(resolved){
+        actual_next = bpu_actual_next(exmem);
+        mispredict = ifid->pc != actual_next;
+    }
+
     //Hazard detection logic
     //If a load is immediately followed be an instruction that uses the result
     //Of the load, then detect it, stall the pipeline, and flush ifid to become nop
-    if(idex->memRead && ((idex->regRt == ifid->regRs) || (idex->regRt == ifid->regRt)) && !(ifid->opCode == OPC_J || ifid->opCode == OPC_JAL)){
+    //sc's result also comes out of memory, so it stalls its users too
+    if((idex->memRead || idex->opCode == OPC_SC) && ((idex->regRt == ifid->regRs) || (idex->regRt == ifid->regRt)) && !(ifid->opCode == OPC_J || ifid->opCode == OPC_JAL)){
         //Stall the pipeline, data dependency after a load
         if(flags & MASK_VERBOSE){
             printf("\tFound dependency on load result: stalling pipeline\n");
         }
         stall = true;
+        stall_cause = STALL_LOAD_USE;
+        stall_pc = idex->pc;
         flush(ifid);
     }
 
@@ -197,7 +210,30 @@ int hazard(control_t *ifid, control_t *idex, control_t *exmem, control_t *memwb,
     //the idex pipeline register. If it was taken, udpate the program counter
     //to the new calculated value and flush IFID. Jumps are also treated the
     //as branches, so IFID will be flushed for all jump instructions.
-    if(idex->jump || idex->PCSrc){
+    if(mispredict){
+        //Wrong path, throw it away and fetch where the branch goes
+        if(flags & MASK_VERBOSE){
+            printf("\tBranch at 0x%08x mispredicted: flushing and fetching 0x%08x\n", exmem->pc, actual_next);
+        }
+        flush(ifid);
+        bpu_squash();
+        *pc = actual_next;
+        stall_cause = STALL_CONTROL;
+        stall_pc = exmem->pc;
+    }
+    else if(bpu_enabled()){
+        //Fetch follows the prediction made for the instruction before the
+        //delay slot, stalls work the same as without a predictor
+        if(stall){
+            flush(ifid);
+            bpu_squash();
+        } else if(idex->predTaken){
+            *pc = idex->predTarget;
+        } else {
+            *pc = *pc + 4;
+        }
+    }
+    else if(idex->jump || idex->PCSrc){
         //Jump or branch occured, flush ifid
         if(flags & MASK_VERBOSE){
             printf("\tBranching or Jumping: inserting nop and overriding pc\n");
@@ -217,22 +253,53 @@ int hazard(control_t *ifid, control_t *idex, control_t *exmem, control_t *memwb,
         *pc = *pc + 4;
     }
 
+    //A miss fetching down the wrong path doesn't hold anything up
+    bool restored = false;
     if(cache_cfg->inst_enabled || cache_cfg->data_enabled){
-        if(memwb->status == CACHE_MISS || ifid->status == CACHE_MISS){
-            if(flags & MASK_DEBUG){
-                printf("\tcache miss! Restoring the pipeline\n");
+        if(memwb->status == CACHE_MISS || (ifid->status == CACHE_MISS && !mispredict)){
+            restored = true;
+            EVENT(EV_HAZARD_MISS);
+            //If only the fetch missed, the memory stage finished its access
+            //this cycle. Remember that so it isn't performed twice.
+            bool mem_done = (memwb->memRead || memwb->memWrite) && memwb->status != CACHE_MISS;
+            if(memwb->status == CACHE_MISS){
+                stall_cause = STALL_D_MISS;
+                stall_pc = memwb->pc;
+            } else {
+                stall_cause = STALL_I_MISS;
+                stall_pc = ifid->pc;
             }
+            word_t mem_data = memwb->memData;
             restore(ifid, idex, exmem, memwb, pc);
+            //The fetch of this cycle will be done again
+            bpu_squash();
+            exmem->memDone = mem_done;
+            if(mem_done){
+                exmem->memData = mem_data;
+            }
         }
     }
+    //The branch only counts once the cycle it resolved in sticks
+    if(resolved && !restored){
+        bpu_update(exmem, mispredict);
+    }
     return 0;
 }
 
 
+stall_cause_t hazard_stall_cause(pc_t *pc){
+    *pc = stall_pc;
+    return stall_cause;
+}
+
 void hazard_init(void){
     pipeline_init(&ifid_backup, &idex_backup, &exmem_backup, &memwb_backup, &pc_backup, 0);
 }
 
+void hazard_free(void){
+    pipeline_destroy(&ifid_backup, &idex_backup, &exmem_backup, &memwb_backup);
+}
+
 void backup(control_t *ifid, control_t *idex, control_t *exmem, control_t *memwb, pc_t *pc){
     copy_pipeline_register(ifid, ifid_backup);
     copy_pipeline_register(idex, idex_backup);
@@ -250,3 +317,285 @@ void restore(control_t *ifid, control_t *idex, control_t *exmem, control_t *memw
     copy_pipeline_register(memwb_backup, memwb);
     *pc = pc_backup;
 }
+
+
+uint32_t hazard_dest(control_t *reg){
+    if(!reg->regWrite){
+        return 0;
+    }
+    return reg->regDst ? reg->regRd : reg->regRt;
+}
+
+// Register a fetched, not yet decoded, instruction writes, 0 if none
+static uint32_t fetched_dest_reg(control_t *reg){
+    switch(reg->opCode){
+        case OPC_RTYPE:
+            return reg->funct == FNC_JR ? 0 : reg->regRd;
+        case OPC_SPECIAL3:
+            return reg->regRd;
+        case OPC_JAL:
+            return REG_RA;
+        case OPC_J:
+        case OPC_BEQ:
+        case OPC_BNE:
+        case OPC_BLTZ:
+        case OPC_BGTZ:
+        case OPC_BLEZ:
+        case OPC_SB:
+        case OPC_SH:
+        case OPC_SW:
+            return 0;
+        default:
+            return reg->regRt;
+    }
+}
+
+bool hazard_reads(control_t *reg, uint32_t r){
+    if(r == 0){
+        return false;
+    }
+    switch(reg->opCode){
+        case OPC_RTYPE:
+            //movz and movn read their old rd too
+            return reg->regRs == r || reg->regRt == r ||
+                ((reg->funct == FNC_MOVZ || reg->funct == FNC_MOVN) && reg->regRd == r);
+        case OPC_SPECIAL3:
+            return reg->regRt == r;
+        case OPC_BEQ:
+        case OPC_BNE:
+        case OPC_SB:
+        case OPC_SH:
+        case OPC_SW:
+        case OPC_SC:
+            return reg->regRs == r || reg->regRt == r;
+        case OPC_J:
+        case OPC_JAL:
+        case OPC_LUI:
+            return false;
+        default:
+            return reg->regRs == r;
+    }
+}
+
+static bool fetched_is_control(control_t *reg){
+    switch(reg->opCode){
+        case OPC_J:
+        case OPC_JAL:
+        case OPC_BEQ:
+        case OPC_BNE:
+        case OPC_BLTZ:
+        case OPC_BGTZ:
+        case OPC_BLEZ:
+            return true;
+        case OPC_RTYPE:
+            return reg->funct == FNC_JR;
+        default:
+            return false;
+    }
+}
+
+static bool fetched_is_memory(control_t *reg){
+    switch(reg->opCode){
+        case OPC_LB:
+        case OPC_LBU:
+        case OPC_LH:
+        case OPC_LHU:
+        case OPC_LW:
+        case OPC_LL:
+        case OPC_SB:
+        case OPC_SH:
+        case OPC_SW:
+        case OPC_SC:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Finds the newest value of register r still in flight, exmem before memwb
+// and the higher (younger) lane first
+static bool forward_value(control_t **exmem, control_t **memwb, int width, uint32_t r, word_t *value){
+    if(r == 0){
+        return false;
+    }
+    for(int i = width - 1; i >= 0; i--){
+        if(hazard_dest(exmem[i]) == r){
+            *value = exmem[i]->ALUresult;
+            return true;
+        }
+    }
+    for(int i = width - 1; i >= 0; i--){
+        if(hazard_dest(memwb[i]) == r){
+            *value = memwb[i]->memToReg ? memwb[i]->memData : memwb[i]->ALUresult;
+            return true;
+        }
+    }
+    return false;
+}
+
+int hazard_group(control_t **ifid, control_t **idex, control_t **exmem, control_t **memwb, int width,
+    int fetched, pc_t *pc, cache_config_t *cache_cfg, issue_limit_t *limit){
+
+    EVENT(EV_HAZARD_WIDE, width, fetched);
+    stall_cause = STALL_NONE;
+
+    //Forwarding into each lane of idex
+    bool redirect = false;
+    pc_t target = 0;
+    for(int j = 0; j < width; j++){
+        bool forward = false;
+        if(forward_value(exmem, memwb, width, idex[j]->regRs, &idex[j]->regRsValue)){
+            forward = true;
+        }
+        if(forward_value(exmem, memwb, width, idex[j]->regRt, &idex[j]->regRtValue)){
+            forward = true;
+        }
+        if(forward){
+            if(flags & MASK_VERBOSE){
+                printf("\tForwarded to lane %d: rs 0x%08x, rt 0x%08x\n", j, idex[j]->regRsValue, idex[j]->regRtValue);
+            }
+            hazard_recheck_branch(idex[j]);
+        }
+        if(idex[j]->jump || idex[j]->PCSrc){
+            redirect = true;
+            target = idex[j]->pcNext;
+        }
+    }
+
+    //Form the issue group out of the fetched lanes
+    int issue = 0;
+    *limit = ISSUE_FULL;
+    bool group_memory = false;
+    bool group_load = false;
+    for(int j = 0; j < fetched && *limit == ISSUE_FULL; j++){
+        if(j > 0 && ifid[j]->status == CACHE_MISS){
+            //The lanes before the miss can go ahead
+            *limit = ISSUE_FETCH;
+            break;
+        }
+        for(int i = 0; i < width; i++){
+            if((idex[i]->memRead || idex[i]->opCode == OPC_SC) && hazard_reads(ifid[j], idex[i]->regRt)){
+                *limit = ISSUE_LOAD_USE;
+                if(j == 0){
+                    stall_cause = STALL_LOAD_USE;
+                    stall_pc = idex[i]->pc;
+                }
+            }
+        }
+        for(int i = 0; i < j; i++){
+            if(hazard_reads(ifid[j], fetched_dest_reg(ifid[i]))){
+                *limit = ISSUE_DEPENDENCY;
+            }
+        }
+        if(*limit != ISSUE_FULL){
+            break;
+        }
+        if(fetched_is_memory(ifid[j])){
+            if(group_memory){
+                *limit = ISSUE_MEMORY;
+                break;
+            }
+            group_memory = true;
+            group_load = ifid[j]->opCode != OPC_SB && ifid[j]->opCode != OPC_SH && ifid[j]->opCode != OPC_SW;
+        }
+        if(fetched_is_control(ifid[j])){
+            //The delay slot always starts the next group. It can't be held
+            //up by a load in this one, so such a branch waits for the next group.
+            if(group_load && j > 0){
+                *limit = ISSUE_CONTROL;
+                break;
+            }
+            issue = j + 1;
+            if(issue < width){
+                *limit = ISSUE_CONTROL;
+            }
+            break;
+        }
+        issue = j + 1;
+    }
+    if(*limit == ISSUE_FULL && issue < width){
+        *limit = ISSUE_FETCH;
+    }
+    if(redirect && issue > 1){
+        //Only the delay slot of a taken branch or jump is on the path
+        issue = 1;
+        *limit = ISSUE_CONTROL;
+    }
+
+    for(int j = issue; j < width; j++){
+        flush(ifid[j]);
+    }
+    if(redirect && issue == 1){
+        if(flags & MASK_VERBOSE){
+            printf("\tBranching or Jumping after the delay slot: overriding pc with 0x%08x\n", target);
+        }
+        *pc = target;
+    } else {
+        *pc = *pc + 4 * issue;
+    }
+    if(flags & MASK_VERBOSE){
+        printf("\tIssued %d of %d lanes\n", issue, width);
+    }
+
+    //Restore every lane on a data cache miss, or if the oldest fetch missed
+    if(cache_cfg->inst_enabled || cache_cfg->data_enabled){
+        bool d_miss = false;
+        for(int i = 0; i < width; i++){
+            if(memwb[i]->status == CACHE_MISS){
+                d_miss = true;
+                stall_pc = memwb[i]->pc;
+            }
+        }
+        if(d_miss || ifid[0]->status == CACHE_MISS){
+            EVENT(EV_HAZARD_MISS);
+            if(d_miss){
+                stall_cause = STALL_D_MISS;
+            } else {
+                stall_cause = STALL_I_MISS;
+                stall_pc = ifid[0]->pc;
+            }
+            for(int i = 0; i < width; i++){
+                //An access that went through must not be performed twice
+                bool mem_done = (memwb[i]->memRead || memwb[i]->memWrite) && memwb[i]->status != CACHE_MISS;
+                word_t mem_data = memwb[i]->memData;
+                copy_pipeline_register(ifid_group_backup[i], ifid[i]);
+                copy_pipeline_register(idex_group_backup[i], idex[i]);
+                copy_pipeline_register(exmem_group_backup[i], exmem[i]);
+                copy_pipeline_register(memwb_group_backup[i], memwb[i]);
+                exmem[i]->memDone = mem_done;
+                if(mem_done){
+                    exmem[i]->memData = mem_data;
+                }
+            }
+            *pc = pc_backup;
+            *limit = ISSUE_RESTORED;
+            return 0;
+        }
+    }
+    return issue;
+}
+
+void hazard_group_init(int width){
+    pc_t unused;
+    group_width = width;
+    for(int i = 0; i < width; i++){
+        pipeline_init(&ifid_group_backup[i], &idex_group_backup[i], &exmem_group_backup[i], &memwb_group_backup[i], &unused, 0);
+    }
+}
+
+void hazard_group_free(void){
+    for(int i = 0; i < group_width; i++){
+        pipeline_destroy(&ifid_group_backup[i], &idex_group_backup[i], &exmem_group_backup[i], &memwb_group_backup[i]);
+    }
+    group_width = 0;
+}
+
+void backup_group(control_t **ifid, control_t **idex, control_t **exmem, control_t **memwb, pc_t *pc){
+    for(int i = 0; i < group_width; i++){
+        copy_pipeline_register(ifid[i], ifid_group_backup[i]);
+        copy_pipeline_register(idex[i], idex_group_backup[i]);
+        copy_pipeline_register(exmem[i], exmem_group_backup[i]);
+        copy_pipeline_register(memwb[i], memwb_group_backup[i]);
+    }
+    pc_backup = *pc;
+}
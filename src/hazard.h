@@ -7,6 +7,30 @@
 
 #include "util.h"
 #include "types.h"
+#include "branch.h"
+
+//Why the pipeline did not move forward in the last cycle
+typedef enum STALL_CAUSE {
+    STALL_NONE,         //an instruction was fetched and everything advanced
+    STALL_LOAD_USE,     //instruction after a load needs its result, a bubble is inserted
+    STALL_CONTROL,      //branch resolved against its prediction, the wrong path fetch is flushed
+    STALL_I_MISS,       //fetch missed in the instruction cache, pipeline restored
+    STALL_D_MISS        //load or store missed in the data cache, pipeline restored
+} stall_cause_t;
+
+//Largest issue group, see issue.h
+#define ISSUE_MAX_WIDTH 8
+
+//What kept an issue group from filling the whole width
+typedef enum ISSUE_LIMIT {
+    ISSUE_FULL,         //every lane issued
+    ISSUE_DEPENDENCY,   //an instruction needs the result of an earlier one in its group
+    ISSUE_MEMORY,       //a second load or store, there is one memory port
+    ISSUE_CONTROL,      //a branch or jump ends its group, a taken one's delay slot issues alone
+    ISSUE_LOAD_USE,     //an instruction needs a load that is only now in execute
+    ISSUE_FETCH,        //fetch stopped at the end of an instruction cache block or missed
+    ISSUE_RESTORED      //a cache miss undid the cycle
+} issue_limit_t;
 
 /*To be called after the execution of a clock cycle. Unit will forward any data
 that will prevent a data hazard, insert nops into the pipeline if forwarding
@@ -15,7 +39,48 @@ can't prevent the data hazard, and flush IFID if a branch is taken
 //HAZARD UPDATES THE PC, SO IT MUST BE CALLED
 int hazard(control_t *ifid, control_t *idex, control_t *exmem, control_t *memwb, pc_t *pc, cache_config_t *cache_cfg);
 
+/* @brief Allocates the pipeline backups restore() goes back to. They
+*  belong to the calling host thread, so every thread running cores calls
+*  this (and hazard_free() when it is done).
+*/
 void hazard_init(void);
+void hazard_free(void);
+
+/* @brief Recomputes the outcome of the branch (or the target of the jr) in
+*  reg from its operand values, after they were forwarded
+*/
+void hazard_recheck_branch(control_t *reg);
+
+/* @brief Returns the register a decoded instruction writes, 0 if none */
+uint32_t hazard_dest(control_t *reg);
+
+/* @brief Returns true if the instruction in reg, decoded or only fetched,
+*  reads register r. Never true for $zero.
+*/
+bool hazard_reads(control_t *reg, uint32_t r);
+
+/* @brief Hazard unit for an in-order group of width lanes, lane 0 the oldest.
+*  Forwards to every idex lane from the youngest matching exmem/memwb lane,
+*  then decides how many of the fetched ifid lanes issue: a group stops at
+*  an instruction that depends on an earlier one in the group or on a load
+*  in idex, at a second memory operation and after a branch or jump.
+*  Lanes that don't issue are flushed and fetched again.
+*  @returns the number of lanes issued, *limit says why it wasn't all of them
+*/
+int hazard_group(control_t **ifid, control_t **idex, control_t **exmem, control_t **memwb, int width,
+    int fetched, pc_t *pc, cache_config_t *cache_cfg, issue_limit_t *limit);
+
+/* @brief Sets up the backup registers hazard_group() restores on a cache miss */
+void hazard_group_init(int width);
+void hazard_group_free(void);
+
+void backup_group(control_t **ifid, control_t **idex, control_t **exmem, control_t **memwb, pc_t *pc);
+
+/* @brief Returns why the last cycle stalled and sets *pc to the instruction
+*  responsible (the load for load-use and data cache stalls, the instruction
+*  being fetched for instruction cache stalls)
+*/
+stall_cause_t hazard_stall_cause(pc_t *pc);
 
 void restore(control_t *ifid, control_t *idex, control_t *exmem, control_t *memwb, pc_t *pc);
 
@@ -0,0 +1,289 @@
+/* src/host.c
+* Host side measurements of a run
+*/
+
+#include <time.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#include "host.h"
+#include "stats.h"
+
+extern int flags;
+
+static const char * const HOST_STAGE_STRINGS[] = {
+    [HOST_BACKUP]       = "backup",
+    [HOST_WRITEBACK]    = "writeback",
+    [HOST_MEMORY]       = "memory",
+    [HOST_EXECUTE]      = "execute",
+    [HOST_DECODE]       = "decode",
+    [HOST_FETCH]        = "fetch",
+    [HOST_HAZARD]       = "hazard",
+    [HOST_CYCLE]        = "core cycle",
+    [HOST_CACHE]        = "cache_digest",
+    [HOST_CPI]          = "cpi",
+    [HOST_PROFILE]      = "profile",
+    [HOST_CHECKER]      = "checker",
+    [HOST_PIPETRACE]    = "pipe trace"
+};
+
+static const char * const HOST_COUNTER_STRINGS[] = {
+    [HOST_INSTRUCTIONS]     = "instructions",
+    [HOST_CYCLES]           = "cycles",
+    [HOST_CACHE_MISSES]     = "cache-misses",
+    [HOST_BRANCH_MISSES]    = "branch-misses"
+};
+
+bool host_timing = false;
+uint64_t host_ticks_spent[HOST_STAGES];
+uint32_t host_calls[HOST_STAGES];
+uint64_t host_entered = 0;
+bool host_counting = false;
+
+//Counters that opened, read together through the first one
+static int counter_fd[HOST_COUNTERS];
+static int counter_slot[HOST_COUNTERS];     //place in a group read, -1 if not open
+static int counters_open = 0;
+static uint64_t counts_started[HOST_COUNTERS];
+static uint64_t counts_stopped[HOST_COUNTERS];
+static uint64_t counts_entered[HOST_COUNTERS];
+static uint64_t counts_spent[HOST_STAGES][HOST_COUNTERS];
+//Share of the run the group was on the host's counters, below 1 if the
+//kernel had to multiplex them
+static double counted_share = 1;
+
+static struct timespec started;
+static struct timespec stopped;
+static uint64_t ticks_started = 0;
+static uint64_t ticks_stopped = 0;
+
+#ifdef __linux__
+static const uint64_t HOST_COUNTER_CONFIGS[] = {
+    [HOST_INSTRUCTIONS]     = PERF_COUNT_HW_INSTRUCTIONS,
+    [HOST_CYCLES]           = PERF_COUNT_HW_CPU_CYCLES,
+    [HOST_CACHE_MISSES]     = PERF_COUNT_HW_CACHE_MISSES,
+    [HOST_BRANCH_MISSES]    = PERF_COUNT_HW_BRANCH_MISSES
+};
+
+/* Reads every open counter with one system call
+*  @returns the share of the time enabled the group was counting
+*/
+static double host_counters_read(uint64_t *counts){
+    //nr, time enabled, time running, then a value per counter
+    uint64_t values[3 + HOST_COUNTERS];
+    if(read(counter_fd[0], values, sizeof(values)) < (ssize_t)((3 + counters_open) * sizeof(uint64_t))){
+        memset(counts, 0, HOST_COUNTERS * sizeof(uint64_t));
+        return 0;
+    }
+    for(int i = 0; i < HOST_COUNTERS; i++){
+        counts[i] = counter_slot[i] < 0 ? 0 : values[3 + counter_slot[i]];
+    }
+    return values[1] ? (double)values[2] / values[1] : 0;
+}
+#endif
+
+bool host_counters_init(void){
+    counters_open = 0;
+    memset(counts_spent, 0, sizeof(counts_spent));
+    memset(counts_started, 0, sizeof(counts_started));
+    memset(counts_stopped, 0, sizeof(counts_stopped));
+#ifdef __linux__
+    int leader = -1;
+    for(int i = 0; i < HOST_COUNTERS; i++){
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = HOST_COUNTER_CONFIGS[i];
+        attr.disabled = leader < 0;     //the group starts with its leader
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        int fd = syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+        if(fd < 0){
+            cprintf(ANSI_C_YELLOW, "Host counter %s is not available: %s\n", HOST_COUNTER_STRINGS[i], strerror(errno));
+            counter_slot[i] = -1;
+            continue;
+        }
+        if(leader < 0){
+            leader = fd;
+        }
+        counter_fd[counters_open] = fd;
+        counter_slot[i] = counters_open++;
+    }
+#else
+    for(int i = 0; i < HOST_COUNTERS; i++){
+        counter_slot[i] = -1;
+    }
+    cprintf(ANSI_C_YELLOW, "Host counters need Linux perf_event_open\n");
+#endif
+    host_counting = counters_open > 0;
+    return host_counting;
+}
+
+void host_counters_free(void){
+    for(int i = 0; i < counters_open; i++){
+        close(counter_fd[i]);
+    }
+    counters_open = 0;
+    host_counting = false;
+}
+
+void host_counters_enter(void){
+#ifdef __linux__
+    host_counters_read(counts_entered);
+#endif
+}
+
+void host_counters_leave(host_stage_t stage){
+#ifdef __linux__
+    uint64_t counts[HOST_COUNTERS];
+    host_counters_read(counts);
+    for(int i = 0; i < HOST_COUNTERS; i++){
+        counts_spent[stage][i] += counts[i] - counts_entered[i];
+    }
+#else
+    (void)stage;
+#endif
+}
+
+void host_start(void){
+#ifdef __linux__
+    if(host_counting){
+        ioctl(counter_fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        host_counters_read(counts_started);
+    }
+#endif
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    stopped = started;
+    ticks_started = ticks_stopped = host_ticks();
+}
+
+void host_stop(void){
+    ticks_stopped = host_ticks();
+    clock_gettime(CLOCK_MONOTONIC, &stopped);
+#ifdef __linux__
+    if(host_counting){
+        counted_share = host_counters_read(counts_stopped);
+        ioctl(counter_fd[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+}
+
+double host_seconds(void){
+    return (double)(stopped.tv_sec - started.tv_sec) + (double)(stopped.tv_nsec - started.tv_nsec) / 1e9;
+}
+
+uint32_t host_instructions(void){
+    //The out-of-order core counts what it commits, the wide pipeline what
+    //it issues, everything else an instruction per base cycle
+    const stat_t *stat = stats_find("ooo", "committed");
+    if(stat == NULL){
+        stat = stats_find("issue", "instructions");
+    }
+    if(stat == NULL){
+        stat = stats_find("cpi", "base");
+    }
+    return stat == NULL ? 0 : *stat->value;
+}
+
+void host_report(uint32_t cycles){
+    double seconds = host_seconds();
+    uint32_t instructions = host_instructions();
+    //Linux gives the peak in kilobytes
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    double rate = seconds > 0 ? 1e-6 / seconds : 0;
+    printf("Host: %.3f s, %d cycles (%.2f M/s), %d instructions (%.2f M/s), peak RSS %ld KB\n",
+        seconds, cycles, cycles * rate, instructions, instructions * rate, usage.ru_maxrss);
+}
+
+void host_timing_init(void){
+    for(int i = 0; i < HOST_STAGES; i++){
+        host_ticks_spent[i] = 0;
+        host_calls[i] = 0;
+    }
+    host_timing = true;
+}
+
+void host_timing_report(void){
+    if(!host_timing){
+        return;
+    }
+    uint64_t total = ticks_stopped - ticks_started;
+    double seconds = host_seconds();
+    //The counter runs at its own rate, the wall clock tells which
+    double ns_per_tick = total ? seconds * 1e9 / total : 0;
+    uint64_t staged = 0;
+    printf("Host time by stage (%.3f s):\n", seconds);
+    printf("\t%-14s %10s %10s %7s %9s\n", "stage", "calls", "ms", "share", "ns/call");
+    for(int i = 0; i < HOST_STAGES; i++){
+        if(host_calls[i] == 0){
+            continue;
+        }
+        staged += host_ticks_spent[i];
+        printf("\t%-14s %10d %10.1f %6.1f%% %9.1f\n", HOST_STAGE_STRINGS[i], host_calls[i],
+            host_ticks_spent[i] * ns_per_tick / 1e6, total ? 100.0 * host_ticks_spent[i] / total : 0,
+            host_ticks_spent[i] * ns_per_tick / host_calls[i]);
+    }
+    //Halt checks, breakpoints and the timing itself
+    uint64_t rest = total > staged ? total - staged : 0;
+    printf("\t%-14s %10s %10.1f %6.1f%%\n", "rest of loop", "",
+        rest * ns_per_tick / 1e6, total ? 100.0 * rest / total : 0);
+}
+
+/* Prints count as a rate of what it is divided by, or that it wasn't counted */
+static void host_counters_rate(const char *label, host_counter_t counter, uint64_t count, double by){
+    if(counter_slot[counter] < 0){
+        printf("  %s n/a", label);
+    } else {
+        printf("  %s %.3f", label, by > 0 ? count / by : 0);
+    }
+}
+
+void host_counters_report(void){
+    if(!host_counting){
+        return;
+    }
+    uint64_t counts[HOST_COUNTERS];
+    for(int i = 0; i < HOST_COUNTERS; i++){
+        counts[i] = counts_stopped[i] - counts_started[i];
+    }
+    double instructions = host_instructions();
+    printf("Host counters (%.0f%% of the loop counted):\n", 100 * counted_share);
+    for(int i = 0; i < HOST_COUNTERS; i++){
+        if(counter_slot[i] < 0){
+            printf("\t%-14s %14s\n", HOST_COUNTER_STRINGS[i], "n/a");
+        } else {
+            printf("\t%-14s %14lu %10.3f per simulated instruction\n", HOST_COUNTER_STRINGS[i],
+                (unsigned long)counts[i], instructions > 0 ? counts[i] / instructions : 0);
+        }
+    }
+    if(counter_slot[HOST_INSTRUCTIONS] >= 0 && counter_slot[HOST_CYCLES] >= 0){
+        printf("\tHost IPC %.3f\n", counts[HOST_CYCLES] ? (double)counts[HOST_INSTRUCTIONS] / counts[HOST_CYCLES] : 0);
+    }
+    if(!host_timing){
+        return;
+    }
+    printf("Host counters by stage, per call:\n");
+    for(int i = 0; i < HOST_STAGES; i++){
+        if(host_calls[i] == 0){
+            continue;
+        }
+        uint64_t *spent = counts_spent[i];
+        printf("\t%-14s", HOST_STAGE_STRINGS[i]);
+        host_counters_rate("instructions", HOST_INSTRUCTIONS, spent[HOST_INSTRUCTIONS], host_calls[i]);
+        if(counter_slot[HOST_INSTRUCTIONS] >= 0 && counter_slot[HOST_CYCLES] >= 0){
+            printf("  IPC %.3f", spent[HOST_CYCLES] ? (double)spent[HOST_INSTRUCTIONS] / spent[HOST_CYCLES] : 0);
+        }
+        host_counters_rate("cache-misses", HOST_CACHE_MISSES, spent[HOST_CACHE_MISSES], host_calls[i]);
+        host_counters_rate("branch-misses", HOST_BRANCH_MISSES, spent[HOST_BRANCH_MISSES], host_calls[i]);
+        printf("\n");
+    }
+}
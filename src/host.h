@@ -0,0 +1,147 @@
+/* src/host.h
+* Measures the simulator itself: host wall time of the run, simulated
+* cycles and instructions per host second and peak resident set size, and
+* optionally the host time spent in each stage called by the main loop.
+*
+* Stage timing reads the time stamp counter (clock_gettime on other hosts)
+* around every call wrapped in HOST_TIME(). Turned off it costs a branch a
+* call, built with -D NO_HOST_TIMING it costs nothing. Logging is charged to
+* the stage that prints it.
+*
+* On Linux the host's own hardware counters (instructions, cycles, cache and
+* branch misses) can be read through perf_event_open around the loop, and
+* around every stage along with the timing. Only the thread running the main
+* loop is counted, not the front-end of the decoupled model or quantum workers.
+* Reading the counters is a system call, so per stage counts include some of
+* its cost in misses, the whole loop counts don't.
+*/
+
+#ifndef _HOST_H
+#define _HOST_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include "util.h"
+#include "types.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+typedef enum HOST_STAGE {
+    HOST_BACKUP,
+    HOST_WRITEBACK,
+    HOST_MEMORY,
+    HOST_EXECUTE,
+    HOST_DECODE,
+    HOST_FETCH,
+    HOST_HAZARD,
+    HOST_CYCLE,         //whole cycle of the wide, out-of-order, multicore or decoupled model
+    HOST_CACHE,         //cache_digest()
+    HOST_CPI,
+    HOST_PROFILE,
+    HOST_CHECKER,
+    HOST_PIPETRACE,
+    HOST_STAGES
+} host_stage_t;
+
+typedef enum HOST_COUNTER {
+    HOST_INSTRUCTIONS,
+    HOST_CYCLES,
+    HOST_CACHE_MISSES,
+    HOST_BRANCH_MISSES,
+    HOST_COUNTERS
+} host_counter_t;
+
+//Set by host_timing_init(), tells HOST_TIME() to time its call
+extern bool host_timing;
+extern uint64_t host_ticks_spent[HOST_STAGES];
+extern uint32_t host_calls[HOST_STAGES];
+extern uint64_t host_entered;
+//Set by host_counters_init() once a counter opened
+extern bool host_counting;
+
+static inline uint64_t host_ticks(void){
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + now.tv_nsec;
+#endif
+}
+
+/* @brief Reads the counters as a stage is entered */
+void host_counters_enter(void);
+
+/* @brief Charges the counts since host_counters_enter() to stage */
+void host_counters_leave(host_stage_t stage);
+
+static inline void host_stage_enter(void){
+    if(host_counting){
+        host_counters_enter();
+    }
+    host_entered = host_ticks();
+}
+
+static inline void host_stage_leave(host_stage_t stage){
+    host_ticks_spent[stage] += host_ticks() - host_entered;
+    host_calls[stage]++;
+    if(host_counting){
+        host_counters_leave(stage);
+    }
+}
+
+//Runs call, charging the host time it took to stage if timing is on
+#ifdef NO_HOST_TIMING
+#define HOST_TIME(stage, call) do { call; } while (0)
+#else
+#define HOST_TIME(stage, call) do { \
+    if (host_timing) { \
+        host_stage_enter(); \
+        call; \
+        host_stage_leave(stage); \
+    } else { \
+        call; \
+    } \
+} while (0)
+#endif
+
+/* @brief Opens the hardware counters of the calling thread, before
+*  host_start(). Counters the host doesn't have are left out.
+*  @returns false if none could be opened
+*/
+bool host_counters_init(void);
+void host_counters_free(void);
+
+/* @brief Starts the wall clock (and the counters), just before the first cycle */
+void host_start(void);
+
+/* @brief Stops the wall clock (and the counters), once the simulation halted */
+void host_stop(void);
+
+/* @brief Seconds between host_start() and host_stop() */
+double host_seconds(void);
+
+/* @brief Instructions the run completed, by whichever core model ran */
+uint32_t host_instructions(void);
+
+/* @brief Prints the one line summary make bench reads */
+void host_report(uint32_t cycles);
+
+/* @brief Turns stage timing on, before host_start() */
+void host_timing_init(void);
+
+/* @brief Prints the host time of every stage, and of the rest of the main
+*  loop, as a share of the whole run
+*/
+void host_timing_report(void);
+
+/* @brief Prints host IPC and misses per simulated instruction of the whole
+*  loop, and of every stage if they were timed
+*/
+void host_counters_report(void);
+
+#endif /* _HOST_H */
@@ -0,0 +1,267 @@
+/* src/interval.c
+* Interval statistics written as CSV or JSON lines
+*/
+
+#include <string.h>
+#include "interval.h"
+
+extern int flags;
+
+typedef enum INTERVAL_COUNTER {
+    IV_INSTRUCTIONS,
+    IV_I_READS,
+    IV_I_WRITES,
+    IV_I_READ_HITS,
+    IV_I_WRITE_HITS,
+    IV_D_READS,
+    IV_D_WRITES,
+    IV_D_READ_HITS,
+    IV_D_WRITE_HITS,
+    IV_BUS_WRITING,
+    IV_WB_FULL_STALLS,
+    IV_CPI_BASE,
+    IV_CPI_LOAD_USE,
+    IV_CPI_CONTROL,
+    IV_CPI_I_MISS,
+    IV_CPI_D_MISS,
+    IV_CPI_WB_FULL,
+    IV_CPI_BUS,
+    IV_BRANCHES,
+    IV_JUMPS,
+    IV_TAKEN,
+    IV_MISPREDICTS,
+    IV_COUNTERS
+} interval_counter_t;
+
+//Where each counter is registered. Instructions are counted by the core
+//model that runs, as for --host-stats, see interval_open().
+static const char * const INTERVAL_COUNTER_STATS[IV_COUNTERS][2] = {
+    [IV_INSTRUCTIONS]   = {"cpi", "base"},
+    [IV_I_READS]        = {"icache", "reads"},
+    [IV_I_WRITES]       = {"icache", "writes"},
+    [IV_I_READ_HITS]    = {"icache", "read_hits"},
+    [IV_I_WRITE_HITS]   = {"icache", "write_hits"},
+    [IV_D_READS]        = {"dcache", "reads"},
+    [IV_D_WRITES]       = {"dcache", "writes"},
+    [IV_D_READ_HITS]    = {"dcache", "read_hits"},
+    [IV_D_WRITE_HITS]   = {"dcache", "write_hits"},
+    [IV_BUS_WRITING]    = {"bus", "writing"},
+    [IV_WB_FULL_STALLS] = {"write_buffer", "full_stalls"},
+    [IV_CPI_BASE]       = {"cpi", "base"},
+    [IV_CPI_LOAD_USE]   = {"cpi", "load_use"},
+    [IV_CPI_CONTROL]    = {"cpi", "control"},
+    [IV_CPI_I_MISS]     = {"cpi", "i_miss"},
+    [IV_CPI_D_MISS]     = {"cpi", "d_miss"},
+    [IV_CPI_WB_FULL]    = {"cpi", "wb_full"},
+    [IV_CPI_BUS]        = {"cpi", "bus"},
+    [IV_BRANCHES]       = {"bpu", "branches"},
+    [IV_JUMPS]          = {"bpu", "jumps"},
+    [IV_TAKEN]          = {"bpu", "taken"},
+    [IV_MISPREDICTS]    = {"bpu", "mispredicts"}
+};
+
+//Columns of a row after the cycle it ends in and its length
+typedef enum INTERVAL_COLUMN {
+    IC_INSTRUCTIONS,
+    IC_IPC,
+    IC_I_HIT_RATE,
+    IC_D_HIT_RATE,
+    IC_WB_OCCUPANCY,        //share of the cycles the write buffer was draining
+    IC_WB_FULL_STALLS,
+    IC_BASE,
+    IC_LOAD_USE,
+    IC_CONTROL,
+    IC_I_MISS,
+    IC_D_MISS,
+    IC_WB_FULL,
+    IC_BUS,
+    IC_BRANCHES,
+    IC_TAKEN,
+    IC_MISPREDICTS,
+    IC_BRANCH_ACCURACY,
+    IC_COLUMNS
+} interval_column_t;
+
+static const char * const INTERVAL_COLUMN_STRINGS[] = {
+    [IC_INSTRUCTIONS]       = "instructions",
+    [IC_IPC]                = "ipc",
+    [IC_I_HIT_RATE]         = "icache_hit_rate",
+    [IC_D_HIT_RATE]         = "dcache_hit_rate",
+    [IC_WB_OCCUPANCY]       = "wb_occupancy",
+    [IC_WB_FULL_STALLS]     = "wb_full_stalls",
+    [IC_BASE]               = "base",
+    [IC_LOAD_USE]           = "load_use",
+    [IC_CONTROL]            = "control",
+    [IC_I_MISS]             = "i_miss",
+    [IC_D_MISS]             = "d_miss",
+    [IC_WB_FULL]            = "wb_full",
+    [IC_BUS]                = "bus",
+    [IC_BRANCHES]           = "branches",
+    [IC_TAKEN]              = "taken",
+    [IC_MISPREDICTS]        = "mispredicts",
+    [IC_BRANCH_ACCURACY]    = "branch_accuracy"
+};
+
+//Columns that are a counter's change, the others are worked out from them
+static const struct {
+    interval_column_t column;
+    interval_counter_t counter;
+} INTERVAL_COPIED[] = {
+    {IC_INSTRUCTIONS,   IV_INSTRUCTIONS},
+    {IC_WB_FULL_STALLS, IV_WB_FULL_STALLS},
+    {IC_BASE,           IV_CPI_BASE},
+    {IC_LOAD_USE,       IV_CPI_LOAD_USE},
+    {IC_CONTROL,        IV_CPI_CONTROL},
+    {IC_I_MISS,         IV_CPI_I_MISS},
+    {IC_D_MISS,         IV_CPI_D_MISS},
+    {IC_WB_FULL,        IV_CPI_WB_FULL},
+    {IC_BUS,            IV_CPI_BUS},
+    {IC_BRANCHES,       IV_BRANCHES},
+    {IC_TAKEN,          IV_TAKEN},
+    {IC_MISPREDICTS,    IV_MISPREDICTS}
+};
+
+static FILE *fp = NULL;
+static char *buffer = NULL;
+static bool json = false;
+static uint32_t every = 0;
+static uint32_t last_cycle = 0;     //end of the last row
+static const uint32_t *counters[IV_COUNTERS];
+static uint32_t last[IV_COUNTERS];  //counters at the end of the last row
+
+bool interval_open(const char *path, uint32_t cycles){
+    fp = fopen(path, "w");
+    if(fp == NULL){
+        return false;
+    }
+    buffer = (char *)malloc(INTERVAL_BUFFER);
+    if(buffer == NULL){
+        cprintf(ANSI_C_RED, "interval_open: Unable to allocate the buffer\n");
+        assert(0);
+    }
+    setvbuf(fp, buffer, _IOFBF, INTERVAL_BUFFER);
+    size_t len = strlen(path);
+    json = (len > 6 && !strcmp(path + len - 6, ".jsonl")) || (len > 5 && !strcmp(path + len - 5, ".json"));
+    every = cycles;
+    last_cycle = 0;
+    for(int i = 0; i < IV_COUNTERS; i++){
+        const stat_t *stat = stats_find(INTERVAL_COUNTER_STATS[i][0], INTERVAL_COUNTER_STATS[i][1]);
+        counters[i] = stat == NULL ? NULL : stat->value;
+    }
+    const stat_t *stat = stats_find("ooo", "committed");
+    if(stat == NULL){
+        stat = stats_find("issue", "instructions");
+    }
+    if(stat != NULL){
+        counters[IV_INSTRUCTIONS] = stat->value;
+    }
+    for(int i = 0; i < IV_COUNTERS; i++){
+        last[i] = counters[i] == NULL ? 0 : *counters[i];
+    }
+    if(!json){
+        fprintf(fp, "cycle,cycles");
+        for(int i = 0; i < IC_COLUMNS; i++){
+            fprintf(fp, ",%s", INTERVAL_COLUMN_STRINGS[i]);
+        }
+        fprintf(fp, "\n");
+    }
+    return true;
+}
+
+/* Change of a counter over the interval, false if the run doesn't have it */
+static bool interval_delta(interval_counter_t counter, const uint32_t *now, double *delta){
+    if(counters[counter] == NULL){
+        *delta = 0;
+        return false;
+    }
+    *delta = now[counter] - last[counter];
+    return true;
+}
+
+/* Share of a counter in another one, false if either is missing or the
+*  other one didn't move
+*/
+static bool interval_ratio(double part, bool have_part, double whole, bool have_whole, double *ratio){
+    if(!have_part || !have_whole || whole == 0){
+        return false;
+    }
+    *ratio = part / whole;
+    return true;
+}
+
+static void interval_row(uint32_t cycle){
+    uint32_t now[IV_COUNTERS];
+    double delta[IV_COUNTERS], value[IC_COLUMNS];
+    bool have[IV_COUNTERS], valid[IC_COLUMNS], count[IC_COLUMNS];
+    double cycles = cycle - last_cycle;
+
+    for(int i = 0; i < IV_COUNTERS; i++){
+        now[i] = counters[i] == NULL ? 0 : *counters[i];
+        have[i] = interval_delta(i, now, &delta[i]);
+    }
+    for(int i = 0; i < IC_COLUMNS; i++){
+        valid[i] = false;
+        count[i] = false;
+    }
+    for(size_t i = 0; i < sizeof(INTERVAL_COPIED) / sizeof(INTERVAL_COPIED[0]); i++){
+        interval_column_t column = INTERVAL_COPIED[i].column;
+        valid[column] = have[INTERVAL_COPIED[i].counter];
+        value[column] = delta[INTERVAL_COPIED[i].counter];
+        count[column] = true;
+    }
+    valid[IC_IPC] = interval_ratio(delta[IV_INSTRUCTIONS], have[IV_INSTRUCTIONS], cycles, true, &value[IC_IPC]);
+    valid[IC_I_HIT_RATE] = interval_ratio(delta[IV_I_READ_HITS] + delta[IV_I_WRITE_HITS], have[IV_I_READ_HITS],
+        delta[IV_I_READS] + delta[IV_I_WRITES], have[IV_I_READS], &value[IC_I_HIT_RATE]);
+    valid[IC_D_HIT_RATE] = interval_ratio(delta[IV_D_READ_HITS] + delta[IV_D_WRITE_HITS], have[IV_D_READ_HITS],
+        delta[IV_D_READS] + delta[IV_D_WRITES], have[IV_D_READS], &value[IC_D_HIT_RATE]);
+    valid[IC_WB_OCCUPANCY] = interval_ratio(delta[IV_BUS_WRITING], have[IV_BUS_WRITING], cycles, true, &value[IC_WB_OCCUPANCY]);
+    //Of branches and jumps, as bpu_report() has it
+    valid[IC_BRANCH_ACCURACY] = interval_ratio(delta[IV_BRANCHES] + delta[IV_JUMPS] - delta[IV_MISPREDICTS], have[IV_MISPREDICTS],
+        delta[IV_BRANCHES] + delta[IV_JUMPS], have[IV_BRANCHES], &value[IC_BRANCH_ACCURACY]);
+
+    if(json){
+        fprintf(fp, "{\"cycle\": %u, \"cycles\": %u", cycle, cycle - last_cycle);
+    } else {
+        fprintf(fp, "%u,%u", cycle, cycle - last_cycle);
+    }
+    for(int i = 0; i < IC_COLUMNS; i++){
+        if(json){
+            fprintf(fp, ", \"%s\": ", INTERVAL_COLUMN_STRINGS[i]);
+        } else {
+            fprintf(fp, ",");
+        }
+        //A column the run doesn't have is empty
+        if(!valid[i]){
+            fprintf(fp, "%s", json ? "null" : "");
+        } else if(count[i]){
+            fprintf(fp, "%u", (uint32_t)value[i]);
+        } else {
+            fprintf(fp, "%.4f", value[i]);
+        }
+    }
+    fprintf(fp, json ? "}\n" : "\n");
+    memcpy(last, now, sizeof(last));
+    last_cycle = cycle;
+}
+
+void interval_cycle(uint32_t cycle){
+    if(cycle - last_cycle >= every){
+        interval_row(cycle);
+    }
+}
+
+void interval_close(uint32_t cycle){
+    if(fp == NULL){
+        return;
+    }
+    if(cycle != last_cycle){
+        interval_row(cycle);
+    }
+    if(ferror(fp)){
+        cprintf(ANSI_C_YELLOW, "Unable to write every interval row\n");
+    }
+    fclose(fp);
+    fp = NULL;
+    free(buffer);
+    buffer = NULL;
+}
@@ -0,0 +1,37 @@
+/* src/interval.h
+* Interval statistics. Every so many cycles a row is appended to a file with
+* what happened since the row before: IPC, cache hit rates, write buffer
+* occupancy, the CPI stack and branch behaviour. The counters come from the
+* statistics registry, so a row only has what the run has (no cache, no
+* branch predictor and so on). Rows are CSV, or JSON lines for a file named
+* *.jsonl or *.json.
+*/
+
+#ifndef _INTERVAL_H
+#define _INTERVAL_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <assert.h>
+#include "util.h"
+#include "stats.h"
+
+//Stdio buffer of the interval file
+#define INTERVAL_BUFFER (1<<16)
+
+/* @brief Starts writing a row every cycles cycles to path. The counters are
+*  looked up now, they must be registered already.
+*  @returns false if path can't be written
+*/
+bool interval_open(const char *path, uint32_t cycles);
+
+/* @brief Writes a row for what is left since the last one and closes the file */
+void interval_close(uint32_t cycle);
+
+/* @brief Writes a row if an interval ended. Called once a cycle, or once a
+*  quantum, with the cycles simulated so far
+*/
+void interval_cycle(uint32_t cycle);
+
+#endif /* _INTERVAL_H */
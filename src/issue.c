@@ -0,0 +1,138 @@
+/* src/issue.c
+* N-wide in-order issue
+*/
+
+#include "issue.h"
+#include "write.h"
+#include "memory.h"
+#include "alu.h"
+#include "decode.h"
+#include "fetch.h"
+#include "stats.h"
+
+extern int flags;
+
+static const char * const ISSUE_LIMIT_STRINGS[] = {
+    [ISSUE_FULL]        = "full",
+    [ISSUE_DEPENDENCY]  = "dependency",
+    [ISSUE_MEMORY]      = "memory_port",
+    [ISSUE_CONTROL]     = "control",
+    [ISSUE_LOAD_USE]    = "load_use",
+    [ISSUE_FETCH]       = "fetch",
+    [ISSUE_RESTORED]    = "restored"
+};
+
+static const char * const ISSUE_LIMIT_DESC[] = {
+    [ISSUE_FULL]        = "cycles every lane issued",
+    [ISSUE_DEPENDENCY]  = "groups cut at a dependency on an earlier lane",
+    [ISSUE_MEMORY]      = "groups cut at a second load or store",
+    [ISSUE_CONTROL]     = "groups cut after a branch or jump",
+    [ISSUE_LOAD_USE]    = "groups cut at a use of a load in execute",
+    [ISSUE_FETCH]       = "groups cut at the end of a fetch block or a fetch miss",
+    [ISSUE_RESTORED]    = "cycles undone by a cache miss"
+};
+
+static int width = 0;
+static control_t *ifid[ISSUE_MAX_WIDTH];
+static control_t *idex[ISSUE_MAX_WIDTH];
+static control_t *exmem[ISSUE_MAX_WIDTH];
+static control_t *memwb[ISSUE_MAX_WIDTH];
+//Counters
+static uint32_t issued = 0;
+static uint32_t limits[ISSUE_RESTORED+1];
+
+void issue_init(int lanes, control_t *ifid0, control_t *idex0, control_t *exmem0, control_t *memwb0){
+    if(lanes < 1 || lanes > ISSUE_MAX_WIDTH){
+        cprintf(ANSI_C_RED, "issue_init: Issue width %d requested, must be 1 to %d\n", lanes, ISSUE_MAX_WIDTH);
+        assert(0);
+    }
+    width = lanes;
+    ifid[0] = ifid0;
+    idex[0] = idex0;
+    exmem[0] = exmem0;
+    memwb[0] = memwb0;
+    for(int i = 1; i < width; i++){
+        pc_t unused;
+        pipeline_init(&ifid[i], &idex[i], &exmem[i], &memwb[i], &unused, 0);
+    }
+    hazard_group_init(width);
+    issued = 0;
+    stats_register("issue", "instructions", &issued, "instructions issued");
+    for(int i = 0; i <= ISSUE_RESTORED; i++){
+        limits[i] = 0;
+        stats_register("issue", ISSUE_LIMIT_STRINGS[i], &limits[i], ISSUE_LIMIT_DESC[i]);
+    }
+}
+
+void issue_free(void){
+    if(width == 0){
+        return;
+    }
+    stats_unregister("issue");
+    hazard_group_free();
+    for(int i = 1; i < width; i++){
+        pipeline_destroy(&ifid[i], &idex[i], &exmem[i], &memwb[i]);
+    }
+    width = 0;
+}
+
+void issue_cycle(pc_t *pc, cache_config_t *cache_cfg){
+    int i;
+    backup_group(ifid, idex, exmem, memwb, pc);
+    //Older lanes first, so the youngest write to a register wins
+    for(i = 0; i < width; i++){
+        writeback(memwb[i]);
+    }
+    for(i = 0; i < width; i++){
+        memory(exmem[i], memwb[i], cache_cfg);
+    }
+    for(i = 0; i < width; i++){
+        execute(idex[i], exmem[i]);
+    }
+    for(i = 0; i < width; i++){
+        decode(ifid[i], idex[i]);
+    }
+    //Fetch consecutive words, a group never spans two instruction cache blocks
+    pc_t fetch_pc = *pc;
+    for(i = 0; i < width; i++){
+        if(i > 0 && cache_cfg->inst_enabled && ((fetch_pc >> 2) % cache_cfg->inst_block) == 0){
+            break;
+        }
+        fetch(ifid[i], &fetch_pc, cache_cfg);
+        fetch_pc += 4;
+    }
+    int fetched = i;
+    for(; i < width; i++){
+        flush(ifid[i]);
+    }
+    issue_limit_t limit;
+    issued += hazard_group(ifid, idex, exmem, memwb, width, fetched, pc, cache_cfg, &limit);
+    limits[limit]++;
+}
+
+bool issue_halted(void){
+    for(int i = 0; i < width; i++){
+        if(ifid[i]->instr == 0x1000ffff || ifid[i]->instr == 0x00000008){
+            return true;
+        }
+    }
+    return false;
+}
+
+void issue_report(uint32_t cycles){
+    if(width == 0){
+        return;
+    }
+    printf("Issue (%d wide, in order):\n", width);
+    printf("\tInstructions issued:    %d\n", issued);
+    if(cycles){
+        printf("\tIPC:                    %.3f\n", (double)issued / cycles);
+    }
+    printf("\tFull groups:            %d\n", limits[ISSUE_FULL]);
+    printf("\tCut by dependency:      %d\n", limits[ISSUE_DEPENDENCY]);
+    printf("\tCut by memory port:     %d\n", limits[ISSUE_MEMORY]);
+    printf("\tCut by branch or jump:  %d\n", limits[ISSUE_CONTROL]);
+    printf("\tCut by load-use:        %d\n", limits[ISSUE_LOAD_USE]);
+    printf("\tCut by fetch:           %d\n", limits[ISSUE_FETCH]);
+    printf("\tRestored on a miss:     %d\n", limits[ISSUE_RESTORED]);
+}
@@ -0,0 +1,38 @@
+/* src/issue.h
+* N-wide in-order issue. Each lane is its own IF/ID, ID/EX, EX/MEM and MEM/WB
+* chain, lane 0 holding the oldest instruction of each group. Fetch reads
+* consecutive words up to the end of an instruction cache block and the
+* hazard unit decides how many of them issue together.
+*/
+
+#ifndef _ISSUE_H
+#define _ISSUE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <assert.h>
+#include "util.h"
+#include "types.h"
+#include "cache.h"
+#include "hazard.h"
+
+/* @brief Sets up width lanes. Lane 0 is the scalar pipeline registers
+*  passed in, the others are allocated here. Registers the "issue"
+*  statistics group.
+*/
+void issue_init(int width, control_t *ifid, control_t *idex, control_t *exmem, control_t *memwb);
+void issue_free(void);
+
+/* @brief Runs one clock cycle of every stage on every lane and updates pc */
+void issue_cycle(pc_t *pc, cache_config_t *cache_cfg);
+
+/* @brief Returns true if a halt instruction (beq $zero, $zero, -1 or
+*  jr $zero) was fetched into any lane
+*/
+bool issue_halted(void);
+
+/* @brief Prints instructions per cycle and why groups were cut short */
+void issue_report(uint32_t cycles);
+
+#endif /* _ISSUE_H */
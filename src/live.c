@@ -0,0 +1,128 @@
+/* src/live.c
+* Live statistics in a shared memory segment
+*/
+
+#include <assert.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include "live.h"
+#include "util.h"
+#include "stats.h"
+
+extern int flags;
+
+//Where each counter is registered. Instructions are counted by the core
+//model that runs, as for --host-stats, see live_open().
+static const char * const LIVE_COUNTER_STATS[LIVE_COUNTERS][2] = {
+    [LIVE_INSTRUCTIONS]     = {"cpi", "base"},
+    [LIVE_I_READS]          = {"icache", "reads"},
+    [LIVE_I_WRITES]         = {"icache", "writes"},
+    [LIVE_I_READ_HITS]      = {"icache", "read_hits"},
+    [LIVE_I_WRITE_HITS]     = {"icache", "write_hits"},
+    [LIVE_D_READS]          = {"dcache", "reads"},
+    [LIVE_D_WRITES]         = {"dcache", "writes"},
+    [LIVE_D_READ_HITS]      = {"dcache", "read_hits"},
+    [LIVE_D_WRITE_HITS]     = {"dcache", "write_hits"},
+    [LIVE_CPI_BASE]         = {"cpi", "base"},
+    [LIVE_CPI_LOAD_USE]     = {"cpi", "load_use"},
+    [LIVE_CPI_CONTROL]      = {"cpi", "control"},
+    [LIVE_CPI_I_MISS]       = {"cpi", "i_miss"},
+    [LIVE_CPI_D_MISS]       = {"cpi", "d_miss"},
+    [LIVE_CPI_WB_FULL]      = {"cpi", "wb_full"},
+    [LIVE_CPI_BUS]          = {"cpi", "bus"},
+    [LIVE_BRANCHES]         = {"bpu", "branches"},
+    [LIVE_JUMPS]            = {"bpu", "jumps"},
+    [LIVE_MISPREDICTS]      = {"bpu", "mispredicts"}
+};
+
+static live_segment_t *segment = NULL;
+static const char *segment_name = NULL;
+static uint32_t every = 0;
+static uint32_t last_cycle = 0;     //of the last snapshot
+static const uint32_t *counters[LIVE_COUNTERS];
+
+bool live_open(const char *name, uint32_t cycles){
+    int fd = shm_open(name, O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if(fd < 0){
+        return false;
+    }
+    if(ftruncate(fd, sizeof(live_segment_t)) != 0){
+        close(fd);
+        shm_unlink(name);
+        return false;
+    }
+    segment = (live_segment_t *)mmap(NULL, sizeof(live_segment_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(segment == MAP_FAILED){
+        segment = NULL;
+        shm_unlink(name);
+        return false;
+    }
+    segment_name = name;
+    every = cycles;
+    last_cycle = 0;
+    segment->snapshot.present = 0;
+    for(int i = 0; i < LIVE_COUNTERS; i++){
+        const stat_t *stat = stats_find(LIVE_COUNTER_STATS[i][0], LIVE_COUNTER_STATS[i][1]);
+        counters[i] = stat == NULL ? NULL : stat->value;
+    }
+    const stat_t *stat = stats_find("ooo", "committed");
+    if(stat == NULL){
+        stat = stats_find("issue", "instructions");
+    }
+    if(stat != NULL){
+        counters[LIVE_INSTRUCTIONS] = stat->value;
+    }
+    for(int i = 0; i < LIVE_COUNTERS; i++){
+        if(counters[i] != NULL){
+            segment->snapshot.present |= 1u << i;
+        }
+    }
+    segment->pid = getpid();
+    segment->every = every;
+    segment->version = LIVE_VERSION;
+    atomic_store_explicit(&segment->seq, 0, memory_order_relaxed);
+    //Readers check the magic last, once the rest is there
+    atomic_thread_fence(memory_order_release);
+    segment->magic = LIVE_MAGIC;
+    return true;
+}
+
+/* Copies the counters into the segment under the sequence lock */
+static void live_publish(uint32_t cycle, uint32_t pc, bool halted){
+    struct timespec now;
+    unsigned seq = atomic_load_explicit(&segment->seq, memory_order_relaxed);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    atomic_store_explicit(&segment->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    segment->snapshot.time_ns = (uint64_t)now.tv_sec * 1000000000u + now.tv_nsec;
+    segment->snapshot.cycles = cycle;
+    segment->snapshot.pc = pc;
+    segment->snapshot.halted = halted;
+    for(int i = 0; i < LIVE_COUNTERS; i++){
+        segment->snapshot.counters[i] = counters[i] == NULL ? 0 : *counters[i];
+    }
+    atomic_store_explicit(&segment->seq, seq + 2, memory_order_release);
+    last_cycle = cycle;
+}
+
+void live_cycle(uint32_t cycle, uint32_t pc){
+    if(cycle - last_cycle >= every){
+        live_publish(cycle, pc, false);
+    }
+}
+
+void live_close(uint32_t cycle, uint32_t pc){
+    if(segment == NULL){
+        return;
+    }
+    live_publish(cycle, pc, true);
+    munmap(segment, sizeof(live_segment_t));
+    if(shm_unlink(segment_name) != 0){
+        cprintf(ANSI_C_YELLOW, "Unable to remove live statistics segment %s\n", segment_name);
+    }
+    segment = NULL;
+    segment_name = NULL;
+}
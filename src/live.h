@@ -0,0 +1,103 @@
+/* src/live.h
+* Live statistics. Every so many cycles the cycle count, PC and a handful of
+* counters (instructions, cache accesses and hits, the CPI stack, branches)
+* are copied into a POSIX shared memory segment that tools/simtop.c, or
+* anything else on the host, can map and read while the run goes on.
+*
+* The segment is written by the simulation thread only and guarded by a
+* sequence lock: the writer makes seq odd, copies the snapshot and makes it
+* even again. A reader copies the snapshot between two reads of seq and tries
+* again if they differ or are odd, so it never sees a half written one and
+* never holds the writer up.
+*
+* This header is shared with simtop, it only uses the C library.
+*/
+
+#ifndef _LIVE_H
+#define _LIVE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+
+//Segment name simtop attaches to by default
+#define LIVE_NAME "/sim-live"
+//Cycles between snapshots by default
+#define LIVE_EVERY 100000
+#define LIVE_MAGIC 0x4556494c   //"LIVE"
+#define LIVE_VERSION 1
+
+typedef enum LIVE_COUNTER {
+    LIVE_INSTRUCTIONS,
+    LIVE_I_READS,
+    LIVE_I_WRITES,
+    LIVE_I_READ_HITS,
+    LIVE_I_WRITE_HITS,
+    LIVE_D_READS,
+    LIVE_D_WRITES,
+    LIVE_D_READ_HITS,
+    LIVE_D_WRITE_HITS,
+    LIVE_CPI_BASE,
+    LIVE_CPI_LOAD_USE,
+    LIVE_CPI_CONTROL,
+    LIVE_CPI_I_MISS,
+    LIVE_CPI_D_MISS,
+    LIVE_CPI_WB_FULL,
+    LIVE_CPI_BUS,
+    LIVE_BRANCHES,
+    LIVE_JUMPS,
+    LIVE_MISPREDICTS,
+    LIVE_COUNTERS
+} live_counter_t;
+
+//What the run looked like when it was published, counters are totals
+typedef struct LIVE_SNAPSHOT {
+    uint64_t time_ns;                   //CLOCK_MONOTONIC when it was written
+    uint32_t cycles;
+    uint32_t pc;
+    uint32_t halted;                    //the last snapshot of the run
+    uint32_t present;                   //bit i set if the run has counter i
+    uint32_t counters[LIVE_COUNTERS];
+} live_snapshot_t;
+
+typedef struct LIVE_SEGMENT {
+    uint32_t magic;
+    uint32_t version;
+    int32_t pid;                        //of the simulator writing it
+    uint32_t every;
+    atomic_uint seq;                    //odd while the snapshot is written
+    live_snapshot_t snapshot;
+} live_segment_t;
+
+/* @brief Creates the segment name and publishes a snapshot every cycles
+*  cycles. The counters are looked up now, they must be registered already.
+*  @returns false if the segment can't be created
+*/
+bool live_open(const char *name, uint32_t cycles);
+
+/* @brief Publishes the final snapshot and removes the segment, readers that
+*  have it mapped keep it until they let go
+*/
+void live_close(uint32_t cycle, uint32_t pc);
+
+/* @brief Publishes a snapshot if an interval ended. Called once a cycle, or
+*  once a quantum, with the cycles simulated so far and the PC
+*/
+void live_cycle(uint32_t cycle, uint32_t pc);
+
+/* @brief Copies a consistent snapshot out of a mapped segment, spinning while
+*  the simulator is halfway through writing one
+*/
+static inline void live_read(const live_segment_t *segment, live_snapshot_t *snapshot){
+    live_segment_t *shared = (live_segment_t *)segment;
+    unsigned before, after;
+    do {
+        before = atomic_load_explicit(&shared->seq, memory_order_acquire);
+        memcpy(snapshot, (const void *)&shared->snapshot, sizeof(*snapshot));
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&shared->seq, memory_order_relaxed);
+    } while((before & 1) || before != after);
+}
+
+#endif /* _LIVE_H */
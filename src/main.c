@@ -10,6 +10,19 @@ int flags = 0; // Global flags register, shared across all files
 cpu_config_t cpu_config = {
     .single_cycle   = false,
     .mem_size       = DEFAULT_MEM_SIZE,
+    .issue_width    = 1,
+    .bp_type        = BP_NONE,
+    .bp_entries     = 256,
+    .btb_entries    = 64,
+    .ras_depth      = 8,
+    .ooo            = false,
+    .rob_entries    = 32,
+    .rs_entries     = 16,
+    .lsq_entries    = 8,
+    .cores          = 1,
+    .quantum        = 0,
+    .host_threads   = 1,
+    .decoupled      = false,
 };
 cache_config_t cache_config = {
     .mode           = CACHE_SPLIT,
@@ -18,15 +31,23 @@ cache_config_t cache_config = {
     .data_block     = 4,
     .data_type      = CACHE_DIRECT,
     .data_wpolicy   = CACHE_WRITETHROUGH,
+    .data_mshrs     = 1,
+    .data_prefetch  = CACHE_PREFETCH_NONE,
+    .data_victim    = 0,
     .inst_enabled   = true,
     .inst_size      = 1024,
     .inst_block     = 4,
     .inst_type      = CACHE_DIRECT,
     .inst_wpolicy   = CACHE_WRITETHROUGH,
+    .inst_prefetch  = CACHE_PREFETCH_NONE,
+    .inst_victim    = 0,
     .size           = 1024,
     .block          = 4,
     .type           = CACHE_DIRECT,
     .wpolicy        = CACHE_WRITETHROUGH,
+    .cores          = 1,
+    .coherence      = CACHE_MESI,
+    .quantum        = 0,
 };
 
 /* CPU state */
@@ -36,10 +57,27 @@ control_t* exmem = NULL; // EX/MEM pipeline register
 control_t* memwb = NULL; // MEM/WB pipeline register
 pc_t pc = 0;             // Program counter
 
+const char *stats_json = NULL; // File the statistics are dumped to as JSON ("-" for stdout)
+uint32_t profile_top = 0;      // Hot spots printed by the profiler, 0 for all of them
+uint32_t cpi_interval = 0;     // Cycles between CPI stack reports, 0 for none
+uint32_t stats_interval = 0;   // Cycles between rows of interval statistics, 0 for none
+const char *stats_interval_file = "stats-interval.csv"; // File they are written to
+uint32_t live_stats = 0;       // Cycles between live statistics snapshots, 0 for none
+const char *live_stats_name = LIVE_NAME; // Shared memory segment they are published in
+bool check = false;            // Check the pipeline against a functional reference
+bool host_stats = false;       // Report how fast the simulator itself ran
+bool host_stages = false;      // and where its time went
+bool host_counters = false;    // and what the host's own counters saw
+const char *event_log = NULL;  // File the debug events are recorded to
+const char *pipe_trace = NULL; // File the pipeline trace is written to
+const char *commands_file = NULL; // File the interactive commands are read from
 
-#define BREAKPOINT_MAX 8
-uint32_t breakpoints_address[BREAKPOINT_MAX] = {0}; // the address of a breakpoint
-uint8_t breakpoints_status[BREAKPOINT_MAX] = {0}; // breakpoint status, 0: disabled, 1:enabled
+
+FILE *interactive_fp = NULL;   // where interactive commands are read from, NULL before the first prompt
+bool interactive_tty = false;  // stdin is a terminal in non-canonical mode
+struct termios interactive_saved; // terminal settings to put back at exit
+uint32_t interactive_steps = 0; // cycles left to run before the next prompt
+until_t until = {.kind = UNTIL_NONE}; // condition that ends a run-until
 
 int main(int argc, char *argv[]) {
     int i;
@@ -66,11 +104,26 @@ int main(int argc, char *argv[]) {
     /* Parse command line arguments and options */
     FILE *source_fp = NULL;
     int rv = arguments(argc,argv,&source_fp,&cpu_config,&cache_config);
-    if (rv !=  0) return rv;
     if (rv == -1) return 0;
+    if (rv !=  0) return rv;
     bprintf("","CPU settings:\n");
-    bprintf("","\tArchitecture: %s\n",cpu_config.single_cycle?"single-cycle":"five-stage pipeline");
+    bprintf("","\tArchitecture: %s\n",cpu_config.single_cycle?"single-cycle":cpu_config.ooo?"out-of-order":"five-stage pipeline");
     bprintf("","\tMemory size: %lu words (%lu bytes, top = 0x%08lx)\n",cpu_config.mem_size>>2,cpu_config.mem_size,cpu_config.mem_size-1);
+    bprintf("","\tIssue width: %d\n",cpu_config.issue_width);
+    bprintf("","\tCores: %d\n",cpu_config.cores);
+    if (cpu_config.quantum) bprintf("","\t    Quantum: %d cycles on %d host threads\n",cpu_config.quantum,cpu_config.host_threads);
+    if (cpu_config.decoupled) bprintf("","\tDecoupled: functional front-end thread, timing replay\n");
+    if (cpu_config.ooo) {
+        bprintf("","\t    Reorder buffer entries: %d\n",cpu_config.rob_entries);
+        bprintf("","\t    Reservation station entries: %d\n",cpu_config.rs_entries);
+        bprintf("","\t    Load/store queue entries: %d\n",cpu_config.lsq_entries);
+    }
+    bprintf("","\tBranch predictor: %s\n",BP_TYPE_STRINGS[cpu_config.bp_type]);
+    if (cpu_config.bp_type != BP_NONE) {
+        bprintf("","\t    Predictor entries: %d\n",cpu_config.bp_entries);
+        bprintf("","\t    BTB entries: %d\n",cpu_config.btb_entries);
+        bprintf("","\t    Return address stack entries: %d\n",cpu_config.ras_depth);
+    }
     bprintf("","Cache settings:\n");
     if (cache_config.mode == CACHE_SPLIT) {
         bprintf("","\tData cache:\n");
@@ -79,12 +132,18 @@ int main(int argc, char *argv[]) {
         bprintf("","\t    Data cache block size: %d\n",cache_config.data_block);
         bprintf("","\t    Data cache type: %s\n",CACHE_TYPE_STRINGS[cache_config.data_type]);
         bprintf("","\t    Data cache write policy: %s\n",CACHE_WPOLICY_STRINGS[cache_config.data_wpolicy]);
+        bprintf("","\t    Data cache MSHRs: %d (%s)\n",cache_config.data_mshrs,cache_config.data_mshrs>1?"non-blocking":"blocking");
+        bprintf("","\t    Data cache prefetcher: %s\n",CACHE_PREFETCH_STRINGS[cache_config.data_prefetch]);
+        bprintf("","\t    Data victim cache entries: %d\n",cache_config.data_victim);
         bprintf("","\tInstruction cache:\n");
         bprintf("","\t    Instruction cache %s\n",cache_config.inst_enabled?"enabled":"disabled");
         bprintf("","\t    Instruction cache size: %d\n",cache_config.inst_size);
         bprintf("","\t    Instruction cache block size: %d\n",cache_config.inst_block);
         bprintf("","\t    Instruction cache type: %s\n",CACHE_TYPE_STRINGS[cache_config.inst_type]);
         bprintf("","\t    Instruction cache write policy: %s\n",CACHE_WPOLICY_STRINGS[cache_config.inst_wpolicy]);
+        bprintf("","\t    Instruction cache prefetcher: %s\n",CACHE_PREFETCH_STRINGS[cache_config.inst_prefetch]);
+        bprintf("","\t    Instruction victim cache entries: %d\n",cache_config.inst_victim);
+        if (cache_config.cores > 1) bprintf("","\tCoherence protocol: %s\n",CACHE_COHERENCE_STRINGS[cache_config.coherence]);
     } else if (cache_config.mode == CACHE_UNIFIED) {
         bprintf("","\t    Unified cache size: %d\n",cache_config.size);
         bprintf("","\t    Unified cache block size: %d\n",cache_config.block);
@@ -111,41 +170,165 @@ int main(int argc, char *argv[]) {
     pipeline_init(&ifid, &idex, &exmem, &memwb, &pc,  (pc_t)mem_start());
     hazard_init();
     cache_init(&cache_config);
+    cpi_init(cpi_interval);
+    bpu_init(&cpu_config);
+    if (cpu_config.ooo) ooo_init(&cpu_config);
+    else if (cpu_config.issue_width > 1) issue_init(cpu_config.issue_width, ifid, idex, exmem, memwb);
+    if (flags & MASK_PROFILE) {
+        profile_init();
+        for (i = 0; i < (int)mem_size_w(); ++i) {
+            if (lines[i].type == 3) profile_annotate(mem_start()+(i<<2), lines[i].comment);
+        }
+    }
     uint32_t word = 0;
     if (flags & MASK_ALTFORMAT) {
         // set the program counter based on the fifth word of memory
         mem_read_w(5<<2, &word);
         pc = word * 4;
     }
+    if (cpu_config.cores > 1) multicore_init(&cpu_config, ifid, idex, exmem, memwb, &pc);
+    if (cpu_config.decoupled) decoupled_init(pc);
+    if (check) checker_init(pc);
+    if (pipe_trace != NULL) {
+        if (!pipetrace_open(pipe_trace, pc)) {
+            cprintf(ANSI_C_RED,"Unable to open pipeline trace %s\n",pipe_trace);
+            return 1;
+        }
+        for (i = 0; i < (int)mem_size_w(); ++i) {
+            if (lines[i].type == 3) pipetrace_annotate(mem_start()+(i<<2), lines[i].comment);
+        }
+    }
     // Run the simulation
-    int cycles = 0;
+    uint32_t cycles = 0;
+    bool diverged = false;
+    stats_register("sim", "cycles", &cycles, "clock cycles simulated");
+    if (event_log != NULL && !event_log_open(event_log)) {
+        cprintf(ANSI_C_RED,"Unable to open event log %s\n",event_log);
+        return 1;
+    }
+    if (stats_interval && !interval_open(stats_interval_file, stats_interval)) {
+        cprintf(ANSI_C_RED,"Unable to open interval statistics file %s\n",stats_interval_file);
+        return 1;
+    }
+    if (live_stats && !live_open(live_stats_name, live_stats)) {
+        cprintf(ANSI_C_RED,"Unable to create live statistics segment %s\n",live_stats_name);
+        return 1;
+    }
+    if (host_counters) host_counters_init();
+    if (host_stages) host_timing_init();
+    host_start();
     while (1) {
+        event_cycle = cycles;
+        if (cpu_config.quantum) {
+            // The cores run a whole quantum apart, caches and CPI stacks included
+            HOST_TIME(HOST_CYCLE, cycles += multicore_quantum(&cache_config));
+            if (stats_interval) interval_cycle(cycles);
+            if (live_stats) live_cycle(cycles, pc);
+            if (multicore_halted()) break;
+            continue;
+        }
         // Run a pipeline cycle
-        backup(ifid, idex, exmem, memwb, &pc);
-        writeback(memwb);
-        memory(exmem, memwb, &cache_config);
-        execute(idex, exmem);
-        decode(ifid, idex);
-        fetch(ifid, &pc, &cache_config);
-        hazard(ifid, idex, exmem, memwb, &pc, &cache_config);
-        cache_digest();
+        if (cpu_config.cores > 1) {
+            HOST_TIME(HOST_CYCLE, multicore_cycle(&cache_config));
+        } else if (cpu_config.ooo) {
+            HOST_TIME(HOST_CYCLE, ooo_cycle(ifid, &pc, &cache_config));
+        } else if (cpu_config.issue_width > 1) {
+            HOST_TIME(HOST_CYCLE, issue_cycle(&pc, &cache_config));
+        } else if (cpu_config.decoupled) {
+            HOST_TIME(HOST_CYCLE, decoupled_cycle(ifid, idex, exmem, memwb, &pc, &cache_config));
+        } else {
+            HOST_TIME(HOST_BACKUP, backup(ifid, idex, exmem, memwb, &pc));
+            HOST_TIME(HOST_WRITEBACK, writeback(memwb));
+            HOST_TIME(HOST_MEMORY, memory(exmem, memwb, &cache_config));
+            HOST_TIME(HOST_EXECUTE, execute(idex, exmem));
+            HOST_TIME(HOST_DECODE, decode(ifid, idex));
+            HOST_TIME(HOST_FETCH, fetch(ifid, &pc, &cache_config));
+            HOST_TIME(HOST_HAZARD, hazard(ifid, idex, exmem, memwb, &pc, &cache_config));
+        }
+        HOST_TIME(HOST_CACHE, cache_digest());
         ++cycles;
-        // Check for a magic halt number (beq zero zero -1 or jr zero)
-        if (ifid->instr == 0x1000ffff || ifid->instr == 0x00000008 || pc == 0) break;
+        if (cpu_config.cores > 1) HOST_TIME(HOST_CPI, multicore_account());
+        else HOST_TIME(HOST_CPI, cpi_cycle());
+        if (flags & MASK_PROFILE) HOST_TIME(HOST_PROFILE, profile_cycle(ifid->pc));
+        if (flags & MASK_PIPETRACE) HOST_TIME(HOST_PIPETRACE, pipetrace_cycle(ifid, idex, exmem, memwb, pc));
+        if (stats_interval) interval_cycle(cycles);
+        if (live_stats) live_cycle(cycles, pc);
+        if (checker_enabled()) {
+            bool agreed;
+            HOST_TIME(HOST_CHECKER, agreed = checker_cycle(cycles));
+            if (!agreed) {
+                diverged = true;
+                break;
+            }
+        }
+        // Check for a magic halt number (beq zero zero -1 or jr zero), the
+        // out-of-order core first drains everything older than it and
+        // several cores wait for each other
+        if (cpu_config.cores > 1) {
+            if (multicore_halted()) break;
+        } else if (cpu_config.ooo) {
+            if (ooo_halted()) break;
+        } else if (ifid->instr == 0x1000ffff || ifid->instr == 0x00000008 || pc == 0 || issue_halted()) break;
         // Breakpoint and interactive stuff
-        breakpoint_check(pc);
+        if (flags & (MASK_BREAKPOINTS | MASK_WATCHPOINTS)) breakpoint_check(pc);
         if (flags & MASK_INTERACTIVE) { // Run interactive step
-            if (interactive(lines) !=0) return 1;
+            if (interactive(lines, cycles) !=0) {
+                event_log_close();
+                pipetrace_close();
+                interval_close(cycles);
+                live_close(cycles, pc);
+                return 1;
+            }
         }
     }
+    // The front-end has to be done with registers and memory before they are dumped
+    if (cpu_config.decoupled) decoupled_stop();
+    host_stop();
     printf("\nPipeline halted after %d cycles (address 0x%08x)\n",cycles,pc);
+    // Get anything still sitting in the caches out to memory before dumping it
+    if (cache_config.mode != CACHE_DISABLE) cache_flush();
+    event_log_close();
+    pipetrace_close();
+    interval_close(cycles);
+    live_close(cycles, pc);
     // Dump registers and the first couple words of memory so we can see what's going on
     reg_dump();
     mem_dump_cute(0,16);
+    if (cache_config.mode != CACHE_DISABLE) cache_report();
+    cpi_report();
+    bpu_report();
+    issue_report(cycles);
+    ooo_report(cycles);
+    multicore_report();
+    if (flags & MASK_PROFILE) profile_report(profile_top);
+    if (host_stats) host_report(cycles);
+    if (host_stages) host_timing_report();
+    if (host_counters) host_counters_report();
+    if (flags & MASK_STATS) stats_dump(stdout);
+    if (stats_json != NULL) {
+        FILE *json_fp = strcmp(stats_json,"-") ? fopen(stats_json,"w") : stdout;
+        if (json_fp == NULL) {
+            cprintf(ANSI_C_RED,"Unable to open statistics file %s\n",stats_json);
+        } else {
+            stats_dump_json(json_fp);
+            if (json_fp != stdout) fclose(json_fp);
+        }
+    }
+    stats_unregister("sim");
+    cpi_free();
+    bpu_free();
+    issue_free();
+    ooo_free();
+    host_counters_free();
+    multicore_free();
+    decoupled_free();
+    checker_free();
+    profile_free();
     // Close memory, and cleanup register files (we don't need to clean up registers)
     pipeline_destroy(&ifid, &idex, &exmem, &memwb);
+    cache_destroy();
     mem_close();
-    return 0; // exit without errors
+    return diverged ? 1 : 0; // exit without errors unless the checker found one
 }
 
 /* Parse command line arguments and options
@@ -157,6 +340,7 @@ int arguments(int argc, char **argv, FILE** source_fp,
     int c;
     int option_index = 0;
     int32_t temp, srv;
+    const char *event_decode_file = NULL;
     //opterr = 0; // disable getopt_long default errors
     while (1) {
         static struct option long_options[] = {
@@ -166,12 +350,43 @@ int arguments(int argc, char **argv, FILE** source_fp,
             {"debug",           no_argument,        0, 'd'},
             {"help",            no_argument,        0, 'h'},
             {"interactive",     no_argument,        0, 'i'},
+            {"commands",        required_argument,  0, OPT_COMMANDS}, // file
             {"sanity",          no_argument,        0, 'y'},
             {"version",         no_argument,        0, 'V'},
             {"verbose",         no_argument,        0, 'v'},
+            {"stats",           no_argument,        0, 's'},
+            {"stats-json",      required_argument,  0, 'j'}, // file, - for stdout
+            {"profile",         required_argument,  0, 'p'}, // hot spots to print, 0 for all
+            {"cpi-interval",    required_argument,  0, 'k'}, // cycles, 0 for none
+            {"stats-interval",  required_argument,  0, OPT_STATS_INTERVAL}, // cycles, 0 for none
+            {"stats-interval-file", required_argument, 0, OPT_STATS_INTERVAL_FILE}, // *.csv, *.jsonl
+            {"live-stats",      required_argument,  0, OPT_LIVE_STATS}, // cycles, 0 for none
+            {"live-stats-name", required_argument,  0, OPT_LIVE_STATS_NAME}, // /name
+            {"check",           no_argument,        0, 'l'},
+            {"host-stats",      no_argument,        0, 'z'},
+            {"host-stages",     no_argument,        0, 'O'},
+            {"host-counters",   no_argument,        0, 'U'},
+            {"event-log",       required_argument,  0, OPT_EVENT_LOG},
+            {"event-filter",    required_argument,  0, OPT_EVENT_FILTER}, // fetch,decode,...
+            {"event-decode",    required_argument,  0, OPT_EVENT_DECODE},
+            {"pipe-trace",      required_argument,  0, OPT_PIPE_TRACE},
             /* CPU options */
             {"single-cycle",    no_argument,        0, 'g'},
             {"mem-size",        required_argument,  0, 'm'}, // 2^n, 0 <= n < 15
+            {"issue-width",     required_argument,  0, 'w'}, // 1 <= n <= 8
+            {"bp",              required_argument,  0, 'b'}, // (none,static,bimodal,gshare,tournament)
+            {"bp-entries",      required_argument,  0, 'e'}, // 2^n, 0 <= n <= 16
+            {"btb-entries",     required_argument,  0, 't'}, // 2^n, 0 <= n <= 16
+            {"ras-depth",       required_argument,  0, 'r'}, // 0 <= n <= 64
+            {"ooo",             no_argument,        0, 'o'},
+            {"rob-entries",     required_argument,  0, 'R'}, // 1 <= n <= 256
+            {"rs-entries",      required_argument,  0, 'u'}, // n >= 1
+            {"lsq-entries",     required_argument,  0, 'q'}, // n >= 1
+            {"cores",           required_argument,  0, 'n'}, // 1 <= n <= 16
+            {"coherence",       required_argument,  0, 'x'}, // (msi,mesi)
+            {"quantum",         required_argument,  0, 'Z'}, // 0 <= Z
+            {"host-threads",    required_argument,  0, 'A'}, // 1 <= A <= 16
+            {"decoupled",       no_argument,        0, 'f'},
             /* Cache options */
             {"cache-mode",      required_argument,  0, 'c'}, // (disabled,split,unified)
             /* Split cache options */
@@ -180,11 +395,16 @@ int arguments(int argc, char **argv, FILE** source_fp,
             {"cache-dblock",    required_argument,  0, 'F'}, // 2^n, 0 < n <= 7
             {"cache-dtype",     required_argument,  0, 'G'}, // (direct,sa2)
             {"cache-dwrite",    required_argument,  0, 'H'}, // (back,thru)
+            {"cache-dmshr",     required_argument,  0, 'N'}, // 1 <= n <= 16
+            {"cache-dprefetch", required_argument,  0, 'P'}, // (none,next,stride,stream)
+            {"cache-dvictim",   required_argument,  0, 'X'}, // 0 <= n <= 16
             {"cache-inst",      required_argument,  0, 'I'}, // (enabled,disabled)
             {"cache-isize",     required_argument,  0, 'J'}, // 2^n, 0 < n <= 15
             {"cache-iblock",    required_argument,  0, 'K'}, // 2^n, 0 < n <= 7
             {"cache-itype",     required_argument,  0, 'L'}, // (direct,sa2)
             {"cache-iwrite",    required_argument,  0, 'M'}, // (back,thru)
+            {"cache-iprefetch", required_argument,  0, 'Q'}, // (none,next,stride,stream)
+            {"cache-ivictim",   required_argument,  0, 'Y'}, // 0 <= n <= 16
             /* Unified cache options */
             {"cache-block",     required_argument,  0, 'B'}, // 2^n, 0 < n <= 15
             {"cache-size",      required_argument,  0, 'S'}, // 2^n, 0 < n <= 7
@@ -192,7 +412,7 @@ int arguments(int argc, char **argv, FILE** source_fp,
             {"cache-write",     required_argument,  0, 'W'}, // (back,thru)
             {0, 0, 0, 0}
         };
-        c = getopt_long (argc, argv, "aC:dhiyVvc:gm:D:E:F:G:H:I:J:K:L:M:B:S:T:W:",long_options, &option_index);
+        c = getopt_long (argc, argv, "aC:dhiyVvsj:p:k:lzOUc:gm:b:e:t:r:w:ofR:u:q:n:x:Z:A:D:E:F:G:H:N:P:X:I:J:K:L:M:Q:Y:B:S:T:W:",long_options, &option_index);
         if (c == -1) break; // Detect the end of the options.
 
         switch (c) {
@@ -241,14 +461,21 @@ int arguments(int argc, char **argv, FILE** source_fp,
                         "   \tPrints this usage information and exits.\n" \
                         "   "ANSI_BOLD"--interactive, -i"ANSI_RESET"\n" \
                         "   \tEnables an interactive debugger for step-by-step and breakpoint-\n" \
-                        "   \tbased debugging.\n" \
+                        "   \tbased debugging. Commands are single keypresses on a terminal,\n" \
+                        "   \tpress "ANSI_BOLD"?"ANSI_RESET" for the list. Piped into stdin they are read as a batch.\n" \
+                        "   "ANSI_BOLD"--commands "ANSI_RUNDER"file"ANSI_RESET"\n" \
+                        "   \tReads the interactive commands and their arguments from "ANSI_UNDER"file"ANSI_RESET",\n" \
+                        "   \tseparated by blanks, then from the terminal if there is one\n" \
+                        "   \t(implies --interactive). "ANSI_BOLD"n 1000 u pc 100 r d"ANSI_RESET" steps 1000 cycles,\n" \
+                        "   \truns until the pc is 0x100, dumps registers and runs to the end.\n" \
                         "   "ANSI_BOLD"--sanity, -y"ANSI_RESET"\n" \
                         "   \tEnables internal sanity checking with a slight speed penalty.\n" \
                         "   "ANSI_BOLD"--version, -V"ANSI_RESET"\n" \
                         "   \tPrints simulator version information.\n" \
                         "   "ANSI_BOLD"--verbose, -v"ANSI_RESET"\n" \
-                        "   \tEnable verbose output.\n" \
-                        "CPU configuration options:\n" \
+                        "   \tEnable verbose output.\n",
+                        TARGET_STRING,TARGET_STRING,TARGET_STRING,TARGET_STRING);
+                printf( "CPU configuration options:\n" \
                         "   "ANSI_BOLD"--single-cycle, -g"ANSI_RESET"\n" \
                         "   \tModels a single-cycle CPU, where each instruction takes one cycle.\n" \
                         "   \tIf not set, the default is a five-stage pipeline architecture.\n" \
@@ -288,14 +515,156 @@ int arguments(int argc, char **argv, FILE** source_fp,
                         "   \tSets the write policy of the unified, data, or instruction cache,\n" \
                         "   \trespectively. "ANSI_UNDER"policy"ANSI_RESET" must be ("ANSI_BOLD"back,thru"ANSI_RESET").\n" \
                         "   \t"ANSI_BOLD"back"ANSI_RESET" - uses a writeback policy.\n" \
-                        "   \t"ANSI_BOLD"thru"ANSI_RESET" - uses a writethrough policy.\n" \
-                        "\nEmail bug reports to /dev/null\n", \
-                        TARGET_STRING,TARGET_STRING,TARGET_STRING,TARGET_STRING,DEFAULT_MEM_SIZE);
+                        "   \t"ANSI_BOLD"thru"ANSI_RESET" - uses a writethrough policy.\n", \
+                        DEFAULT_MEM_SIZE);
+                // Split up, ISO C only guarantees string literals up to 4095 characters
+                printf( "   "ANSI_BOLD"--cache-dmshr "ANSI_RUNDER"count"ANSI_RBOLD", -N "ANSI_RUNDER"count"ANSI_RESET"\n" \
+                        "   \tSets the number of miss status holding registers of the data cache.\n" \
+                        "   \t"ANSI_UNDER"count"ANSI_RESET" must be 1 to 16, defaults to 1 (a blocking cache). With more\n" \
+                        "   \tthan one, hits and new misses are serviced under outstanding misses.\n" \
+                        "   "ANSI_BOLD"--cache-dprefetch "ANSI_RUNDER"type"ANSI_RBOLD", -P "ANSI_RUNDER"type"ANSI_RESET"\n" \
+                        "   "ANSI_BOLD"--cache-iprefetch "ANSI_RUNDER"type"ANSI_RBOLD", -Q "ANSI_RUNDER"type"ANSI_RESET"\n" \
+                        "   \tSets the hardware prefetcher of the data or instruction cache,\n" \
+                        "   \trespectively. "ANSI_UNDER"type"ANSI_RESET" must be ("ANSI_BOLD"none,next,stride,stream"ANSI_RESET"), defaults to none.\n" \
+                        "   \t"ANSI_BOLD"next"ANSI_RESET" - tagged next-line, fetches the block after a miss.\n" \
+                        "   \t"ANSI_BOLD"stride"ANSI_RESET" - per-PC stride detection, meant for the data cache.\n" \
+                        "   \t"ANSI_BOLD"stream"ANSI_RESET" - stream buffers that follow sequential misses.\n" \
+                        "   \tPrefetches only use the memory bus when it would otherwise be idle.\n" \
+                        "   "ANSI_BOLD"--cache-dvictim "ANSI_RUNDER"entries"ANSI_RBOLD", -X "ANSI_RUNDER"entries"ANSI_RESET"\n" \
+                        "   "ANSI_BOLD"--cache-ivictim "ANSI_RUNDER"entries"ANSI_RBOLD", -Y "ANSI_RUNDER"entries"ANSI_RESET"\n" \
+                        "   \tAdds a fully associative victim cache of "ANSI_UNDER"entries"ANSI_RESET" blocks behind the data\n" \
+                        "   \tor instruction cache, respectively. "ANSI_UNDER"entries"ANSI_RESET" must be 0 to 16, defaults\n" \
+                        "   \tto 0 (none). A block found there is swapped back in for one cycle.\n" \
+                        "Statistics options:\n" \
+                        "   "ANSI_BOLD"--stats, -s"ANSI_RESET"\n" \
+                        "   \tPrints every registered counter (cache accesses, hits, misses by\n" \
+                        "   \ttype, evictions, writebacks, write buffer and bus use) at halt.\n" \
+                        "   "ANSI_BOLD"--stats-json "ANSI_RUNDER"file"ANSI_RBOLD", -j "ANSI_RUNDER"file"ANSI_RESET"\n" \
+                        "   \tWrites the same counters to "ANSI_UNDER"file"ANSI_RESET" as JSON at halt, "ANSI_BOLD"-"ANSI_RESET" for stdout.\n" \
+                        "   "ANSI_BOLD"--profile "ANSI_RUNDER"count"ANSI_RBOLD", -p "ANSI_RUNDER"count"ANSI_RESET"\n" \
+                        "   \tCharges every cycle to an instruction address, stalls to the load,\n" \
+                        "   \tstore or fetch that caused them, and prints the "ANSI_UNDER"count"ANSI_RESET" most expensive\n" \
+                        "   \tinstructions with their disassembly at halt (0 prints all of them).\n" \
+                        "   "ANSI_BOLD"--cpi-interval "ANSI_RUNDER"cycles"ANSI_RBOLD", -k "ANSI_RUNDER"cycles"ANSI_RESET"\n" \
+                        "   \tPrints the CPI stack (base, load-use, control, i-miss, d-miss,\n" \
+                        "   \twrite buffer full, bus contention) of every "ANSI_UNDER"cycles"ANSI_RESET" cycles. The stack\n" \
+                        "   \tof the whole run is always printed at halt.\n");
+                printf( "   "ANSI_BOLD"--stats-interval "ANSI_RUNDER"cycles"ANSI_RESET"\n" \
+                        "   \tAppends a row every "ANSI_UNDER"cycles"ANSI_RESET" cycles to the interval file with the IPC,\n" \
+                        "   \tinstruction and data cache hit rates, write buffer occupancy, CPI\n" \
+                        "   \tstack and branches of those cycles, to find the phases of a program.\n" \
+                        "   "ANSI_BOLD"--stats-interval-file "ANSI_RUNDER"file"ANSI_RESET"\n" \
+                        "   \tInterval file, JSON lines if "ANSI_UNDER"file"ANSI_RESET" ends in "ANSI_BOLD".jsonl"ANSI_RESET" or "ANSI_BOLD".json"ANSI_RESET", CSV\n" \
+                        "   \totherwise. Defaults to "ANSI_BOLD"stats-interval.csv"ANSI_RESET".\n" \
+                        "   "ANSI_BOLD"--live-stats "ANSI_RUNDER"cycles"ANSI_RESET"\n" \
+                        "   \tPublishes the cycle count, PC, instructions, cache hits, CPI stack\n" \
+                        "   \tand branches every "ANSI_UNDER"cycles"ANSI_RESET" cycles in a shared memory segment while\n" \
+                        "   \tthe run goes on, for "ANSI_BOLD"simtop"ANSI_RESET" to watch. %d is a sensible rate.\n" \
+                        "   "ANSI_BOLD"--live-stats-name "ANSI_RUNDER"name"ANSI_RESET"\n" \
+                        "   \tName of the segment, defaults to "ANSI_BOLD"%s"ANSI_RESET".\n" \
+                        "   "ANSI_BOLD"--check, -l"ANSI_RESET"\n" \
+                        "   \tRuns a functional reference model alongside the pipeline and checks\n" \
+                        "   \tthe register write and store of every instruction written back\n" \
+                        "   \tagainst it. The first divergence is reported and stops the run with\n" \
+                        "   \texit status 1. Five-stage pipeline only.\n" \
+                        "   "ANSI_BOLD"--host-stats, -z"ANSI_RESET"\n" \
+                        "   \tPrints the host wall time of the run, simulated cycles and\n" \
+                        "   \tinstructions per host second and the peak RSS at halt.\n" \
+                        "   "ANSI_BOLD"--host-stages, -O"ANSI_RESET"\n" \
+                        "   \tAlso times every stage called by the main loop on the host and\n" \
+                        "   \tprints where the time went (implies --host-stats).\n" \
+                        "   "ANSI_BOLD"--host-counters, -U"ANSI_RESET"\n" \
+                        "   \tReads the host's instruction, cycle, cache miss and branch miss\n" \
+                        "   \tcounters (Linux perf_event_open) around the loop, and around every\n" \
+                        "   \tstage with --host-stages. Implies --host-stats.\n",LIVE_EVERY,LIVE_NAME);
+                printf( "Event log and trace options:\n" \
+                        "   "ANSI_BOLD"--event-log "ANSI_RUNDER"file"ANSI_RESET"\n" \
+                        "   \tRecords what the stages, caches and main memory do to "ANSI_UNDER"file"ANSI_RESET" as binary\n" \
+                        "   \trecords instead of printing it as --debug does. Much faster.\n" \
+                        "   "ANSI_BOLD"--event-filter "ANSI_RUNDER"list"ANSI_RESET"\n" \
+                        "   \tOnly records (or prints, or decodes) the events of the comma\n" \
+                        "   \tseparated subsystems in "ANSI_UNDER"list"ANSI_RESET": "ANSI_BOLD"fetch"ANSI_RESET", "ANSI_BOLD"decode"ANSI_RESET", "ANSI_BOLD"execute"ANSI_RESET", "ANSI_BOLD"memory"ANSI_RESET",\n" \
+                        "   \t"ANSI_BOLD"writeback"ANSI_RESET", "ANSI_BOLD"hazard"ANSI_RESET", "ANSI_BOLD"cache"ANSI_RESET" and "ANSI_BOLD"main"ANSI_RESET" (main memory). Defaults to "ANSI_BOLD"all"ANSI_RESET".\n" \
+                        "   "ANSI_BOLD"--event-decode "ANSI_RUNDER"file"ANSI_RESET"\n" \
+                        "   \tPrints the events recorded to "ANSI_UNDER"file"ANSI_RESET" as --debug would have, a cycle at\n" \
+                        "   \ta time, and exits.\n" \
+                        "   "ANSI_BOLD"--pipe-trace "ANSI_RUNDER"file"ANSI_RESET"\n" \
+                        "   \tWrites the cycle every instruction entered each stage, when it was\n" \
+                        "   \twritten back or flushed and the stalls behind it to "ANSI_UNDER"file"ANSI_RESET" in the\n" \
+                        "   \tKanata log format, for pipeline viewers such as Konata. Five-stage\n" \
+                        "   \tpipeline of one core only.\n");
+                printf( "Issue options:\n" \
+                        "   "ANSI_BOLD"--issue-width "ANSI_RUNDER"lanes"ANSI_RBOLD", -w "ANSI_RUNDER"lanes"ANSI_RESET"\n" \
+                        "   \tFetches and issues up to "ANSI_UNDER"lanes"ANSI_RESET" instructions a cycle, in order. 1 to 8,\n" \
+                        "   \tdefaults to 1. A group stops at a dependency inside it, a second\n" \
+                        "   \tload or store, a branch or jump, or the end of an instruction cache\n" \
+                        "   \tblock. Branches resolve in decode, so no predictor is used.\n" \
+                        "   "ANSI_BOLD"--ooo, -o"ANSI_RESET"\n" \
+                        "   \tRuns an out-of-order core instead of the pipeline: "ANSI_UNDER"lanes"ANSI_RESET" instructions\n" \
+                        "   \tare renamed, issued and committed a cycle, loads go to the data\n" \
+                        "   \tcache as soon as no older store is in the way, stores write at\n" \
+                        "   \tcommit. Fetch waits for branches, nothing is speculated.\n" \
+                        "   "ANSI_BOLD"--rob-entries "ANSI_RUNDER"entries"ANSI_RBOLD", -R "ANSI_RUNDER"entries"ANSI_RESET"\n" \
+                        "   "ANSI_BOLD"--rs-entries "ANSI_RUNDER"entries"ANSI_RBOLD", -u "ANSI_RUNDER"entries"ANSI_RESET"\n" \
+                        "   "ANSI_BOLD"--lsq-entries "ANSI_RUNDER"entries"ANSI_RBOLD", -q "ANSI_RUNDER"entries"ANSI_RESET"\n" \
+                        "   \tSizes the reorder buffer (1 to 256, default 32), the reservation\n" \
+                        "   \tstations (default 16) and the load/store queue (default 8).\n" \
+                        "   "ANSI_BOLD"--decoupled, -f"ANSI_RESET"\n" \
+                        "   \tRuns the program on a functional front-end thread and replays each\n" \
+                        "   \tinstruction it ran through the pipeline and caches for timing on\n" \
+                        "   \tanother, overlapping the two. Same cycle counts as the pipeline, but\n" \
+                        "   \tthe registers at halt include the instructions still in flight.\n" \
+                        "   \tFive-stage pipeline only, interactive mode is turned off.\n" \
+                        "Branch prediction options:\n" \
+                        "   "ANSI_BOLD"--bp "ANSI_RUNDER"type"ANSI_RBOLD", -b "ANSI_RUNDER"type"ANSI_RESET"\n" \
+                        "   \tSelects the branch predictor. "ANSI_UNDER"type"ANSI_RESET" may be:\n" \
+                        "   \t"ANSI_BOLD"none"ANSI_RESET" - (default) branches resolve in decode and nothing is predicted.\n" \
+                        "   \t"ANSI_BOLD"static"ANSI_RESET" - branches resolve in execute, always predicted not taken.\n" \
+                        "   \t"ANSI_BOLD"bimodal"ANSI_RESET" - 2-bit counters indexed by PC.\n" \
+                        "   \t"ANSI_BOLD"gshare"ANSI_RESET" - 2-bit counters indexed by PC xor global history.\n" \
+                        "   \t"ANSI_BOLD"tournament"ANSI_RESET" - bimodal and gshare with a per-PC chooser.\n" \
+                        "   \tWith a predictor, fetch follows the prediction past the delay slot\n" \
+                        "   \tand a wrong path is flushed when the branch reaches execute.\n" \
+                        "   "ANSI_BOLD"--bp-entries "ANSI_RUNDER"entries"ANSI_RBOLD", -e "ANSI_RUNDER"entries"ANSI_RESET"\n" \
+                        "   "ANSI_BOLD"--btb-entries "ANSI_RUNDER"entries"ANSI_RBOLD", -t "ANSI_RUNDER"entries"ANSI_RESET"\n" \
+                        "   \tSets the counters in each predictor table (default 256) and the\n" \
+                        "   \tbranch target buffer entries (default 64). Both must be 2^n up to 65536.\n" \
+                        "   "ANSI_BOLD"--ras-depth "ANSI_RUNDER"entries"ANSI_RBOLD", -r "ANSI_RUNDER"entries"ANSI_RESET"\n" \
+                        "   \tSets the depth of the return address stack that predicts jr $ra,\n" \
+                        "   \tpushed by each jal. 0 to 64, defaults to 8, 0 leaves returns to the BTB.\n");
+                printf( "Multicore options:\n" \
+                        "   "ANSI_BOLD"--cores "ANSI_RUNDER"cores"ANSI_RBOLD", -n "ANSI_RUNDER"cores"ANSI_RESET"\n" \
+                        "   \tRuns the program on "ANSI_UNDER"cores"ANSI_RESET" five-stage pipelines at once, 1 to 16,\n" \
+                        "   \tdefaults to 1. They all start at the same address, $k0 holds the\n" \
+                        "   \tcore number and $k1 the number of cores. Each gets its own split\n" \
+                        "   \tcaches sharing the bus and write buffer. ll and sc synchronize them.\n" \
+                        "   \tWide issue, out-of-order, branch prediction, prefetching, victim\n" \
+                        "   \tcaches and profiling are turned off.\n" \
+                        "   "ANSI_BOLD"--coherence "ANSI_RUNDER"protocol"ANSI_RBOLD", -x "ANSI_RUNDER"protocol"ANSI_RESET"\n" \
+                        "   \tKeeps the data caches coherent by snooping the bus with "ANSI_BOLD"msi"ANSI_RESET" or\n" \
+                        "   \t"ANSI_BOLD"mesi"ANSI_RESET" (default). MESI loads a block nobody else has exclusive, so\n" \
+                        "   \ta later store to it needs no bus upgrade.\n" \
+                        "   "ANSI_BOLD"--quantum "ANSI_RUNDER"cycles"ANSI_RBOLD", -Z "ANSI_RUNDER"cycles"ANSI_RESET"\n" \
+                        "   \tLets the cores run "ANSI_UNDER"cycles"ANSI_RESET" apart, each on its own bus and write\n" \
+                        "   \tbuffer, meeting between quanta to settle coherence. A miss or\n" \
+                        "   \tupgrade waits for the next meeting, so a bigger quantum runs faster\n" \
+                        "   \tbut less accurately. 0 (default) runs them in lockstep on one bus.\n" \
+                        "   \tTurns the data caches on and interactive mode off.\n" \
+                        "   "ANSI_BOLD"--host-threads "ANSI_RUNDER"threads"ANSI_RBOLD", -A "ANSI_RUNDER"threads"ANSI_RESET"\n" \
+                        "   \tSpreads the cores of a quantum over "ANSI_UNDER"threads"ANSI_RESET" host threads, at most one\n" \
+                        "   \tper core. Defaults to 1, more sets the quantum to %d if it is 0.\n" \
+                        "   \tThe results are the same for any number of threads.\n" \
+                        "\nEmail bug reports to /dev/null\n", MULTICORE_QUANTUM);
                 return -1; // caller should exit
             case 'i': // --interactive
                 flags |= MASK_INTERACTIVE;
                 bprintf("","Interactive mode enabled (flags = 0x%04x).\n",flags);
                 break;
+            case OPT_COMMANDS: // --commands
+                commands_file = optarg;
+                flags |= MASK_INTERACTIVE;
+                bprintf("","Interactive commands will be read from %s.\n",commands_file);
+                break;
             case 'y': // --sanity
                 flags |= MASK_SANITY;
                 bprintf("","Sanity checks enabled (flags = 0x%04x).\n",flags);
@@ -307,6 +676,96 @@ int arguments(int argc, char **argv, FILE** source_fp,
                 flags |= MASK_VERBOSE;
                 bprintf("","Verbose output enabled (flags = 0x%04x).\n",flags);
                 break;
+            case 's': // --stats
+                flags |= MASK_STATS;
+                bprintf("","Statistics dump enabled (flags = 0x%04x).\n",flags);
+                break;
+            case 'j': // --stats-json
+                stats_json = optarg;
+                bprintf("","Statistics will be dumped as JSON to %s.\n",stats_json);
+                break;
+            case 'p': // --profile
+                srv = sscanf(optarg,"%d",&temp);
+                if (!srv || temp < 0) {
+                    cprintf(ANSI_C_YELLOW,"Invalid number of hot spots: %s\n",optarg);
+                } else {
+                    flags |= MASK_PROFILE;
+                    profile_top = temp;
+                    bprintf("","Profiling enabled, reporting %d hot spots (flags = 0x%04x).\n",profile_top,flags);
+                }
+                break;
+            case 'k': // --cpi-interval
+                srv = sscanf(optarg,"%d",&temp);
+                if (!srv || temp < 0) {
+                    cprintf(ANSI_C_YELLOW,"Invalid CPI interval: %s\n",optarg);
+                } else {
+                    cpi_interval = temp;
+                    bprintf("","CPI stack reported every %d cycles.\n",cpi_interval);
+                }
+                break;
+            case OPT_STATS_INTERVAL: // --stats-interval
+                srv = sscanf(optarg,"%d",&temp);
+                if (!srv || temp < 0) {
+                    cprintf(ANSI_C_YELLOW,"Invalid statistics interval: %s\n",optarg);
+                } else {
+                    stats_interval = temp;
+                    bprintf("","Interval statistics written every %d cycles.\n",stats_interval);
+                }
+                break;
+            case OPT_STATS_INTERVAL_FILE: // --stats-interval-file
+                stats_interval_file = optarg;
+                bprintf("","Interval statistics will be written to %s.\n",stats_interval_file);
+                break;
+            case OPT_LIVE_STATS: // --live-stats
+                srv = sscanf(optarg,"%d",&temp);
+                if (!srv || temp < 0) {
+                    cprintf(ANSI_C_YELLOW,"Invalid live statistics interval: %s\n",optarg);
+                } else {
+                    live_stats = temp;
+                    bprintf("","Live statistics published every %d cycles.\n",live_stats);
+                }
+                break;
+            case OPT_LIVE_STATS_NAME: // --live-stats-name
+                live_stats_name = optarg;
+                bprintf("","Live statistics will be published in %s.\n",live_stats_name);
+                break;
+            case 'l': // --check
+                check = true;
+                bprintf("","Lockstep checker enabled.\n");
+                break;
+            case 'z': // --host-stats
+                host_stats = true;
+                bprintf("","Host statistics enabled.\n");
+                break;
+            case 'O': // --host-stages
+                host_stats = true;
+                host_stages = true;
+                bprintf("","Host stage timing enabled.\n");
+                break;
+            case 'U': // --host-counters
+                host_stats = true;
+                host_counters = true;
+                bprintf("","Host counters enabled.\n");
+                break;
+            case OPT_EVENT_LOG: // --event-log
+                event_log = optarg;
+                bprintf("","Events will be recorded to %s.\n",event_log);
+                break;
+            case OPT_EVENT_FILTER: // --event-filter
+                if (!event_filter(optarg)) {
+                    cprintf(ANSI_C_YELLOW,"Invalid event subsystems: %s\n",optarg);
+                    return 1;
+                }
+                bprintf("","Event subsystems set to 0x%02x.\n",event_mask);
+                break;
+            case OPT_EVENT_DECODE: // --event-decode
+                // The filter applies to what is decoded, it may come later
+                event_decode_file = optarg;
+                break;
+            case OPT_PIPE_TRACE: // --pipe-trace
+                pipe_trace = optarg;
+                bprintf("","Pipeline trace will be written to %s.\n",pipe_trace);
+                break;
             /* CPU options */
             case 'g': // --single-cycle
                 cpu_cfg->single_cycle = true;
@@ -325,6 +784,112 @@ int arguments(int argc, char **argv, FILE** source_fp,
                 }
                 bprintf("","CPU$ memory size set to %ld.\n",cpu_cfg->mem_size);
                 break;
+            case 'w': // --issue-width
+                srv = sscanf(optarg,"%d",&temp);
+                if (!srv || temp < 1 || temp > ISSUE_MAX_WIDTH) {
+                    cprintf(ANSI_C_YELLOW,"Invalid issue width: %s\n",optarg);
+                } else {
+                    cpu_cfg->issue_width = temp;
+                }
+                bprintf("","CPU$ issue width set to %d.\n",cpu_cfg->issue_width);
+                break;
+            case 'o': // --ooo
+                cpu_cfg->ooo = true;
+                bprintf("","CPU$ out-of-order core enabled.\n");
+                break;
+            case 'f': // --decoupled
+                cpu_cfg->decoupled = true;
+                bprintf("","CPU$ decoupled functional-first simulation enabled.\n");
+                break;
+            case 'R': // --rob-entries
+            case 'u': // --rs-entries
+            case 'q': // --lsq-entries
+                srv = sscanf(optarg,"%d",&temp);
+                if (!srv || temp < 1 || (c == 'R' && temp > OOO_MAX_ROB)) {
+                    cprintf(ANSI_C_YELLOW,"Invalid number of %s entries: %s\n",c=='R'?"reorder buffer":c=='u'?"reservation station":"load/store queue",optarg);
+                } else if (c == 'R') {
+                    cpu_cfg->rob_entries = temp;
+                } else if (c == 'u') {
+                    cpu_cfg->rs_entries = temp;
+                } else {
+                    cpu_cfg->lsq_entries = temp;
+                }
+                bprintf("","CPU$ %d ROB, %d RS, %d LSQ entries.\n",cpu_cfg->rob_entries,cpu_cfg->rs_entries,cpu_cfg->lsq_entries);
+                break;
+            case 'n': // --cores
+                srv = sscanf(optarg,"%d",&temp);
+                if (!srv || temp < 1 || temp > COHERENCE_MAX_CORES) {
+                    cprintf(ANSI_C_YELLOW,"Invalid number of cores: %s\n",optarg);
+                } else {
+                    cpu_cfg->cores = temp;
+                }
+                bprintf("","CPU$ cores set to %d.\n",cpu_cfg->cores);
+                break;
+            case 'x': // --coherence
+                if (!strcmp(optarg,"msi")) {
+                    cache_cfg->coherence = CACHE_MSI;
+                } else if (!strcmp(optarg,"mesi")) {
+                    cache_cfg->coherence = CACHE_MESI;
+                } else {
+                    cprintf(ANSI_C_YELLOW,"Invalid coherence protocol: %s\n",optarg);
+                }
+                bprintf("","CACHE$ coherence protocol: %s.\n",CACHE_COHERENCE_STRINGS[cache_cfg->coherence]);
+                break;
+            case 'Z': // --quantum
+                srv = sscanf(optarg,"%d",&temp);
+                if (!srv || temp < 0) {
+                    cprintf(ANSI_C_YELLOW,"Invalid quantum: %s\n",optarg);
+                } else {
+                    cpu_cfg->quantum = temp;
+                }
+                bprintf("","CPU$ quantum set to %d cycles.\n",cpu_cfg->quantum);
+                break;
+            case 'A': // --host-threads
+                srv = sscanf(optarg,"%d",&temp);
+                if (!srv || temp < 1 || temp > COHERENCE_MAX_CORES) {
+                    cprintf(ANSI_C_YELLOW,"Invalid number of host threads: %s\n",optarg);
+                } else {
+                    cpu_cfg->host_threads = temp;
+                }
+                bprintf("","CPU$ host threads set to %d.\n",cpu_cfg->host_threads);
+                break;
+            case 'b': // --bp
+                if (!strcmp(optarg,"none") || !strcmp(optarg,"n")) {
+                    cpu_cfg->bp_type = BP_NONE;
+                } else if (!strcmp(optarg,"static") || !strcmp(optarg,"s")) {
+                    cpu_cfg->bp_type = BP_STATIC;
+                } else if (!strcmp(optarg,"bimodal") || !strcmp(optarg,"b")) {
+                    cpu_cfg->bp_type = BP_BIMODAL;
+                } else if (!strcmp(optarg,"gshare") || !strcmp(optarg,"g")) {
+                    cpu_cfg->bp_type = BP_GSHARE;
+                } else if (!strcmp(optarg,"tournament") || !strcmp(optarg,"t")) {
+                    cpu_cfg->bp_type = BP_TOURNAMENT;
+                } else {
+                    cprintf(ANSI_C_YELLOW,"Invalid branch predictor: %s\n",optarg);
+                }
+                bprintf("","CPU$ branch predictor: %s.\n",BP_TYPE_STRINGS[cpu_cfg->bp_type]);
+                break;
+            case 'e': // --bp-entries
+            case 't': // --btb-entries
+                srv = sscanf(optarg,"%d",&temp);
+                if (!srv || temp <= 0 || (temp&(temp-1)) || temp > BP_MAX_ENTRIES) {
+                    cprintf(ANSI_C_YELLOW,"Invalid number of %s entries: %s\n",c=='e'?"predictor":"BTB",optarg);
+                } else if (c == 'e') {
+                    cpu_cfg->bp_entries = temp;
+                } else {
+                    cpu_cfg->btb_entries = temp;
+                }
+                bprintf("","CPU$ %d predictor entries, %d BTB entries.\n",cpu_cfg->bp_entries,cpu_cfg->btb_entries);
+                break;
+            case 'r': // --ras-depth
+                srv = sscanf(optarg,"%d",&temp);
+                if (!srv || temp < 0 || temp > RAS_MAX_DEPTH) {
+                    cprintf(ANSI_C_YELLOW,"Invalid return address stack depth: %s\n",optarg);
+                } else {
+                    cpu_cfg->ras_depth = temp;
+                }
+                bprintf("","CPU$ return address stack depth set to %d.\n",cpu_cfg->ras_depth);
+                break;
             /* Cache options */
             case 'c': // --cache-mode
                 if (!strcmp(optarg,"disabled") || !strcmp(optarg,"d")) {
@@ -395,6 +960,46 @@ int arguments(int argc, char **argv, FILE** source_fp,
                 }
                 bprintf("","CACHE$ data cache write policy set to %s.\n",CACHE_WPOLICY_STRINGS[cache_cfg->data_wpolicy]);
                 break;
+            case 'N': // --cache-dmshr
+                srv = sscanf(optarg,"%d",&temp);
+                if (!srv) {
+                    cprintf(ANSI_C_YELLOW,"D-cache MSHR count must be a number: %s\n",optarg);
+                } else {
+                    if (temp >= 1 && temp <= CACHE_MSHR_MAX) {
+                        cache_cfg->data_mshrs = temp;
+                    } else {
+                        cprintf(ANSI_C_YELLOW,"Invalid d-cache MSHR count: %d\n", temp);
+                    }
+                }
+                bprintf("","CACHE$ data cache MSHRs set to %d.\n",cache_cfg->data_mshrs);
+                break;
+            case 'P': // --cache-dprefetch
+                if (!strcmp(optarg,"none") || !strcmp(optarg,"n")) {
+                    cache_cfg->data_prefetch = CACHE_PREFETCH_NONE;
+                } else if (!strcmp(optarg,"next") || !strcmp(optarg,"x")) {
+                    cache_cfg->data_prefetch = CACHE_PREFETCH_NEXTLINE;
+                } else if (!strcmp(optarg,"stride") || !strcmp(optarg,"s")) {
+                    cache_cfg->data_prefetch = CACHE_PREFETCH_STRIDE;
+                } else if (!strcmp(optarg,"stream") || !strcmp(optarg,"b")) {
+                    cache_cfg->data_prefetch = CACHE_PREFETCH_STREAM;
+                } else {
+                    cprintf(ANSI_C_YELLOW,"Invalid data cache prefetcher: %s\n", optarg);
+                }
+                bprintf("","CACHE$ data cache prefetcher set to %s.\n",CACHE_PREFETCH_STRINGS[cache_cfg->data_prefetch]);
+                break;
+            case 'X': // --cache-dvictim
+                srv = sscanf(optarg,"%d",&temp);
+                if (!srv) {
+                    cprintf(ANSI_C_YELLOW,"D-cache victim entries must be a number: %s\n",optarg);
+                } else {
+                    if (temp >= 0 && temp <= VICTIM_MAX_ENTRIES) {
+                        cache_cfg->data_victim = temp;
+                    } else {
+                        cprintf(ANSI_C_YELLOW,"Invalid d-cache victim entries: %d\n", temp);
+                    }
+                }
+                bprintf("","CACHE$ data victim cache entries set to %d.\n",cache_cfg->data_victim);
+                break;
             case 'I': // --cache-inst
                 if (!strcmp(optarg,"disabled") || !strcmp(optarg,"d")) {
                     cache_cfg->inst_enabled = false;
@@ -451,6 +1056,33 @@ int arguments(int argc, char **argv, FILE** source_fp,
                 }
                 bprintf("","CACHE$ instruction cache write policy set to %s.\n",CACHE_WPOLICY_STRINGS[cache_cfg->inst_wpolicy]);
                 break;
+            case 'Q': // --cache-iprefetch
+                if (!strcmp(optarg,"none") || !strcmp(optarg,"n")) {
+                    cache_cfg->inst_prefetch = CACHE_PREFETCH_NONE;
+                } else if (!strcmp(optarg,"next") || !strcmp(optarg,"x")) {
+                    cache_cfg->inst_prefetch = CACHE_PREFETCH_NEXTLINE;
+                } else if (!strcmp(optarg,"stride") || !strcmp(optarg,"s")) {
+                    cache_cfg->inst_prefetch = CACHE_PREFETCH_STRIDE;
+                } else if (!strcmp(optarg,"stream") || !strcmp(optarg,"b")) {
+                    cache_cfg->inst_prefetch = CACHE_PREFETCH_STREAM;
+                } else {
+                    cprintf(ANSI_C_YELLOW,"Invalid instruction cache prefetcher: %s\n", optarg);
+                }
+                bprintf("","CACHE$ instruction cache prefetcher set to %s.\n",CACHE_PREFETCH_STRINGS[cache_cfg->inst_prefetch]);
+                break;
+            case 'Y': // --cache-ivictim
+                srv = sscanf(optarg,"%d",&temp);
+                if (!srv) {
+                    cprintf(ANSI_C_YELLOW,"I-cache victim entries must be a number: %s\n",optarg);
+                } else {
+                    if (temp >= 0 && temp <= VICTIM_MAX_ENTRIES) {
+                        cache_cfg->inst_victim = temp;
+                    } else {
+                        cprintf(ANSI_C_YELLOW,"Invalid i-cache victim entries: %d\n", temp);
+                    }
+                }
+                bprintf("","CACHE$ instruction victim cache entries set to %d.\n",cache_cfg->inst_victim);
+                break;
             /* Unified cache options */
             case 'B': // --cache-block
                 srv = sscanf(optarg,"%d",&temp);
@@ -507,6 +1139,84 @@ int arguments(int argc, char **argv, FILE** source_fp,
         }
     }
 
+    if ((cpu_cfg->issue_width > 1 || cpu_cfg->ooo) && cpu_cfg->bp_type != BP_NONE) {
+        cprintf(ANSI_C_YELLOW,"Branch prediction is not modelled with wide issue or out of order, ignoring it.\n");
+        cpu_cfg->bp_type = BP_NONE;
+    }
+    if (cpu_cfg->cores > 1) {
+        // Every core is a plain five-stage pipeline with split, coherent caches
+        if (cpu_cfg->issue_width > 1 || cpu_cfg->ooo || cpu_cfg->bp_type != BP_NONE) {
+            cprintf(ANSI_C_YELLOW,"Multiple cores run the five-stage pipeline without prediction, ignoring the issue options.\n");
+            cpu_cfg->issue_width = 1;
+            cpu_cfg->ooo = false;
+            cpu_cfg->bp_type = BP_NONE;
+        }
+        if (cache_cfg->mode == CACHE_UNIFIED) {
+            cprintf(ANSI_C_YELLOW,"Multiple cores need split caches, using them.\n");
+            cache_cfg->mode = CACHE_SPLIT;
+        }
+        if (cache_cfg->data_prefetch != CACHE_PREFETCH_NONE || cache_cfg->data_victim) {
+            cprintf(ANSI_C_YELLOW,"Data prefetching and victim caches are not kept coherent, ignoring them.\n");
+            cache_cfg->data_prefetch = CACHE_PREFETCH_NONE;
+            cache_cfg->data_victim = 0;
+        }
+        if (flags & MASK_PROFILE) {
+            cprintf(ANSI_C_YELLOW,"Profiling follows a single core, ignoring it.\n");
+            flags &= ~MASK_PROFILE;
+        }
+        if (cpu_cfg->host_threads > 1 && !cpu_cfg->quantum) cpu_cfg->quantum = MULTICORE_QUANTUM;
+        if (cpu_cfg->host_threads > cpu_cfg->cores) cpu_cfg->host_threads = cpu_cfg->cores;
+        if (cpu_cfg->quantum) {
+            // Cores running apart only hear of each other through their data caches
+            if (cache_cfg->mode == CACHE_DISABLE || !cache_cfg->data_enabled) {
+                cprintf(ANSI_C_YELLOW,"Cores running apart need their data caches, turning them on.\n");
+                cache_cfg->mode = CACHE_SPLIT;
+                cache_cfg->data_enabled = true;
+            }
+            if (flags & MASK_INTERACTIVE) {
+                cprintf(ANSI_C_YELLOW,"Interactive mode steps single cycles, ignoring it with a quantum.\n");
+                flags &= ~MASK_INTERACTIVE;
+            }
+        }
+    } else if (cpu_cfg->quantum || cpu_cfg->host_threads > 1) {
+        cprintf(ANSI_C_YELLOW,"A quantum and host threads need several cores, ignoring them.\n");
+        cpu_cfg->quantum = 0;
+        cpu_cfg->host_threads = 1;
+    }
+    if (check && (cpu_cfg->issue_width > 1 || cpu_cfg->ooo || cpu_cfg->cores > 1 || cpu_cfg->decoupled)) {
+        cprintf(ANSI_C_YELLOW,"The checker follows the five-stage pipeline of one core, ignoring it.\n");
+        check = false;
+    }
+    if (pipe_trace != NULL && (cpu_cfg->issue_width > 1 || cpu_cfg->ooo || cpu_cfg->cores > 1 || cpu_cfg->decoupled)) {
+        cprintf(ANSI_C_YELLOW,"The pipeline trace follows the five-stage pipeline of one core, ignoring it.\n");
+        pipe_trace = NULL;
+    }
+    if (cpu_cfg->decoupled) {
+        // The replay only knows the scalar pipeline
+        if (cpu_cfg->issue_width > 1 || cpu_cfg->ooo || cpu_cfg->cores > 1) {
+            cprintf(ANSI_C_YELLOW,"Decoupled simulation replays the five-stage pipeline of one core, ignoring it.\n");
+            cpu_cfg->decoupled = false;
+        } else if (flags & MASK_INTERACTIVE) {
+            cprintf(ANSI_C_YELLOW,"Registers run ahead of the pipeline when decoupled, ignoring interactive mode.\n");
+            flags &= ~MASK_INTERACTIVE;
+        }
+    }
+    if (cache_cfg->mode == CACHE_DISABLE) {
+        // Fetch and memory go straight to main memory
+        cache_cfg->data_enabled = false;
+        cache_cfg->inst_enabled = false;
+    }
+    cache_cfg->cores = cpu_cfg->cores;
+    cache_cfg->quantum = cpu_cfg->quantum;
+    cache_cfg->timing_only = cpu_cfg->decoupled;
+    // The shadow cache behind the 3C counters costs every access, only keep it if they are printed
+    cache_cfg->classify = (flags & MASK_STATS) || stats_json != NULL || stats_interval || live_stats;
+
+    if (event_decode_file != NULL) {
+        // Nothing is simulated
+        return event_decode(event_decode_file, stdout) ? -1 : 1;
+    }
+
     /* Print any remaining command line arguments (not options). */
     if (optind < argc) {
         if (argc-optind > 1) {
@@ -588,98 +1298,250 @@ int parse(FILE *fp, asm_line_t *lines, cpu_config_t cpu_cfg) {
     printf("Successfully extracted %d lines\n",count);
     return count;
 }
-// Breakpoint wrappers
-int breakpoint_get_active(void) {
-    int i, sum = 0;
-    for (i = 0; i < BREAKPOINT_MAX; ++i) {
-        sum += breakpoints_status[i] & 0x1;
+// Drops into interactive mode at a breakpoint or after a watched access
+void breakpoint_check(pc_t current_pc) {
+    watch_hit_t hit;
+    bool stop = false;
+    if ((flags & MASK_BREAKPOINTS) && breakpoint_at(current_pc)) {
+        cprintf(ANSI_C_GREEN, "Halted at breakpoint (pc = 0x%08x)\n",current_pc);
+        stop = true;
+    }
+    if ((flags & MASK_WATCHPOINTS) && watch_hit(&hit)) {
+        cprintf(ANSI_C_GREEN, "Halted at watchpoint, %s 0x%08x %s 0x%08x by the instruction at 0x%08x (pc = 0x%08x)\n",
+            hit.write?"store of":"load of",hit.value,hit.write?"to":"from",hit.address,hit.pc,current_pc);
+        stop = true;
+    }
+    if (stop) {
+        // Debug and verbose output stay as they were, the n and u commands
+        // would print every stage of every cycle they run otherwise
+        flags |= MASK_INTERACTIVE;
+        interactive_steps = 0;
+        until.kind = UNTIL_NONE;
     }
-    return sum;
 }
-void breakpoint_add(uint32_t address) {
-    int i = 0;
-    do {
-        if (!(breakpoints_status[i] & 0x1)) {
-            breakpoints_address[i] = address;
-            breakpoints_status[i] |= 0x1;
-            break;
+static const char * const UNTIL_STRINGS[] = {
+    [UNTIL_NONE]    = "none",
+    [UNTIL_PC]      = "pc",
+    [UNTIL_CYCLE]   = "cycle",
+    [UNTIL_REG]     = "reg",
+    [UNTIL_MEM]     = "mem"
+};
+
+// The terminal is switched to single keypresses once, at the first prompt,
+// and back when the simulator exits. Commands come from a file or a pipe
+// instead in batch mode, one character each followed by their arguments.
+static void interactive_restore(void) {
+    if (interactive_tty) tcsetattr(STDIN_FILENO, TCSAFLUSH, &interactive_saved);
+    interactive_tty = false;
+}
+
+static void interactive_signal(int sig) {
+    interactive_restore();
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+/* Picks where the commands come from: the commands file, then a terminal
+*  switched to keypresses, otherwise stdin read as a batch
+*/
+static void interactive_open(void) {
+    if (commands_file != NULL && interactive_fp == NULL) {
+        interactive_fp = fopen(commands_file, "r");
+        if (interactive_fp != NULL) return;
+        cprintf(ANSI_C_YELLOW,"Unable to read commands from %s, reading them from stdin.\n",commands_file);
+    }
+    interactive_fp = stdin;
+    if (isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &interactive_saved) == 0) {
+        struct termios raw = interactive_saved;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        raw.c_cc[VMIN] = 1;
+        raw.c_cc[VTIME] = 0;
+        if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) == 0) {
+            interactive_tty = true;
+            atexit(interactive_restore);
+            signal(SIGINT, interactive_signal);
+            signal(SIGTERM, interactive_signal);
         }
-    } while (i++ < BREAKPOINT_MAX);
-    cprintf(ANSI_C_GREEN, "Added breakpoint at 0x%08x, %d active breakpoints\n",
-        address,
-        breakpoint_get_active());
+    }
 }
-void breakpoint_dump(void) {
-    int i = 0;
-    printf("\tIndex Status  Address\n");
-    for (i = 0; i < BREAKPOINT_MAX; ++i) {
-        printf("%s\t(%2d)  %s     0x%08x\n" ANSI_RESET,
-            (breakpoints_status[i] & 0x1)?(ANSI_C_CYAN):(ANSI_RESET),
-            i,
-            (breakpoints_status[i] & 0x1)?"SET":"---",
-            breakpoints_address[i]);
+
+/* Reads the next command, a keypress on a terminal or the next character
+*  that isn't blank in batch mode
+*  @returns EOF once the commands run out
+*/
+static int interactive_key(void) {
+    char c;
+    if (interactive_tty) return getchar();
+    if (fscanf(interactive_fp, " %c", &c) != 1) return EOF;
+    return c;
+}
+
+/* Reads an argument of a command into buf: a line typed on the terminal,
+*  edited with backspace, or the next word in batch mode
+*  @returns false if there is none
+*/
+static bool interactive_word(const char *prompt, char *buf, size_t size) {
+    size_t n = 0;
+    int c;
+    fflush(stdout);
+    cprintf(ANSI_C_GREEN, "%s", prompt);
+    if (!interactive_tty) {
+        char format[16];
+        snprintf(format, sizeof(format), "%%%zus", size - 1);
+        if (fscanf(interactive_fp, format, buf) != 1) {
+            printf("\n");
+            return false;
+        }
+        printf("%s\n", buf);
+        fflush(stdout);
+        return true;
+    }
+    while ((c = getchar()) != EOF && c != '\n' && c != '\r') {
+        if ((c == 127 || c == '\b') && n > 0) {
+            --n;
+            printf("\b \b");
+        } else if (isgraph(c) && n + 1 < size) {
+            buf[n++] = c;
+            putchar(c);
+        }
+        fflush(stdout);
     }
+    printf("\n");
+    buf[n] = '\0';
+    return n > 0;
 }
-void breakpoint_delete(int n) {
-    if (breakpoints_status[n] & 0x1) {
-        breakpoints_status[n] &= ~(0x1);
-        cprintf(ANSI_C_GREEN, "Cleared breakpoint at 0x%08x, %d active breakpoints\n",
-            breakpoints_address[n],
-            breakpoint_get_active());
-        breakpoints_address[n] = 0x0;
-    } else {
-        cprintf(ANSI_C_GREEN, "Breakpoint not set, so not cleared. Pay attention!\n");
+
+/* Reads a number argument, in base (0 for C notation)
+*  @returns false if there is none or it doesn't parse
+*/
+static bool interactive_number(const char *prompt, int base, uint32_t *value) {
+    char buf[32], *end;
+    if (!interactive_word(prompt, buf, sizeof(buf))) return false;
+    *value = strtoul(buf, &end, base);
+    if (*end != '\0') {
+        printf("Not a number: %s\n", buf);
+        return false;
     }
+    return true;
 }
-void breakpoint_check(pc_t current_pc) {
-    int i = 0;
-    for (i = 0; i < BREAKPOINT_MAX; ++i) {
-        if ((breakpoints_status[i] & 0x1) && (current_pc == breakpoints_address[i])) {
-            flags |= MASK_INTERACTIVE | MASK_DEBUG | MASK_VERBOSE;
-            cprintf(ANSI_C_GREEN, "Halted at breakpoint %d (pc = 0x%08x)\n",i,current_pc);
+
+/* Reads the condition of a run-until */
+static bool interactive_until(void) {
+    char buf[16];
+    until_t next = {.kind = UNTIL_NONE};
+    if (!interactive_word("until (pc, cycle, reg or mem): ", buf, sizeof(buf))) return false;
+    for (int i = UNTIL_PC; i <= UNTIL_MEM; ++i) {
+        if (!strcmp(buf, UNTIL_STRINGS[i])) next.kind = i;
+    }
+    switch (next.kind) {
+        case UNTIL_PC:
+            if (!interactive_number("pc: ", 16, &next.where)) return false;
             break;
-        }
+        case UNTIL_CYCLE:
+            if (!interactive_number("cycle: ", 10, &next.where)) return false;
+            break;
+        case UNTIL_REG:
+            if (!interactive_number("register number: ", 10, &next.where) || !interactive_number("equals: ", 0, &next.value)) return false;
+            if (next.where >= 32) {
+                printf("Register out of range\n");
+                return false;
+            }
+            break;
+        case UNTIL_MEM:
+            if (!interactive_number("memory address: ", 16, &next.where) || !interactive_number("equals: ", 0, &next.value)) return false;
+            if (next.where < mem_start() || next.where > mem_end()) {
+                printf("Address out of range\n");
+                return false;
+            }
+            break;
+        default:
+            printf("Unrecognized condition \"%s\"\n", buf);
+            return false;
+    }
+    until = next;
+    return true;
+}
+
+/* Whether a run-until is over after the cycle that just ended */
+static bool interactive_until_met(uint32_t cycles) {
+    word_t value = 0;
+    switch (until.kind) {
+        case UNTIL_PC:      return pc == until.where;
+        case UNTIL_CYCLE:   return cycles >= until.where;
+        case UNTIL_REG:     reg_read(until.where, &value); return value == until.value;
+        case UNTIL_MEM:     mem_read_w(until.where, &value); return value == until.value;
+        default:            return true;
     }
 }
+
 // Provides a crude interactive debugger for the simulator
-int interactive(asm_line_t* lines) {
+int interactive(asm_line_t* lines, uint32_t cycles) {
     uint32_t i_addr = 0, i_data;
     asm_line_t line;
+    char kind[8];
+    watch_kind_t watch;
+    int c;
+    // Still running a step or run-until
+    if (interactive_steps) {
+        --interactive_steps;
+        return 0;
+    }
+    if (until.kind != UNTIL_NONE) {
+        if (!interactive_until_met(cycles)) return 0;
+        cprintf(ANSI_C_GREEN, "Stopped at cycle %d (pc = 0x%08x), %s condition met.\n",cycles,pc,UNTIL_STRINGS[until.kind]);
+        until.kind = UNTIL_NONE;
+    }
+    if (interactive_fp == NULL) interactive_open();
 PROMPT: // LOL gotos
+    fflush(stdout); // the prompt goes to stderr, after what the cycle printed
     cprintf(ANSI_C_GREEN, "(interactive) > ");
-    system ("/bin/stty raw"); // set terminal to raw/unbuffered
-    char c = getchar();
-    system ("/bin/stty sane"); // set back to sane
+    c = interactive_key();
+    if (c == EOF) {
+        printf("\n");
+        // Out of commands, stdin takes over from a commands file
+        if (interactive_fp != stdin) {
+            fclose(interactive_fp);
+            interactive_open();
+            goto PROMPT;
+        }
+        flags &= ~(MASK_INTERACTIVE | MASK_VERBOSE | MASK_DEBUG);
+        cprintf(ANSI_C_GREEN, "No more commands. Running until breakpoint (if set).\n");
+        return 0;
+    }
     printf("%c\n",c);
+    fflush(stdout);
     switch(c) {
         case 'a': // add a breakpoint
-            if (breakpoint_get_active() >= BREAKPOINT_MAX) {
-                cprintf(ANSI_C_GREEN, "Cannot add breakpoint, active breakpoint limit reached.\n");
+            if (!interactive_number("breakpoint address: ", 16, &i_addr)) goto PROMPT;
+            if (i_addr < mem_start() || i_addr > mem_end()) {
+                printf("Address out of range\n");
+                goto PROMPT;
+            }
+            if (breakpoint_add(i_addr)) {
+                cprintf(ANSI_C_GREEN, "Added breakpoint at 0x%08x, %d active breakpoints\n",i_addr,breakpoint_get_active());
             } else {
-                cprintf(ANSI_C_GREEN, "breakpoint address: ");
-                scanf("%x",&i_addr); getchar();
-                if (i_addr < mem_start() || i_addr > mem_end()) {
-                    printf("Address out of range\n");
-                    goto PROMPT;
-                }
-                breakpoint_add(i_addr);
-
+                cprintf(ANSI_C_GREEN, "Breakpoint already set at 0x%08x.\n",i_addr);
             }
             goto PROMPT;
-        case 'b': // list breakpoints
-            if (breakpoint_get_active() == 0) {
-                cprintf(ANSI_C_GREEN, "No breakpoints active.\n");
+        case 'b': // list breakpoints and watchpoints
+            if (breakpoint_get_active() == 0 && watch_get_active() == 0) {
+                cprintf(ANSI_C_GREEN, "No breakpoints or watchpoints active.\n");
             } else {
                 breakpoint_dump();
             }
             goto PROMPT;
-        case 'c': // clear a breakpoint
-            if (breakpoint_get_active() == 0) {
-                cprintf(ANSI_C_GREEN, "No breakpoints active.\n");
+        case 'c': // clear the breakpoint and watchpoint at an address
+            if (breakpoint_get_active() == 0 && watch_get_active() == 0) {
+                cprintf(ANSI_C_GREEN, "No breakpoints or watchpoints active.\n");
             } else {
-                cprintf(ANSI_C_GREEN, "breakpoint number to clear: ");
-                scanf("%d",&i_addr); getchar();
-                if (i_addr < BREAKPOINT_MAX) breakpoint_delete(i_addr);
+                if (!interactive_number("address to clear: ", 16, &i_addr)) goto PROMPT;
+                bool cleared = breakpoint_delete(i_addr);
+                cleared |= watch_delete(i_addr);
+                if (cleared) {
+                    cprintf(ANSI_C_GREEN, "Cleared 0x%08x, %d active breakpoints and %d watchpoints\n",i_addr,breakpoint_get_active(),watch_get_active());
+                } else {
+                    cprintf(ANSI_C_GREEN, "Nothing set at 0x%08x, so not cleared. Pay attention!\n",i_addr);
+                }
             }
             goto PROMPT;
         case 'd': // disable interactive (disable verbose and debug as well to avoid flood)
@@ -687,8 +1549,11 @@ PROMPT: // LOL gotos
             cprintf(ANSI_C_GREEN, "Interactive stepping disabled. Running until breakpoint (if set).\n");
             break;
         case 'l': // print the original disassembly for a given address
-            cprintf(ANSI_C_GREEN, "input address: ");
-            scanf("%x",&i_addr); getchar();
+            if (!interactive_number("input address: ", 16, &i_addr)) goto PROMPT;
+            if (i_addr < mem_start() || i_addr > mem_end()) {
+                printf("Address out of range\n");
+                goto PROMPT;
+            }
             line = lines[(i_addr>>2)-(mem_start()>>2)];
             if (line.type == 3) {
                 printf("\t0x%08x: 0x%08x %s\n",line.addr,line.inst,line.comment);
@@ -699,8 +1564,7 @@ PROMPT: // LOL gotos
             }
             goto PROMPT;
         case 'm': // view a word of memory
-            cprintf(ANSI_C_GREEN, "memory address: ");
-            scanf("%x",&i_addr); getchar();
+            if (!interactive_number("memory address: ", 16, &i_addr)) goto PROMPT;
             if (i_addr < mem_start() || i_addr > mem_end()) {
                 printf("Address out of range\n");
                 goto PROMPT;
@@ -708,9 +1572,12 @@ PROMPT: // LOL gotos
             mem_read_w(i_addr, &i_data);
             printf("mem[0x%08x]: 0x%08x (0d%d)\n",i_addr,i_data,i_data);
             goto PROMPT;
+        case 'n': // step a number of cycles
+            if (!interactive_number("cycles: ", 10, &i_data) || i_data == 0) goto PROMPT;
+            interactive_steps = i_data - 1;
+            break;
         case 'o': // view a region of memory
-            cprintf(ANSI_C_GREEN,"memory address: ");
-            scanf("%x",&i_addr); getchar();
+            if (!interactive_number("memory address: ", 16, &i_addr)) goto PROMPT;
             if (i_addr < mem_start() || i_addr > mem_end()) {
                 printf("Address out of range\n");
                 goto PROMPT;
@@ -724,20 +1591,42 @@ PROMPT: // LOL gotos
         case 'r': // dump registers
             reg_dump();
             goto PROMPT;
+        case 'u': // run until a condition holds
+            if (!interactive_until()) goto PROMPT;
+            break;
+        case 'w': // watch a word of memory
+            if (!interactive_word("watch (r, w or rw): ", kind, sizeof(kind))) goto PROMPT;
+            watch = !strcmp(kind, "r") ? WATCH_READ : !strcmp(kind, "w") ? WATCH_WRITE : !strcmp(kind, "rw") ? WATCH_ACCESS : 0;
+            if (!watch) {
+                printf("Unrecognized watch \"%s\"\n", kind);
+                goto PROMPT;
+            }
+            if (!interactive_number("memory address: ", 16, &i_addr)) goto PROMPT;
+            if (!watch_add(i_addr, watch)) {
+                printf("Address out of range\n");
+                goto PROMPT;
+            }
+            cprintf(ANSI_C_GREEN, "Watching 0x%08x, %d active watchpoints\n",i_addr & ~0x3,watch_get_active());
+            goto PROMPT;
         case 'x': // exit
             cprintf(ANSI_C_GREEN, "Simulation halted in interactive mode.\n");
+            interactive_restore();
             return 1;
         case '?': // help
             printf("Available interactive commands: \n" \
                 "\ta: add breakpoint at a memory address\n" \
-                "\tb: list breakpoints\n" \
-                "\tc: clear a breakpoint by breakpoint index\n" \
+                "\tb: list breakpoints and watchpoints\n" \
+                "\tc: clear the breakpoint and watchpoint at a memory address\n" \
                 "\td: disable interactive mode\n" \
                 "\tl: print the original disassembly for a given memory address\n" \
                 "\tm: print a memory word for a given memory address\n" \
+                "\tn: step the pipeline a given number of cycles\n" \
                 "\to: print 11 words of memory surrounding a given memory address\n" \
                 "\ts: single-step the pipeline\n" \
                 "\tr: dump registers\n" \
+                "\tu: run until the pc, the cycle count, a register or a memory word\n" \
+                "\t   reaches a given value (pc 1c, cycle 500, reg 8 0x10, mem 100 7)\n" \
+                "\tw: stop after loads (r), stores (w) or both (rw) of a memory word\n" \
                 "\tx: exit simulation run\n");
             goto PROMPT;
         default:
@@ -7,6 +7,10 @@
 #include <stdbool.h>
 #include <string.h>
 #include <getopt.h>
+#include <ctype.h>
+#include <signal.h>
+#include <termios.h>
+#include <unistd.h>
 
 #include "util.h"
 #include "types.h"
@@ -17,6 +21,21 @@
 #include "alu.h"
 #include "fetch.h"
 #include "hazard.h"
+#include "stats.h"
+#include "profile.h"
+#include "cpi.h"
+#include "branch.h"
+#include "issue.h"
+#include "ooo.h"
+#include "multicore.h"
+#include "decoupled.h"
+#include "checker.h"
+#include "host.h"
+#include "eventlog.h"
+#include "pipetrace.h"
+#include "interval.h"
+#include "live.h"
+#include "breakpoint.h"
 
 // Set at compile time from the Makefile
 //#define VERSION_STRING      "?.?.????"
@@ -45,17 +64,58 @@ const char * const CACHE_WPOLICY_STRINGS[] = {
     [CACHE_WRITEBACK]       = "writeback",
     [CACHE_WRITETHROUGH]    = "writethrough"
 };
+const char * const CACHE_PREFETCH_STRINGS[] = {
+    [CACHE_PREFETCH_NONE]       = "none",
+    [CACHE_PREFETCH_NEXTLINE]   = "next-line",
+    [CACHE_PREFETCH_STRIDE]     = "stride",
+    [CACHE_PREFETCH_STREAM]     = "stream buffers"
+};
+const char * const CACHE_COHERENCE_STRINGS[] = {
+    [CACHE_MSI]             = "MSI",
+    [CACHE_MESI]            = "MESI"
+};
+const char * const BP_TYPE_STRINGS[] = {
+    [BP_NONE]               = "none (resolved in decode)",
+    [BP_STATIC]             = "static not-taken",
+    [BP_BIMODAL]            = "bimodal",
+    [BP_GSHARE]             = "gshare",
+    [BP_TOURNAMENT]         = "tournament"
+};
+
+// Condition a run-until in interactive mode stops at
+typedef enum UNTIL_KIND {
+    UNTIL_NONE,
+    UNTIL_PC,           // the pc reaches where
+    UNTIL_CYCLE,        // the cycle count reaches where
+    UNTIL_REG,          // register where holds value
+    UNTIL_MEM           // the memory word at where holds value
+} until_kind_t;
+
+typedef struct UNTIL {
+    until_kind_t kind;
+    uint32_t where;
+    uint32_t value;
+} until_t;
+
+// Codes of the options that only have a long form, past every character
+enum LONG_OPTION {
+    OPT_EVENT_LOG = 256,
+    OPT_EVENT_FILTER,
+    OPT_EVENT_DECODE,
+    OPT_PIPE_TRACE,
+    OPT_STATS_INTERVAL,
+    OPT_STATS_INTERVAL_FILE,
+    OPT_LIVE_STATS,
+    OPT_LIVE_STATS_NAME,
+    OPT_COMMANDS
+};
 
 int arguments(int argc, char **argv, FILE** source_fp,
         cpu_config_t *cpu_cfg, cache_config_t *cache_cfg);
 
 int parse(FILE *fp, asm_line_t *lines, cpu_config_t cpu_cfg);
 
-int interactive(asm_line_t *lines);
+int interactive(asm_line_t *lines, uint32_t cycles);
 
-// Breakpoint wrappers
-int breakpoint_get_active(void);
-void breakpoint_add(uint32_t address);
-void breakpoint_dump(void);
-void breakpoint_delete(int n);
+// Enters interactive mode at a breakpoint or watchpoint (see breakpoint.h)
 void breakpoint_check(pc_t current_pc);
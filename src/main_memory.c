@@ -3,6 +3,7 @@
  */
 
 #include "main_memory.h"
+#include "eventlog.h"
 
 extern int flags; // from main.c or memory-test.c
 static word_t *mem; // pointer to memory block
@@ -89,9 +90,7 @@ void mem_read_w(uint32_t address, word_t *data) {
         assert(!(index >= length)); // fail fast
     }
     *data = mem[index];
-    if (flags & MASK_DEBUG) {
-        printf("mem_read_w: address 0x%08x, data 0x%08x, array index %d\n",address,*data,index);
-    }
+    EVENT(EV_MAIN_ACCESS, 0, address, *data, index);
 }
 // Read a halfword from a (halfword-aligned) memory address
 void mem_read_h(uint32_t address, word_t *data) {
@@ -104,9 +103,7 @@ void mem_read_h(uint32_t address, word_t *data) {
     *data = mem[index];
     *data >>= shift;
     *data &= 0xffff;
-    if (flags & MASK_DEBUG) {
-        printf("mem_read_h: address 0x%08x, data 0x%08x, array index %d\n",address,*data,index);
-    }
+    EVENT(EV_MAIN_ACCESS, 1, address, *data, index);
 }
 // Read a byte from a memory address
 void mem_read_b(uint32_t address, word_t *data) {
@@ -119,9 +116,7 @@ void mem_read_b(uint32_t address, word_t *data) {
     *data = mem[index];
     *data >>= shift;
     *data &= 0xff;
-    if (flags & MASK_DEBUG) {
-        printf("mem_read_b: address 0x%08x, data 0x%08x, array index %d\n",address,*data,index);
-    }
+    EVENT(EV_MAIN_ACCESS, 2, address, *data, index);
 }
 // Write a word to a (word-aligned) memory address
 void mem_write_w(uint32_t address, word_t *data) {
@@ -131,9 +126,7 @@ void mem_write_w(uint32_t address, word_t *data) {
         assert(!(index >= length)); // fail fast
     }
     mem[index] = *data;
-    if (flags & MASK_DEBUG) {
-        printf("mem_write_w: address 0x%08x, data 0x%08x, array index %d\n",address,*data,index);
-    }
+    EVENT(EV_MAIN_ACCESS, 3, address, *data, index);
 }
 // Write a halfword to a (halfword-aligned) memory address
 void mem_write_h(uint32_t address, word_t *data) {
@@ -145,9 +138,7 @@ void mem_write_h(uint32_t address, word_t *data) {
     }
     mem[index] &= ~(0xffff << shift); // clear the byte we are writing to
     mem[index] |= (*data & 0xffff)<<shift; // set the byte we are writing to
-    if (flags & MASK_DEBUG) {
-        printf("mem_write_h: address 0x%08x, data 0x%08x, array index %d\n",address,*data,index);
-    }
+    EVENT(EV_MAIN_ACCESS, 4, address, *data, index);
 }
 // Write a byte to a memory address
 void mem_write_b(uint32_t address, word_t *data) {
@@ -159,7 +150,5 @@ void mem_write_b(uint32_t address, word_t *data) {
     }
     mem[index] &= ~(0xff << shift); // clear the byte we are writing to
     mem[index] |= (*data & 0xff)<<shift; // set the byte we are writing to
-    if (flags & MASK_DEBUG) {
-        printf("mem_write_b: address 0x%08x, data 0x%08x, array index %d\n",address,*data,index);
-    }
+    EVENT(EV_MAIN_ACCESS, 5, address, *data, index);
 }
@@ -3,15 +3,20 @@
  */
 
 #include "memory.h"
+#include "coherence.h"
+#include "eventlog.h"
 
 extern int flags;
 
 void memory(control_t * exmem, control_t * memwb, cache_config_t *cache_cfg) {
-    if(flags & MASK_DEBUG){
-        cprintf(ANSI_C_CYAN, "MEMORY:\n");
-        printf("\tInstruction: 0x%08x\n", exmem->instr);
-    }
+    EVENT(EV_MEMORY, exmem->instr);
     copy_pipeline_register(exmem, memwb);
+    if (exmem->memDone) {
+        // The access went through before the pipeline was restored. Loads
+        // kept their data in exmem->memData, stores must not be repeated
+        EVENT(EV_MEMORY_DONE);
+        return;
+    }
     word_t temp;
     cache_status_t status = CACHE_NO_ACCESS; //if no memory operation, don't want to send an accidental miss
     if (exmem->memRead) {
@@ -19,7 +24,7 @@ void memory(control_t * exmem, control_t * memwb, cache_config_t *cache_cfg) {
             case OPC_LBU:
             case OPC_LB:
                 if(cache_cfg->data_enabled){
-                    status = d_cache_read_w(&exmem->ALUresult, &temp);
+                    status = d_cache_read_w(&exmem->ALUresult, &temp, exmem->pc);
                     temp = temp >> ((3-(exmem->ALUresult & 0x3))<<3);
                     temp &= 0xff;
                 } else {
@@ -30,7 +35,7 @@ void memory(control_t * exmem, control_t * memwb, cache_config_t *cache_cfg) {
             case OPC_LHU:
             case OPC_LH:
                 if(cache_cfg->data_enabled){
-                    status = d_cache_read_w(&exmem->ALUresult, &temp);
+                    status = d_cache_read_w(&exmem->ALUresult, &temp, exmem->pc);
                     temp = temp >> ((2-(exmem->ALUresult & 0x2))<<3);
                     temp &= 0xffff;
                 } else {
@@ -39,36 +44,38 @@ void memory(control_t * exmem, control_t * memwb, cache_config_t *cache_cfg) {
                 if (exmem->opCode == OPC_LH) temp = SIGN_EXTEND_H(temp);
                 break;
             case OPC_LW:
+            case OPC_LL:
                 if(cache_cfg->data_enabled){
-                    status = d_cache_read_w(&exmem->ALUresult, &temp);
+                    status = d_cache_read_w(&exmem->ALUresult, &temp, exmem->pc);
                 } else {
                     mem_read_w(exmem->ALUresult, &temp);
                 }
+                if(exmem->opCode == OPC_LL && status != CACHE_MISS){
+                    coherence_link(exmem->ALUresult);
+                }
                 break;
             default: // We should not get here. Complain and crash.
                 cprintf(ANSI_C_RED, "Illegal memory operation, opcode 0x%02x, (memRead asserted). Halting.\n", exmem->opCode);
                 assert(0);
         }
-        if(flags & MASK_DEBUG){
-            printf("\tLoaded 0x%08x from address 0x%08x\n", temp, exmem->ALUresult);
-        }
+        EVENT(EV_MEMORY_LOAD, temp, exmem->ALUresult);
+        if ((flags & MASK_WATCHPOINTS) && status != CACHE_MISS) watch_access(exmem->ALUresult, false, exmem->pc, temp);
         memwb->memData = temp;
         memwb->status = status;
     }
     if (exmem->memWrite) {
-        word_t data_in_cache;
+        word_t mask;
+        uint32_t shift;
+        bool stored = true;
         switch (exmem->opCode) {
             case OPC_SB:
                 temp = exmem->regRtValue;
                 if(cache_cfg->data_enabled){
-                    status = d_cache_read_w(&exmem->ALUresult, &data_in_cache);
-                    if(status == CACHE_HIT){
-                        uint32_t shift = ((3-(exmem->ALUresult & 0x3))<<3);
-                        temp = temp << shift;
-                        data_in_cache &= ~(0xff << shift);
-                        temp = temp & data_in_cache;
-                        status = d_cache_write_w(&exmem->ALUresult, &temp);
-                    }
+                    // only the addressed byte lane gets written
+                    shift = ((3-(exmem->ALUresult & 0x3))<<3);
+                    mask = 0xff << shift;
+                    temp = (temp << shift) & mask;
+                    status = d_cache_write_w(&exmem->ALUresult, &temp, mask, exmem->pc);
                 } else {
                     mem_write_b(exmem->ALUresult, &temp);
                 }
@@ -76,14 +83,10 @@ void memory(control_t * exmem, control_t * memwb, cache_config_t *cache_cfg) {
             case OPC_SH:
                 temp = exmem->regRtValue;
                 if(cache_cfg->data_enabled){
-                    status = d_cache_read_w(&exmem->ALUresult, &data_in_cache);
-                    if(status == CACHE_HIT){
-                        uint32_t shift = ((2-(exmem->ALUresult & 0x2))<<3);
-                        temp = temp << shift; // shift amount based on byte position
-                        data_in_cache &= ~(0xffff << shift);
-                        temp = temp & data_in_cache;
-                        status = d_cache_write_w(&exmem->ALUresult, &temp);
-                    }
+                    shift = ((2-(exmem->ALUresult & 0x2))<<3); // shift amount based on byte position
+                    mask = 0xffff << shift;
+                    temp = (temp << shift) & mask;
+                    status = d_cache_write_w(&exmem->ALUresult, &temp, mask, exmem->pc);
                 } else {
                     mem_write_h(exmem->ALUresult, &temp);
                 }
@@ -91,10 +94,22 @@ void memory(control_t * exmem, control_t * memwb, cache_config_t *cache_cfg) {
             case OPC_SW:
                 temp = exmem->regRtValue;
                 if(cache_cfg->data_enabled){
-                    status = d_cache_read_w(&exmem->ALUresult, &temp);
-                    if(status == CACHE_HIT){
-                        status = d_cache_write_w(&exmem->ALUresult, &temp);
-                    }
+                    status = d_cache_write_w(&exmem->ALUresult, &temp, 0xffffffff, exmem->pc);
+                } else {
+                    mem_write_w(exmem->ALUresult, &temp);
+                }
+                break;
+            case OPC_SC:
+                //Only stores if nothing was written to the word since the ll,
+                //rt gets 1 if it did and 0 if it didn't
+                temp = exmem->regRtValue;
+                stored = coherence_linked(exmem->ALUresult);
+                memwb->memData = stored;
+                if(!stored){
+                    break;
+                }
+                if(cache_cfg->data_enabled){
+                    status = d_cache_write_w(&exmem->ALUresult, &temp, 0xffffffff, exmem->pc);
                 } else {
                     mem_write_w(exmem->ALUresult, &temp);
                 }
@@ -103,18 +118,16 @@ void memory(control_t * exmem, control_t * memwb, cache_config_t *cache_cfg) {
                 cprintf(ANSI_C_RED, "Illegal memory operation, opcode 0x%02x, (memWrite asserted). Halting.\n", exmem->opCode);
                 assert(0);
         }
+        if(stored && status != CACHE_MISS){
+            //Breaks the link of every core that did an ll on this word
+            coherence_stored(exmem->ALUresult, exmem->opCode == OPC_SC);
+            if (flags & MASK_WATCHPOINTS) watch_access(exmem->ALUresult, true, exmem->pc, exmem->regRtValue);
+        }
         memwb->status = status;
-        if(flags & MASK_DEBUG){
-            if(cache_cfg->data_enabled){
-                if(memwb->status == CACHE_HIT){
-                    printf("\tStored 0x%08x to address 0x%08x\n", temp, exmem->ALUresult);
-                }
-                else {
-                    printf("\tTried to store 0x%08x to address 0x%08x\n", temp, exmem->ALUresult);
-                }
-            } else {
-                printf("\tStored 0x%08x to address 0x%08x\n", temp, exmem->ALUresult);
-            }
+        if(cache_cfg->data_enabled && memwb->status != CACHE_HIT){
+            EVENT(EV_MEMORY_STORE_MISS, temp, exmem->ALUresult);
+        } else {
+            EVENT(EV_MEMORY_STORE, temp, exmem->ALUresult);
         }
     }
 }
@@ -9,6 +9,7 @@
 #include "util.h"
 #include "main_memory.h"
 #include "cache.h"
+#include "breakpoint.h"
 
 void memory(control_t *exmem, control_t *memwb, cache_config_t *cache_cfg);
 
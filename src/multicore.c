@@ -0,0 +1,246 @@
+/* src/multicore.c
+* Runs several five-stage cores in lockstep
+*/
+
+#include <pthread.h>
+#include "multicore.h"
+#include "registers.h"
+#include "fetch.h"
+#include "decode.h"
+#include "alu.h"
+#include "memory.h"
+#include "write.h"
+
+extern int flags;
+
+static multicore_core_t cores[COHERENCE_MAX_CORES];
+static uint32_t num_cores = 0;
+static pc_t *main_pc = NULL;
+//Running apart, core k runs on host thread k % num_threads, thread 0 is the caller
+static uint32_t quantum = 0;
+static uint32_t num_threads = 1;
+static uint32_t settle_first = 0;       //core whose requests are served first
+static pthread_t threads[COHERENCE_MAX_CORES];
+static pthread_barrier_t barrier;       //start and end of every quantum
+static cache_config_t *quantum_cfg = NULL;
+static bool stopping = false;
+
+static void *multicore_thread(void *arg);
+
+void multicore_init(cpu_config_t *cpu_cfg, control_t *ifid, control_t *idex, control_t *exmem, control_t *memwb, pc_t *pc){
+    if(cpu_cfg->cores < 2 || cpu_cfg->cores > COHERENCE_MAX_CORES){
+        cprintf(ANSI_C_RED, "multicore_init: %d cores requested, must be 2 to %d\n", cpu_cfg->cores, COHERENCE_MAX_CORES);
+        assert(0);
+    }
+    num_cores = cpu_cfg->cores;
+    main_pc = pc;
+    for(uint32_t k = 0; k < num_cores; k++){
+        multicore_core_t *core = &cores[k];
+        memset(core, 0, sizeof(multicore_core_t));
+        if(k == 0){
+            core->ifid = ifid;
+            core->idex = idex;
+            core->exmem = exmem;
+            core->memwb = memwb;
+        } else {
+            pipeline_init(&core->ifid, &core->idex, &core->exmem, &core->memwb, &core->pc, *pc);
+            for(int r = 0; r < 32; r++){
+                reg_read(r, &core->regs[r]);
+            }
+        }
+    }
+    //$k0 is the core number and $k1 the number of cores
+    for(uint32_t k = 0; k < num_cores; k++){
+        word_t value = k;
+        reg_select(k ? cores[k].regs : NULL);
+        reg_write(REG_K0, &value);
+        value = num_cores;
+        reg_write(REG_K1, &value);
+    }
+    reg_select(NULL);
+    quantum = cpu_cfg->quantum;
+    num_threads = 1;
+    settle_first = 0;
+    stopping = false;
+    if(quantum && cpu_cfg->host_threads > 1){
+        num_threads = cpu_cfg->host_threads < num_cores ? cpu_cfg->host_threads : num_cores;
+        pthread_barrier_init(&barrier, NULL, num_threads);
+        for(uint32_t t = 1; t < num_threads; t++){
+            if(pthread_create(&threads[t], NULL, multicore_thread, (void *)(uintptr_t)t) != 0){
+                cprintf(ANSI_C_RED, "multicore_init: unable to start host thread %d\n", t);
+                assert(0);
+            }
+        }
+    }
+    if(flags & MASK_DEBUG){
+        printf("multicore_init: %d cores starting at 0x%08x\n", num_cores, *pc);
+        if(quantum){
+            printf("multicore_init: %d cycle quantum on %d host threads\n", quantum, num_threads);
+        }
+    }
+}
+
+void multicore_free(void){
+    if(num_threads > 1){
+        //Sends the threads waiting for the next quantum home
+        stopping = true;
+        pthread_barrier_wait(&barrier);
+        for(uint32_t t = 1; t < num_threads; t++){
+            pthread_join(threads[t], NULL);
+        }
+        pthread_barrier_destroy(&barrier);
+        num_threads = 1;
+        stopping = false;
+    }
+    quantum = 0;
+    for(uint32_t k = 1; k < num_cores; k++){
+        pipeline_destroy(&cores[k].ifid, &cores[k].idex, &cores[k].exmem, &cores[k].memwb);
+    }
+    reg_select(NULL);
+    num_cores = 0;
+    main_pc = NULL;
+}
+
+/* Runs one clock cycle of core k on the calling host thread */
+static void multicore_step(uint32_t k, cache_config_t *cache_cfg){
+    multicore_core_t *core = &cores[k];
+    pc_t *pc = k ? &core->pc : main_pc;
+    if(flags & MASK_DEBUG){
+        cprintf(ANSI_C_CYAN, "CORE %d:\n", k);
+    }
+    cache_select(k);
+    reg_select(k ? core->regs : NULL);
+    backup(core->ifid, core->idex, core->exmem, core->memwb, pc);
+    writeback(core->memwb);
+    memory(core->exmem, core->memwb, cache_cfg);
+    execute(core->idex, core->exmem);
+    decode(core->ifid, core->idex);
+    fetch(core->ifid, pc, cache_cfg);
+    hazard(core->ifid, core->idex, core->exmem, core->memwb, pc, cache_cfg);
+    pc_t stall_pc;
+    core->stall = hazard_stall_cause(&stall_pc);
+    core->ran = true;
+    core->cycles++;
+    //Same magic halt numbers as the single core (beq zero zero -1 or jr zero)
+    if(core->ifid->instr == 0x1000ffff || core->ifid->instr == 0x00000008 || *pc == 0){
+        core->halted = true;
+        if(flags & MASK_VERBOSE){
+            printf("Core %d halted after %d cycles (address 0x%08x)\n", k, core->cycles, *pc);
+        }
+    }
+}
+
+void multicore_cycle(cache_config_t *cache_cfg){
+    for(uint32_t k = 0; k < num_cores; k++){
+        if(!cores[k].halted){
+            multicore_step(k, cache_cfg);
+        }
+    }
+    cache_select(0);
+    reg_select(NULL);
+}
+
+/* Runs the cores of host thread thread for a quantum, each on its own bus */
+static void multicore_run(uint32_t thread){
+    for(uint32_t k = thread; k < num_cores; k += num_threads){
+        multicore_core_t *core = &cores[k];
+        cache_select(k);
+        coherence_receive(k);
+        core->ran_quantum = 0;
+        for(uint32_t cycle = 0; cycle < quantum; cycle++){
+            if(core->halted){
+                //What it left in flight still has to get through, others may wait on it
+                if(!cache_busy()){
+                    break;
+                }
+                cache_digest();
+                continue;
+            }
+            multicore_step(k, quantum_cfg);
+            cache_digest();
+            //Charged to the core alone, added to the run between quanta
+            uint32_t full_stalls = write_buffer_full_stalls();
+            core->cpi.cycles[cpi_classify(core->stall, full_stalls != core->full_stalls)]++;
+            core->full_stalls = full_stalls;
+            core->ran = false;
+            core->ran_quantum++;
+        }
+    }
+}
+
+static void *multicore_thread(void *arg){
+    uint32_t thread = (uint32_t)(uintptr_t)arg;
+    hazard_init();
+    while(1){
+        pthread_barrier_wait(&barrier);
+        if(stopping){
+            break;
+        }
+        multicore_run(thread);
+        pthread_barrier_wait(&barrier);
+    }
+    hazard_free();
+    return NULL;
+}
+
+uint32_t multicore_quantum(cache_config_t *cache_cfg){
+    quantum_cfg = cache_cfg;
+    if(num_threads > 1){
+        pthread_barrier_wait(&barrier);
+    }
+    multicore_run(0);
+    if(num_threads > 1){
+        pthread_barrier_wait(&barrier);
+    }
+    //Every core stopped, they meet here
+    cache_select(0);
+    reg_select(NULL);
+    cache_publish();
+    coherence_settle(settle_first);
+    settle_first = (settle_first + 1) % num_cores;
+    uint32_t cycles = 0;
+    for(uint32_t k = 0; k < num_cores; k++){
+        multicore_core_t *core = &cores[k];
+        cpi_merge(&core->merged, &core->cpi);
+        core->merged = core->cpi;
+        if(core->ran_quantum > cycles){
+            cycles = core->ran_quantum;
+        }
+        core->ran_quantum = 0;
+    }
+    for(uint32_t i = 0; i < cycles; i++){
+        cpi_tick();
+    }
+    return cycles;
+}
+
+void multicore_account(void){
+    for(uint32_t k = 0; k < num_cores; k++){
+        if(cores[k].ran){
+            cpi_charge(cores[k].stall, &cores[k].cpi);
+            cores[k].ran = false;
+        }
+    }
+    cpi_tick();
+}
+
+bool multicore_halted(void){
+    for(uint32_t k = 0; k < num_cores; k++){
+        if(!cores[k].halted){
+            return false;
+        }
+    }
+    return true;
+}
+
+void multicore_report(void){
+    if(num_cores == 0){
+        return;
+    }
+    printf("Cores (%d):\n", num_cores);
+    for(uint32_t k = 0; k < num_cores; k++){
+        multicore_core_t *core = &cores[k];
+        printf("\tcore %2d: %8d cycles %8d instructions", k, core->cycles, core->cpi.cycles[CPI_BASE]);
+        cpi_print_stack(&core->cpi);
+    }
+}
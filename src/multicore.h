@@ -0,0 +1,85 @@
+/* src/multicore.h
+* Several five-stage cores running the same program (SPMD) against one main
+* memory. Each core has its own pipeline registers, program counter and
+* register file, and its own data and instruction caches (see cache.h),
+* kept coherent on the shared bus by coherence.h.
+*
+* Every core starts at the same pc with the same registers, except $k0
+* holding its number and $k1 the number of cores, so a program can split
+* its work. Cores meet with ll/sc.
+*
+* With a quantum the cores run that many cycles apart, each on its own bus
+* and write buffer, and only see each other's requests when they meet
+* between quanta (coherence_defer()). The cores of a quantum can then be
+* spread over host threads without changing the result.
+*/
+
+#ifndef _MULTICORE_H
+#define _MULTICORE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <assert.h>
+#include "util.h"
+#include "types.h"
+#include "cache.h"
+#include "hazard.h"
+#include "cpi.h"
+#include "coherence.h"
+
+//Quantum when host threads are asked for without one
+#define MULTICORE_QUANTUM 64
+
+typedef struct MULTICORE_CORE {
+    control_t *ifid;
+    control_t *idex;
+    control_t *exmem;
+    control_t *memwb;
+    pc_t pc;                //unused by core 0, which runs on the caller's pc
+    word_t regs[32];        //unused by core 0, which owns the main register file
+    bool halted;            //fetched a halt instruction (or jumped to 0)
+    bool ran;               //ran in the cycle not accounted for yet
+    stall_cause_t stall;    //why its last cycle stalled
+    uint32_t cycles;        //cycles run until it halted
+    cpi_stack_t cpi;
+    //Running apart
+    uint32_t ran_quantum;   //cycles run in the last quantum
+    uint32_t full_stalls;   //write buffer full stalls up to its last cycle
+    cpi_stack_t merged;     //part of cpi already in the stack of the run
+} multicore_core_t;
+
+/* @brief Sets up cpu_cfg->cores cores. Core 0 runs on the pipeline
+*  registers, pc and register file passed in, the others start as copies of
+*  it. Call once the program is loaded and pc set. With cpu_cfg->quantum the
+*  cpu_cfg->host_threads - 1 extra host threads are started here.
+*/
+void multicore_init(cpu_config_t *cpu_cfg, control_t *ifid, control_t *idex, control_t *exmem, control_t *memwb, pc_t *pc);
+void multicore_free(void);
+
+/* @brief Runs one clock cycle of every core that hasn't halted, each on its
+*  own caches and register file. Core 0 is selected again at the end.
+*/
+void multicore_cycle(cache_config_t *cache_cfg);
+
+/* @brief Runs every core that hasn't halted for a quantum, caches and CPI
+*  stacks included, spread over the host threads. Then, with the cores
+*  stopped, settles their coherence requests. Replaces multicore_cycle(),
+*  cache_digest() and multicore_account().
+*  @returns the cycles the quantum took, less than the quantum once the
+*  last cores halt in it
+*/
+uint32_t multicore_quantum(cache_config_t *cache_cfg);
+
+/* @brief Charges the cycle to the CPI stack of each core that ran in it.
+*  Called after cache_digest(), instead of cpi_cycle().
+*/
+void multicore_account(void);
+
+/* @brief Returns true once every core halted */
+bool multicore_halted(void);
+
+/* @brief Prints cycles, instructions and the CPI stack of each core */
+void multicore_report(void);
+
+#endif /* _MULTICORE_H */
@@ -0,0 +1,388 @@
+/* src/ooo.c
+* Out-of-order core timing model
+*/
+
+#include "ooo.h"
+#include "alu.h"
+#include "decode.h"
+#include "fetch.h"
+#include "memory.h"
+#include "registers.h"
+#include "hazard.h"
+#include "stats.h"
+
+extern int flags;
+
+static ooo_core_t *core = NULL;
+static bool port_used = false;     //the data cache port was used this cycle
+
+void ooo_init(cpu_config_t *cpu_cfg){
+    if(cpu_cfg->rob_entries < 1 || cpu_cfg->rob_entries > OOO_MAX_ROB ||
+        cpu_cfg->rs_entries < 1 || cpu_cfg->lsq_entries < 1 || cpu_cfg->issue_width < 1){
+        cprintf(ANSI_C_RED, "ooo_init: %d ROB, %d reservation station and %d load/store queue entries requested, need 1 to %d ROB entries and at least one of each\n",
+            cpu_cfg->rob_entries, cpu_cfg->rs_entries, cpu_cfg->lsq_entries, OOO_MAX_ROB);
+        assert(0);
+    }
+    core = (ooo_core_t *)malloc(sizeof(ooo_core_t));
+    if(core == NULL){
+        cprintf(ANSI_C_RED, "ooo_init: Unable to allocate out-of-order core\n");
+        assert(0);
+    }
+    core->rob = (rob_entry_t *)calloc(cpu_cfg->rob_entries, sizeof(rob_entry_t));
+    if(core->rob == NULL){
+        cprintf(ANSI_C_RED, "ooo_init: Unable to allocate reorder buffer\n");
+        assert(0);
+    }
+    for(uint32_t i = 0; i < cpu_cfg->rob_entries; i++){
+        core->rob[i].inst.regName = "ROB";
+    }
+    core->width = cpu_cfg->issue_width;
+    core->rob_size = cpu_cfg->rob_entries;
+    core->rs_size = cpu_cfg->rs_entries;
+    core->lsq_size = cpu_cfg->lsq_entries;
+    core->head = 0;
+    core->count = 0;
+    for(int i = 0; i < 32; i++){
+        core->rat[i] = -1;
+    }
+    core->rs_used = 0;
+    core->lsq_used = 0;
+    core->cycle = 0;
+    core->branch = -1;
+    core->slot_fetched = false;
+    core->branch_resolved = false;
+    core->branch_target = 0;
+    core->halted = false;
+    core->port_owner = -1;
+    core->committed = 0;
+    core->loads = 0;
+    core->stores = 0;
+    core->rob_full = 0;
+    core->rs_full = 0;
+    core->lsq_full = 0;
+    core->branch_waits = 0;
+    core->fetch_misses = 0;
+    core->load_waits = 0;
+
+    stats_register("ooo", "committed", &core->committed, "instructions committed");
+    stats_register("ooo", "loads", &core->loads, "loads committed");
+    stats_register("ooo", "stores", &core->stores, "stores committed");
+    stats_register("ooo", "rob_full", &core->rob_full, "cycles dispatch stopped on a full reorder buffer");
+    stats_register("ooo", "rs_full", &core->rs_full, "cycles dispatch stopped on full reservation stations");
+    stats_register("ooo", "lsq_full", &core->lsq_full, "cycles dispatch stopped on a full load/store queue");
+    stats_register("ooo", "branch_waits", &core->branch_waits, "cycles fetch waited for a branch to resolve");
+    stats_register("ooo", "fetch_misses", &core->fetch_misses, "cycles fetch waited on the instruction cache");
+    stats_register("ooo", "load_waits", &core->load_waits, "times a load waited behind an older store");
+}
+
+void ooo_free(void){
+    if(core == NULL){
+        return;
+    }
+    stats_unregister("ooo");
+    free(core->rob);
+    free(core);
+    core = NULL;
+}
+
+// Index of the n-th oldest entry
+static uint32_t ooo_index(uint32_t n){
+    return (core->head + n) % core->rob_size;
+}
+
+// Where fetch goes after the delay slot of a finished branch or jump
+static pc_t ooo_branch_next(rob_entry_t *b){
+    return (b->inst.jump || b->inst.PCSrc) ? b->inst.pcNext : b->inst.pc + 8;
+}
+
+static bool ooo_is_control(control_t *reg){
+    switch(reg->opCode){
+        case OPC_BEQ:
+        case OPC_BNE:
+        case OPC_BLTZ:
+        case OPC_BGTZ:
+        case OPC_BLEZ:
+            return true;
+        default:
+            return reg->jump;
+    }
+}
+
+// Reads register r at dispatch. Returns the entry that will produce it, or
+// -1 if *value already holds it
+static int32_t ooo_rename(uint32_t r, word_t *value){
+    int32_t producer = r ? core->rat[r] : -1;
+    if(producer < 0){
+        reg_read((int)r, value);
+        return -1;
+    }
+    if(core->rob[producer].done){
+        *value = core->rob[producer].value;
+        return -1;
+    }
+    return producer;
+}
+
+// Hands the result of entry producer to every operand waiting on it
+static void ooo_broadcast(uint32_t producer){
+    word_t value = core->rob[producer].value;
+    for(uint32_t n = 0; n < core->count; n++){
+        rob_entry_t *e = &core->rob[ooo_index(n)];
+        if(e->src[0] == (int32_t)producer){
+            e->inst.regRsValue = value;
+            e->src[0] = -1;
+        }
+        if(e->src[1] == (int32_t)producer){
+            e->inst.regRtValue = value;
+            e->src[1] = -1;
+        }
+        if(e->src[2] == (int32_t)producer){
+            e->inst.ALUresult = value;
+            e->src[2] = -1;
+        }
+    }
+}
+
+// True if an older store hasn't computed its address yet or writes the
+// word the load at position n reads. There is no store to load forwarding,
+// the load waits for the store to commit.
+static bool ooo_store_blocks(uint32_t n, uint32_t word){
+    for(uint32_t k = 0; k < n; k++){
+        rob_entry_t *s = &core->rob[ooo_index(k)];
+        if(s->inst.memWrite && (!s->issued || (s->inst.ALUresult & ~3u) == word)){
+            return true;
+        }
+    }
+    return false;
+}
+
+// Retires finished instructions in order. Stores write memory here.
+static void ooo_commit(cache_config_t *cache_cfg){
+    for(uint32_t n = 0; n < core->width && core->count; n++){
+        rob_entry_t *e = &core->rob[core->head];
+        //sc only knows its result once it reaches memory
+        bool conditional = e->inst.opCode == OPC_SC && e->issued;
+        if(!e->done && !conditional){
+            break;
+        }
+        if(e->inst.memWrite){
+            //A load filling a blocking cache keeps the port until it is done
+            if(port_used || (core->port_owner >= 0 && core->port_owner != (int32_t)core->head)){
+                break;
+            }
+            control_t result = e->inst;
+            memory(&e->inst, &result, cache_cfg);
+            port_used = true;
+            if(cache_cfg->data_enabled && result.status == CACHE_MISS){
+                core->port_owner = core->head;
+                break;
+            }
+            if(core->port_owner == (int32_t)core->head){
+                core->port_owner = -1;
+            }
+            core->stores++;
+            if(conditional){
+                e->value = result.memData;
+                e->done = true;
+                ooo_broadcast(core->head);
+            }
+        }
+        if(e->inst.memRead){
+            core->loads++;
+        }
+        if(e->dest){
+            reg_write((int)e->dest, &e->value);
+            if(core->rat[e->dest] == (int32_t)core->head){
+                core->rat[e->dest] = -1;
+            }
+        }
+        if(e->memory){
+            core->lsq_used--;
+        }
+        //With a small reorder buffer the delay slot can take this entry over
+        if((int32_t)core->head == core->branch && !core->branch_resolved){
+            core->branch_target = ooo_branch_next(e);
+            core->branch_resolved = true;
+        }
+        if(flags & MASK_DEBUG){
+            printf("\tooo_commit: 0x%08x at 0x%08x\n", e->inst.instr, e->inst.pc);
+        }
+        core->head = (core->head + 1) % core->rob_size;
+        core->count--;
+        core->committed++;
+    }
+}
+
+// Finishes whatever the functional units were working on
+static void ooo_complete(void){
+    for(uint32_t n = 0; n < core->count; n++){
+        uint32_t i = ooo_index(n);
+        rob_entry_t *e = &core->rob[i];
+        if(e->issued && !e->done && e->done_cycle <= core->cycle && e->inst.opCode != OPC_SC){
+            e->done = true;
+            ooo_broadcast(i);
+        }
+    }
+}
+
+// Sends the oldest ready instructions to the functional units, up to the
+// width, and at most one load to the data cache
+static void ooo_issue(cache_config_t *cache_cfg){
+    uint32_t issued = 0;
+    for(uint32_t n = 0; n < core->count && issued < core->width; n++){
+        uint32_t i = ooo_index(n);
+        rob_entry_t *e = &core->rob[i];
+        if(e->issued || e->src[0] >= 0 || e->src[1] >= 0 || e->src[2] >= 0){
+            continue;
+        }
+        control_t out = e->inst;
+        if(e->inst.memRead){
+            if(port_used || (core->port_owner >= 0 && core->port_owner != (int32_t)i)){
+                continue;
+            }
+            execute(&e->inst, &out);
+            if(ooo_store_blocks(n, out.ALUresult & ~3u)){
+                core->load_waits++;
+                continue;
+            }
+            control_t result = out;
+            memory(&out, &result, cache_cfg);
+            port_used = true;
+            if(cache_cfg->data_enabled && result.status == CACHE_MISS){
+                if(cache_cfg->data_mshrs <= 1){
+                    core->port_owner = i;
+                }
+                continue;
+            }
+            if(core->port_owner == (int32_t)i){
+                core->port_owner = -1;
+            }
+            e->inst.ALUresult = out.ALUresult;
+            e->value = result.memData;
+        } else {
+            if(ooo_is_control(&e->inst)){
+                hazard_recheck_branch(&e->inst);
+            }
+            execute(&e->inst, &out);
+            //Stores keep their address for commit
+            e->inst.ALUresult = out.ALUresult;
+            e->value = out.ALUresult;
+            if(!e->memory){
+                core->rs_used--;
+            }
+        }
+        e->issued = true;
+        e->done_cycle = core->cycle + 1;
+        issued++;
+        if(flags & MASK_DEBUG){
+            printf("\tooo_issue: 0x%08x at 0x%08x\n", e->inst.instr, e->inst.pc);
+        }
+    }
+}
+
+// Fetches, decodes and renames up to the width into the reorder buffer
+static void ooo_front_end(control_t *ifid, pc_t *pc, cache_config_t *cache_cfg){
+    for(uint32_t n = 0; n < core->width && !core->halted; n++){
+        //Past the delay slot fetch goes where the branch went. j and jal
+        //targets are known at decode, the rest wait until they execute.
+        if(core->branch >= 0 && core->slot_fetched){
+            rob_entry_t *b = &core->rob[core->branch];
+            if(core->branch_resolved){
+                *pc = core->branch_target;
+            } else if(b->inst.opCode != OPC_J && b->inst.opCode != OPC_JAL && !b->done){
+                core->branch_waits++;
+                return;
+            } else {
+                *pc = ooo_branch_next(b);
+            }
+            core->branch = -1;
+        }
+        if(core->count == core->rob_size){
+            core->rob_full++;
+            return;
+        }
+        fetch(ifid, pc, cache_cfg);
+        if(cache_cfg->inst_enabled && ifid->status == CACHE_MISS){
+            core->fetch_misses++;
+            return;
+        }
+        if(ifid->instr == 0x1000ffff || ifid->instr == 0x00000008){
+            core->halted = true;
+            return;
+        }
+        uint32_t i = ooo_index(core->count);
+        rob_entry_t *e = &core->rob[i];
+        decode(ifid, &e->inst);
+        e->memory = e->inst.memRead || e->inst.memWrite;
+        if(e->memory ? core->lsq_used == core->lsq_size : core->rs_used == core->rs_size){
+            //Fetched again next cycle
+            if(e->memory){
+                core->lsq_full++;
+            } else {
+                core->rs_full++;
+            }
+            return;
+        }
+        //Rename, operands come from the register file, a finished entry or later from a broadcast
+        e->inst.memDone = false;
+        e->src[0] = hazard_reads(&e->inst, e->inst.regRs) ? ooo_rename(e->inst.regRs, &e->inst.regRsValue) : -1;
+        e->src[1] = hazard_reads(&e->inst, e->inst.regRt) ? ooo_rename(e->inst.regRt, &e->inst.regRtValue) : -1;
+        e->src[2] = -1;
+        if(e->inst.opCode == OPC_RTYPE && (e->inst.funct == FNC_MOVZ || e->inst.funct == FNC_MOVN)){
+            e->src[2] = ooo_rename(e->inst.regRd, &e->inst.ALUresult);
+        }
+        e->dest = hazard_dest(&e->inst);
+        if(e->dest){
+            core->rat[e->dest] = i;
+        }
+        e->value = 0;
+        e->issued = false;
+        e->done = false;
+        if(e->memory){
+            core->lsq_used++;
+        } else {
+            core->rs_used++;
+        }
+        core->count++;
+        if(core->branch >= 0){
+            core->slot_fetched = true;
+        } else if(ooo_is_control(&e->inst)){
+            core->branch = i;
+            core->slot_fetched = false;
+            core->branch_resolved = false;
+        }
+        *pc = *pc + 4;
+    }
+}
+
+void ooo_cycle(control_t *ifid, pc_t *pc, cache_config_t *cache_cfg){
+    if(flags & MASK_DEBUG){
+        cprintf(ANSI_C_CYAN, "OOO: cycle %d, %d in flight\n", core->cycle, core->count);
+    }
+    core->cycle++;
+    port_used = false;
+    ooo_commit(cache_cfg);
+    ooo_complete();
+    ooo_issue(cache_cfg);
+    ooo_front_end(ifid, pc, cache_cfg);
+}
+
+bool ooo_halted(void){
+    return core != NULL && core->halted && core->count == 0;
+}
+
+void ooo_report(uint32_t cycles){
+    if(core == NULL){
+        return;
+    }
+    printf("Out-of-order core (%d wide, %d ROB, %d RS, %d LSQ entries):\n", core->width,
+        core->rob_size, core->rs_size, core->lsq_size);
+    printf("\tInstructions committed: %d (%d loads, %d stores)\n", core->committed, core->loads, core->stores);
+    if(cycles){
+        printf("\tIPC:                    %.3f\n", (double)core->committed / cycles);
+    }
+    printf("\tDispatch stalls:        %d ROB full, %d RS full, %d LSQ full\n", core->rob_full,
+        core->rs_full, core->lsq_full);
+    printf("\tFetch stalls:           %d branch, %d instruction cache\n", core->branch_waits, core->fetch_misses);
+    printf("\tLoads behind stores:    %d\n", core->load_waits);
+}
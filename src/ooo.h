@@ -0,0 +1,90 @@
+/* src/ooo.h
+* Out-of-order core timing model. A Tomasulo style engine with a reorder
+* buffer: instructions are renamed at dispatch, wait in reservation stations
+* (or the load/store queue) until their operands are broadcast, execute on
+* alu() and the data cache out of order and commit in order into the
+* register file. Stores only write memory when they commit, so sc only has its
+* result then.
+*
+* Nothing is executed speculatively: fetch stops after the delay slot of a
+* branch or jr until it resolves. j and jal redirect at dispatch.
+*/
+
+#ifndef _OOO_H
+#define _OOO_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <assert.h>
+#include "util.h"
+#include "types.h"
+#include "cache.h"
+
+//Largest reorder buffer that can be configured
+#define OOO_MAX_ROB 256
+
+//A reorder buffer entry, which also holds the instruction's operands
+typedef struct ROB_ENTRY {
+    control_t inst;         //decoded instruction, operand values captured as they arrive
+    int32_t src[3];         //entry producing rs, rt and the old rd of movz/movn, -1 once captured
+    uint32_t dest;          //register written at commit, 0 if none
+    word_t value;           //result, the loaded word for loads
+    bool memory;            //a load or store, holds a load/store queue entry
+    bool issued;            //left its reservation station
+    bool done;              //result ready for dependents and commit
+    uint32_t done_cycle;    //cycle the functional unit finishes
+} rob_entry_t;
+
+typedef struct OOO_CORE {
+    uint32_t width;         //instructions dispatched, issued and committed per cycle
+    uint32_t rob_size;
+    uint32_t rs_size;
+    uint32_t lsq_size;
+    rob_entry_t *rob;
+    uint32_t head;          //oldest entry
+    uint32_t count;
+    int32_t rat[32];        //entry that will write each register, -1 for the register file
+    uint32_t rs_used;
+    uint32_t lsq_used;
+    uint32_t cycle;
+    //Front end
+    int32_t branch;         //branch or jump whose delay slot is being fetched, -1 if none
+    bool slot_fetched;      //its delay slot was dispatched
+    bool branch_resolved;   //it committed, fetch goes to branch_target
+    pc_t branch_target;     //where it went, kept as its entry may be reused by then
+    bool halted;            //a halt instruction was fetched
+    int32_t port_owner;     //load holding a blocking data cache until its miss is filled, -1 if none
+    //Counters
+    uint32_t committed;
+    uint32_t loads;
+    uint32_t stores;
+    uint32_t rob_full;      //cycles dispatch stopped on a full reorder buffer
+    uint32_t rs_full;       //... on full reservation stations
+    uint32_t lsq_full;      //... on a full load/store queue
+    uint32_t branch_waits;  //cycles fetch waited for a branch to resolve
+    uint32_t fetch_misses;  //cycles fetch waited on the instruction cache
+    uint32_t load_waits;    //cycles a load waited behind an older store to the same word
+} ooo_core_t;
+
+/* @brief Creates the core described by cpu_cfg (issue width, ROB, reservation
+*  station and load/store queue sizes) and registers the "ooo" statistics
+*/
+void ooo_init(cpu_config_t *cpu_cfg);
+void ooo_free(void);
+
+/* @brief Runs one cycle: commit, complete, issue, then fetch and dispatch
+*  up to the width. ifid holds the last instruction fetched and *pc is
+*  where fetch goes next.
+*/
+void ooo_cycle(control_t *ifid, pc_t *pc, cache_config_t *cache_cfg);
+
+/* @brief Returns true once a halt instruction was fetched and every older
+*  instruction committed
+*/
+bool ooo_halted(void);
+
+/* @brief Prints IPC and what held dispatch up */
+void ooo_report(uint32_t cycles);
+
+#endif /* _OOO_H */
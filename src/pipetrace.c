@@ -0,0 +1,222 @@
+/* src/pipetrace.c
+* Pipeline trace in the Kanata log format
+*/
+
+#include <stdarg.h>
+#include <string.h>
+#include "pipetrace.h"
+#include "main_memory.h"
+
+extern int flags;
+
+static const char * const TRACE_STAGE_STRINGS[] = {
+    [TRACE_IF]      = "IF",
+    [TRACE_ID]      = "ID",
+    [TRACE_EX]      = "EX",
+    [TRACE_MEM]     = "MEM",
+    [TRACE_WB]      = "WB"
+};
+
+//Stage of the instruction hazard() blames a stall on, and what it is called
+static const pipetrace_stage_t TRACE_STALL_STAGES[] = {
+    [STALL_NONE]        = TRACE_IF,
+    [STALL_LOAD_USE]    = TRACE_ID,     //the load, decoded this cycle
+    [STALL_CONTROL]     = TRACE_EX,     //the branch, resolved this cycle
+    [STALL_I_MISS]      = TRACE_IF,
+    [STALL_D_MISS]      = TRACE_MEM
+};
+static const char * const TRACE_STALL_STRINGS[] = {
+    [STALL_NONE]        = "none",
+    [STALL_LOAD_USE]    = "load_use",
+    [STALL_CONTROL]     = "control",
+    [STALL_I_MISS]      = "i_miss",
+    [STALL_D_MISS]      = "d_miss"
+};
+
+static FILE *fp = NULL;
+static char *buffer = NULL;
+static const char **source = NULL;
+static uint32_t num_source = 0;
+//Instructions are numbered from 1 as they are fetched, the log counts from 0
+static uint32_t next_seq = 0;
+static uint32_t retired = 0;
+static uint32_t written = 0;        //last one written back
+//In MEM/WB when the cycle started, written back in it
+static uint32_t writing = 0;
+//What each stage held the cycle before
+static uint32_t last[TRACE_STAGES];
+//Being fetched, kept while a miss makes the cycle be done again
+static uint32_t fetching = 0;
+static pc_t fetch_pc = 0;
+static uint32_t cycle = 0;
+static uint32_t idle = 0;           //cycles passed since the last line
+static stall_cause_t last_cause = STALL_NONE;
+static uint32_t last_stalled = 0;
+
+/* Writes a line of the log in the cycle running now */
+static void pipetrace_printf(const char *format, ...){
+    va_list args;
+    if(idle){
+        fprintf(fp, "C\t%u\n", idle);
+        idle = 0;
+    }
+    va_start(args, format);
+    vfprintf(fp, format, args);
+    va_end(args);
+}
+
+bool pipetrace_open(const char *path, pc_t start){
+    fp = fopen(path, "w");
+    if(fp == NULL){
+        return false;
+    }
+    buffer = (char *)malloc(PIPETRACE_BUFFER);
+    num_source = mem_size_w();
+    source = (const char **)calloc(num_source, sizeof(const char *));
+    if(buffer == NULL || source == NULL){
+        cprintf(ANSI_C_RED, "pipetrace_open: Unable to allocate the trace buffers\n");
+        assert(0);
+    }
+    setvbuf(fp, buffer, _IOFBF, PIPETRACE_BUFFER);
+    next_seq = 0;
+    retired = 0;
+    written = 0;
+    writing = 0;
+    memset(last, 0, sizeof(last));
+    fetching = 0;
+    fetch_pc = start;
+    cycle = 0;
+    idle = 0;
+    last_cause = STALL_NONE;
+    last_stalled = 0;
+    fprintf(fp, "Kanata\t0004\nC=\t0\n");
+    flags |= MASK_PIPETRACE;
+    return true;
+}
+
+void pipetrace_close(void){
+    if(fp == NULL){
+        return;
+    }
+    //The stages of the last cycle end with it, and what it wrote back is done
+    if(last[TRACE_WB] != 0){
+        pipetrace_printf("R\t%u\t%u\t0\n", last[TRACE_WB] - 1, retired++);
+    } else if(idle){
+        fprintf(fp, "C\t%u\n", idle);
+    }
+    if(ferror(fp)){
+        cprintf(ANSI_C_YELLOW, "Unable to write the whole pipeline trace\n");
+    }
+    fclose(fp);
+    fp = NULL;
+    free(buffer);
+    free(source);
+    buffer = NULL;
+    source = NULL;
+    num_source = 0;
+    flags &= ~MASK_PIPETRACE;
+}
+
+void pipetrace_annotate(pc_t pc, const char *text){
+    uint32_t index = (pc - mem_start()) >> 2;
+    if(pc >= mem_start() && index < num_source){
+        source[index] = text;
+    }
+}
+
+/* Labels an instruction with its address and disassembly, or the raw
+*  instruction if there is none. A flushed fetch has no instruction left.
+*/
+static void pipetrace_label(uint32_t seq, pc_t pc, bool fetched, inst_t instr){
+    uint32_t index = (pc - mem_start()) >> 2;
+    if(pc >= mem_start() && index < num_source && source[index] != NULL){
+        pipetrace_printf("L\t%u\t0\t%08x: %s\n", seq - 1, pc, source[index]);
+    } else if(fetched){
+        pipetrace_printf("L\t%u\t0\t%08x: %08x\n", seq - 1, pc, instr);
+    } else {
+        pipetrace_printf("L\t%u\t0\t%08x\n", seq - 1, pc);
+    }
+}
+
+static bool pipetrace_holds(const uint32_t *stages, uint32_t seq){
+    for(int s = 0; s < TRACE_STAGES; s++){
+        if(stages[s] == seq){
+            return true;
+        }
+    }
+    return false;
+}
+
+void pipetrace_cycle(control_t *ifid, control_t *idex, control_t *exmem, control_t *memwb, pc_t pc){
+    pc_t stall_pc;
+    stall_cause_t cause = hazard_stall_cause(&stall_pc);
+    bool restored = cause == STALL_I_MISS || cause == STALL_D_MISS;
+    uint32_t now[TRACE_STAGES];
+
+    if(fetching == 0){
+        fetching = ++next_seq;
+        pipetrace_printf("I\t%u\t%u\t0\n", fetching - 1, fetching - 1);
+    }
+    now[TRACE_IF] = fetching;
+    if(restored){
+        //The registers are back to how the cycle found them, each one
+        //holds what the stage after it worked on
+        now[TRACE_ID] = ifid->seq;
+        now[TRACE_EX] = idex->seq;
+        now[TRACE_MEM] = exmem->seq;
+    } else {
+        now[TRACE_ID] = idex->seq;
+        now[TRACE_EX] = exmem->seq;
+        now[TRACE_MEM] = memwb->seq;
+    }
+    //memwb is written back again every cycle a miss restores, once counts
+    now[TRACE_WB] = writing > written ? writing : 0;
+    writing = memwb->seq;
+
+    //Gone from the pipeline: written back the cycle before, or flushed
+    //from fetch
+    for(int s = 0; s < TRACE_STAGES; s++){
+        if(last[s] != 0 && !pipetrace_holds(now, last[s])){
+            if(s == TRACE_WB){
+                pipetrace_printf("R\t%u\t%u\t0\n", last[s] - 1, retired++);
+            } else {
+                pipetrace_printf("R\t%u\t0\t1\n", last[s] - 1);
+            }
+        }
+    }
+    for(int s = 0; s < TRACE_STAGES; s++){
+        if(now[s] != 0 && now[s] != last[s]){
+            pipetrace_printf("S\t%u\t0\t%s\n", now[s] - 1, TRACE_STAGE_STRINGS[s]);
+        }
+    }
+    if(now[TRACE_WB] != 0){
+        written = now[TRACE_WB];
+    }
+
+    //The fetch is done unless a miss makes the cycle be done again. The
+    //number goes with the instruction, hazard() flushes it off the wrong
+    //path or from behind a load.
+    if(!restored){
+        if(cause == STALL_LOAD_USE || cause == STALL_CONTROL){
+            pipetrace_label(fetching, fetch_pc, false, 0);
+            pipetrace_printf("L\t%u\t1\tflushed (%s). \n", fetching - 1, TRACE_STALL_STRINGS[cause]);
+        } else {
+            ifid->seq = fetching;
+            pipetrace_label(fetching, fetch_pc, true, ifid->instr);
+        }
+        fetching = 0;
+    }
+
+    //A stall is put on the instruction that caused it when it starts
+    uint32_t stalled = cause == STALL_NONE ? 0 : now[TRACE_STALL_STAGES[cause]];
+    if(stalled != 0 && (cause != last_cause || stalled != last_stalled)){
+        pipetrace_printf("L\t%u\t1\t%s stall from cycle %u. \n", stalled - 1, TRACE_STALL_STRINGS[cause], cycle);
+    }
+    last_cause = cause;
+    last_stalled = stalled;
+
+    memcpy(last, now, sizeof(last));
+    fetch_pc = pc;
+    cycle++;
+    idle++;
+}
@@ -0,0 +1,56 @@
+/* src/pipetrace.h
+* Pipeline trace. Writes the cycle every dynamic instruction entered IF, ID,
+* EX, MEM and WB, when it left the pipeline and whether it was flushed, and
+* the stalls hazard() reported, in the Kanata log format (version 0004) read
+* by pipeline viewers such as Konata.
+*
+* The five-stage pipeline of one core only. Every instruction fetched is
+* numbered in the seq field of its pipeline register, which follows it
+* through the stages and is put back with them when a miss restores the
+* pipeline. A stage holds the instruction it worked on in the cycle: while a
+* miss is being filled the stages work on the same instructions again, so
+* they stay where they are.
+*/
+
+#ifndef _PIPETRACE_H
+#define _PIPETRACE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <assert.h>
+#include "util.h"
+#include "types.h"
+#include "hazard.h"
+
+//Stdio buffer of the trace, a million cycles write around 150 MB
+#define PIPETRACE_BUFFER (1<<20)
+
+typedef enum PIPETRACE_STAGE {
+    TRACE_IF,
+    TRACE_ID,
+    TRACE_EX,
+    TRACE_MEM,
+    TRACE_WB,
+    TRACE_STAGES
+} pipetrace_stage_t;
+
+/* @brief Starts a trace in path, the first instruction is fetched from start
+*  @returns false if it can't be written
+*/
+bool pipetrace_open(const char *path, pc_t start);
+
+/* @brief Writes what is left of the trace out and closes it */
+void pipetrace_close(void);
+
+/* @brief Labels the instruction at pc with its disassembly. text must stay
+*  valid until the trace is closed.
+*/
+void pipetrace_annotate(pc_t pc, const char *text);
+
+/* @brief Traces the cycle that just ended. Called once a cycle after
+*  hazard(), pc is the address the next cycle fetches from
+*/
+void pipetrace_cycle(control_t *ifid, control_t *idex, control_t *exmem, control_t *memwb, pc_t pc);
+
+#endif /* _PIPETRACE_H */
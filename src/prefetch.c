@@ -0,0 +1,421 @@
+/*
+* src/prefetch.c
+* next-line, stride and stream buffer prefetchers for the direct mapped cache
+*/
+
+#include "prefetch.h"
+#include "stats.h"
+#include "eventlog.h"
+
+extern int flags;
+
+static const char * const PREFETCH_TYPE_STRINGS[] = {
+    [CACHE_PREFETCH_NONE]       = "none",
+    [CACHE_PREFETCH_NEXTLINE]   = "next-line",
+    [CACHE_PREFETCH_STRIDE]     = "stride",
+    [CACHE_PREFETCH_STREAM]     = "stream buffers"
+};
+
+prefetcher_t *prefetch_init(direct_cache_t *cache, cache_prefetch_t type){
+    if(type == CACHE_PREFETCH_NONE){
+        return NULL;
+    }
+    prefetcher_t *pf = (prefetcher_t *)malloc(sizeof(prefetcher_t));
+    if(pf == NULL){
+        cprintf(ANSI_C_RED, "prefetch_init: Unable to allocate prefetcher\n");
+        assert(0);
+    }
+    pf->type = type;
+    pf->block_bytes = cache->block_size << 2;
+    pf->queue_head = 0;
+    pf->queue_count = 0;
+    pf->last_pc = 0;
+    pf->last_address = 0;
+    pf->trained = false;
+    pf->rpt = NULL;
+    pf->streams = NULL;
+    pf->stream_words = NULL;
+    pf->stream_ready = NULL;
+    pf->clock = 0;
+    pf->issued = 0;
+    pf->useful = 0;
+    pf->late = 0;
+    pf->useless = 0;
+    pf->dropped = 0;
+
+    uint32_t i, j;
+    if(type == CACHE_PREFETCH_STRIDE){
+        pf->rpt = (rpt_entry_t *)malloc(sizeof(rpt_entry_t) * PREFETCH_RPT_SIZE);
+        if(pf->rpt == NULL){
+            cprintf(ANSI_C_RED, "prefetch_init: Unable to allocate reference prediction table\n");
+            assert(0);
+        }
+        for(i = 0; i < PREFETCH_RPT_SIZE; i++){
+            pf->rpt[i].valid = false;
+        }
+    } else if(type == CACHE_PREFETCH_STREAM){
+        uint32_t slots = PREFETCH_STREAMS * PREFETCH_STREAM_DEPTH;
+        pf->streams = (stream_buffer_t *)malloc(sizeof(stream_buffer_t) * PREFETCH_STREAMS);
+        pf->stream_words = (word_t *)malloc(sizeof(word_t) * slots * cache->block_size);
+        pf->stream_ready = (bool *)malloc(sizeof(bool) * slots * cache->block_size);
+        if(pf->streams == NULL || pf->stream_words == NULL || pf->stream_ready == NULL){
+            cprintf(ANSI_C_RED, "prefetch_init: Unable to allocate stream buffers\n");
+            assert(0);
+        }
+        //Every slot gets its own piece of the linear storage, like cache blocks
+        for(i = 0; i < PREFETCH_STREAMS; i++){
+            pf->streams[i].active = false;
+            pf->streams[i].next_address = 0;
+            pf->streams[i].last_used = 0;
+            pf->streams[i].count = 0;
+            for(j = 0; j < PREFETCH_STREAM_DEPTH; j++){
+                uint32_t slot = i * PREFETCH_STREAM_DEPTH + j;
+                pf->streams[i].entries[j].valid = false;
+                pf->streams[i].entries[j].late = false;
+                pf->streams[i].entries[j].block_address = 0;
+                pf->streams[i].entries[j].data = pf->stream_words + slot * cache->block_size;
+                pf->streams[i].entries[j].ready = pf->stream_ready + slot * cache->block_size;
+            }
+        }
+    }
+    return pf;
+}
+
+void prefetch_free(prefetcher_t *pf){
+    if(pf == NULL){
+        return;
+    }
+    free(pf->rpt);
+    free(pf->streams);
+    free(pf->stream_words);
+    free(pf->stream_ready);
+    free(pf);
+}
+
+/* Returns true if the whole block at address lies inside main memory */
+static bool prefetch_in_memory(prefetcher_t *pf, uint32_t address){
+    return address >= mem_start() && address <= mem_end() - (pf->block_bytes - 1);
+}
+
+/* Adds a block to the candidates waiting for the bus */
+static void prefetch_enqueue(prefetcher_t *pf, uint32_t address){
+    uint32_t block_address = address & ~(pf->block_bytes - 1);
+    if(!prefetch_in_memory(pf, block_address)){
+        return;
+    }
+    for(uint32_t i = 0; i < pf->queue_count; i++){
+        if(pf->queue[(pf->queue_head + i) % PREFETCH_QUEUE_SIZE] == block_address){
+            return;
+        }
+    }
+    if(pf->queue_count == PREFETCH_QUEUE_SIZE){
+        //The oldest candidate is the least likely to still be useful
+        pf->queue_head = (pf->queue_head + 1) % PREFETCH_QUEUE_SIZE;
+        pf->queue_count--;
+    }
+    pf->queue[(pf->queue_head + pf->queue_count) % PREFETCH_QUEUE_SIZE] = block_address;
+    pf->queue_count++;
+    EVENT(EV_PREFETCH_CANDIDATE, block_address);
+}
+
+static void prefetch_dequeue(prefetcher_t *pf){
+    pf->queue_head = (pf->queue_head + 1) % PREFETCH_QUEUE_SIZE;
+    pf->queue_count--;
+}
+
+/* Reference prediction table update (Chen and Baer). Once a load/store has
+*  shown the same stride twice in a row, the block it will touch next is
+*  prefetched.
+*/
+static void prefetch_stride_train(prefetcher_t *pf, pc_t pc, uint32_t address){
+    rpt_entry_t *entry = &pf->rpt[(pc >> 2) % PREFETCH_RPT_SIZE];
+    if(!entry->valid || entry->pc != pc){
+        entry->valid = true;
+        entry->pc = pc;
+        entry->last_address = address;
+        entry->stride = 0;
+        entry->state = RPT_INITIAL;
+        return;
+    }
+    int32_t stride = (int32_t)(address - entry->last_address);
+    bool correct = (stride == entry->stride);
+    switch(entry->state){
+        case RPT_INITIAL:
+            if(correct){
+                entry->state = RPT_STEADY;
+            } else {
+                entry->stride = stride;
+                entry->state = RPT_TRANSIENT;
+            }
+            break;
+        case RPT_TRANSIENT:
+            if(correct){
+                entry->state = RPT_STEADY;
+            } else {
+                entry->stride = stride;
+                entry->state = RPT_NO_PRED;
+            }
+            break;
+        case RPT_STEADY:
+            if(!correct){
+                entry->state = RPT_INITIAL;
+            }
+            break;
+        case RPT_NO_PRED:
+            if(correct){
+                entry->state = RPT_TRANSIENT;
+            } else {
+                entry->stride = stride;
+            }
+            break;
+        default:
+            cprintf(ANSI_C_RED, "prefetch_stride_train: Undefined RPT state %d\n", entry->state);
+            assert(0);
+    }
+    entry->last_address = address;
+
+    if(entry->state == RPT_STEADY && entry->stride != 0){
+        uint32_t target = address + entry->stride;
+        uint32_t block_mask = ~(pf->block_bytes - 1);
+        if((target & block_mask) == (address & block_mask)){
+            //Small strides stay in the block for a while, go for the next one
+            target = (entry->stride > 0) ? address + pf->block_bytes : address - pf->block_bytes;
+        }
+        prefetch_enqueue(pf, target);
+    }
+}
+
+/* A stream buffer slot is ready once the last word of its block is in */
+static bool prefetch_stream_entry_ready(prefetcher_t *pf, stream_entry_t *entry){
+    return entry->ready[(pf->block_bytes >> 2) - 1];
+}
+
+/* Points the least recently used stream buffer at the blocks following a
+*  miss. Buffers with fills in flight are left alone.
+*/
+static void prefetch_stream_allocate(prefetcher_t *pf, uint32_t address){
+    stream_buffer_t *victim = NULL;
+    for(uint32_t i = 0; i < PREFETCH_STREAMS; i++){
+        stream_buffer_t *buf = &pf->streams[i];
+        bool filling = false;
+        for(uint32_t j = 0; j < buf->count; j++){
+            if(!prefetch_stream_entry_ready(pf, &buf->entries[j])){
+                filling = true;
+            }
+        }
+        if(filling){
+            continue;
+        }
+        if(!buf->active){
+            victim = buf;
+            break;
+        }
+        if(victim == NULL || buf->last_used < victim->last_used){
+            victim = buf;
+        }
+    }
+    if(victim == NULL){
+        return;
+    }
+    for(uint32_t j = 0; j < victim->count; j++){
+        //Never got used
+        victim->entries[j].valid = false;
+        pf->useless++;
+    }
+    victim->count = 0;
+    victim->active = true;
+    victim->next_address = (address & ~(pf->block_bytes - 1)) + pf->block_bytes;
+    victim->last_used = ++pf->clock;
+    EVENT(EV_PREFETCH_STREAM, victim - pf->streams, victim->next_address);
+}
+
+/* Takes slot k out of a stream buffer, keeping the FIFO order of the rest.
+*  The slot storage moves to the free end of the buffer.
+*/
+static void prefetch_stream_remove(stream_buffer_t *buf, uint32_t k){
+    stream_entry_t removed = buf->entries[k];
+    for(uint32_t i = k; i + 1 < buf->count; i++){
+        buf->entries[i] = buf->entries[i + 1];
+    }
+    buf->count--;
+    removed.valid = false;
+    removed.late = false;
+    buf->entries[buf->count] = removed;
+}
+
+void prefetch_access(direct_cache_t *cache, pc_t pc, uint32_t address, prefetch_event_t event){
+    prefetcher_t *pf = cache->prefetch;
+    if(pf == NULL){
+        return;
+    }
+    if(pf->trained && pc == pf->last_pc && address == pf->last_address){
+        //Replay of a stalled access, already seen
+        return;
+    }
+    pf->trained = true;
+    pf->last_pc = pc;
+    pf->last_address = address;
+
+    switch(pf->type){
+        case CACHE_PREFETCH_NEXTLINE:
+            //Tagged next-line: on a miss and on the first use of a prefetched block
+            if(event != PREFETCH_EVENT_HIT){
+                prefetch_enqueue(pf, (address & ~(pf->block_bytes - 1)) + pf->block_bytes);
+            }
+            break;
+        case CACHE_PREFETCH_STRIDE:
+            prefetch_stride_train(pf, pc, address);
+            break;
+        case CACHE_PREFETCH_STREAM:
+            if(event == PREFETCH_EVENT_MISS){
+                prefetch_stream_allocate(pf, address);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+bool prefetch_issue(direct_cache_t *cache){
+    prefetcher_t *pf = cache->prefetch;
+    if(pf == NULL){
+        return false;
+    }
+    while(pf->queue_count){
+        uint32_t address = pf->queue[pf->queue_head];
+        if(direct_cache_holds(cache, address)){
+            pf->dropped++;
+            prefetch_dequeue(pf);
+            continue;
+        }
+        if(direct_cache_queue_prefetch(cache, address, NULL, NULL) == NULL){
+            //No MSHR or block to put it in, try again next idle cycle
+            return false;
+        }
+        prefetch_dequeue(pf);
+        pf->issued++;
+        return true;
+    }
+
+    if(pf->streams == NULL){
+        return false;
+    }
+    //The most recently used stream buffer with room gets the bus
+    stream_buffer_t *buf = NULL;
+    for(uint32_t i = 0; i < PREFETCH_STREAMS; i++){
+        stream_buffer_t *candidate = &pf->streams[i];
+        if(candidate->active && candidate->count < PREFETCH_STREAM_DEPTH &&
+            (buf == NULL || candidate->last_used > buf->last_used)){
+            buf = candidate;
+        }
+    }
+    if(buf == NULL){
+        return false;
+    }
+    uint32_t address = buf->next_address;
+    if(!prefetch_in_memory(pf, address)){
+        //Ran off the end of memory
+        buf->active = false;
+        return false;
+    }
+    if(direct_cache_holds(cache, address) || prefetch_stream_holds(pf, address)){
+        pf->dropped++;
+        buf->next_address += pf->block_bytes;
+        return false;
+    }
+    stream_entry_t *entry = &buf->entries[buf->count];
+    if(direct_cache_queue_prefetch(cache, address, entry->data, entry->ready) == NULL){
+        return false;
+    }
+    entry->valid = true;
+    entry->late = false;
+    entry->block_address = address;
+    buf->count++;
+    buf->next_address += pf->block_bytes;
+    pf->issued++;
+    return true;
+}
+
+cache_status_t prefetch_stream_lookup(direct_cache_t *cache, cache_access_t *info){
+    prefetcher_t *pf = cache->prefetch;
+    if(pf == NULL || pf->streams == NULL){
+        return CACHE_NO_ACCESS;
+    }
+    uint32_t block_address = info->address & ~(pf->block_bytes - 1);
+    for(uint32_t i = 0; i < PREFETCH_STREAMS; i++){
+        stream_buffer_t *buf = &pf->streams[i];
+        for(uint32_t k = 0; k < buf->count; k++){
+            stream_entry_t *entry = &buf->entries[k];
+            if(entry->block_address != block_address){
+                continue;
+            }
+            buf->last_used = ++pf->clock;
+            if(!prefetch_stream_entry_ready(pf, entry)){
+                //Still on its way, the access waits for it instead of going to memory again
+                if(!entry->late){
+                    entry->late = true;
+                    pf->late++;
+                }
+                return CACHE_MISS;
+            }
+            if(!direct_cache_install_block(cache, info, entry->data)){
+                return CACHE_MISS;
+            }
+            EVENT(EV_PREFETCH_STREAM_HIT, block_address, i);
+            pf->useful++;
+            prefetch_stream_remove(buf, k);
+            return CACHE_HIT;
+        }
+    }
+    return CACHE_NO_ACCESS;
+}
+
+bool prefetch_stream_holds(prefetcher_t *pf, uint32_t address){
+    if(pf == NULL || pf->streams == NULL){
+        return false;
+    }
+    uint32_t block_address = address & ~(pf->block_bytes - 1);
+    for(uint32_t i = 0; i < PREFETCH_STREAMS; i++){
+        for(uint32_t k = 0; k < pf->streams[i].count; k++){
+            if(pf->streams[i].entries[k].block_address == block_address){
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void prefetch_report(direct_cache_t *cache, const char *name){
+    prefetcher_t *pf = cache->prefetch;
+    if(pf == NULL){
+        return;
+    }
+    printf("%s cache prefetcher (%s):\n", name, PREFETCH_TYPE_STRINGS[pf->type]);
+    printf("\tPrefetches issued:      %d\n", pf->issued);
+    printf("\tUseful prefetches:      %d (%d late)\n", pf->useful, pf->late);
+    printf("\tUnused prefetches:      %d (replaced before any use)\n", pf->useless);
+    printf("\tRedundant candidates:   %d (already in the cache)\n", pf->dropped);
+    printf("\tDemand misses left:     %d\n", cache->mshr_primary);
+    if(pf->issued){
+        printf("\tAccuracy:   %.3f (useful / issued)\n", (double)pf->useful / pf->issued);
+    }
+    if(pf->useful + cache->mshr_primary){
+        printf("\tCoverage:   %.3f (misses removed / misses without prefetching)\n",
+            (double)pf->useful / (pf->useful + cache->mshr_primary));
+    }
+    if(pf->useful){
+        printf("\tTimeliness: %.3f (useful prefetches that arrived in time)\n",
+            (double)(pf->useful - pf->late) / pf->useful);
+    }
+}
+
+void prefetch_register_stats(prefetcher_t *pf, const char *group){
+    if(pf == NULL){
+        return;
+    }
+    stats_register(group, "issued", &pf->issued, "prefetch fills started");
+    stats_register(group, "useful", &pf->useful, "prefetched blocks used by a demand access");
+    stats_register(group, "late", &pf->late, "demand accesses that caught their prefetch in flight");
+    stats_register(group, "useless", &pf->useless, "prefetched blocks replaced before any use");
+    stats_register(group, "dropped", &pf->dropped, "candidates already in the cache or on their way");
+}
@@ -0,0 +1,127 @@
+/*
+* src/prefetch.h
+* Hardware prefetchers that can be attached to a direct mapped cache
+*/
+
+#ifndef _PREFETCH_H
+#define _PREFETCH_H
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "util.h"
+#include "types.h"
+#include "direct.h"
+
+//Number of candidate blocks waiting for an idle bus
+#define PREFETCH_QUEUE_SIZE 8
+//Entries in the reference prediction table of the stride prefetcher
+#define PREFETCH_RPT_SIZE 64
+//Number of stream buffers and blocks held by each one
+#define PREFETCH_STREAMS 4
+#define PREFETCH_STREAM_DEPTH 4
+
+//What a demand access told the prefetcher
+typedef enum PREFETCH_EVENT {
+    PREFETCH_EVENT_HIT,         //block was in the cache
+    PREFETCH_EVENT_MISS,        //block had to be fetched from memory
+    PREFETCH_EVENT_PREFETCHED   //first use of a block brought in by a prefetch
+} prefetch_event_t;
+
+//States of a reference prediction table entry (Chen and Baer)
+typedef enum RPT_STATE {
+    RPT_INITIAL,
+    RPT_TRANSIENT,
+    RPT_STEADY,
+    RPT_NO_PRED
+} rpt_state_t;
+
+typedef struct RPT_ENTRY {
+    bool valid;
+    pc_t pc;                    //load/store this entry belongs to
+    uint32_t last_address;
+    int32_t stride;
+    rpt_state_t state;
+} rpt_entry_t;
+
+//One block slot of a stream buffer. The slot owns its word storage so an
+//MSHR can fill it the same way it fills a cache block.
+typedef struct STREAM_ENTRY {
+    bool valid;                 //slot holds a block, arrived or still in flight
+    bool late;                  //a demand access already had to wait on it
+    uint32_t block_address;
+    word_t *data;
+    bool *ready;                //per word, set as the fill brings words in
+} stream_entry_t;
+
+//FIFO of blocks following a miss stream, entries[0] is the oldest
+typedef struct STREAM_BUFFER {
+    bool active;
+    uint32_t next_address;      //next block the buffer will prefetch
+    uint32_t last_used;         //prefetcher clock at allocation or last hit, for LRU
+    uint32_t count;
+    stream_entry_t entries[PREFETCH_STREAM_DEPTH];
+} stream_buffer_t;
+
+typedef struct PREFETCHER {
+    cache_prefetch_t type;
+    uint32_t block_bytes;
+    //Candidates waiting for the bus (next-line and stride)
+    uint32_t queue[PREFETCH_QUEUE_SIZE];
+    uint32_t queue_head;
+    uint32_t queue_count;
+    //Last access trained on, the pipeline replays stalled accesses every cycle
+    pc_t last_pc;
+    uint32_t last_address;
+    bool trained;
+    rpt_entry_t *rpt;
+    stream_buffer_t *streams;
+    word_t *stream_words;
+    bool *stream_ready;
+    uint32_t clock;
+    //Counters
+    uint32_t issued;            //prefetch fills started
+    uint32_t useful;            //prefetched blocks used by a demand access
+    uint32_t late;              //demand accesses that caught their prefetch still in flight
+    uint32_t useless;           //prefetched blocks replaced or dropped before any use
+    uint32_t dropped;           //candidates already in the cache or on their way
+} prefetcher_t;
+
+/* @brief Creates a prefetcher of the given type for cache
+*  @returns NULL for CACHE_PREFETCH_NONE
+*/
+prefetcher_t *prefetch_init(direct_cache_t *cache, cache_prefetch_t type);
+
+void prefetch_free(prefetcher_t *pf);
+
+/* @brief Trains the prefetcher on a demand access
+*  Called once per access by the cache, replays of a stalled access are
+*  ignored.
+*  @params pc is the address of the instruction making the access
+*/
+void prefetch_access(direct_cache_t *cache, pc_t pc, uint32_t address, prefetch_event_t event);
+
+/* @brief Starts at most one prefetch for cache.
+*  Only to be called when the memory bus is idle.
+*  @returns true if a fill was started
+*/
+bool prefetch_issue(direct_cache_t *cache);
+
+/* @brief Looks for the block holding address in the stream buffers.
+*  A block that has fully arrived is moved into the cache.
+*  @returns CACHE_NO_ACCESS if no stream buffer has the block, CACHE_HIT if
+*  it was moved into the cache, CACHE_MISS if the access has to wait for it
+*/
+cache_status_t prefetch_stream_lookup(direct_cache_t *cache, cache_access_t *info);
+
+/* @brief Returns true if address is held (or being fetched) by a stream buffer */
+bool prefetch_stream_holds(prefetcher_t *pf, uint32_t address);
+
+/* @brief Registers the prefetch counters with the statistics registry */
+void prefetch_register_stats(prefetcher_t *pf, const char *group);
+
+/* @brief Prints accuracy, coverage and timeliness of the prefetcher of cache */
+void prefetch_report(direct_cache_t *cache, const char *name);
+
+#endif /* _PREFETCH_H */
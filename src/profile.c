@@ -0,0 +1,135 @@
+/* src/profile.c
+* Per-PC cycle and stall profiler
+*/
+
+#include "profile.h"
+#include "main_memory.h"
+
+extern int flags;
+
+static profile_entry_t *entries = NULL;
+static const char **source = NULL;
+static uint32_t num_entries = 0;
+static uint32_t total_cycles = 0;
+//Cause and instruction of the previous cycle, a miss is only counted when its stall starts
+static stall_cause_t last_cause = STALL_NONE;
+static pc_t last_pc = 0;
+
+void profile_init(void){
+    num_entries = mem_size_w();
+    entries = (profile_entry_t *)calloc(num_entries, sizeof(profile_entry_t));
+    source = (const char **)calloc(num_entries, sizeof(const char *));
+    if(entries == NULL || source == NULL){
+        cprintf(ANSI_C_RED, "profile_init: Unable to allocate profile counters\n");
+        assert(0);
+    }
+    total_cycles = 0;
+    last_cause = STALL_NONE;
+    last_pc = 0;
+}
+
+void profile_free(void){
+    free(entries);
+    free(source);
+    entries = NULL;
+    source = NULL;
+    num_entries = 0;
+}
+
+static profile_entry_t *profile_entry(pc_t pc){
+    uint32_t index = (pc - mem_start()) >> 2;
+    if(pc < mem_start() || index >= num_entries){
+        return NULL;
+    }
+    return &entries[index];
+}
+
+void profile_annotate(pc_t pc, const char *text){
+    if(profile_entry(pc) != NULL){
+        source[(pc - mem_start()) >> 2] = text;
+    }
+}
+
+void profile_cycle(pc_t fetched){
+    pc_t pc;
+    stall_cause_t cause = hazard_stall_cause(&pc);
+    if(cause == STALL_NONE){
+        pc = fetched;
+    }
+    total_cycles++;
+    profile_entry_t *entry = profile_entry(pc);
+    if(entry == NULL){
+        last_cause = cause;
+        return;
+    }
+    bool starts = cause != last_cause || pc != last_pc;
+    entry->cycles++;
+    switch(cause){
+        case STALL_NONE:
+            entry->fetched++;
+            break;
+        case STALL_LOAD_USE:
+            entry->load_use++;
+            break;
+        case STALL_CONTROL:
+            entry->control++;
+            break;
+        case STALL_I_MISS:
+            entry->i_miss_cycles++;
+            if(starts) entry->i_misses++;
+            break;
+        case STALL_D_MISS:
+            entry->d_miss_cycles++;
+            if(starts) entry->d_misses++;
+            break;
+    }
+    if(flags & MASK_DEBUG){
+        printf("\tprofile_cycle: cycle charged to 0x%08x (cause %d)\n", pc, cause);
+    }
+    last_cause = cause;
+    last_pc = pc;
+}
+
+const profile_entry_t *profile_get(pc_t pc){
+    return profile_entry(pc);
+}
+
+static int profile_compare(const void *a, const void *b){
+    uint32_t ca = entries[*(const uint32_t *)a].cycles;
+    uint32_t cb = entries[*(const uint32_t *)b].cycles;
+    if(ca != cb){
+        return ca < cb ? 1 : -1;
+    }
+    //Ties in address order
+    return *(const uint32_t *)a < *(const uint32_t *)b ? -1 : 1;
+}
+
+void profile_report(uint32_t top){
+    if(entries == NULL){
+        return;
+    }
+    uint32_t *order = (uint32_t *)malloc(sizeof(uint32_t) * num_entries);
+    uint32_t count = 0;
+    for(uint32_t i = 0; i < num_entries; i++){
+        if(entries[i].cycles){
+            order[count++] = i;
+        }
+    }
+    qsort(order, count, sizeof(uint32_t), profile_compare);
+    if(top == 0 || top > count){
+        top = count;
+    }
+    printf("Profile: %d cycles over %d instructions, top %d by cycles\n", total_cycles, count, top);
+    printf("  %-10s %10s %6s %9s %6s %8s %8s %8s %8s %6s %6s  %s\n",
+        "pc", "cycles", "%", "fetched", "cpi", "d-stall", "i-stall", "ld-use", "control", "d-miss", "i-miss", "source");
+    for(uint32_t i = 0; i < top; i++){
+        profile_entry_t *e = &entries[order[i]];
+        pc_t pc = mem_start() + (order[i] << 2);
+        const char *text = source[order[i]] != NULL ? source[order[i]] : "";
+        printf("  0x%08x %10u %5.1f%% %9u %6.2f %8u %8u %8u %8u %6u %6u  %s\n",
+            pc, e->cycles, 100.0 * e->cycles / total_cycles, e->fetched,
+            e->fetched ? (double)e->cycles / e->fetched : 0.0,
+            e->d_miss_cycles, e->i_miss_cycles, e->load_use, e->control, e->d_misses, e->i_misses, text);
+    }
+    free(order);
+}
@@ -0,0 +1,51 @@
+/* src/profile.h
+* Per-PC cycle and stall profiler. Every simulated cycle is charged to one
+* instruction address, stalls to the instruction that caused them.
+*/
+
+#ifndef _PROFILE_H
+#define _PROFILE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <assert.h>
+#include "util.h"
+#include "types.h"
+#include "hazard.h"
+
+//Counters kept for each word of program memory
+typedef struct PROFILE_ENTRY {
+    uint32_t fetched;           //times the instruction entered the pipeline
+    uint32_t cycles;            //every cycle charged to it, base and stall
+    uint32_t load_use;          //bubbles inserted behind it (it is a load)
+    uint32_t control;           //cycles lost flushing its mispredicted wrong path
+    uint32_t i_miss_cycles;     //cycles waiting on the instruction cache to fetch it
+    uint32_t d_miss_cycles;     //cycles waiting on the data cache for its access
+    uint32_t i_misses;          //instruction cache misses fetching it
+    uint32_t d_misses;          //data cache misses of its load or store
+} profile_entry_t;
+
+/* @brief Sets up a counter for each word of main memory, which must be
+*  initialized already
+*/
+void profile_init(void);
+void profile_free(void);
+
+/* @brief Keeps the disassembly of the instruction at pc for the report.
+*  text must stay valid until the report is printed.
+*/
+void profile_annotate(pc_t pc, const char *text);
+
+/* @brief Charges the cycle that just ended. Called once a cycle after
+*  hazard(), fetched is the address of the instruction fetched this cycle
+*/
+void profile_cycle(pc_t fetched);
+
+/* @brief Returns the counters of the instruction at pc, NULL if pc is not in memory */
+const profile_entry_t *profile_get(pc_t pc);
+
+/* @brief Prints the top instructions by cycles charged, 0 prints all of them */
+void profile_report(uint32_t top);
+
+#endif /* _PROFILE_H */
@@ -4,12 +4,18 @@
 
 #include "registers.h"
 
-static word_t regfile[32];
+static word_t registers[32];
+static _Thread_local word_t *regfile = registers; // file being read and written by this host thread
 
 void reg_init(void) {
+    regfile = registers;
     for (int i = 0; i < 32; ++i) regfile[i] = 0;
 }
 
+void reg_select(word_t *file) {
+    regfile = file ? file : registers;
+}
+
 void reg_read(int reg, word_t *value) {
     *value = regfile[reg];
 }
@@ -10,6 +10,8 @@
 
 // Initialize the registers
 void reg_init(void);
+// Make file (32 registers) the one read and written, NULL for the main one
+void reg_select(word_t *file);
 // Print all the register values
 void reg_dump(void);
 
@@ -0,0 +1,59 @@
+/* src/spsc.c
+* Single producer, single consumer lock-free ring
+*/
+
+#include "spsc.h"
+
+extern int flags;
+
+spsc_t *spsc_init(size_t size, uint32_t capacity){
+    if(capacity == 0 || (capacity & (capacity - 1)) != 0){
+        cprintf(ANSI_C_RED, "spsc_init: capacity %d not a power of two\n", capacity);
+        assert(0);
+    }
+    //sizeof is a multiple of the alignment, as aligned_alloc wants
+    spsc_t *queue = (spsc_t *)aligned_alloc(SPSC_LINE, sizeof(spsc_t));
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+    queue->mask = capacity - 1;
+    queue->size = size;
+    queue->slots = (uint8_t *)malloc(size * capacity);
+    return queue;
+}
+
+void spsc_free(spsc_t *queue){
+    if(queue == NULL){
+        return;
+    }
+    free(queue->slots);
+    free(queue);
+}
+
+bool spsc_push(spsc_t *queue, const void *item){
+    uint_fast32_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    uint_fast32_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+    if(tail - head > queue->mask){
+        return false;
+    }
+    memcpy(&queue->slots[(tail & queue->mask) * queue->size], item, queue->size);
+    //The element has to be there before the consumer sees the new tail
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+bool spsc_pop(spsc_t *queue, void *item){
+    uint_fast32_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    uint_fast32_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    if(head == tail){
+        return false;
+    }
+    memcpy(item, &queue->slots[(head & queue->mask) * queue->size], queue->size);
+    //Done reading the slot before the producer may reuse it
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+    return true;
+}
+
+uint32_t spsc_count(spsc_t *queue){
+    return atomic_load_explicit(&queue->tail, memory_order_acquire) -
+        atomic_load_explicit(&queue->head, memory_order_acquire);
+}
@@ -0,0 +1,50 @@
+/* src/spsc.h
+* Lock-free queue between exactly one producer thread and one consumer
+* thread, a ring of fixed size elements
+*/
+
+#ifndef _SPSC_H
+#define _SPSC_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <assert.h>
+#include "util.h"
+
+//Keeps the two indices on separate cache lines of the host
+#define SPSC_LINE 64
+
+typedef struct SPSC {
+    _Alignas(SPSC_LINE) atomic_uint_fast32_t head;  //next slot popped, written by the consumer
+    _Alignas(SPSC_LINE) atomic_uint_fast32_t tail;  //next slot pushed, written by the producer
+    _Alignas(SPSC_LINE) uint32_t mask;              //capacity - 1
+    size_t size;                                    //bytes in an element
+    uint8_t *slots;
+} spsc_t;
+
+/* @brief Builds an empty queue of capacity elements of size bytes each,
+*  capacity must be a power of two
+*/
+spsc_t *spsc_init(size_t size, uint32_t capacity);
+void spsc_free(spsc_t *queue);
+
+/* @brief Copies item to the back of the queue, producer only
+*  @returns false if the queue is full
+*/
+bool spsc_push(spsc_t *queue, const void *item);
+
+/* @brief Copies the front of the queue to item and removes it, consumer only
+*  @returns false if the queue is empty
+*/
+bool spsc_pop(spsc_t *queue, void *item);
+
+/* @brief Number of elements waiting, exact only when called by one of the
+*  two threads while the other isn't touching the queue
+*/
+uint32_t spsc_count(spsc_t *queue);
+
+#endif /* _SPSC_H */
@@ -0,0 +1,90 @@
+/* src/stats.c
+ * Statistics registry and the text/JSON dumps
+ */
+
+#include "stats.h"
+
+extern int flags;
+
+static stat_t stats[STATS_MAX];
+static int num_stats = 0;
+
+void stats_register(const char *group, const char *name, const uint32_t *value, const char *desc) {
+    if (num_stats == STATS_MAX) {
+        cprintf(ANSI_C_RED, "stats_register: no room for %s.%s, raise STATS_MAX\n", group, name);
+        assert(0);
+    }
+    if (stats_find(group, name) != NULL) {
+        cprintf(ANSI_C_RED, "stats_register: %s.%s registered twice\n", group, name);
+        assert(0);
+    }
+    stats[num_stats].group = group;
+    stats[num_stats].name  = name;
+    stats[num_stats].desc  = desc;
+    stats[num_stats].value = value;
+    ++num_stats;
+}
+
+// True if stat belongs to group or to one of its subgroups ("group.sub")
+static bool stats_in_group(const stat_t *stat, const char *group) {
+    size_t len = strlen(group);
+    return !strncmp(stat->group, group, len) && (stat->group[len] == '\0' || stat->group[len] == '.');
+}
+
+void stats_unregister(const char *group) {
+    int kept = 0;
+    for (int i = 0; i < num_stats; ++i) {
+        if (!stats_in_group(&stats[i], group)) stats[kept++] = stats[i];
+    }
+    num_stats = kept;
+}
+
+int stats_count(void) {
+    return num_stats;
+}
+
+const stat_t *stats_find(const char *group, const char *name) {
+    for (int i = 0; i < num_stats; ++i) {
+        if (!strcmp(stats[i].group, group) && !strcmp(stats[i].name, name)) return &stats[i];
+    }
+    return NULL;
+}
+
+// True if group already showed up before index i, so dumps visit each group once
+static bool stats_group_seen(int i) {
+    for (int j = 0; j < i; ++j) {
+        if (!strcmp(stats[j].group, stats[i].group)) return true;
+    }
+    return false;
+}
+
+void stats_dump(FILE *fp) {
+    char full[64];
+    fprintf(fp, "Statistics:\n");
+    for (int i = 0; i < num_stats; ++i) {
+        if (stats_group_seen(i)) continue;
+        for (int j = i; j < num_stats; ++j) {
+            if (strcmp(stats[j].group, stats[i].group)) continue;
+            snprintf(full, sizeof(full), "%s.%s", stats[j].group, stats[j].name);
+            fprintf(fp, "  %-32s %12u  # %s\n", full, *stats[j].value, stats[j].desc);
+        }
+    }
+}
+
+void stats_dump_json(FILE *fp) {
+    bool first_group = true;
+    fprintf(fp, "{");
+    for (int i = 0; i < num_stats; ++i) {
+        if (stats_group_seen(i)) continue;
+        fprintf(fp, "%s\n  \"%s\": {", first_group ? "" : ",", stats[i].group);
+        first_group = false;
+        bool first = true;
+        for (int j = i; j < num_stats; ++j) {
+            if (strcmp(stats[j].group, stats[i].group)) continue;
+            fprintf(fp, "%s\n    \"%s\": %u", first ? "" : ",", stats[j].name, *stats[j].value);
+            first = false;
+        }
+        fprintf(fp, "\n  }");
+    }
+    fprintf(fp, "\n}\n");
+}
@@ -0,0 +1,42 @@
+/* src/stats.h
+ * Statistics registry. Components keep their own counters and register a
+ * pointer to each one here, so they can all be dumped in one place at halt.
+ */
+
+#ifndef _STATS_H
+#define _STATS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#include "util.h"
+
+// Most counters that can be registered at once
+#define STATS_MAX 256
+
+typedef struct STAT {
+    const char *group;      // component the counter belongs to, e.g. "dcache"
+    const char *name;       // counter name within the group
+    const char *desc;       // one line description for the text dump
+    const uint32_t *value;
+} stat_t;
+
+// Registers a counter under group.name. The counter must stay valid until
+// stats_unregister() is called for its group.
+void stats_register(const char *group, const char *name, const uint32_t *value, const char *desc);
+// Drops every counter of a group and its subgroups ("group.sub"), called
+// when the component is destroyed
+void stats_unregister(const char *group);
+// Number of counters currently registered
+int stats_count(void);
+// Looks up a counter, returns NULL if it isn't registered
+const stat_t *stats_find(const char *group, const char *name);
+
+// Text dump, one "group.name value # description" line per counter
+void stats_dump(FILE *fp);
+// JSON dump, an object per group holding its counters
+void stats_dump_json(FILE *fp);
+
+#endif /* _STATS_H */
@@ -60,8 +60,10 @@ typedef enum OpCodes {
     OPC_LHU     = 0x25, // 0b100101, Load Halfword Unsigned
     OPC_LUI     = 0x0f, // 0b001111, Load Upper Immediate
     OPC_LW      = 0x23, // 0b100011, Load Word
+    OPC_LL      = 0x30, // 0b110000, Load Linked Word
     OPC_ORI     = 0x0d, // 0b001101, Or Immediate
     OPC_SB      = 0x28, // 0b101000, Store Byte
+    OPC_SC      = 0x38, // 0b111000, Store Conditional Word
     OPC_SH      = 0x29, // 0b101001, Store Halfword
     OPC_SLTI    = 0x0a, // 0b001010, Set on Less Than Immediate
     OPC_SLTIU   = 0x0b, // 0b001011, Set on Less Than Immediate Unsigned
@@ -148,10 +150,12 @@ typedef enum Operations {
     OPR_LH,     // Load Halfword                                    (MIPS I)
     OPR_LHU,    // Load Halfword Unsigned                           (MIPS I)
     OPR_LW,     // Load Word                                        (MIPS I)
+    OPR_LL,     // Load Linked Word                                 (MIPS II)
     // Store
     OPR_SB,     // Store Byte                                       (MIPS I)
     OPR_SH,     // Store Halfword                                   (MIPS I)
     OPR_SW,     // Store Word                                       (MIPS I)
+    OPR_SC,     // Store Conditional Word                           (MIPS II)
     // Data movement
     OPR_MOVN,   // Move Conditional on Not Zero                     (MIPS IV)
     OPR_MOVZ,   // Move Conditional on Zero                         (MIPS IV)
@@ -195,10 +199,17 @@ typedef struct CONTROL_REGISTER {
     uint32_t regRtValue;
 
     uint32_t ALUresult;
+    pc_t pc;            // Address the instruction was fetched from
+    bool predTaken;     // fetch predicted the instruction after the delay slot comes from predTarget
+    pc_t predTarget;
+    uint32_t bpHistory; // global branch history when the prediction was made
+    bool predReturn;    // predTarget came from the return address stack
     uint32_t pcNext;
     uint32_t memData;
 
     cache_status_t status;
+    bool memDone;       // memory access already performed before the pipeline was restored, don't repeat it
+    uint32_t seq;       // number of the instruction in the pipeline trace, 0 for a bubble
 
 } control_t;
 
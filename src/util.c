@@ -55,8 +55,14 @@ void copy_pipeline_register(control_t* orig, control_t* copy){
     copy->regRsValue    = orig->regRsValue;
     copy->regRtValue    = orig->regRtValue;
     copy->ALUresult     = orig->ALUresult;
+    copy->pc            = orig->pc;
+    copy->predTaken     = orig->predTaken;
+    copy->predTarget    = orig->predTarget;
+    copy->bpHistory     = orig->bpHistory;
+    copy->predReturn    = orig->predReturn;
     copy->pcNext        = orig->pcNext;
     copy->memData       = orig->memData;
+    copy->seq           = orig->seq;
 }
 
 void flush(control_t* reg){
@@ -80,8 +86,15 @@ void flush(control_t* reg){
     reg->regRsValue     = 0;
     reg->regRtValue     = 0;
     reg->ALUresult      = 0;
+    reg->pc             = 0;
+    reg->predTaken      = false;
+    reg->predTarget     = 0;
+    reg->bpHistory      = 0;
+    reg->predReturn     = false;
     reg->pcNext         = 0;
     reg->memData        = 0;
+    reg->memDone        = false;
+    reg->seq            = 0;
 }
 
 void pipeline_init(control_t** ifid, control_t** idex, control_t** exmem, control_t** memwb, pc_t* pc, pc_t pc_start) {
@@ -22,6 +22,12 @@
 #define MASK_INTERACTIVE    (1<<3) // Interactive stepping
 #define MASK_ALTFORMAT      (1<<4) // Alternate assembly input format
 #define MASK_COLOR          (1<<5) // Colorized text output
+#define MASK_STATS          (1<<6) // Dump the statistics registry at halt
+#define MASK_PROFILE        (1<<7) // Charge every cycle to an instruction address
+#define MASK_EVENTS         (1<<8) // Record debug events in the binary log (see eventlog.h)
+#define MASK_PIPETRACE      (1<<9) // Write the pipeline trace (see pipetrace.h)
+#define MASK_BREAKPOINTS    (1<<10) // Some breakpoint is set (see breakpoint.h)
+#define MASK_WATCHPOINTS    (1<<11) // Some watchpoint is set
 
 // ANSI colour escapes
 #define ANSI_C_BLACK        "\x1b[1;30m"
@@ -49,9 +55,30 @@ do {if (flags & MASK_COLOR) \
 #define gprintf(COLOR__,str,...) if (flags & MASK_DEBUG) cprintf(COLOR__,str,##__VA_ARGS__)
 #define bprintf(COLOR__,str,...) if (flags & MASK_VERBOSE) cprintf(COLOR__,str,##__VA_ARGS__)
 
+typedef enum bp_type_t {
+    BP_NONE,            // Branches resolved in decode, no prediction needed
+    BP_STATIC,          // Resolved in execute, always predict not taken
+    BP_BIMODAL,         // Resolved in execute, 2-bit counters indexed by PC
+    BP_GSHARE,          // Resolved in execute, 2-bit counters indexed by PC xor global history
+    BP_TOURNAMENT       // Resolved in execute, bimodal and gshare with a chooser
+} bp_type_t;
+
 typedef struct cpu_config_t {
     bool single_cycle;
     unsigned long mem_size;
+    unsigned int issue_width;   // instructions fetched and issued each cycle
+    bp_type_t bp_type;
+    unsigned int bp_entries;    // 2-bit counters in each predictor table
+    unsigned int btb_entries;   // branch target buffer entries
+    unsigned int ras_depth;     // return address stack entries, 0 for none
+    bool ooo;                   // out-of-order core instead of the pipeline
+    unsigned int rob_entries;   // reorder buffer entries
+    unsigned int rs_entries;    // reservation station entries
+    unsigned int lsq_entries;   // load/store queue entries
+    unsigned int cores;         // pipelines sharing main memory
+    unsigned int quantum;       // cycles the cores run apart between synchronizations, 0 for lockstep
+    unsigned int host_threads;  // host threads running the cores in a quantum
+    bool decoupled;             // functional front-end thread feeding a timing-only pipeline
 } cpu_config_t;
 
 typedef enum cache_mode_t {
@@ -67,6 +94,16 @@ typedef enum cache_wpolicy_t {
     CACHE_WRITEBACK,
     CACHE_WRITETHROUGH
 } cache_wpolicy_t;
+typedef enum cache_prefetch_t {
+    CACHE_PREFETCH_NONE,        // No prefetching
+    CACHE_PREFETCH_NEXTLINE,    // Tagged next-line
+    CACHE_PREFETCH_STRIDE,      // PC-indexed reference prediction table
+    CACHE_PREFETCH_STREAM       // Stream buffers
+} cache_prefetch_t;
+typedef enum cache_coherence_t {
+    CACHE_MSI,          // Modified, shared, invalid
+    CACHE_MESI          // MSI plus exclusive, a block no one else holds is written without a bus transaction
+} cache_coherence_t;
 
 
 typedef struct cache_config_t {
@@ -77,16 +114,27 @@ typedef struct cache_config_t {
     unsigned int    data_block;
     cache_type_t    data_type;
     cache_wpolicy_t data_wpolicy;
+    unsigned int    data_mshrs;
+    cache_prefetch_t data_prefetch;
+    unsigned int    data_victim;    // victim cache entries, 0 for none
     bool            inst_enabled;
     unsigned int    inst_size;
     unsigned int    inst_block;
     cache_type_t    inst_type;
     cache_wpolicy_t inst_wpolicy;
+    cache_prefetch_t inst_prefetch;
+    unsigned int    inst_victim;
     /* Unified cache options */
     unsigned int    size;
     unsigned int    block;
     cache_type_t    type;
     cache_wpolicy_t wpolicy;
+    /* Multicore options */
+    unsigned int    cores;          // private caches to build, one set per core (0 or 1 for one)
+    cache_coherence_t coherence;    // protocol keeping the data caches of the cores coherent
+    unsigned int    quantum;        // cycles the cores run apart, each on its own bus (0 for lockstep)
+    bool            timing_only;    // tags and timing only, no data moves to or from main memory
+    bool            classify;       // split misses into compulsory, capacity and conflict, only for statistics
 } cache_config_t;
 
 void print_pipeline_register(control_t *reg);
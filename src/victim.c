@@ -0,0 +1,158 @@
+/*
+* src/victim.c
+* Fully associative victim cache for the direct mapped caches
+*/
+
+#include "victim.h"
+#include "cache.h"
+#include "main_memory.h"
+#include "stats.h"
+#include "eventlog.h"
+
+extern int flags;
+
+victim_cache_t *victim_init(uint32_t num_entries, uint32_t block_size){
+    if(num_entries == 0){
+        return NULL;
+    }
+    if(num_entries > VICTIM_MAX_ENTRIES){
+        cprintf(ANSI_C_RED, "victim_init: %d entries requested, must be between 1 and %d\n", num_entries, VICTIM_MAX_ENTRIES);
+        assert(0);
+    }
+    victim_cache_t *vc = (victim_cache_t *)malloc(sizeof(victim_cache_t));
+    if(vc == NULL){
+        cprintf(ANSI_C_RED, "victim_init: Unable to allocate victim cache\n");
+        assert(0);
+    }
+    vc->num_entries = num_entries;
+    vc->block_size = block_size;
+    vc->entries = (victim_entry_t *)malloc(sizeof(victim_entry_t) * num_entries);
+    vc->words = (word_t *)malloc(sizeof(word_t) * num_entries * block_size);
+    vc->valid = (bool *)malloc(sizeof(bool) * block_size);
+    vc->swap = (word_t *)malloc(sizeof(word_t) * block_size);
+    if(vc->entries == NULL || vc->words == NULL || vc->valid == NULL || vc->swap == NULL){
+        cprintf(ANSI_C_RED, "victim_init: Unable to allocate victim cache\n");
+        assert(0);
+    }
+    for(uint32_t i = 0; i < num_entries; i++){
+        vc->entries[i].valid = false;
+        vc->entries[i].dirty = false;
+        vc->entries[i].block_address = 0;
+        vc->entries[i].last_used = 0;
+        vc->entries[i].data = vc->words + i * block_size;
+    }
+    for(uint32_t i = 0; i < block_size; i++){
+        vc->valid[i] = true;
+    }
+    vc->clock = 0;
+    vc->last_probe = 0xffffffff;
+    vc->probes = 0;
+    vc->hits = 0;
+    vc->inserts = 0;
+    vc->evictions = 0;
+    vc->writebacks = 0;
+    return vc;
+}
+
+void victim_free(victim_cache_t *vc){
+    if(vc == NULL){
+        return;
+    }
+    free(vc->swap);
+    free(vc->valid);
+    free(vc->words);
+    free(vc->entries);
+    free(vc);
+}
+
+victim_entry_t *victim_find(victim_cache_t *vc, uint32_t block_address){
+    if(vc == NULL){
+        return NULL;
+    }
+    for(uint32_t i = 0; i < vc->num_entries; i++){
+        if(vc->entries[i].valid && vc->entries[i].block_address == block_address){
+            return &vc->entries[i];
+        }
+    }
+    return NULL;
+}
+
+bool victim_insert(victim_cache_t *vc, uint32_t block_address, word_t *data, bool dirty){
+    victim_entry_t *entry = NULL;
+    for(uint32_t i = 0; i < vc->num_entries; i++){
+        if(!vc->entries[i].valid){
+            entry = &vc->entries[i];
+            break;
+        }
+        if(entry == NULL || vc->entries[i].last_used < entry->last_used){
+            entry = &vc->entries[i];
+        }
+    }
+    if(entry->valid){
+        //Full, the least recently used block leaves for good
+        if(entry->dirty){
+            if(write_buffer_enqueue(entry->block_address, entry->data, vc->valid, vc->block_size) == CACHE_MISS){
+                EVENT(EV_VICTIM_FULL, entry->block_address);
+                return false;
+            }
+            vc->writebacks++;
+        }
+        vc->evictions++;
+        EVENT(EV_VICTIM_EVICT, entry->block_address);
+    }
+    for(uint32_t i = 0; i < vc->block_size; i++){
+        entry->data[i] = data[i];
+    }
+    entry->valid = true;
+    entry->dirty = dirty;
+    entry->block_address = block_address;
+    entry->last_used = ++vc->clock;
+    vc->inserts++;
+    EVENT(EV_VICTIM_INSERT, block_address, dirty);
+    return true;
+}
+
+void victim_touch(victim_cache_t *vc, victim_entry_t *entry){
+    entry->last_used = ++vc->clock;
+}
+
+void victim_flush(victim_cache_t *vc){
+    if(vc == NULL){
+        return;
+    }
+    for(uint32_t i = 0; i < vc->num_entries; i++){
+        victim_entry_t *entry = &vc->entries[i];
+        if(!entry->valid || !entry->dirty){
+            continue;
+        }
+        for(uint32_t j = 0; j < vc->block_size; j++){
+            mem_write_w(entry->block_address | (j << 2), &entry->data[j]);
+        }
+        entry->dirty = false;
+    }
+}
+
+void victim_register_stats(victim_cache_t *vc, const char *group){
+    if(vc == NULL){
+        return;
+    }
+    stats_register(group, "probes", &vc->probes, "cache misses that looked in the victim cache");
+    stats_register(group, "hits", &vc->hits, "blocks swapped back into the cache");
+    stats_register(group, "inserts", &vc->inserts, "blocks caught on their way out of the cache");
+    stats_register(group, "evictions", &vc->evictions, "blocks pushed out to make room");
+    stats_register(group, "writebacks", &vc->writebacks, "pushed out blocks written back to memory");
+}
+
+void victim_report(victim_cache_t *vc, const char *name){
+    if(vc == NULL){
+        return;
+    }
+    printf("%s victim cache (%d entr%s):\n", name, vc->num_entries, vc->num_entries == 1 ? "y" : "ies");
+    printf("\tProbes:                 %d (misses in the cache)\n", vc->probes);
+    printf("\tHits:                   %d (swapped back into the cache)\n", vc->hits);
+    printf("\tBlocks caught:          %d\n", vc->inserts);
+    printf("\tBlocks pushed out:      %d (%d dirty written back)\n", vc->evictions, vc->writebacks);
+    if(vc->probes){
+        printf("\tHit rate:   %.3f\n", (double)vc->hits / vc->probes);
+    }
+}
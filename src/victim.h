@@ -0,0 +1,72 @@
+/*
+* src/victim.h
+* Small fully associative victim cache that sits behind a direct mapped cache
+*/
+
+#ifndef _VICTIM_H
+#define _VICTIM_H
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "util.h"
+#include "types.h"
+
+//Largest number of blocks a victim cache can hold
+#define VICTIM_MAX_ENTRIES 16
+
+typedef struct VICTIM_ENTRY {
+    bool valid;
+    bool dirty;
+    uint32_t block_address;
+    uint32_t last_used;         //victim cache clock at insertion or last hit, for LRU
+    word_t *data;
+} victim_entry_t;
+
+typedef struct VICTIM_CACHE {
+    uint32_t num_entries;
+    uint32_t block_size;        //in words
+    victim_entry_t *entries;
+    word_t *words;
+    bool *valid;                //all true, for writing whole blocks back
+    word_t *swap;               //scratch block for swapping with the cache
+    uint32_t clock;
+    uint32_t last_probe;        //block of the last probe, replays are not counted again
+    //Counters
+    uint32_t probes;            //misses in the cache that looked here
+    uint32_t hits;              //blocks swapped back into the cache
+    uint32_t inserts;           //blocks caught on their way out of the cache
+    uint32_t evictions;         //blocks pushed out to make room
+    uint32_t writebacks;        //pushed out blocks that had to go to memory
+} victim_cache_t;
+
+/* @brief Creates a victim cache holding num_entries blocks of block_size words
+*  @returns NULL if num_entries is 0
+*/
+victim_cache_t *victim_init(uint32_t num_entries, uint32_t block_size);
+
+void victim_free(victim_cache_t *vc);
+
+/* @brief Finds the entry holding the block at block_address, NULL if none */
+victim_entry_t *victim_find(victim_cache_t *vc, uint32_t block_address);
+
+/* @brief Takes in a block evicted from the cache. The least recently used
+*  entry makes room, going to the write buffer if it is dirty.
+*  @returns false if the write buffer can't take that block this cycle
+*/
+bool victim_insert(victim_cache_t *vc, uint32_t block_address, word_t *data, bool dirty);
+
+/* @brief Marks an entry as just used */
+void victim_touch(victim_cache_t *vc, victim_entry_t *entry);
+
+/* @brief Writes every dirty block straight to main memory */
+void victim_flush(victim_cache_t *vc);
+
+/* @brief Registers the victim cache counters with the statistics registry */
+void victim_register_stats(victim_cache_t *vc, const char *group);
+
+/* @brief Prints the hit counters of the victim cache */
+void victim_report(victim_cache_t *vc, const char *name);
+
+#endif /* _VICTIM_H */
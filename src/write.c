@@ -3,6 +3,7 @@
 */
 
 #include "write.h"
+#include "eventlog.h"
 
 extern int flags;
 
@@ -23,19 +24,14 @@ void writeback(control_t *memwb){
         writeRegisterValue = memwb->ALUresult;
     }
 
-    if (flags & MASK_DEBUG) {
-        cprintf(ANSI_C_CYAN, "WRITE: \n");
-        printf("\tInstruction: 0x%08x\n", memwb->instr);
+    EVENT(EV_WRITEBACK, memwb->instr);
+    // The instruction is done, the checker sees what it left behind
+    if (checker_enabled()) {
+        checker_commit(memwb);
     }
     // Write back to the register file
     if (memwb->regWrite) {
-        if (flags & MASK_DEBUG) {
-            printf("\tWriting 0x%08x to register 0x%02x (0d%d, $%s)\n",
-                writeRegisterValue,
-                writeRegister,
-                writeRegister,
-                get_register_name_string(writeRegister));
-        }
+        EVENT(EV_WRITEBACK_REG, writeRegisterValue, writeRegister);
         reg_write(writeRegister, &writeRegisterValue);
     }
 }
@@ -8,6 +8,7 @@
 #include "types.h"
 #include "util.h"
 #include "registers.h"
+#include "checker.h"
 
 void writeback(control_t *memwb);
 
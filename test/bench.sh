@@ -0,0 +1,66 @@
+#!/bin/sh
+# test/bench.sh
+# Simulator throughput benchmark, run by make bench. Runs every asm/bench-*.s
+# workload in every mode below and prints a table of host wall time,
+# simulated cycles, simulated instructions per host second and peak RSS.
+# The table of an earlier run given as BASELINE adds a column with the
+# speedup over it, so a change can be judged against it:
+#     make bench > before.txt
+#     (change something)
+#     make bench BASELINE=before.txt
+# Exits with status 1 if a workload ends with the wrong result in $v0.
+
+SIM=${SIM:-./sim}
+BASELINE=$1
+
+# name and options of every mode
+MODES="scalar:
+caches:-D e -H back -N 4
+gshare:-b gshare -D e -H back -N 4
+width2:-w 2 -D e -H back -N 4
+ooo:-o -D e -H back -N 4
+decoupled:-f -D e -H back -N 4
+check:-l -D e -H back -N 4"
+
+if [ -n "$BASELINE" ] && [ ! -r "$BASELINE" ]; then
+    echo "bench: can't read baseline $BASELINE" >&2
+    exit 2
+fi
+
+failed=0
+printf "%-10s %-10s %8s %10s %10s %8s %8s" workload mode seconds cycles instrs Minstr/s RSS_KB
+[ -n "$BASELINE" ] && printf " %8s" speedup
+printf "\n"
+for file in asm/bench-*.s; do
+    workload=$(basename "$file" .s | sed 's/^bench-//')
+    # the expected result is the last word of the header's Result line
+    expected=$(grep -m1 '^# Result' "$file" | awk '{print $NF}')
+    while IFS=: read -r mode options; do
+        out=$($SIM -z $options "$file" 2>&1)
+        host=$(echo "$out" | grep '^Host:')
+        result=$(echo "$out" | grep -m1 '\$v0:' | awk '{print $2}')
+        if [ -z "$host" ] || [ "$result" != "$expected" ]; then
+            printf "%-10s %-10s FAILED, \$v0 = %s, expected %s\n" "$workload" "$mode" "${result:-nothing}" "$expected"
+            failed=1
+            continue
+        fi
+        # Host: 0.231 s, 866145 cycles (3.75 M/s), 866145 instructions (3.74 M/s), peak RSS 3456 KB
+        echo "$host" | awk -v w="$workload" -v m="$mode" -v base="$BASELINE" '{
+            gsub(/[(,]/, "")
+            line = sprintf("%-10s %-10s %8.3f %10d %10d %8.2f %8d", w, m, $2, $4, $8, $10, $14)
+            if (base != "") {
+                speedup = "-"
+                while ((getline old < base) > 0) {
+                    split(old, f)
+                    if (f[1] == w && f[2] == m && f[6] > 0) speedup = sprintf("%.2fx", $10 / f[6])
+                }
+                close(base)
+                line = line sprintf(" %8s", speedup)
+            }
+            print line
+        }'
+    done <<END
+$MODES
+END
+done
+exit $failed
@@ -9,22 +9,399 @@
 #include "minunit.h"
 #include "../src/cache.h"
 #include "../src/direct.h"
+#include "../src/coherence.h"
+#include "../src/prefetch.h"
+#include "../src/stats.h"
 #include "../src/types.h"
 #include "../src/util.h"
 
 
 int tests_run = 0;
 
-int flags = MASK_DEBUG | MASK_VERBOSE | MASK_SANITY;
+int flags = 0; // MASK_DEBUG | MASK_VERBOSE | MASK_SANITY;
 
+extern _Thread_local direct_cache_t *d_cache;
 
-static char * test_cache(){
-    mem_init(2<<14, 0);
-    cache_init();
+cache_config_t cache_config = {
+    .mode           = CACHE_SPLIT,
+    .data_enabled   = true,
+    .data_size      = 64,
+    .data_block     = 4,
+    .data_type      = CACHE_DIRECT,
+    .data_wpolicy   = CACHE_WRITEBACK,
+    .data_mshrs     = 1,
+    .data_prefetch  = CACHE_PREFETCH_NONE,
+    .data_victim    = 0,
+    .inst_enabled   = true,
+    .inst_size      = 64,
+    .inst_block     = 4,
+    .inst_type      = CACHE_DIRECT,
+    .inst_wpolicy   = CACHE_WRITETHROUGH,
+    .inst_prefetch  = CACHE_PREFETCH_NONE,
+    .inst_victim    = 0,
+    .size           = 1024,
+    .block          = 4,
+    .type           = CACHE_DIRECT,
+    .wpolicy        = CACHE_WRITETHROUGH,
+};
+
+// Fill memory with data that is easy to recognize (each word holds its address)
+static void mem_setup(void){
+    mem_init(2<<12, 0);
+    for(uint32_t i = 0; i < (2<<12); i += 4){
+        mem_write_w(i, &i);
+    }
 }
 
-static char * all_tests() {
+// Run the cache for a number of cycles
+static void digest(int cycles){
+    for(int i = 0; i < cycles; i++){
+        cache_digest();
+    }
+}
+
+static char * test_blocking_miss(){
+    uint32_t address = 0x100, other = 0x210;
+    word_t data = 0;
+    mem_setup();
+    cache_config.data_mshrs = 1;
+    cache_init(&cache_config);
+    mu_assert(_FL "cold cache should miss", d_cache_read_w(&address, &data, 0) == CACHE_MISS);
+    mu_assert(_FL "miss should allocate an MSHR", d_cache->mshr_primary == 1);
+    // A second miss can't go anywhere while the only MSHR is busy
+    mu_assert(_FL "second miss should miss", d_cache_read_w(&other, &data, 0) == CACHE_MISS);
+    mu_assert(_FL "second miss should find no free MSHR", d_cache->mshr_full == 1);
+    // Bus arbitration takes a cycle, then the first word needs the full penalty
+    digest(CACHE_MISS_PENALTY + 1);
+    mu_assert(_FL "first word should be in", d_cache_read_w(&address, &data, 0) == CACHE_HIT);
+    mu_assert(_FL "bad data from cache", data == address);
+    cache_destroy();
+    mem_close();
+    return 0;
+}
+
+static char * test_miss_under_miss(){
+    uint32_t first = 0x100, second = 0x210, merged = 0x108;
+    word_t data = 0;
+    mem_setup();
+    cache_config.data_mshrs = 4;
+    cache_init(&cache_config);
+    mu_assert(_FL "cold cache should miss", d_cache_read_w(&first, &data, 0) == CACHE_MISS);
+    mu_assert(_FL "second block should miss", d_cache_read_w(&second, &data, 0) == CACHE_MISS);
+    mu_assert(_FL "both misses should be outstanding", direct_cache_mshrs_busy(d_cache) == 2);
+    mu_assert(_FL "second miss is a miss under miss", d_cache->miss_under_miss == 1);
+    // Same block as the first miss, gets merged instead of going to memory again
+    mu_assert(_FL "word in flight should miss", d_cache_read_w(&merged, &data, 0) == CACHE_MISS);
+    mu_assert(_FL "secondary miss should merge", d_cache->mshr_secondary == 1);
+    mu_assert(_FL "merge should not allocate", d_cache->mshr_primary == 2);
+    // Replaying the same access does not count twice
+    d_cache_read_w(&merged, &data, 0);
+    mu_assert(_FL "replay counted as another merge", d_cache->mshr_secondary == 1);
+    // Both fills overlap, so both blocks are in after one block worth of cycles
+    digest(CACHE_MISS_PENALTY + (d_cache->block_size - 1) * CACHE_MISS_SUBSEQUENT_PENALTY + 1);
+    mu_assert(_FL "first block should be in", d_cache_read_w(&merged, &data, 0) == CACHE_HIT);
+    mu_assert(_FL "bad data from first block", data == merged);
+    mu_assert(_FL "second block should be in", d_cache_read_w(&second, &data, 0) == CACHE_HIT);
+    mu_assert(_FL "bad data from second block", data == second);
+    mu_assert(_FL "MSHRs should be free", direct_cache_mshrs_busy(d_cache) == 0);
+    mu_assert(_FL "two MSHRs should have been busy at once", d_cache->mshr_peak == 2);
+    cache_destroy();
+    mem_close();
+    return 0;
+}
+
+static char * test_store_under_miss(){
+    uint32_t address = 0x104;
+    word_t data = 0xdeadbeef, read = 0;
+    mem_setup();
+    cache_config.data_mshrs = 2;
+    cache_init(&cache_config);
+    // A non-blocking cache takes the store and finishes it when the block shows up
+    mu_assert(_FL "store miss should not stall", d_cache_write_w(&address, &data, 0xffff0000, 0) == CACHE_HIT);
+    mu_assert(_FL "store miss should allocate", d_cache->mshr_primary == 1);
+    mu_assert(_FL "stored word is not in yet", d_cache_read_w(&address, &read, 0) == CACHE_MISS);
+    digest(CACHE_MISS_PENALTY + CACHE_MISS_SUBSEQUENT_PENALTY + 1);
+    mu_assert(_FL "stored word should be in", d_cache_read_w(&address, &read, 0) == CACHE_HIT);
+    mu_assert(_FL "store should be merged into the fill", read == ((0xdeadbeef & 0xffff0000) | (address & 0xffff)));
+    // Flushing writes the dirty block back to memory
+    cache_flush();
+    mem_read_w(address, &read);
+    mu_assert(_FL "store should reach memory", read == ((0xdeadbeef & 0xffff0000) | (address & 0xffff)));
+    cache_destroy();
+    mem_close();
+    return 0;
+}
+
+static char * test_same_store_under_miss(){
+    // A=1, A=2, A=1 inside one miss window: each is a store of its own, the
+    // last one has to win even though it matches the first
+    uint32_t address = 0x104;
+    word_t one = 1, two = 2, read = 0;
+    mem_setup();
+    cache_config.data_mshrs = 4;
+    cache_init(&cache_config);
+    mu_assert(_FL "store miss should not stall", d_cache_write_w(&address, &one, 0xffffffff, 0) == CACHE_HIT);
+    mu_assert(_FL "store under miss should not stall", d_cache_write_w(&address, &two, 0xffffffff, 0) == CACHE_HIT);
+    mu_assert(_FL "store under miss should not stall", d_cache_write_w(&address, &one, 0xffffffff, 0) == CACHE_HIT);
+    mu_assert(_FL "every store should be parked", d_cache->mshrs[0].num_targets == 3);
+    digest(CACHE_MISS_PENALTY + CACHE_MISS_SUBSEQUENT_PENALTY + 1);
+    mu_assert(_FL "stored word should be in", d_cache_read_w(&address, &read, 0) == CACHE_HIT);
+    mu_assert(_FL "the last store should win", read == 1);
+    cache_flush();
+    mem_read_w(address, &read);
+    mu_assert(_FL "the last store should reach memory", read == 1);
+    cache_destroy();
+    mem_close();
+    return 0;
+}
+
+static char * test_dirty_eviction(){
+    // Both addresses map to the same block of the 16 word cache
+    uint32_t address = 0x100, conflict = 0x200;
+    word_t data = 0x12345678, read = 0;
+    int cycles = 0;
+    mem_setup();
+    cache_config.data_mshrs = 1;
+    cache_init(&cache_config);
+    while(d_cache_write_w(&address, &data, 0xffffffff, 0) != CACHE_HIT && cycles++ < 100){
+        cache_digest();
+    }
+    mu_assert(_FL "store never hit", cycles < 100);
+    cycles = 0;
+    while(d_cache_read_w(&conflict, &read, 0) != CACHE_HIT && cycles++ < 100){
+        cache_digest();
+    }
+    mu_assert(_FL "conflicting load never hit", cycles < 100);
+    mu_assert(_FL "bad data from conflicting block", read == conflict);
+    // The evicted dirty block drains through the write buffer once the fill is done with the bus
+    digest((d_cache->block_size - 1) * CACHE_MISS_SUBSEQUENT_PENALTY + 1);
+    digest(CACHE_WRITE_PENALTY + d_cache->block_size * CACHE_WRITE_SUBSEQUENT_PENALTY + 1);
+    mem_read_w(address, &read);
+    mu_assert(_FL "dirty block was not written back", read == data);
+    cache_destroy();
+    mem_close();
+    return 0;
+}
+
+// Replay a load every cycle until it hits, like the pipeline does
+static int read_until_hit(uint32_t address, word_t *data, pc_t pc){
+    int cycles = 0;
+    while(d_cache_read_w(&address, data, pc) != CACHE_HIT && cycles < 100){
+        cache_digest();
+        cycles++;
+    }
+    return cycles;
+}
 
+static char * test_nextline_prefetch(){
+    uint32_t next = 0x110;
+    word_t data = 0;
+    mem_setup();
+    cache_config.data_mshrs = 1;
+    cache_config.data_prefetch = CACHE_PREFETCH_NEXTLINE;
+    cache_init(&cache_config);
+    mu_assert(_FL "demand miss never hit", read_until_hit(0x100, &data, 0x40) < 100);
+    mu_assert(_FL "next block should not be requested before the bus is idle", d_cache->prefetch->issued == 0);
+    // Let the demand fill finish, then the prefetch gets the idle bus
+    digest((d_cache->block_size - 1) * CACHE_MISS_SUBSEQUENT_PENALTY + 2);
+    mu_assert(_FL "next block should be prefetched", d_cache->prefetch->issued == 1);
+    digest(CACHE_MISS_PENALTY + (d_cache->block_size - 1) * CACHE_MISS_SUBSEQUENT_PENALTY + 1);
+    mu_assert(_FL "prefetched block should hit", d_cache_read_w(&next, &data, 0x44) == CACHE_HIT);
+    mu_assert(_FL "bad data from prefetched block", data == next);
+    mu_assert(_FL "prefetch should be useful", d_cache->prefetch->useful == 1 && d_cache->prefetch->late == 0);
+    mu_assert(_FL "prefetch should not count as a demand miss", d_cache->mshr_primary == 1);
+    cache_destroy();
+    mem_close();
+    cache_config.data_prefetch = CACHE_PREFETCH_NONE;
+    return 0;
+}
+
+static char * test_stride_prefetch(){
+    // Stride of two blocks from the same load
+    uint32_t predicted = 0x160;
+    word_t data = 0;
+    mem_setup();
+    cache_config.data_mshrs = 4;
+    cache_config.data_prefetch = CACHE_PREFETCH_STRIDE;
+    cache_init(&cache_config);
+    mu_assert(_FL "first access never hit", read_until_hit(0x100, &data, 0x40) < 100);
+    mu_assert(_FL "second access never hit", read_until_hit(0x120, &data, 0x40) < 100);
+    mu_assert(_FL "stride is not confirmed yet", d_cache->prefetch->queue_count == 0);
+    mu_assert(_FL "third access never hit", read_until_hit(0x140, &data, 0x40) < 100);
+    // Another load with its own entry does not disturb the stride
+    mu_assert(_FL "other load never hit", read_until_hit(0x104, &data, 0x80) < 100);
+    digest(2 * (CACHE_MISS_PENALTY + (d_cache->block_size - 1) * CACHE_MISS_SUBSEQUENT_PENALTY + 1));
+    mu_assert(_FL "one prefetch should be issued", d_cache->prefetch->issued == 1);
+    mu_assert(_FL "predicted block should hit", d_cache_read_w(&predicted, &data, 0x40) == CACHE_HIT);
+    mu_assert(_FL "bad data from predicted block", data == predicted);
+    mu_assert(_FL "prefetch should be useful", d_cache->prefetch->useful == 1);
+    cache_destroy();
+    mem_close();
+    cache_config.data_prefetch = CACHE_PREFETCH_NONE;
+    return 0;
+}
+
+static char * test_stream_buffer(){
+    uint32_t next = 0x118;
+    word_t data = 0;
+    mem_setup();
+    cache_config.data_mshrs = 1;
+    cache_config.data_prefetch = CACHE_PREFETCH_STREAM;
+    cache_init(&cache_config);
+    mu_assert(_FL "demand miss never hit", read_until_hit(0x100, &data, 0x40) < 100);
+    // Give the stream buffer time to fill up behind the miss
+    digest(PREFETCH_STREAM_DEPTH * (CACHE_MISS_PENALTY + (d_cache->block_size - 1) * CACHE_MISS_SUBSEQUENT_PENALTY + 1) + 4);
+    mu_assert(_FL "stream buffer should be full", d_cache->prefetch->issued == PREFETCH_STREAM_DEPTH);
+    mu_assert(_FL "stream buffer does not fill the cache", d_cache_read_w(&next, &data, 0x40) == CACHE_MISS);
+    mu_assert(_FL "block should move over from the stream buffer", d_cache_read_w(&next, &data, 0x40) == CACHE_HIT);
+    mu_assert(_FL "bad data from stream buffer", data == next);
+    mu_assert(_FL "stream hit should not go to memory", d_cache->mshr_primary == 1);
+    mu_assert(_FL "stream hit should be useful", d_cache->prefetch->useful == 1);
+    // The freed slot lets the stream run one block further
+    digest(CACHE_MISS_PENALTY + (d_cache->block_size - 1) * CACHE_MISS_SUBSEQUENT_PENALTY + 2);
+    mu_assert(_FL "stream should keep going", d_cache->prefetch->issued == PREFETCH_STREAM_DEPTH + 1);
+    cache_destroy();
+    mem_close();
+    cache_config.data_prefetch = CACHE_PREFETCH_NONE;
+    return 0;
+}
+
+static char * test_victim_cache(){
+    // Both addresses map to the same block of the 16 word cache
+    uint32_t address = 0x100, conflict = 0x200;
+    word_t data = 0xcafef00d, read = 0;
+    int cycles = 0;
+    mem_setup();
+    cache_config.data_mshrs = 1;
+    cache_config.data_victim = 2;
+    cache_init(&cache_config);
+    while(d_cache_write_w(&address, &data, 0xffffffff, 0) != CACHE_HIT && cycles++ < 100){
+        cache_digest();
+    }
+    mu_assert(_FL "store never hit", cycles < 100);
+    mu_assert(_FL "conflicting load never hit", read_until_hit(conflict, &read, 0) < 100);
+    mu_assert(_FL "evicted block should be caught", d_cache->victim->inserts == 1);
+    // The dirty block went to the victim cache, not to memory
+    mu_assert(_FL "dirty block should not be written back yet", write_buffer_pending(address, 1) == false);
+    digest(CACHE_MISS_PENALTY);
+    // Coming back costs one cycle instead of a trip to memory
+    mu_assert(_FL "victim hit should take a cycle", d_cache_read_w(&address, &read, 0) == CACHE_MISS);
+    mu_assert(_FL "victim hit should not go to memory", direct_cache_mshrs_busy(d_cache) == 0);
+    mu_assert(_FL "block should be swapped back", d_cache_read_w(&address, &read, 0) == CACHE_HIT);
+    mu_assert(_FL "swapped block lost the store", read == data);
+    mu_assert(_FL "victim hit not counted", d_cache->victim->hits == 1);
+    mu_assert(_FL "swap should bring the other block back", d_cache_read_w(&conflict, &read, 0) == CACHE_MISS);
+    mu_assert(_FL "other block should be swapped back", d_cache_read_w(&conflict, &read, 0) == CACHE_HIT);
+    mu_assert(_FL "bad data from other block", read == conflict);
+    mu_assert(_FL "only the first two misses should go to memory", d_cache->mshr_primary == 2);
+    // Dirty data in the victim cache reaches memory on a flush
+    cache_flush();
+    mem_read_w(address, &read);
+    mu_assert(_FL "dirty victim block was not flushed", read == data);
+    cache_destroy();
+    mem_close();
+    cache_config.data_victim = 0;
+    return 0;
+}
+
+static char * test_cache_stats(){
+    // 0x100 and 0x200 map to the same block of the 16 block cache
+    uint32_t address = 0x100, neighbour = 0x104, conflict = 0x200;
+    word_t read = 0;
+    mem_setup();
+    cache_config.data_mshrs = 1;
+    cache_config.classify = true;
+    cache_init(&cache_config);
+    mu_assert(_FL "cold load never hit", read_until_hit(address, &read, 0x40) < 100);
+    mu_assert(_FL "replays should count once", d_cache->reads == 1 && d_cache->read_misses == 1);
+    mu_assert(_FL "first touch is compulsory", d_cache->compulsory_misses == 1);
+    digest(d_cache->block_size * CACHE_MISS_SUBSEQUENT_PENALTY);
+    mu_assert(_FL "same block should hit", read_until_hit(neighbour, &read, 0x44) == 0);
+    mu_assert(_FL "hit not counted", d_cache->reads == 2 && d_cache->read_hits == 1);
+    mu_assert(_FL "conflicting load never hit", read_until_hit(conflict, &read, 0x48) < 100);
+    mu_assert(_FL "replaced block not counted", d_cache->evictions == 1);
+    mu_assert(_FL "first load never hit again", read_until_hit(address, &read, 0x40) < 100);
+    mu_assert(_FL "fully associative cache would hit", d_cache->conflict_misses == 1);
+    // Touch more blocks than the cache holds, the first one falls out of the shadow
+    for(uint32_t i = 0; i <= d_cache->num_blocks; i++){
+        mu_assert(_FL "sweep load never hit", read_until_hit(0x400 + i * 0x10, &read, 0x4c) < 100);
+    }
+    mu_assert(_FL "sweep should be compulsory", d_cache->compulsory_misses == 3 + d_cache->num_blocks);
+    mu_assert(_FL "swept block never hit", read_until_hit(0x400, &read, 0x4c) < 100);
+    mu_assert(_FL "fully associative cache would miss", d_cache->capacity_misses == 1);
+    // The registry sees the same counters
+    const stat_t *stat = stats_find("dcache", "reads");
+    mu_assert(_FL "reads not registered", stat != NULL && *stat->value == d_cache->reads);
+    mu_assert(_FL "bus not registered", stats_find("bus", "reading_d") != NULL);
+    mu_assert(_FL "bus never read", *stats_find("bus", "reading_d")->value > 0);
+    cache_destroy();
+    mu_assert(_FL "counters should go with the cache", stats_count() == 0);
+    mem_close();
+    cache_config.classify = false;
+    return 0;
+}
+
+// State of the block holding address in the selected core's data cache
+static coherence_state_t state_of(uint32_t address){
+    cache_access_t info;
+    direct_cache_get_tag_and_index(&info, d_cache, &address);
+    direct_cache_block_t *block = &d_cache->blocks[info.index];
+    return block->tag == info.tag ? block->state : COH_INVALID;
+}
+
+static char * test_coherence(){
+    uint32_t address = 0x100;
+    word_t read = 0, data = 0xdeadbeef;
+    int cycles = 0;
+    mem_setup();
+    cache_config.cores = 2;
+    cache_config.coherence = CACHE_MESI;
+    cache_init(&cache_config);
+    // Nobody else has it, MESI loads it exclusive
+    cache_select(0);
+    mu_assert(_FL "core 0 load never hit", read_until_hit(address, &read, 0x40) < 100);
+    mu_assert(_FL "lone copy should be exclusive", state_of(address) == COH_EXCLUSIVE);
+    // A second reader makes both copies shared
+    cache_select(1);
+    mu_assert(_FL "core 1 load never hit", read_until_hit(address, &read, 0x40) < 100);
+    mu_assert(_FL "core 1 copy should be shared", state_of(address) == COH_SHARED);
+    cache_select(0);
+    mu_assert(_FL "core 0 copy should be downgraded", state_of(address) == COH_SHARED);
+    // A store invalidates the other copy
+    cache_select(1);
+    while(d_cache_write_w(&address, &data, 0xffffffff, 0x44) != CACHE_HIT && cycles++ < 100){
+        cache_digest();
+    }
+    mu_assert(_FL "store never hit", cycles < 100);
+    mu_assert(_FL "stored copy should be modified", state_of(address) == COH_MODIFIED);
+    mu_assert(_FL "store should upgrade", *stats_find("coherence", "upgrades")->value == 1);
+    cache_select(0);
+    mu_assert(_FL "core 0 copy should be invalidated", state_of(address) == COH_INVALID);
+    // Reading it back gets the modified data from core 1
+    mu_assert(_FL "core 0 reload never hit", read_until_hit(address, &read, 0x48) < 100);
+    mu_assert(_FL "core 0 read stale data", read == data);
+    mu_assert(_FL "modified copy should be written back", *stats_find("coherence", "interventions")->value == 1);
+    cache_select(1);
+    mu_assert(_FL "core 1 copy should be shared again", state_of(address) == COH_SHARED);
+    cache_select(0);
+    cache_destroy();
+    cache_config.cores = 1;
+    mem_close();
+    return 0;
+}
+
+static char * all_tests() {
+    mu_run_test(test_blocking_miss);
+    mu_run_test(test_miss_under_miss);
+    mu_run_test(test_store_under_miss);
+    mu_run_test(test_same_store_under_miss);
+    mu_run_test(test_dirty_eviction);
+    mu_run_test(test_nextline_prefetch);
+    mu_run_test(test_stride_prefetch);
+    mu_run_test(test_stream_buffer);
+    mu_run_test(test_victim_cache);
+    mu_run_test(test_cache_stats);
+    mu_run_test(test_coherence);
     return 0;
 }
 
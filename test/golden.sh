@@ -0,0 +1,94 @@
+#!/bin/sh
+# test/golden.sh
+# Cycle count regression, run by make test and make golden. Runs every
+# program below in every configuration below and compares the cycle count,
+# the CPI stack, cache hits and misses and branch mispredictions with the
+# numbers checked in to test/golden.txt. Any difference fails, so a change
+# to simulated timing never goes unnoticed. When the change is meant to
+# alter timing, regenerate the numbers with make golden-update (or
+# test/golden.sh update) and check them in along with it.
+#
+# The .s listings disassembly.s, disjoint.s, handcoded.s and sample.s are
+# only parser input and don't run.
+
+SIM=${SIM:-./sim}
+GOLDEN=test/golden.txt
+
+PROGRAMS="asm/program1file.txt
+asm/program2file.txt
+asm/handcoded.txt
+asm/test-jal.txt
+asm/test-lui.txt
+asm/test-many.txt
+asm/test-mov_.txt
+asm/test-seb.txt
+asm/test-seh.txt
+asm/llsc.s
+asm/bench-list.s
+asm/bench-matmul.s
+asm/bench-memcpy.s
+asm/bench-recurse.s
+asm/bench-sort.s"
+
+# name and options of every configuration
+CONFIGS="default:
+nocache:-c d
+dcache:-D e -H back -N 4
+small:-D e -E 64 -F 2 -N 2
+thru:-D e -H thru -F 1
+prefetch:-D e -H back -P stride -X 4 -Q next
+gshare:-b gshare -D e -H back
+tournament:-b tournament -e 1024 -D e
+width2:-w 2 -D e -H back
+ooo:-o -D e -H back
+decoupled:-f -D e -H back -N 4
+cores2:-n 2 -D e -H back"
+
+# Counters compared, as printed by --stats
+METRICS='^  (sim\.cycles|cpi\.[a-z_]+|[di]cache\.(read|write)_(hits|misses)|bpu\.mispredicts) '
+
+run() {
+    for program in $PROGRAMS; do
+        case $program in
+            *.txt) format=-a ;;
+            *) format= ;;
+        esac
+        while IFS=: read -r config options; do
+            if ! out=$($SIM -s $format $options "$program" 2>&1); then
+                echo "$program $config failed"
+                continue
+            fi
+            echo "$out" | grep -E "$METRICS" | awk -v p="$program" -v c="$config" '{ print p, c, $1, $2 }'
+        done <<END
+$CONFIGS
+END
+    done
+}
+
+if [ "$1" = "update" ]; then
+    run > $GOLDEN
+    echo "golden: wrote $(wc -l < $GOLDEN) numbers to $GOLDEN"
+    exit 0
+fi
+
+if [ ! -r $GOLDEN ]; then
+    echo "golden: no $GOLDEN, make golden-update writes it" >&2
+    exit 2
+fi
+run > $GOLDEN.now
+# program config metric golden now, for every number that changed
+if ! cmp -s $GOLDEN $GOLDEN.now; then
+    echo "golden: simulated timing changed"
+    awk 'NR == FNR { golden[$1 " " $2 " " $3] = $4; next }
+        { key = $1 " " $2 " " $3; seen[key] = 1
+          if (!(key in golden)) printf "\t%-24s %-10s %-24s new: %s\n", $1, $2, $3, $0
+          else if (golden[key] != $4) printf "\t%-24s %-10s %-24s %10s -> %s\n", $1, $2, $3, golden[key], $4 }
+        END { for (key in golden) if (!(key in seen)) { split(key, k); printf "\t%-24s %-10s %-24s gone\n", k[1], k[2], k[3] } }' \
+        $GOLDEN $GOLDEN.now
+    echo "golden: if the change is intended, make golden-update and check in $GOLDEN"
+    rm -f $GOLDEN.now
+    exit 1
+fi
+rm -f $GOLDEN.now
+echo "golden: $(wc -l < $GOLDEN) numbers match"
+exit 0
@@ -175,9 +175,64 @@ static char * test_mem_small_load() {
     return 0;
 }
 
+static char * test_mem_watchpoints() {
+    // Loads and stores of watched words stop the run, others don't
+    watch_hit_t hit;
+    size = 0x140;
+    offs = 0x80;
+    mem_init(size,offs);
+    control_t *exmem = (control_t *)calloc(1, sizeof(control_t));
+    control_t *memwb = (control_t *)calloc(1, sizeof(control_t));
+    mu_assert(_FL "outside memory", !watch_add(0x40, WATCH_WRITE));
+    mu_assert(_FL "bad watch", watch_add(0x90, WATCH_WRITE) && watch_add(0x94, WATCH_READ));
+    mu_assert(_FL "watching should set the flag", (flags & MASK_WATCHPOINTS) && watch_get_active() == 2);
+    exmem->opCode = OPC_SW; // store word to a word watched for loads
+    exmem->memWrite = true;
+    exmem->ALUresult = 0x94;
+    exmem->regRtValue = 0x12345678;
+    exmem->pc = 0x100;
+    memory(exmem, memwb, &cache_config);
+    mu_assert(_FL "a store shouldn't hit a read watchpoint", !watch_hit(&hit));
+    exmem->opCode = OPC_SB; // store byte into a watched word
+    exmem->ALUresult = 0x92;
+    exmem->regRtValue = 0xab;
+    exmem->pc = 0x104;
+    memory(exmem, memwb, &cache_config);
+    mu_assert(_FL "a byte store should hit the word", watch_hit(&hit));
+    mu_assert(_FL "bad hit", hit.write && hit.address == 0x92 && hit.pc == 0x104 && hit.value == 0xab);
+    mu_assert(_FL "a hit is handed over once", !watch_hit(&hit));
+    exmem->opCode = OPC_LW; // load the word watched for loads
+    exmem->memWrite = false;
+    exmem->memRead = true;
+    exmem->ALUresult = 0x94;
+    exmem->pc = 0x108;
+    memory(exmem, memwb, &cache_config);
+    mu_assert(_FL "bad load hit", watch_hit(&hit) && !hit.write && hit.value == 0x12345678 && hit.pc == 0x108);
+    mu_assert(_FL "bad delete", watch_delete(0x94) && !watch_delete(0x94));
+    memory(exmem, memwb, &cache_config);
+    mu_assert(_FL "a cleared watchpoint shouldn't hit", !watch_hit(&hit));
+    mu_assert(_FL "bad delete", watch_delete(0x90) && !(flags & MASK_WATCHPOINTS));
+
+    // Breakpoints have no limit
+    for (addr = 0x80; addr < 0x80 + size; addr += 4) {
+        mu_assert(_FL "bad breakpoint", breakpoint_add(addr));
+    }
+    mu_assert(_FL "every word should have one", breakpoint_get_active() == size / 4 && breakpoint_at(0x1bc) && !breakpoint_add(0x1bc));
+    mu_assert(_FL "outside memory", !breakpoint_at(0x1c0) && !breakpoint_add(0x1c0));
+    mu_assert(_FL "bad delete", breakpoint_delete(0x100) && !breakpoint_at(0x100) && breakpoint_at(0x104));
+    breakpoint_free();
+    mu_assert(_FL "freeing should clear everything", !breakpoint_at(0x104) && !(flags & MASK_BREAKPOINTS));
+
+    mem_close();
+    free(exmem);
+    free(memwb);
+    return 0;
+}
+
 static char * all_tests() {
     mu_run_test(test_mem_small_store);
     mu_run_test(test_mem_small_load);
+    mu_run_test(test_mem_watchpoints);
     return 0;
 }
 
@@ -0,0 +1,133 @@
+/* test/micro-bench.c
+* Times the hot primitives of the simulator in isolation, see microbench.h
+*/
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "microbench.h"
+#include "../src/alu.h"
+#include "../src/cache.h"
+#include "../src/decode.h"
+#include "../src/direct.h"
+#include "../src/fetch.h"
+#include "../src/main_memory.h"
+#include "../src/registers.h"
+#include "../src/types.h"
+#include "../src/util.h"
+
+int flags = 0;
+
+extern _Thread_local direct_cache_t *d_cache;
+
+cache_config_t cache_config = {
+    .mode           = CACHE_SPLIT,
+    .data_enabled   = true,
+    .data_size      = 256,
+    .data_block     = 4,
+    .data_type      = CACHE_DIRECT,
+    .data_wpolicy   = CACHE_WRITEBACK,
+    .data_mshrs     = 1,
+    .data_prefetch  = CACHE_PREFETCH_NONE,
+    .data_victim    = 0,
+    .inst_enabled   = false,
+    .inst_size      = 256,
+    .inst_block     = 4,
+    .inst_type      = CACHE_DIRECT,
+    .inst_wpolicy   = CACHE_WRITETHROUGH,
+    .inst_prefetch  = CACHE_PREFETCH_NONE,
+    .inst_victim    = 0,
+    .size           = 1024,
+    .block          = 4,
+    .type           = CACHE_DIRECT,
+    .wpolicy        = CACHE_WRITETHROUGH,
+};
+
+#define MEM_BYTES   (1<<16)
+#define BATCH       64
+
+// A mix of what decode() and alu() see in the test programs
+static const inst_t instructions[16] = {
+    0x8c430000, // lw $v1 0($v0)
+    0xaca30000, // sw $v1 0($a1)
+    0x24420004, // addiu $v0 $v0 4
+    0x1444fffc, // bne $v0 $a0 -4
+    0x00862021, // addu $a0 $a0 $a2
+    0x00063080, // sll $a2 $a2 2
+    0x18c00008, // blez $a2 8
+    0x03e00008, // jr $ra
+    0x0c100006, // jal 0x400018
+    0x3c1c0040, // lui $gp 0x40
+    0x00a41025, // or $v0 $a1 $a0
+    0x0085102a, // slt $v0 $a0 $a1
+    0x90a20000, // lbu $v0 0($a1)
+    0xa0a20000, // sb $v0 0($a1)
+    0x30420fff, // andi $v0 $v0 0xfff
+    0x00000000  // nop
+};
+
+static const operation_t operations[8] = {
+    OPR_ADDU, OPR_SUBU, OPR_AND, OPR_OR, OPR_XOR, OPR_SLT, OPR_SLL, OPR_SRL
+};
+
+static volatile word_t sink;
+
+int main(void) {
+    control_t *ifid, *idex, *exmem, *memwb;
+    control_t fetched[16];
+    pc_t pc;
+    word_t data = 0;
+    bool zero;
+    uint32_t address = 0, misses = 0, samples = 0;
+    cache_access_t info;
+
+    reg_init();
+    mem_init(MEM_BYTES, 0);
+    for (uint32_t i = 0; i < MEM_BYTES; i += 4) {
+        mem_write_w(i, &i);
+    }
+    pipeline_init(&ifid, &idex, &exmem, &memwb, &pc, 0);
+    for (int i = 0; i < 16; ++i) {
+        flush(&fetched[i]);
+        fetched[i].instr = instructions[i];
+        fetched[i].pc = i << 2;
+        fetched[i].pcNext = (i + 1) << 2;
+        fetch_fields(&fetched[i]);
+    }
+    cache_init(&cache_config);
+
+    mb_calibrate();
+
+    mb_bench("copy_pipeline_register", BATCH, , copy_pipeline_register(ifid, idex));
+    mb_bench("decode", BATCH, , decode(&fetched[mb_i & 15], idex));
+    mb_bench("alu", BATCH, , alu(operations[mb_i & 7], mb_i, 0x1234, mb_i & 31, &data, &zero));
+    mb_bench("mem_read_b", BATCH, , mem_read_b(mb_i * 13, &data); sink = data);
+    mb_bench("mem_read_h", BATCH, , mem_read_h((mb_i * 26) & ~1u, &data); sink = data);
+    mb_bench("mem_read_w", BATCH, , mem_read_w((mb_i * 52) & ~3u, &data); sink = data);
+    mb_bench("direct_cache_get_tag_and_index", BATCH, ,
+        address = mb_i * 52; direct_cache_get_tag_and_index(&info, d_cache, &address));
+
+    // Hits: the first blocks are brought in once and stay
+    for (uint32_t a = 0; a < BATCH * 4; a += 4) {
+        direct_cache_read_w(d_cache, &a, &data, 0);
+        direct_cache_flush(d_cache);
+    }
+    mb_bench("direct_cache_read_w (hit)", BATCH, ,
+        address = mb_i << 2; direct_cache_read_w(d_cache, &address, &data, 0); sink = data);
+
+    // Misses: every access replaces the block of the one before it, the fill
+    // is completed outside of the timed region
+    address = 0;
+    mb_bench("direct_cache_read_w (miss)", 1,
+        direct_cache_flush(d_cache); address = (address + (cache_config.data_size << 2)) % MEM_BYTES; ++samples,
+        misses += direct_cache_read_w(d_cache, &address, &data, 0) == CACHE_MISS);
+    if (misses != samples) {
+        cprintf(ANSI_C_YELLOW, "Only %d of %d accesses of the miss path missed\n", misses, samples);
+    }
+
+    cache_destroy();
+    pipeline_destroy(&ifid, &idex, &exmem, &memwb);
+    mem_close();
+    return 0;
+}
@@ -0,0 +1,100 @@
+/* test/microbench.h
+ * The simplest microbenchmark harness, in the spirit of minunit.h
+ * Each sample runs an untimed setup, then times a batch of calls to the body
+ * with the time stamp counter (rdtsc, fenced on both sides so nothing moves
+ * in or out of the timed region). Warmup samples are thrown away, the cost of
+ * reading the counter is taken off, and the per call cost is reported as the
+ * minimum, median, mean, standard deviation and 95th percentile of the samples.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define MB_UNIT "cycles"
+static inline uint64_t mb_ticks(void) {
+    _mm_lfence();
+    uint64_t ticks = __rdtsc();
+    _mm_lfence();
+    return ticks;
+}
+#else
+// No time stamp counter, nanoseconds instead
+#define MB_UNIT "ns"
+static inline uint64_t mb_ticks(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + now.tv_nsec;
+}
+#endif
+
+#define MB_WARMUP   200     // samples run first and thrown away
+#define MB_SAMPLES  2000    // samples kept
+
+static uint64_t mb_samples[MB_SAMPLES];
+static double mb_overhead = 0;      // ticks to read the counter twice
+static double mb_ticks_per_ns = 1;
+
+// Times MB_SAMPLES samples of batch calls to body, mb_i counts the calls of
+// a batch. setup and body are statements, e.g. mb_bench("x", 8, , f(mb_i));
+#define mb_bench(name, batch, setup, body) do { \
+    for (int mb_s = -MB_WARMUP; mb_s < MB_SAMPLES; ++mb_s) { \
+        setup; \
+        uint64_t mb_start = mb_ticks(); \
+        for (uint32_t mb_i = 0; mb_i < (uint32_t)(batch); ++mb_i) { body; } \
+        uint64_t mb_end = mb_ticks(); \
+        if (mb_s >= 0) mb_samples[mb_s] = mb_end - mb_start; \
+    } \
+    mb_report(name, batch); \
+} while (0)
+
+static int mb_compare(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Measures the overhead of an empty sample and how fast the counter runs
+static void mb_calibrate(void) {
+    for (int s = 0; s < MB_SAMPLES; ++s) {
+        uint64_t start = mb_ticks();
+        mb_samples[s] = mb_ticks() - start;
+    }
+    qsort(mb_samples, MB_SAMPLES, sizeof(uint64_t), mb_compare);
+    mb_overhead = (double)mb_samples[0];
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint64_t ticks = mb_ticks();
+    do {
+        clock_gettime(CLOCK_MONOTONIC, &end);
+    } while ((end.tv_sec - start.tv_sec) * 1000000000 + (end.tv_nsec - start.tv_nsec) < 50000000);
+    ticks = mb_ticks() - ticks;
+    mb_ticks_per_ns = (double)ticks / ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec));
+    printf("Counter: %.3f %s/ns, %.0f %s to read it twice (taken off every sample)\n",
+        mb_ticks_per_ns, MB_UNIT, mb_overhead, MB_UNIT);
+    printf("%-36s %8s %8s %8s %8s %8s %8s\n", "per call (" MB_UNIT ")", "min", "median", "mean", "stddev", "p95", "ns");
+}
+
+static void mb_report(const char *name, uint32_t batch) {
+    double per[MB_SAMPLES];
+    double mean = 0, var = 0;
+    qsort(mb_samples, MB_SAMPLES, sizeof(uint64_t), mb_compare);
+    for (int s = 0; s < MB_SAMPLES; ++s) {
+        per[s] = ((double)mb_samples[s] - mb_overhead) / batch;
+        if (per[s] < 0) per[s] = 0;
+        mean += per[s];
+    }
+    mean /= MB_SAMPLES;
+    for (int s = 0; s < MB_SAMPLES; ++s) {
+        var += (per[s] - mean) * (per[s] - mean);
+    }
+    var /= MB_SAMPLES - 1;
+    double median = per[MB_SAMPLES / 2];
+    // Square root by Newton's method, so there is no need for -lm
+    double stddev = var;
+    for (int i = 0; i < 32 && stddev > 0; ++i) stddev = (stddev + var / stddev) / 2;
+    printf("%-36s %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f\n", name,
+        per[0], median, mean, stddev, per[(MB_SAMPLES * 95) / 100], median / mb_ticks_per_ns);
+}
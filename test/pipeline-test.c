@@ -9,6 +9,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include "minunit.h"
 #include "../src/alu.h"
 #include "../src/decode.h"
@@ -20,6 +25,18 @@
 #include "../src/types.h"
 #include "../src/util.h"
 #include "../src/hazard.h"
+#include "../src/profile.h"
+#include "../src/cpi.h"
+#include "../src/pipetrace.h"
+#include "../src/interval.h"
+#include "../src/live.h"
+#include "../src/branch.h"
+#include "../src/issue.h"
+#include "../src/ooo.h"
+#include "../src/multicore.h"
+#include "../src/decoupled.h"
+#include "../src/checker.h"
+#include "../src/stats.h"
 
 int tests_run = 0;
 
@@ -241,7 +258,648 @@ static char * test_load_dependency(){
     return 0;
 }
 
+static char * test_profile_load_use(){
+    //Same program as test_load_dependency, add $s4 needs the second lw
+    reg_init();
+    pipeline_init(&ifid, &idex, &exmem, &memwb, &pc, 0);
+    profile_init();
+    pc = 0x00000000;
+    for(clock = 0; clock <= 13; clock++){
+        execute_pipeline();
+        profile_cycle(ifid->pc);
+    }
+    const profile_entry_t *load = profile_get(0x1c);
+    mu_assert(_FL "lw $s3 should get the load-use bubble", load->load_use == 1);
+    mu_assert(_FL "lw $s3 should be charged its own cycle too", load->cycles == 2 && load->fetched == 1);
+    mu_assert(_FL "lw $s2 has no dependent", profile_get(0x18)->load_use == 0);
+    uint32_t total = 0;
+    for(pc_t i = 0; i < 0x40; i += 4){
+        total += profile_get(i)->cycles;
+    }
+    mu_assert(_FL "every cycle should be charged once", total == 14);
+    profile_free();
+    pipeline_destroy(&ifid, &idex, &exmem, &memwb);
+    return 0;
+}
+static char * test_cpi_stack(){
+    //Same program as test_load_dependency, one load-use bubble
+    reg_init();
+    pipeline_init(&ifid, &idex, &exmem, &memwb, &pc, 0);
+    cpi_init(0);
+    pc = 0x00000000;
+    for(clock = 0; clock <= 13; clock++){
+        execute_pipeline();
+        cpi_cycle();
+    }
+    const cpi_stack_t *stack = cpi_get();
+    mu_assert(_FL "one load-use bubble expected", stack->cycles[CPI_LOAD_USE] == 1);
+    mu_assert(_FL "caches are disabled", stack->cycles[CPI_I_MISS] == 0 && stack->cycles[CPI_D_MISS] == 0);
+    uint32_t total = 0;
+    for(int i = 0; i < CPI_BUCKETS; i++){
+        total += stack->cycles[i];
+    }
+    mu_assert(_FL "every cycle should land in one bucket", total == 14);
+    cpi_free();
+    pipeline_destroy(&ifid, &idex, &exmem, &memwb);
+    return 0;
+}
+
+static char * test_pipetrace_load_use(){
+    //Same program as test_load_dependency, add $s4 is fetched behind lw $s3,
+    //flushed and fetched again
+    char path[] = "/tmp/pipetrace-test-XXXXXX";
+    int fd = mkstemp(path);
+    mu_assert(_FL "unable to make a temporary file", fd >= 0);
+    close(fd);
+    reg_init();
+    pipeline_init(&ifid, &idex, &exmem, &memwb, &pc, 0);
+    pc = 0x00000000;
+    mu_assert(_FL "unable to open the trace", pipetrace_open(path, pc));
+    for(clock = 0; clock <= 13; clock++){
+        execute_pipeline();
+        pipetrace_cycle(ifid, idex, exmem, memwb, pc);
+    }
+    pipetrace_close();
+    //Follows every instruction through the log
+    char line[128], stage[8];
+    uint32_t id, lane, retire, type, address, cycles = 0;
+    uint32_t stages[16] = {0}, label[16] = {0}, entered_wb[16] = {0};
+    uint32_t retired = 0, flushed = 0, load_use = 0, instructions = 0;
+    FILE *fp = fopen(path, "r");
+    mu_assert(_FL "unable to read the trace back", fp != NULL);
+    while(fgets(line, sizeof(line), fp) != NULL){
+        if(sscanf(line, "C\t%u", &lane) == 1){
+            cycles += lane;
+        } else if(sscanf(line, "I\t%u", &id) == 1){
+            mu_assert(_FL "instructions should be numbered in order", id == instructions++);
+        } else if(sscanf(line, "S\t%u\t%u\t%7s", &id, &lane, stage) == 3){
+            stages[id]++;
+            if(!strcmp(stage, "WB")) entered_wb[id] = cycles;
+        } else if(sscanf(line, "L\t%u\t0\t%x", &id, &address) == 2){
+            label[id] = address;
+        } else if(strstr(line, "load_use stall") != NULL){
+            sscanf(line, "L\t%u", &id);
+            mu_assert(_FL "the bubble should be put on lw $s3", label[id] == 0x1c);
+            load_use++;
+        } else if(sscanf(line, "R\t%u\t%u\t%u", &id, &retire, &type) == 3){
+            if(type){
+                mu_assert(_FL "only add $s4 should be flushed", label[id] == 0x20 && stages[id] == 1);
+                flushed++;
+            } else {
+                mu_assert(_FL "retired out of order", retire == retired++);
+                mu_assert(_FL "every stage should be entered once", stages[id] == TRACE_STAGES);
+            }
+        }
+    }
+    fclose(fp);
+    remove(path);
+    mu_assert(_FL "one load-use bubble expected", load_use == 1 && flushed == 1);
+    mu_assert(_FL "the program and add $s4 should be written back", retired == 9 && entered_wb[9] == 13);
+    mu_assert(_FL "every cycle should be in the log", cycles == 14);
+    pipeline_destroy(&ifid, &idex, &exmem, &memwb);
+    return 0;
+}
+
+static char * test_stats_interval(){
+    //Same program as test_load_dependency, a row every 5 cycles
+    char path[] = "/tmp/interval-test-XXXXXX";
+    int fd = mkstemp(path);
+    mu_assert(_FL "unable to make a temporary file", fd >= 0);
+    close(fd);
+    reg_init();
+    pipeline_init(&ifid, &idex, &exmem, &memwb, &pc, 0);
+    cpi_init(0);
+    mu_assert(_FL "unable to open the interval file", interval_open(path, 5));
+    pc = 0x00000000;
+    for(clock = 0; clock <= 13; clock++){
+        execute_pipeline();
+        cpi_cycle();
+        interval_cycle(clock + 1);
+    }
+    interval_close(14);
+    char line[256];
+    uint32_t cycle, cycles, instructions, load_use, rows = 0, total_cycles = 0, total_instructions = 0, total_load_use = 0;
+    FILE *fp = fopen(path, "r");
+    mu_assert(_FL "unable to read the interval file back", fp != NULL);
+    mu_assert(_FL "a CSV file starts with its header", fgets(line, sizeof(line), fp) != NULL && !strncmp(line, "cycle,cycles,instructions,ipc,", 30));
+    while(fgets(line, sizeof(line), fp) != NULL){
+        //The caches and the branch predictor are off, their columns are empty
+        mu_assert(_FL "wrong row", sscanf(line, "%u,%u,%u,%*[0-9.],,,,,%*u,%u", &cycle, &cycles, &instructions, &load_use) == 4);
+        mu_assert(_FL "rows should end every 5 cycles and at halt", cycle == (rows < 2 ? 5 * (rows + 1) : 14));
+        rows++;
+        total_cycles += cycles;
+        total_instructions += instructions;
+        total_load_use += load_use;
+    }
+    fclose(fp);
+    remove(path);
+    const cpi_stack_t *stack = cpi_get();
+    mu_assert(_FL "three rows expected", rows == 3 && total_cycles == 14);
+    mu_assert(_FL "the rows should add up to the run", total_instructions == stack->cycles[CPI_BASE] && total_load_use == 1);
+    cpi_free();
+    pipeline_destroy(&ifid, &idex, &exmem, &memwb);
+    return 0;
+}
 
+static char * test_live_stats(){
+    //Same program as test_load_dependency, a snapshot every 5 cycles read
+    //back through the segment as simtop does
+    char name[32];
+    snprintf(name, sizeof(name), "/live-test-%d", (int)getpid());
+    reg_init();
+    pipeline_init(&ifid, &idex, &exmem, &memwb, &pc, 0);
+    cpi_init(0);
+    mu_assert(_FL "unable to create the segment", live_open(name, 5));
+    int fd = shm_open(name, O_RDONLY, 0);
+    mu_assert(_FL "unable to open the segment", fd >= 0);
+    const live_segment_t *segment = mmap(NULL, sizeof(live_segment_t), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    mu_assert(_FL "unable to map the segment", segment != MAP_FAILED);
+    mu_assert(_FL "wrong segment header", segment->magic == LIVE_MAGIC && segment->version == LIVE_VERSION && segment->pid == getpid());
+    live_snapshot_t snapshot;
+    pc = 0x00000000;
+    for(clock = 0; clock <= 13; clock++){
+        execute_pipeline();
+        cpi_cycle();
+        live_cycle(clock + 1, pc);
+        live_read(segment, &snapshot);
+        //Published only when an interval ends
+        mu_assert(_FL "a snapshot every 5 cycles", snapshot.cycles == (clock + 1) / 5 * 5 && !snapshot.halted);
+    }
+    live_close(14, pc);
+    live_read(segment, &snapshot);
+    const cpi_stack_t *stack = cpi_get();
+    mu_assert(_FL "the last snapshot is the halt", snapshot.cycles == 14 && snapshot.halted && snapshot.pc == pc);
+    mu_assert(_FL "the caches are off", (snapshot.present >> LIVE_CPI_BASE) & 1 && !((snapshot.present >> LIVE_D_READS) & 1));
+    mu_assert(_FL "wrong counters", snapshot.counters[LIVE_INSTRUCTIONS] == stack->cycles[CPI_BASE] && snapshot.counters[LIVE_CPI_LOAD_USE] == 1);
+    mu_assert(_FL "the segment should be gone", shm_open(name, O_RDONLY, 0) < 0 && errno == ENOENT);
+    munmap((void *)segment, sizeof(live_segment_t));
+    cpi_free();
+    pipeline_destroy(&ifid, &idex, &exmem, &memwb);
+    return 0;
+}
+
+static char * test_bpu_loop(){
+    //Counts $s1 down from 3, the bne is taken twice then falls through
+    reg_init();
+    pipeline_init(&ifid, &idex, &exmem, &memwb, &pc, 0);
+    cpu_config_t cpu_config = {
+        .bp_type        = BP_BIMODAL,
+        .bp_entries     = 16,
+        .btb_entries    = 4,
+    };
+    bpu_init(&cpu_config);
+    cpi_init(0);
+    pc = 0x00000000;
+    word_t data = 0x20110003;       //addi $s1, $zero, 3
+    mem_write_w(pc, &data);
+    data = 0x22520001;              //addi $s2, $s2, 1
+    mem_write_w(pc+4, &data);
+    data = 0x2231ffff;              //addi $s1, $s1, -1
+    mem_write_w(pc+8, &data);
+    data = 0x1620fffd;              //bne $s1, $zero, -3
+    mem_write_w(pc+12, &data);
+    data = 0x00000000;              //nop (delay slot)
+    mem_write_w(pc+16, &data);
+    data = 0x20080007;              //addi $t0, $zero, 7
+    mem_write_w(pc+20, &data);
+    data = 0x00000000;              //nop
+    for(pc_t i = 24; i < 0x40; i += 4){
+        mem_write_w(i, &data);
+    }
+    for(clock = 0; clock < 24; clock++){
+        execute_pipeline();
+        cpi_cycle();
+    }
+    reg_read(REG_S2, &data);
+    mu_assert(_FL "loop body should run three times", data == 3);
+    reg_read(REG_T0, &data);
+    mu_assert(_FL "instruction after the loop should run once", data == 7);
+    mu_assert(_FL "three branches expected", *stats_find("bpu", "branches")->value == 3);
+    mu_assert(_FL "two taken expected", *stats_find("bpu", "taken")->value == 2);
+    //First taken misses the BTB, the fall through is predicted taken
+    mu_assert(_FL "two mispredictions expected", *stats_find("bpu", "mispredicts")->value == 2);
+    mu_assert(_FL "one BTB miss expected", *stats_find("bpu", "btb_misses")->value == 1);
+    mu_assert(_FL "each misprediction should cost a control cycle", cpi_get()->cycles[CPI_CONTROL] == 2);
+    cpi_free();
+    bpu_free();
+    pipeline_destroy(&ifid, &idex, &exmem, &memwb);
+    return 0;
+}
+
+static char * test_bpu_return(){
+    //A call and return, the jr $ra target comes from the return address stack
+    reg_init();
+    pipeline_init(&ifid, &idex, &exmem, &memwb, &pc, 0);
+    cpu_config_t cpu_config = {
+        .bp_type        = BP_BIMODAL,
+        .bp_entries     = 16,
+        .btb_entries    = 4,
+        .ras_depth      = 2,
+    };
+    bpu_init(&cpu_config);
+    pc = 0x00000000;
+    word_t data = 0x0c000004;       //jal 0x10
+    mem_write_w(pc, &data);
+    data = 0x00000000;              //nop (delay slot, and where $ra points)
+    mem_write_w(pc+4, &data);
+    data = 0x20080007;              //addi $t0, $zero, 7
+    mem_write_w(pc+8, &data);
+    data = 0x1000ffff;              //beq $zero, $zero, -1
+    mem_write_w(pc+12, &data);
+    data = 0x20120005;              //addi $s2, $zero, 5
+    mem_write_w(pc+16, &data);
+    data = 0x03e00008;              //jr $ra
+    mem_write_w(pc+20, &data);
+    data = 0x00000000;              //nop (delay slot)
+    for(pc_t i = 24; i < 0x40; i += 4){
+        mem_write_w(i, &data);
+    }
+    for(clock = 0; clock < 14; clock++){
+        execute_pipeline();
+    }
+    reg_read(REG_S2, &data);
+    mu_assert(_FL "function body should run", data == 5);
+    reg_read(REG_T0, &data);
+    mu_assert(_FL "instruction after the return should run", data == 7);
+    mu_assert(_FL "one call expected", *stats_find("bpu", "calls")->value == 1);
+    mu_assert(_FL "return should be predicted by the stack", *stats_find("bpu", "returns")->value == 1);
+    mu_assert(_FL "return should go where the stack said", *stats_find("bpu", "ras_mispredicts")->value == 0);
+    mu_assert(_FL "stack never ran dry", *stats_find("bpu", "ras_underflows")->value == 0);
+    bpu_free();
+    pipeline_destroy(&ifid, &idex, &exmem, &memwb);
+    return 0;
+}
+
+static char * test_dual_issue(){
+    //Each addi needs the one before it, sub and srl can go together
+    reg_init();
+    pipeline_init(&ifid, &idex, &exmem, &memwb, &pc, 0);
+    issue_init(2, ifid, idex, exmem, memwb);
+    pc = 0x00000000;
+    word_t data = 0x20110064;       //addi $s1, $zero, 100
+    mem_write_w(pc, &data);
+    data = 0x2232ffdc;              //addi $s2, $s1, -36
+    mem_write_w(pc+4, &data);
+    data = 0x02324022;              //sub $t0, $s1, $s2
+    mem_write_w(pc+8, &data);
+    data = 0x001160c2;              //srl $t4, $s1, 3
+    mem_write_w(pc+12, &data);
+    data = 0x00000000;              //nop
+    for(pc_t i = 16; i < 0x40; i += 4){
+        mem_write_w(i, &data);
+    }
+    for(clock = 0; clock < 7; clock++){
+        issue_cycle(&pc, &cache_config);
+    }
+    reg_read(REG_S2, &data);
+    mu_assert(_FL "$S2 does not equal 64!", data == 64);
+    reg_read(REG_T0, &data);
+    mu_assert(_FL "$T0 does not equal 36!", data == 36);
+    reg_read(REG_T4, &data);
+    mu_assert(_FL "$T4 does not equal 12!", data == 12);
+    mu_assert(_FL "both addi groups should be cut", *stats_find("issue", "dependency")->value == 2);
+    mu_assert(_FL "sub and srl should issue together", *stats_find("issue", "full")->value == 5);
+    issue_free();
+    pipeline_destroy(&ifid, &idex, &exmem, &memwb);
+    return 0;
+}
+
+static char * test_ooo(){
+    //The load has to wait for the store, srl runs ahead of both
+    cpu_config_t cpu_config = {
+        .issue_width    = 2,
+        .ooo            = true,
+        .rob_entries    = 8,
+        .rs_entries     = 4,
+        .lsq_entries    = 2,
+    };
+    reg_init();
+    pipeline_init(&ifid, &idex, &exmem, &memwb, &pc, 0);
+    ooo_init(&cpu_config);
+    pc = 0x00000000;
+    word_t data = 0x20110064;       //addi $s1, $zero, 100
+    mem_write_w(pc, &data);
+    data = 0x20120040;              //addi $s2, $zero, 64
+    mem_write_w(pc+4, &data);
+    data = 0xae510000;              //sw $s1, 0($s2)
+    mem_write_w(pc+8, &data);
+    data = 0x8e530000;              //lw $s3, 0($s2)
+    mem_write_w(pc+12, &data);
+    data = 0x0271a020;              //add $s4, $s3, $s1
+    mem_write_w(pc+16, &data);
+    data = 0x001160c2;              //srl $t4, $s1, 3
+    mem_write_w(pc+20, &data);
+    data = 0x1000ffff;              //beq $zero, $zero, -1
+    mem_write_w(pc+24, &data);
+    for(clock = 0; clock < 50 && !ooo_halted(); clock++){
+        ooo_cycle(ifid, &pc, &cache_config);
+    }
+    mu_assert(_FL "out-of-order core did not halt!", ooo_halted());
+    reg_read(REG_S3, &data);
+    mu_assert(_FL "$S3 does not equal 100!", data == 100);
+    reg_read(REG_S4, &data);
+    mu_assert(_FL "$S4 does not equal 200!", data == 200);
+    reg_read(REG_T4, &data);
+    mu_assert(_FL "$T4 does not equal 12!", data == 12);
+    mu_assert(_FL "six instructions should commit", *stats_find("ooo", "committed")->value == 6);
+    ooo_free();
+    pipeline_destroy(&ifid, &idex, &exmem, &memwb);
+    return 0;
+}
+
+// Runs a taken beq on an out-of-order core with rob_entries entries. Returns
+// false if it does not halt.
+static bool run_ooo_branch(uint32_t rob_entries){
+    cpu_config_t cpu_config = {
+        .issue_width    = 1,
+        .ooo            = true,
+        .rob_entries    = rob_entries,
+        .rs_entries     = 4,
+        .lsq_entries    = 2,
+    };
+    word_t program[] = {
+        0x20110001,                 //addi $s1, $zero, 1
+        0x12310003,                 //beq $s1, $s1, 3
+        0x20120005,                 //addi $s2, $zero, 5
+        0x20130007,                 //addi $s3, $zero, 7
+        0x20130008,                 //addi $s3, $zero, 8
+        0x20140009,                 //addi $s4, $zero, 9
+        0x1000ffff                  //beq $zero, $zero, -1
+    };
+    reg_init();
+    pipeline_init(&ifid, &idex, &exmem, &memwb, &pc, 0);
+    ooo_init(&cpu_config);
+    pc = 0x00000000;
+    for(pc_t i = 0; i < sizeof(program) / sizeof(word_t); i++){
+        mem_write_w(i << 2, &program[i]);
+    }
+    for(clock = 0; clock < 50 && !ooo_halted(); clock++){
+        ooo_cycle(ifid, &pc, &cache_config);
+    }
+    bool halted = ooo_halted();
+    ooo_free();
+    pipeline_destroy(&ifid, &idex, &exmem, &memwb);
+    return halted;
+}
+
+static char * test_ooo_branch(){
+    //With one entry the delay slot reuses the branch's entry before fetch reads the target
+    for(uint32_t rob_entries = 1; rob_entries <= 2; rob_entries++){
+        word_t data;
+        mu_assert(_FL "out-of-order core did not halt!", run_ooo_branch(rob_entries));
+        reg_read(REG_S2, &data);
+        mu_assert(_FL "delay slot did not run: $S2 does not equal 5!", data == 5);
+        reg_read(REG_S3, &data);
+        mu_assert(_FL "branch was not taken: $S3 does not equal 0!", data == 0);
+        reg_read(REG_S4, &data);
+        mu_assert(_FL "$S4 does not equal 9!", data == 9);
+    }
+    return 0;
+}
+
+//Bumps the counter at 0x200 five times with ll/sc, then stores $k1 at 0x210 + 4 * $k0
+static const word_t LLSC_PROGRAM[] = {
+    0x24080005,                 //addiu $t0, $zero, 5
+    0xc0090200,                 //ll $t1, 0x200($zero)
+    0x25290001,                 //addiu $t1, $t1, 1
+    0xe0090200,                 //sc $t1, 0x200($zero)
+    0x1120fffc,                 //beq $t1, $zero, -4
+    0x00000000,                 //nop
+    0x2508ffff,                 //addiu $t0, $t0, -1
+    0x1500fff9,                 //bne $t0, $zero, -7
+    0x00000000,                 //nop
+    0x001a5080,                 //sll $t2, $k0, 2
+    0xad5b0210,                 //sw $k1, 0x210($t2)
+    0x00000000,                 //nop
+    0x00000000,                 //nop
+    0x00000000,                 //nop
+    0x1000ffff                  //beq $zero, $zero, -1
+};
+
+static char * test_multicore_llsc(){
+    //Two cores bump a shared counter five times each with ll/sc, then store $k1 at their $k0
+    cpu_config_t cpu_config = {
+        .cores          = 2,
+    };
+    reg_init();
+    pipeline_init(&ifid, &idex, &exmem, &memwb, &pc, 0);
+    pc = 0x00000000;
+    for(pc_t i = 0; i < sizeof(LLSC_PROGRAM) / sizeof(word_t); i++){
+        word_t word = LLSC_PROGRAM[i];
+        mem_write_w(i << 2, &word);
+    }
+    word_t data = 0;
+    mem_write_w(0x200, &data);
+    mem_write_w(0x210, &data);
+    mem_write_w(0x214, &data);
+    hazard_init();
+    multicore_init(&cpu_config, ifid, idex, exmem, memwb, &pc);
+    for(clock = 0; clock < 500 && !multicore_halted(); clock++){
+        multicore_cycle(&cache_config);
+    }
+    mu_assert(_FL "cores did not halt!", multicore_halted());
+    mem_read_w(0x200, &data);
+    mu_assert(_FL "counter does not equal 10!", data == 10);
+    mem_read_w(0x210, &data);
+    mu_assert(_FL "core 0 did not see two cores!", data == 2);
+    mem_read_w(0x214, &data);
+    mu_assert(_FL "core 1 did not see two cores!", data == 2);
+    reg_read(REG_K0, &data);
+    mu_assert(_FL "core 0 should own the main register file", data == 0);
+    multicore_free();
+    pipeline_destroy(&ifid, &idex, &exmem, &memwb);
+    return 0;
+}
+
+static char * test_multicore_quantum(){
+    //Four cores on two host threads bump the counter five times each, meeting every 16 cycles
+    cpu_config_t cpu_config = {
+        .cores          = 4,
+        .quantum        = 16,
+        .host_threads   = 2,
+    };
+    cache_config_t quantum_cache = cache_config;
+    quantum_cache.mode = CACHE_SPLIT;
+    quantum_cache.data_enabled = true;
+    quantum_cache.data_wpolicy = CACHE_WRITEBACK;
+    quantum_cache.data_mshrs = 1;
+    quantum_cache.inst_enabled = true;
+    quantum_cache.cores = 4;
+    quantum_cache.coherence = CACHE_MESI;
+    quantum_cache.quantum = 16;
+    reg_init();
+    //Away from 0, a core still waiting on its first fetch would look like it jumped there
+    pipeline_init(&ifid, &idex, &exmem, &memwb, &pc, 0x100);
+    pc = 0x00000100;
+    for(pc_t i = 0; i < sizeof(LLSC_PROGRAM) / sizeof(word_t); i++){
+        word_t word = LLSC_PROGRAM[i];
+        mem_write_w(0x100 + (i << 2), &word);
+    }
+    word_t data = 0;
+    for(uint32_t address = 0x200; address <= 0x21c; address += 4){
+        mem_write_w(address, &data);
+    }
+    cache_init(&quantum_cache);
+    multicore_init(&cpu_config, ifid, idex, exmem, memwb, &pc);
+    uint32_t cycles = 0;
+    for(clock = 0; clock < 200 && !multicore_halted(); clock++){
+        uint32_t ran = multicore_quantum(&quantum_cache);
+        mu_assert(_FL "a quantum ran more than 16 cycles", ran <= 16);
+        cycles += ran;
+    }
+    mu_assert(_FL "cores did not halt!", multicore_halted());
+    mu_assert(_FL "no cycles were run", cycles > 0);
+    cache_flush();
+    mem_read_w(0x200, &data);
+    mu_assert(_FL "counter does not equal 20!", data == 20);
+    for(uint32_t address = 0x210; address <= 0x21c; address += 4){
+        mem_read_w(address, &data);
+        mu_assert(_FL "a core did not see four cores!", data == 4);
+    }
+    reg_read(REG_K0, &data);
+    mu_assert(_FL "core 0 should own the main register file", data == 0);
+    multicore_free();
+    cache_destroy();
+    pipeline_destroy(&ifid, &idex, &exmem, &memwb);
+    return 0;
+}
+
+// Sums four words with a load-use in the loop, with caches and a predictor,
+// either on the pipeline or decoupled. Returns the cycles taken.
+static uint32_t run_sum(bool decoupled){
+    cpu_config_t cpu_config = {
+        .bp_type        = BP_BIMODAL,
+        .bp_entries     = 16,
+        .btb_entries    = 4,
+    };
+    cache_config_t sum_cache = cache_config;
+    sum_cache.mode = CACHE_SPLIT;
+    sum_cache.data_enabled = true;
+    sum_cache.data_wpolicy = CACHE_WRITEBACK;
+    sum_cache.data_mshrs = 1;
+    sum_cache.inst_enabled = true;
+    sum_cache.timing_only = decoupled;
+    word_t program[] = {
+        0x24080004,                 //addiu $t0, $zero, 4
+        0x240a0200,                 //addiu $t2, $zero, 0x200
+        0x8d4b0000,                 //lw $t3, 0($t2)
+        0x012b4821,                 //addu $t1, $t1, $t3
+        0x254a0004,                 //addiu $t2, $t2, 4
+        0x2508ffff,                 //addiu $t0, $t0, -1
+        0x1500fffb,                 //bne $t0, $zero, -5
+        0x00000000,                 //nop
+        0xac090210,                 //sw $t1, 0x210($zero)
+        0x00000000,                 //nop
+        0x00000000,                 //nop
+        0x00000000,                 //nop
+        0x1000ffff                  //beq $zero, $zero, -1
+    };
+    reg_init();
+    pipeline_init(&ifid, &idex, &exmem, &memwb, &pc, 0x100);
+    for(pc_t i = 0; i < sizeof(program) / sizeof(word_t); i++){
+        mem_write_w(0x100 + (i << 2), &program[i]);
+    }
+    for(word_t i = 0; i < 5; i++){
+        word_t data = i < 4 ? i + 1 : 0;
+        mem_write_w(0x200 + (i << 2), &data);
+    }
+    hazard_init();
+    cache_init(&sum_cache);
+    bpu_init(&cpu_config);
+    if(decoupled){
+        decoupled_init(pc);
+    }
+    uint32_t cycles = 0;
+    for(clock = 0; clock < 1000; clock++){
+        if(decoupled){
+            decoupled_cycle(ifid, idex, exmem, memwb, &pc, &sum_cache);
+        } else {
+            backup(ifid, idex, exmem, memwb, &pc);
+            writeback(memwb);
+            memory(exmem, memwb, &sum_cache);
+            execute(idex, exmem);
+            decode(ifid, idex);
+            fetch(ifid, &pc, &sum_cache);
+            hazard(ifid, idex, exmem, memwb, &pc, &sum_cache);
+        }
+        cache_digest();
+        cycles++;
+        if(ifid->instr == 0x1000ffff){
+            break;
+        }
+    }
+    if(decoupled){
+        decoupled_stop();
+        decoupled_free();
+    }
+    cache_flush();
+    bpu_free();
+    cache_destroy();
+    hazard_free();
+    pipeline_destroy(&ifid, &idex, &exmem, &memwb);
+    return cycles;
+}
+
+static char * test_decoupled(){
+    uint32_t cycles = run_sum(false);
+    word_t data;
+    mem_read_w(0x210, &data);
+    mu_assert(_FL "pipeline sum does not equal 10!", data == 10);
+    mu_assert(_FL "pipeline did not halt!", cycles < 1000);
+    uint32_t replayed = run_sum(true);
+    mem_read_w(0x210, &data);
+    mu_assert(_FL "decoupled sum does not equal 10!", data == 10);
+    reg_read(REG_T1, &data);
+    mu_assert(_FL "front-end should own the register file", data == 10);
+    mu_assert(_FL "replay should take as many cycles as the pipeline", replayed == cycles);
+    return 0;
+}
+
+// Runs a load, an add and a store under the checker. With stale set,
+// memory changes behind the reference's back after it took its copy.
+static bool run_checked(bool stale, uint32_t *checked){
+    word_t program[] = {
+        0x8c080200,                 //lw $t0, 0x200($zero)
+        0x25090001,                 //addiu $t1, $t0, 1
+        0xac090204,                 //sw $t1, 0x204($zero)
+        0x00000000,                 //nop
+        0x00000000,                 //nop
+        0x00000000,                 //nop
+        0x1000ffff                  //beq $zero, $zero, -1
+    };
+    reg_init();
+    pipeline_init(&ifid, &idex, &exmem, &memwb, &pc, 0);
+    for(pc_t i = 0; i < sizeof(program) / sizeof(word_t); i++){
+        mem_write_w(i << 2, &program[i]);
+    }
+    word_t data = 7;
+    mem_write_w(0x200, &data);
+    checker_init(pc);
+    if(stale){
+        data = 8;
+        mem_write_w(0x200, &data);
+    }
+    bool agreed = true;
+    *checked = 0;
+    for(clock = 0; clock < 20 && agreed && ifid->instr != 0x1000ffff; clock++){
+        execute_pipeline();
+        agreed = checker_cycle(clock + 1);
+    }
+    *checked = *stats_find("checker", "commits")->value;
+    checker_free();
+    pipeline_destroy(&ifid, &idex, &exmem, &memwb);
+    return agreed;
+}
+
+static char * test_checker(){
+    uint32_t checked;
+    mu_assert(_FL "checker should agree with the pipeline", run_checked(false, &checked));
+    mu_assert(_FL "load, add and store should have been checked", checked == 3);
+    mu_assert(_FL "checker should catch the load", !run_checked(true, &checked));
+    mu_assert(_FL "checker should stop at the load", checked == 1);
+    return 0;
+}
 
 static char * all_tests() {
     //Pipeline initialization
@@ -254,6 +912,20 @@ static char * all_tests() {
     mu_run_test(test_bne);
     mu_run_test(test_beq);
     mu_run_test(test_load_dependency);
+    mu_run_test(test_profile_load_use);
+    mu_run_test(test_cpi_stack);
+    mu_run_test(test_pipetrace_load_use);
+    mu_run_test(test_stats_interval);
+    mu_run_test(test_live_stats);
+    mu_run_test(test_bpu_loop);
+    mu_run_test(test_bpu_return);
+    mu_run_test(test_dual_issue);
+    mu_run_test(test_ooo);
+    mu_run_test(test_ooo_branch);
+    mu_run_test(test_multicore_llsc);
+    mu_run_test(test_multicore_quantum);
+    mu_run_test(test_decoupled);
+    mu_run_test(test_checker);
     return 0;
 }
 
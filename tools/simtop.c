@@ -0,0 +1,193 @@
+/* tools/simtop.c
+* Watches a run started with --live-stats: maps its shared memory segment
+* (see src/live.h) and prints how fast it goes and what it is doing, over
+* the last refresh and over the whole run, until it halts.
+*
+* usage: simtop [-i milliseconds] [-b] [name]
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include "../src/live.h"
+
+#define SIMTOP_REFRESH 500  //ms between refreshes by default
+
+static const char * const SIMTOP_CPI_STRINGS[] = {
+    "base", "load_use", "control", "i_miss", "d_miss", "wb_full", "bus"
+};
+
+static bool has(const live_snapshot_t *s, live_counter_t counter){
+    return (s->present >> counter) & 1;
+}
+
+static uint32_t delta(const live_snapshot_t *now, const live_snapshot_t *then, live_counter_t counter){
+    return now->counters[counter] - (then == NULL ? 0 : then->counters[counter]);
+}
+
+/* Prints part / whole as a percentage, or a dash if there is nothing to divide */
+static void percent(double part, double whole){
+    if(whole == 0){
+        printf("%8s", "-");
+    } else {
+        printf("%7.2f%%", 100.0 * part / whole);
+    }
+}
+
+static void hit_rate(const char *name, const live_snapshot_t *now, const live_snapshot_t *then,
+                     live_counter_t reads, live_counter_t writes, live_counter_t read_hits, live_counter_t write_hits){
+    if(!has(now, reads)){
+        return;
+    }
+    printf("%-16s", name);
+    percent(delta(now, then, read_hits) + delta(now, then, write_hits), delta(now, then, reads) + delta(now, then, writes));
+    percent(delta(now, NULL, read_hits) + delta(now, NULL, write_hits), delta(now, NULL, reads) + delta(now, NULL, writes));
+    printf("\n");
+}
+
+/* Prints a screen of what changed between then and now, and since the start */
+static void simtop_print(const char *name, const live_segment_t *segment, const live_snapshot_t *now,
+                         const live_snapshot_t *then, bool batch){
+    double seconds = then == NULL ? 0 : (now->time_ns - then->time_ns) / 1e9;
+    uint32_t cycles = now->cycles - (then == NULL ? 0 : then->cycles);
+    uint32_t instructions = delta(now, then, LIVE_INSTRUCTIONS);
+
+    if(!batch){
+        printf("\x1b[H\x1b[2J");
+    }
+    printf("%s, pid %d, every %u cycles, %s\n", name, segment->pid, segment->every, now->halted ? "halted" : "running");
+    printf("cycle %u, pc 0x%08x\n\n", now->cycles, now->pc);
+    printf("%-16s%8s%8s\n", "", "last", "run");
+    if(seconds > 0){
+        printf("%-16s%8.3f\n", "Mcycles/s", cycles / seconds / 1e6);
+        printf("%-16s%8.3f\n", "MIPS", instructions / seconds / 1e6);
+    }
+    printf("%-16s", "IPC");
+    if(cycles == 0){
+        printf("%8s", "-");
+    } else {
+        printf("%8.4f", (double)instructions / cycles);
+    }
+    printf("%8.4f\n", now->cycles == 0 ? 0.0 : (double)now->counters[LIVE_INSTRUCTIONS] / now->cycles);
+    hit_rate("icache hits", now, then, LIVE_I_READS, LIVE_I_WRITES, LIVE_I_READ_HITS, LIVE_I_WRITE_HITS);
+    hit_rate("dcache hits", now, then, LIVE_D_READS, LIVE_D_WRITES, LIVE_D_READ_HITS, LIVE_D_WRITE_HITS);
+    if(has(now, LIVE_MISPREDICTS)){
+        uint32_t branches = delta(now, then, LIVE_BRANCHES) + delta(now, then, LIVE_JUMPS);
+        uint32_t total = delta(now, NULL, LIVE_BRANCHES) + delta(now, NULL, LIVE_JUMPS);
+        printf("%-16s", "branch accuracy");
+        percent(branches - delta(now, then, LIVE_MISPREDICTS), branches);
+        percent(total - delta(now, NULL, LIVE_MISPREDICTS), total);
+        printf("\n");
+    }
+    if(has(now, LIVE_CPI_BASE)){
+        uint32_t stack = 0, total = 0;
+        printf("\nshare of cycles\n");
+        for(int i = LIVE_CPI_BASE; i <= LIVE_CPI_BUS; i++){
+            stack += delta(now, then, i);
+            total += delta(now, NULL, i);
+        }
+        for(int i = LIVE_CPI_BASE; i <= LIVE_CPI_BUS; i++){
+            printf("  %-14s", SIMTOP_CPI_STRINGS[i - LIVE_CPI_BASE]);
+            percent(delta(now, then, i), stack);
+            percent(delta(now, NULL, i), total);
+            printf("\n");
+        }
+    }
+    if(batch){
+        printf("\n");
+    }
+    fflush(stdout);
+}
+
+/* Maps the segment once the simulator has made it */
+static const live_segment_t *simtop_attach(const char *name, unsigned refresh){
+    bool waiting = false;
+    while(1){
+        int fd = shm_open(name, O_RDONLY, 0);
+        if(fd >= 0){
+            void *map = mmap(NULL, sizeof(live_segment_t), PROT_READ, MAP_SHARED, fd, 0);
+            close(fd);
+            if(map == MAP_FAILED){
+                perror("simtop: mmap");
+                exit(1);
+            }
+            const live_segment_t *segment = (const live_segment_t *)map;
+            if(segment->magic == LIVE_MAGIC){
+                atomic_thread_fence(memory_order_acquire);
+                if(segment->version != LIVE_VERSION){
+                    fprintf(stderr, "simtop: %s is version %u, expected %u\n", name, segment->version, LIVE_VERSION);
+                    exit(1);
+                }
+                return segment;
+            }
+            //Still being set up
+            munmap(map, sizeof(live_segment_t));
+        } else if(errno != ENOENT){
+            perror("simtop: shm_open");
+            exit(1);
+        }
+        if(!waiting){
+            fprintf(stderr, "Waiting for %s...\n", name);
+            waiting = true;
+        }
+        usleep(refresh * 1000);
+    }
+}
+
+int main(int argc, char **argv){
+    const char *name = LIVE_NAME;
+    unsigned refresh = SIMTOP_REFRESH;
+    bool batch = !isatty(STDOUT_FILENO);
+    int c;
+
+    while((c = getopt(argc, argv, "i:bh")) != -1){
+        switch(c){
+            case 'i':
+                refresh = atoi(optarg);
+                if(refresh == 0){
+                    fprintf(stderr, "simtop: invalid refresh: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'b':
+                batch = true;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-i milliseconds] [-b] [name]\n" \
+                                "   Watches a simulator run with --live-stats, %s by default. -b prints\n" \
+                                "   a screen after the other instead of redrawing one.\n", argv[0], LIVE_NAME);
+                return c == 'h' ? 0 : 1;
+        }
+    }
+    if(optind < argc){
+        name = argv[optind];
+    }
+
+    const live_segment_t *segment = simtop_attach(name, refresh);
+    live_snapshot_t now, then;
+    bool have_then = false;
+    while(1){
+        live_read(segment, &now);
+        if(!have_then || now.cycles != then.cycles || now.halted){
+            simtop_print(name, segment, &now, have_then ? &then : NULL, batch);
+            then = now;
+            have_then = true;
+        }
+        if(now.halted){
+            break;
+        }
+        //The simulator died without publishing its last snapshot
+        if(kill(segment->pid, 0) != 0 && errno == ESRCH){
+            fprintf(stderr, "simtop: pid %d is gone\n", segment->pid);
+            return 1;
+        }
+        usleep(refresh * 1000);
+    }
+    return 0;
+}